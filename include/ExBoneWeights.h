@@ -0,0 +1,57 @@
+////////////////////////////////////////////////////////////////////////////////
+// ExBoneWeights.h
+// Start Date : October 17, 2026
+////////////////////////////////////////////////////////////////////////////////
+/*********************************************************************************
+*                                                                                *
+*   This program is free software; you can redistribute it and/or modify         *
+*   it under the terms of the GNU Lesser General Public License as published by  *
+*   the Free Software Foundation; either version 2 of the License, or            *
+*   (at your option) any later version.                                          *
+*                                                                                *
+**********************************************************************************/
+
+#ifndef _EXBONEWEIGHTS_H
+#define _EXBONEWEIGHTS_H
+
+// Vertex bone influences packing, no Max or Ogre dependency.
+#include <vector>
+#include "ExVertexStore.h"
+
+namespace EasyOgreExporter
+{
+  /**
+  * Reduce the bone influences of a vertex to maxInfluences.
+  * The weights of a same bone are merged and the null weights dropped, then the largest weights are kept
+  * so the removed part is as small as possible, and the kept weights are scaled to sum to 1.
+  * weights, bones : count influences
+  * outWeights, outBones : receive maxInfluences values sorted by decreasing weight, the unused ones are 0
+  * removedWeight : receive the part of the total weight dropped by the reduction
+  * return the number of distinct bones with a weight before the reduction
+  **/
+  unsigned int reduceInfluences(const float* weights, const int* bones, unsigned int count, unsigned int maxInfluences, float* outWeights, int* outBones, float& removedWeight);
+
+  /**
+  * Quantize normalized weights on bytes summing exactly to 255.
+  * The weights are rounded down then the units left go to the largest remainders, each error stays under 1/255.
+  **/
+  void quantizeWeights(const float* weights, unsigned int count, unsigned char* out);
+
+  /**
+  * Blend index of each bone for a vertex set, like the map Ogre Mesh::buildIndexMap makes from the bone assignments.
+  * The bones with a weight on these vertices are sorted by handle and the blend index is their rank in that list.
+  * vertices : handles of the store vertices, all the vertices of a geometry chunk
+  * blendIndices : receive the blend index of each bone handle up to the largest one used, -1 for the bones not used
+  * return the number of bones used
+  **/
+  unsigned int buildBlendIndexMap(const ExVertexStore& store, const std::vector<unsigned int>& vertices, std::vector<int>& blendIndices);
+
+  /**
+  * Pack the blend indices of a vertex on 4 bytes through a map of buildBlendIndexMap.
+  * The influences without weight and the slots over count are 0, like the Ogre blend buffers.
+  **/
+  void packBlendIndices(const float* weights, const int* bones, unsigned int count, const std::vector<int>& blendIndices, unsigned char* out);
+
+}; // end of namespace
+
+#endif
@@ -0,0 +1,110 @@
+////////////////////////////////////////////////////////////////////////////////
+// ExEdgeListBuilder.h
+// Start Date : October 17, 2026
+////////////////////////////////////////////////////////////////////////////////
+/*********************************************************************************
+*                                                                                *
+*   This program is free software; you can redistribute it and/or modify         *
+*   it under the terms of the GNU Lesser General Public License as published by  *
+*   the Free Software Foundation; either version 2 of the License, or            *
+*   (at your option) any later version.                                          *
+*                                                                                *
+**********************************************************************************/
+
+#ifndef _EXEDGELISTBUILDER_H
+#define _EXEDGELISTBUILDER_H
+
+// Edge list of the stencil shadows, no Max or Ogre dependency.
+#include <vector>
+#include "ExVertexStore.h"
+
+namespace EasyOgreExporter
+{
+  // same content as Ogre EdgeData::Triangle
+  class ExEdgeTriangle
+  {
+  public:
+    //index set (submesh) and vertex set of the triangle
+    unsigned int indexSet;
+    unsigned int vertexSet;
+    //indices in the vertex set
+    unsigned int vertIndex[3];
+    //indices of the welded positions, common to all the vertex sets
+    unsigned int sharedVertIndex[3];
+  };
+
+  // same content as Ogre EdgeData::Edge
+  class ExEdge
+  {
+  public:
+    //the second triangle is 0xffffffff on the open edges
+    unsigned int triIndex[2];
+    unsigned int vertIndex[2];
+    unsigned int sharedVertIndex[2];
+    //only one triangle use the edge
+    bool degenerate;
+  };
+
+  // same content as Ogre EdgeData::EdgeGroup
+  class ExEdgeGroup
+  {
+  public:
+    unsigned int vertexSet;
+    //triangles of the vertex set
+    unsigned int triStart;
+    unsigned int triCount;
+    std::vector<ExEdge> edges;
+  };
+
+  class ExEdgeData
+  {
+  public:
+    //triangles grouped by vertex set
+    std::vector<ExEdgeTriangle> triangles;
+    //4 floats per triangle, the face normal (not normalized) and the plane distance
+    std::vector<float> faceNormals;
+    //one group per vertex set
+    std::vector<ExEdgeGroup> edgeGroups;
+    //every edge is shared by two triangles
+    bool isClosed;
+  };
+
+  /**
+  * Build the edge list of a mesh with the same result as Ogre EdgeListBuilder.
+  * The positions are welded by value with a hash table and the edges are matched in a flat open addressing map
+  * keyed by the welded position pair, each index set on its own thread.
+  * The edges left open by an index set are then matched with the other index sets, in the index sets order.
+  **/
+  class ExEdgeListBuilder
+  {
+  public:
+    //constructor, the store must stay valid while the builder is used
+    ExEdgeListBuilder(const ExVertexStore& store);
+
+    //destructor
+    ~ExEdgeListBuilder();
+
+    //add a vertex set, the shared geometry or the vertices of a submesh, and return its index
+    //vertices : store handles in the vertex buffer order, the vector must stay valid until build
+    unsigned int addVertexSet(const std::vector<unsigned int>& vertices);
+
+    //add the triangle list of a submesh, using the indices of a vertex set
+    //the vector must stay valid until build
+    void addIndexSet(const std::vector<unsigned int>& indices, unsigned int vertexSet);
+
+    //build the edge list
+    //numThreads : 0 use the number of hardware threads
+    void build(ExEdgeData& data, unsigned int numThreads = 0);
+
+  private:
+    void weldPositions(std::vector<unsigned int>& positionIds);
+
+    const ExVertexStore& m_store;
+    std::vector<const std::vector<unsigned int>*> m_vertexSets;
+    std::vector<const std::vector<unsigned int>*> m_indexSets;
+    std::vector<unsigned int> m_indexVertexSets;
+  };
+
+}; // end of namespace
+
+#endif
@@ -0,0 +1,72 @@
+////////////////////////////////////////////////////////////////////////////////
+// ExExportCache.h
+// Start Date : October 17, 2026
+////////////////////////////////////////////////////////////////////////////////
+/*********************************************************************************
+*                                                                                *
+*   This program is free software; you can redistribute it and/or modify         *
+*   it under the terms of the GNU Lesser General Public License as published by  *
+*   the Free Software Foundation; either version 2 of the License, or            *
+*   (at your option) any later version.                                          *
+*                                                                                *
+**********************************************************************************/
+
+#ifndef _EXEXPORTCACHE_H
+#define _EXEXPORTCACHE_H
+
+// Incremental export manifest, no Max or Ogre dependency.
+#include <map>
+#include <string>
+
+namespace EasyOgreExporter
+{
+  /**
+  * Hashes of the files written by the previous export.
+  * A file whose content hash did not change and which still exists on disk is not written again.
+  * The files not exported this time keep their entry, a file written without hash loses it.
+  **/
+  class ExExportCache
+  {
+  public:
+    //constructor
+    ExExportCache();
+
+    //load the manifest of the previous export, forceRebuild ignores it
+    void load(const std::string& path, bool forceRebuild);
+
+    //write the manifest of the current export
+    bool save();
+
+    //true when the file was written with the same hash and still exists, the entry is kept
+    //data receive the values stored with the file
+    bool isUpToDate(const std::string& file, const std::string& hash, std::string* data = 0);
+
+    //record a written file, an empty hash removes its entry
+    void update(const std::string& file, const std::string& hash, const std::string& data = "");
+
+    //forget a file whose writing failed
+    void invalidate(const std::string& file);
+
+    unsigned int getNumSkipped() const;
+    unsigned int getNumWritten() const;
+
+    //size and modification time of a source file, empty if it does not exist
+    static std::string getFileStamp(const std::string& path);
+
+  private:
+    class Entry
+    {
+    public:
+      std::string hash;
+      std::string data;
+    };
+
+    std::string m_path;
+    std::map<std::string, Entry> m_entries;
+    unsigned int m_numSkipped;
+    unsigned int m_numWritten;
+  };
+
+}; // end of namespace
+
+#endif
@@ -0,0 +1,72 @@
+////////////////////////////////////////////////////////////////////////////////
+// ExHash.h
+// Start Date : October 17, 2026
+////////////////////////////////////////////////////////////////////////////////
+/*********************************************************************************
+*                                                                                *
+*   This program is free software; you can redistribute it and/or modify         *
+*   it under the terms of the GNU Lesser General Public License as published by  *
+*   the Free Software Foundation; either version 2 of the License, or            *
+*   (at your option) any later version.                                          *
+*                                                                                *
+**********************************************************************************/
+
+#ifndef _EXHASH_H
+#define _EXHASH_H
+
+// Content hashing, no Max or Ogre dependency.
+#include <stddef.h>
+#include <string>
+#include <vector>
+
+namespace EasyOgreExporter
+{
+  /**
+  * Streaming 128 bits content hash.
+  * Two independent 64 bits lanes process the data by 8 bytes words, the result is used as a content key
+  * (mesh fingerprints, export cache) so the collision probability must stay negligible on large scenes.
+  **/
+  class ExHasher
+  {
+  public:
+    //constructor
+    ExHasher();
+
+    //add raw bytes
+    void add(const void* data, size_t size);
+
+    //add a value, with its size so consecutive values can not alias
+    void addInt(long long value);
+    void addFloat(float value);
+    void addString(const std::string& value);
+
+    //add an array and its size
+    template <typename T> void addArray(const T* data, size_t count)
+    {
+      addInt((long long)count);
+      if (count > 0)
+        add(data, count * sizeof(T));
+    };
+
+    template <typename T> void addVector(const std::vector<T>& data)
+    {
+      addArray(data.empty() ? (const T*)0 : &data[0], data.size());
+    };
+
+    //hash of all the data added, as 32 hexadecimal characters
+    std::string toString() const;
+
+  private:
+    void addWord(unsigned long long word);
+
+    unsigned long long m_lane0;
+    unsigned long long m_lane1;
+    unsigned long long m_length;
+    //pending bytes of an incomplete word
+    unsigned char m_tail[8];
+    unsigned int m_tailSize;
+  };
+
+}; // end of namespace
+
+#endif
@@ -138,7 +138,7 @@ namespace EasyOgreExporter
 		bool load();
 
 		//write material data to Ogre material script
-		bool writeOgreScript(std::ofstream &outMaterial, ExShader* vsAmbShader, ExShader* fpAmbShader, ExShader* vsLightShader, ExShader* fpLightShader);
+		bool writeOgreScript(std::ostream &outMaterial, ExShader* vsAmbShader, ExShader* fpAmbShader, ExShader* vsLightShader, ExShader* fpLightShader);
 
     std::string getShaderName(ExShader::ShaderType type, std::string prefix);
   private:
@@ -147,8 +147,8 @@ namespace EasyOgreExporter
     void loadArchitectureMaterial(IGameMaterial* pGameMaterial);
     void loadArchAndDesignMaterial(IGameMaterial* pGameMaterial);
     void loadStandardMaterial(IGameMaterial* pGameMaterial);
-    void writeMaterialTechnique(std::ofstream &outMaterial, int lod, ExShader* vsAmbShader, ExShader* fpAmbShader, ExShader* vsLightShader, ExShader* fpLightShader);
-    void writeMaterialPass(std::ofstream &outMaterial, int lod, ExShader* vsShader, ExShader* fpShader, ExShader::ShaderPass pass);
+    void writeMaterialTechnique(std::ostream &outMaterial, int lod, ExShader* vsAmbShader, ExShader* fpAmbShader, ExShader* vsLightShader, ExShader* fpLightShader);
+    void writeMaterialPass(std::ostream &outMaterial, int lod, ExShader* vsShader, ExShader* fpShader, ExShader::ShaderPass pass);
 		bool exportColor(Point4& color, IGameProperty* pGameProperty);
     bool exportSpecular(IGameMaterial* pGameMaterial);
     std::string getMaterialName(std::string prefix);
@@ -36,6 +36,7 @@ namespace EasyOgreExporter
     std::vector<std::string> m_textures;
     std::vector<ExShader*> m_Shaders;
     ExMaterial* m_default;
+    ExOgreConverter* m_converter;
   protected:
 
 	public:
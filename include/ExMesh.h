@@ -24,161 +24,24 @@
 #include "ExPrerequisites.h"
 #include "ExOgreConverter.h"
 #include "ExSkeleton.h"
+#include "ExVertexStore.h"
+#include "ExMeshSnapshot.h"
+#include "ExMorphFrames.h"
 
 namespace EasyOgreExporter
 {
-  class ExFace
-  {
-  public:
-		  //constructor
-      ExFace()
-      {
-      };
-
-      //destructor
-		  ~ExFace()
-      {
-        vertices.clear();
-      };
-
-      bool operator==(ExFace const& b)
-      {
-        if(vertices.size() != b.vertices.size())
-          return false;
-
-        if(vertices.size() != 3)
-          return false;
-
-        return ((vertices[0] == b.vertices[0]) && (vertices[1] == b.vertices[1]) && (vertices[2] == b.vertices[2])) ||
-               ((vertices[0] == b.vertices[0]) && (vertices[1] == b.vertices[2]) && (vertices[2] == b.vertices[1])) ||
-               ((vertices[0] == b.vertices[1]) && (vertices[1] == b.vertices[2]) && (vertices[2] == b.vertices[0])) ||
-               ((vertices[0] == b.vertices[1]) && (vertices[1] == b.vertices[0]) && (vertices[2] == b.vertices[2])) ||
-               ((vertices[0] == b.vertices[2]) && (vertices[1] == b.vertices[1]) && (vertices[2] == b.vertices[0])) ||
-               ((vertices[0] == b.vertices[2]) && (vertices[1] == b.vertices[0]) && (vertices[2] == b.vertices[1]));
-      };
-
-      bool operator!=(ExFace const& b)
-      {
-        if(vertices.size() != b.vertices.size())
-          return true;
-
-        if(vertices.size() != 3)
-          return true;
-
-        return ((vertices[0] != b.vertices[0]) || (vertices[1] != b.vertices[1]) || (vertices[2] != b.vertices[2])) &&
-               ((vertices[0] != b.vertices[0]) || (vertices[1] != b.vertices[2]) || (vertices[2] != b.vertices[1])) &&
-               ((vertices[0] != b.vertices[1]) || (vertices[1] != b.vertices[2]) || (vertices[2] != b.vertices[0])) &&
-               ((vertices[0] != b.vertices[1]) || (vertices[1] != b.vertices[0]) || (vertices[2] != b.vertices[2])) &&
-               ((vertices[0] != b.vertices[2]) || (vertices[1] != b.vertices[1]) || (vertices[2] != b.vertices[0])) &&
-               ((vertices[0] != b.vertices[2]) || (vertices[1] != b.vertices[0]) || (vertices[2] != b.vertices[1]));
-      };
-
-      // vertice indices
-      std::vector<int> vertices;
-
-      int iMaxId;
-      int iMaterialId;
-  };
-
-  class ExVertex
-  {
-  public:
-		  //constructor
-      ExVertex()
-      {
-        iMaxId = -1;
-      };
-
-      ExVertex(const ExVertex &vert)
-      {
-        iMaxId = vert.iMaxId;
-        vPos = Point3(vert.vPos);
-        vNorm = Point3(vert.vNorm);
-        vColor = Point4(vert.vColor);
-        lTexCoords = vert.lTexCoords;
-        lTangent = vert.lTangent;
-        lBinormal = vert.lBinormal;
-        lWeight = vert.lWeight;
-        lBoneIndex = vert.lBoneIndex;
-      };
-
-		  //constructor
-      ExVertex(int id)
-      {
-        iMaxId = id;
-      };
-  	  
-      //destructor
-		  ~ExVertex()
-      {
-        lTexCoords.clear();
-        lTangent.clear();
-        lBinormal.clear();
-        lWeight.clear();
-        lBoneIndex.clear();
-      }
-
-      bool cmpPointList(const std::vector<Point3>& l1, const std::vector<Point3>& l2, float sensivity)
-      {
-	      int l1_size = l1.size();
-        if (l1_size != l2.size())
-          return false;
-
-        bool ret = true;
-        int i = 0;
-        while(i < l1_size)
-        {
-          Point3 uv1 = l1[i];
-          Point3 uv2 = l2[i];
-          if(!(uv1.Equals(uv2, sensivity)))
-          {
-            ret = false;
-      			break;
-		      }
-          i++;
-        }
-
-        return ret;
-      };
-
-      bool operator==(ExVertex const& b)
-      {
-        const static float sensivity = 0.000001f;
-
-		    return (vPos.Equals(b.vPos, sensivity) && 
-            vNorm.Equals(b.vNorm, sensivity) && 
-            vColor.Equals(b.vColor, sensivity) &&
-            /*(iMaxId == b.iMaxId) &&*/ cmpPointList(lTexCoords, b.lTexCoords, sensivity) && cmpPointList(lTangent, b.lTangent, sensivity) && cmpPointList(lBinormal, b.lBinormal, sensivity));
-      };
-
-      bool operator!=(ExVertex const& b)
-      {
-        const static float sensivity = 0.000001f;
-        return (!vPos.Equals(b.vPos, sensivity) ||
-            !vNorm.Equals(b.vNorm, sensivity) || 
-            !vColor.Equals(b.vColor, sensivity) ||
-            /*(iMaxId != b.iMaxId) ||*/ (!cmpPointList(lTexCoords, b.lTexCoords, sensivity)) || (!cmpPointList(lTangent, b.lTangent, sensivity)) || (!cmpPointList(lBinormal, b.lBinormal, sensivity)));
-      };
-
-      int iMaxId;
-
-      // next same vertex index in vertices list with the same position
-      Point3 vPos;
-      Point3 vNorm;
-      Point4 vColor;
-      std::vector<Point3> lTexCoords;
-      std::vector<Point3> lTangent;
-      std::vector<Point3> lBinormal;
-      std::vector<float> lWeight;
-      std::vector<int> lBoneIndex;
-  };
-
   class ExSubMesh
   {
   public:
-    std::vector<ExVertex> m_vertices;
-    std::vector<ExFace> m_faces;
+    //handles of the mesh vertices used by the submesh, in local index order
+    std::vector<unsigned int> m_vertices;
+    //snapshot face of each triangle
+    std::vector<int> m_faces;
+    //triangle list using the local vertex indices, 3 per face
+    std::vector<int> m_indices;
     int id;
+    //Max material id of the faces
+    int m_matId;
     ExMaterial* m_mat;
   protected:
   private:
@@ -188,6 +51,7 @@ namespace EasyOgreExporter
     ExSubMesh(int idx, ExMaterial* mat)
     {
       id = idx;
+      m_matId = -1;
       m_mat = mat;
     };
 	  
@@ -196,12 +60,41 @@ namespace EasyOgreExporter
     {
       m_vertices.clear();
       m_faces.clear();
+      m_indices.clear();
     };
 
   protected:
   private:
   };
 
+  //mesh file settings, read from Max before writing
+  class ExMeshWriteSettings
+  {
+  public:
+    //false when the mesh has no vertices to write
+    bool valid;
+    std::string meshfile;
+    //written by ExMeshSerializer, no Max or Ogre call
+    bool native;
+    bool edgeList;
+    bool generateLOD;
+    int lodLevels;
+    float lodReduction;
+    float compressionError;
+
+    //constructor
+    ExMeshWriteSettings()
+    {
+      valid = false;
+      native = false;
+      edgeList = false;
+      generateLOD = false;
+      lodLevels = 0;
+      lodReduction = 0.0f;
+      compressionError = 0.0f;
+    };
+  };
+
 	class ExMesh
 	{
   public:
@@ -219,12 +112,30 @@ namespace EasyOgreExporter
     ExSkeleton* m_pSkeleton;
     Matrix3 offsetTM;
 
-    //faces with new vertices index
-    std::vector<ExFace> m_faces;
+    //3 vertex handles per snapshot face, only kept for the shared geometry
+    std::vector<int> m_faceVertices;
     //cleaned and sorted vertices
-    std::vector<ExVertex> m_vertices;
+    ExVertexStore m_vertices;
     std::vector<ExSubMesh> m_subList;
     unsigned int m_numTextureChannel;
+    //write the packed bone influences in the vertices
+    bool m_blendElements;
+    //Max data copy used by the processing
+    ExMeshSnapshot m_snapshot;
+    //a morph target did not match the base mesh, the following targets and the poses animations are not exported
+    bool m_morphError;
+    //loaded materials by Max material id
+    std::map<int, ExMaterial*> m_materials;
+    //hash of the snapshot and material bindings, known before the processing
+    std::string m_contentHash;
+    //prepareMesh was run
+    bool m_prepared;
+    //settings of the next writeOgreBinary, read by setupWrite
+    ExMeshWriteSettings m_writeSettings;
+    bool m_writeReady;
+    //the native file was written by writeNativeBinary, its result is returned by the next writeOgreBinary
+    bool m_nativeWritten;
+    bool m_nativeResult;
 
   private:
 
@@ -235,26 +146,62 @@ namespace EasyOgreExporter
     //destructor
 		~ExMesh();
 	
+    //build the vertices and submeshes from the snapshot
+    //no Max call, it can run on a worker thread
+    void prepareMesh();
+    bool isPrepared();
+    //captured data size in bytes, used to bound the meshes waiting to be processed
+    size_t getSnapshotSize();
+    //submeshes of a mesh file kept from the previous export, only their materials are set
+    void setCachedSubMeshes(const std::vector<int>& matIds);
+
 		//write to a OGRE binary mesh
 		bool writeOgreBinary();
+    //read the write settings from Max, true when the file is written by the native serializer
+    bool setupWrite();
+    //write the native file set by setupWrite, no Max or Ogre call so it can run on a worker thread
+    void writeNativeBinary(unsigned int numThreads);
     std::vector<ExMaterial*> getMaterials();
+    //Max material id of each submesh
+    std::vector<int> getMaterialIds();
+    const std::string& getName();
+
+    //content fingerprint of the mesh file, empty when the mesh can not be shared by other nodes
+    std::string getFingerprint();
+    //hash of everything written in the mesh file for the export cache, empty when it can not be known before writing
+    std::string getCacheHash();
     
     // get pointer to linked skeleton
     ExSkeleton* getSkeleton();
 
   protected:
-    void prepareMesh(Mesh* mMesh);
-    std::vector<ExFace> GetFacesByMaterialId(int matId);
-    Ogre::SubMesh* createOgreSubmesh(ExSubMesh submesh);
+    void captureSnapshot(Mesh* mMesh);
+    void captureMorphTargets();
+    void loadMaterials();
+    void computeContentHash();
+    void getObjectProperties(BOOL& ignoreLOD, float& compressionError, int& lodLevels, float& lodReduction, BOOL& ignoreEdges);
+    //3 indices of a submesh face, in the shared vertices or in the submesh vertices
+    const int* getSubMeshFace(const ExSubMesh& submesh, size_t face);
+    Ogre::SubMesh* createOgreSubmesh(const ExSubMesh& submesh);
     bool createOgreSharedGeometry();
-    void buildOgreGeometry(Ogre::VertexData* vdata, std::vector<ExVertex> verticesList);
-		ExMaterial* loadMaterial(IGameMaterial* pGameMaterial);
+    //blend indices and weights can be written in the vertices
+    bool useBlendElements();
+    void buildOgreGeometry(Ogre::VertexData* vdata, const std::vector<unsigned int>& vertices);
+    void compressVertexBuffers(float maxError);
+    //index only LOD levels simplified from the submeshes
+    void createLodLevels(int numLevels, float reduction);
+    //write the mesh file without building an Ogre mesh, no LOD or vertex animation
+    bool writeNativeMesh(const std::string& meshfile, bool edgeList, unsigned int numThreads);
     void getModifiers();
     void createPoses();
-    bool exportPosesAnimation(Interval animRange, std::string name, std::vector<morphChannel*> validChan, std::vector<std::vector<int>> poseIndexList, bool bDefault);
+    bool exportPosesAnimation(Interval animRange, std::string name, std::vector<morphChannel*> validChan, const std::vector<std::vector<int>>& poseIndexList, bool bDefault);
     bool exportMorphAnimation(Interval animRange, std::string name);
+    //evaluate the mesh once per key time and keep the export space positions of the frame vertices
+    void sampleMorphFrames(const std::vector<int>& animKeys, ExMorphFrames& frames);
     void createMorphAnimations();
     void updateBounds(Point3);
+    //extend the bounds with the skinned vertices on the sampled skeleton poses
+    void updateSkinBounds();
     bool haveVertexColor;
     bool haveVertexAlpha;
     bool haveVertexIllum;
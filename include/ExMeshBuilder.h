@@ -0,0 +1,166 @@
+////////////////////////////////////////////////////////////////////////////////
+// ExMeshBuilder.h
+// Start Date : October 17, 2026
+////////////////////////////////////////////////////////////////////////////////
+/*********************************************************************************
+*                                                                                *
+*   This program is free software; you can redistribute it and/or modify         *
+*   it under the terms of the GNU Lesser General Public License as published by  *
+*   the Free Software Foundation; either version 2 of the License, or            *
+*   (at your option) any later version.                                          *
+*                                                                                *
+**********************************************************************************/
+
+#ifndef _EXMESHBUILDER_H
+#define _EXMESHBUILDER_H
+
+// Mesh processing on a captured snapshot, no Max or Ogre dependency.
+#include "ExMeshSnapshot.h"
+#include "ExVertexStore.h"
+
+namespace EasyOgreExporter
+{
+  // faces of one material, or one spatial chunk of it
+  class ExBuiltSubMesh
+  {
+  public:
+    //material id of the faces
+    int materialId;
+    //snapshot face of each triangle
+    std::vector<int> faces;
+    //triangle list using the local vertex indices
+    std::vector<int> indices;
+    //store handle of each local vertex
+    std::vector<unsigned int> vertices;
+  };
+
+  // mesh vertex with more bone influences than the vertices keep
+  class ExInfluenceReport
+  {
+  public:
+    //snapshot vertex
+    int vertex;
+    //distinct bones with a weight
+    unsigned int numInfluences;
+    //part of the weight removed before the renormalization
+    float removedWeight;
+  };
+
+  /**
+  * Build the welded vertices and the submeshes from a mesh snapshot.
+  **/
+  class ExMeshBuilder
+  {
+  public:
+    //constructor, the snapshot must stay valid while the builder is used
+    ExMeshBuilder(const ExMeshSnapshot& snapshot);
+
+    //destructor
+    ~ExMeshBuilder();
+
+    //weld the corners and group the faces by material
+    //materials using more than maxSubMeshVertices vertices are split in spatial chunks, 0 never split
+    void build(float weldTolerance, unsigned int maxSubMeshVertices = 0);
+
+    //bone influences kept per vertex, the others are removed and the weights renormalized
+    void setMaxInfluences(unsigned int maxInfluences)
+    {
+      m_maxInfluences = maxInfluences;
+    };
+
+    //uv set used to compute a tangent per vertex before the weld, -1 for no tangents
+    void setTangentTexCoordSet(int set)
+    {
+      m_tangentTexCoordSet = set;
+    };
+
+    //reorder the triangles and the local vertices of a submesh for the vertex cache
+    //overdraw : also sort the triangle clusters to reduce the overdraw
+    void optimizeSubMesh(unsigned int sub, unsigned int cacheSize, bool overdraw, float overdrawThreshold);
+
+    //reorder the store by first use in the submeshes, for shared geometry
+    void optimizeSharedVertices();
+
+    //extend the bounds with a position, 3 floats
+    void extendBounds(const float* pos);
+
+    ExVertexStore& getVertices()
+    {
+      return m_vertices;
+    };
+
+    //3 store handles per snapshot face
+    const std::vector<int>& getFaceVertices() const
+    {
+      return m_faceVertices;
+    };
+
+    std::vector<int>& getFaceVertices()
+    {
+      return m_faceVertices;
+    };
+
+    unsigned int getNumSubMeshes() const
+    {
+      return m_subMeshes.size();
+    };
+
+    const ExBuiltSubMesh& getSubMesh(unsigned int sub) const
+    {
+      return m_subMeshes[sub];
+    };
+
+    ExBuiltSubMesh& getSubMesh(unsigned int sub)
+    {
+      return m_subMeshes[sub];
+    };
+
+    bool hasBounds() const
+    {
+      return m_hasBounds;
+    };
+
+    //3 floats
+    const float* getBoundsMin() const
+    {
+      return m_boundsMin;
+    };
+
+    const float* getBoundsMax() const
+    {
+      return m_boundsMax;
+    };
+
+    //distance of the farthest position from the origin
+    float getRadius() const
+    {
+      return m_radius;
+    };
+
+    //mesh vertices with their influences reduced by the build
+    const std::vector<ExInfluenceReport>& getReducedInfluences() const
+    {
+      return m_reducedInfluences;
+    };
+
+  private:
+    void weldCorners(float weldTolerance);
+    void buildSubMeshes(unsigned int maxSubMeshVertices);
+
+    const ExMeshSnapshot& m_snapshot;
+    int m_tangentTexCoordSet;
+    unsigned int m_maxInfluences;
+    std::vector<ExInfluenceReport> m_reducedInfluences;
+    ExVertexStore m_vertices;
+    std::vector<int> m_faceVertices;
+    std::vector<ExBuiltSubMesh> m_subMeshes;
+
+    bool m_hasBounds;
+    float m_boundsMin[3];
+    float m_boundsMax[3];
+    float m_radius;
+  };
+
+}; // end of namespace
+
+#endif
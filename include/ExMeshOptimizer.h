@@ -0,0 +1,85 @@
+////////////////////////////////////////////////////////////////////////////////
+// ExMeshOptimizer.h
+// Start Date : October 17, 2026
+////////////////////////////////////////////////////////////////////////////////
+/*********************************************************************************
+*                                                                                *
+*   This program is free software; you can redistribute it and/or modify         *
+*   it under the terms of the GNU Lesser General Public License as published by  *
+*   the Free Software Foundation; either version 2 of the License, or            *
+*   (at your option) any later version.                                          *
+*                                                                                *
+**********************************************************************************/
+
+#ifndef _EXMESHOPTIMIZER_H
+#define _EXMESHOPTIMIZER_H
+
+// Index buffer processing on raw triangle lists, no Max or Ogre dependency.
+#include <stddef.h>
+#include <vector>
+
+namespace EasyOgreExporter
+{
+  /**
+  * Group the faces by key (material id) with a counting sort, in one pass over the faces.
+  * faceKeys : key of each face
+  * keys : receive the distinct keys in ascending order
+  * bucketStart : receive the first entry in faceOrder of each key, plus the end of the last bucket
+  * faceOrder : receive the face indices grouped by key, faces keep their order in each bucket
+  **/
+  void bucketFaces(const std::vector<int>& faceKeys, std::vector<int>& keys, std::vector<int>& bucketStart, std::vector<int>& faceOrder);
+
+  /**
+  * Build a compact vertex table for a sub set of triangles.
+  * indices : triangle list using the global vertex indices
+  * localIndices : receive the triangle list using the local vertex indices
+  * usedVertices : receive the global index of each local vertex, in order of first use
+  * remapTable : scratch table, it is resized to numVertices and left filled with -1 so it can be reused for the next sub set
+  **/
+  void remapIndices(const std::vector<int>& indices, unsigned int numVertices, std::vector<int>& localIndices, std::vector<int>& usedVertices, std::vector<int>& remapTable);
+
+  /**
+  * Split a triangle list in spatially coherent chunks using at most maxVertices vertices each.
+  * The triangles are recursively split at the median of their centroids on the largest axis.
+  * positions : 3 floats per vertex
+  * triangleOrder : receive the triangles grouped by chunk
+  * chunkStart : receive the first entry in triangleOrder of each chunk, plus the end of the last chunk
+  **/
+  void splitTriangles(const std::vector<int>& indices, const float* positions, unsigned int numVertices, unsigned int maxVertices, std::vector<int>& triangleOrder, std::vector<int>& chunkStart);
+
+  /**
+  * Reorder the triangles for the post transform vertex cache (Tom Forsyth linear speed vertex cache optimisation).
+  * indices : triangle list, reordered in place
+  * cacheSize : size of the simulated LRU cache
+  * triangleOrder : if set, receive the source triangle of each output triangle
+  **/
+  void optimizeVertexCache(std::vector<int>& indices, unsigned int numVertices, unsigned int cacheSize, std::vector<int>* triangleOrder = 0);
+
+  /**
+  * Reorder the clusters of a cache optimized triangle list to reduce the overdraw.
+  * The list is split where the vertex cache is reset and where the cluster keep an ACMR under threshold * the ACMR of its parent cluster,
+  * then the clusters are sorted by their view independent occlusion potential (most outward facing first).
+  * indices : triangle list, reordered in place
+  * positions : 3 floats per vertex
+  * threshold : max ACMR increase allowed, 1.05 allow 5% more vertex transforms
+  * triangleOrder : if set, receive the source triangle of each output triangle
+  **/
+  void optimizeOverdraw(std::vector<int>& indices, const float* positions, unsigned int numVertices, unsigned int cacheSize, float threshold, std::vector<int>* triangleOrder = 0);
+
+  /**
+  * Reorder the vertices by first use in the triangle list so the vertex fetch is linear.
+  * indices : triangle list, remapped in place
+  * vertexOrder : receive the source vertex of each output vertex, unused vertices are dropped
+  **/
+  void optimizeVertexFetch(std::vector<int>& indices, unsigned int numVertices, std::vector<int>& vertexOrder);
+
+  /**
+  * Simulate a FIFO vertex cache on a triangle list.
+  * return the average cache miss ratio (transformed vertices per triangle)
+  * atvr : if set, receive the average transformed vertices ratio (transformed vertices per referenced vertex)
+  **/
+  float computeACMR(const std::vector<int>& indices, unsigned int numVertices, unsigned int cacheSize, float* atvr = 0);
+
+}; // end of namespace
+
+#endif
@@ -0,0 +1,174 @@
+////////////////////////////////////////////////////////////////////////////////
+// ExMeshSerializer.h
+// Start Date : October 17, 2026
+////////////////////////////////////////////////////////////////////////////////
+/*********************************************************************************
+*                                                                                *
+*   This program is free software; you can redistribute it and/or modify         *
+*   it under the terms of the GNU Lesser General Public License as published by  *
+*   the Free Software Foundation; either version 2 of the License, or            *
+*   (at your option) any later version.                                          *
+*                                                                                *
+**********************************************************************************/
+
+#ifndef _EXMESHSERIALIZER_H
+#define _EXMESHSERIALIZER_H
+
+// Ogre .mesh file writer, no Max or Ogre dependency.
+#include <stddef.h>
+#include <fstream>
+#include <string>
+#include <utility>
+#include <vector>
+#include "ExVertexStore.h"
+#include "ExEdgeListBuilder.h"
+
+namespace EasyOgreExporter
+{
+  // Ogre mesh chunk identifiers (OgreMeshFileFormat.h)
+  enum ExMeshChunkId
+  {
+    EX_M_HEADER = 0x1000,
+    EX_M_MESH = 0x3000,
+    EX_M_SUBMESH = 0x4000,
+    EX_M_SUBMESH_OPERATION = 0x4010,
+    EX_M_SUBMESH_BONE_ASSIGNMENT = 0x4100,
+    EX_M_GEOMETRY = 0x5000,
+    EX_M_GEOMETRY_VERTEX_DECLARATION = 0x5100,
+    EX_M_GEOMETRY_VERTEX_ELEMENT = 0x5110,
+    EX_M_GEOMETRY_VERTEX_BUFFER = 0x5200,
+    EX_M_GEOMETRY_VERTEX_BUFFER_DATA = 0x5210,
+    EX_M_MESH_SKELETON_LINK = 0x6000,
+    EX_M_MESH_BONE_ASSIGNMENT = 0x7000,
+    EX_M_MESH_BOUNDS = 0x9000,
+    EX_M_SUBMESH_NAME_TABLE = 0xA000,
+    EX_M_SUBMESH_NAME_TABLE_ELEMENT = 0xA100,
+    EX_M_EDGE_LISTS = 0xB000,
+    EX_M_EDGE_LIST_LOD = 0xB100,
+    EX_M_EDGE_GROUP = 0xB110
+  };
+
+  // Ogre VertexElementType and VertexElementSemantic values used by the exporter
+  enum ExVertexElementType
+  {
+    EX_VET_FLOAT1 = 0,
+    EX_VET_FLOAT2 = 1,
+    EX_VET_FLOAT3 = 2,
+    EX_VET_FLOAT4 = 3,
+    EX_VET_COLOUR = 4,
+    EX_VET_UBYTE4 = 9,
+    EX_VET_UBYTE4_NORM = 30
+  };
+
+  enum ExVertexElementSemantic
+  {
+    EX_VES_POSITION = 1,
+    EX_VES_BLEND_WEIGHTS = 2,
+    EX_VES_BLEND_INDICES = 3,
+    EX_VES_NORMAL = 4,
+    EX_VES_DIFFUSE = 5,
+    EX_VES_TEXTURE_COORDINATES = 7,
+    EX_VES_TANGENT = 8
+  };
+
+  // Ogre RenderOperation::OT_TRIANGLE_LIST
+  const unsigned short EX_OT_TRIANGLE_LIST = 4;
+
+  class ExVertexElement
+  {
+  public:
+    unsigned short source;
+    unsigned short type;
+    unsigned short semantic;
+    unsigned short offset;
+    unsigned short index;
+  };
+
+  class ExBoneAssignment
+  {
+  public:
+    unsigned int vertexIndex;
+    unsigned short boneIndex;
+    float weight;
+  };
+
+  /**
+  * Streaming writer of the Ogre binary mesh format.
+  * The chunks are written in the order of Ogre MeshSerializer, each chunk size is patched when the chunk ends
+  * so the vertex data goes from the store to the file through a small staging buffer, without building an Ogre::Mesh.
+  * The chunks written here have the same layout in all the serializer versions from 1.30 to 1.100.
+  **/
+  class ExMeshSerializer
+  {
+  public:
+    //constructor
+    ExMeshSerializer();
+
+    //destructor, close the file
+    ~ExMeshSerializer();
+
+    //create the file and write the header
+    //version : serializer version tag, like "[MeshSerializer_v1.100]"
+    bool open(const std::string& path, const std::string& version);
+
+    //close the file, false if any write failed or a chunk is still open
+    bool close();
+
+    //chunks, they can be nested
+    void beginChunk(unsigned short id);
+    void endChunk();
+
+    //mesh chunk, to end with endChunk
+    void beginMesh(bool skeletallyAnimated);
+
+    //submesh chunk with its index buffer, to end with endChunk
+    //the geometry, operation and bone assignments chunks follow when the submesh has its own vertices
+    void beginSubMesh(const std::string& material, bool useSharedVertices, const std::vector<unsigned int>& indices);
+    void writeSubMeshOperation(unsigned short operationType);
+
+    //geometry chunk of the vertices, in output order
+    //elements : organised declaration, see organiseElements
+    //colourARGB : colour packing, ARGB for Direct3D and ABGR otherwise
+    //the uv sets are EX_VET_FLOAT2, the texture coordinates of 3 or 4 floats are the store tangents
+    //the blend indices are EX_VET_UBYTE4 in the blend index map of these vertices, the blend weights are floats or EX_VET_UBYTE4_NORM
+    void writeGeometry(const ExVertexStore& store, const std::vector<unsigned int>& vertices, const std::vector<ExVertexElement>& elements, bool colourARGB);
+
+    //one chunk per assignment, chunkId is EX_M_MESH_BONE_ASSIGNMENT or EX_M_SUBMESH_BONE_ASSIGNMENT
+    void writeBoneAssignments(unsigned short chunkId, const std::vector<ExBoneAssignment>& assignments);
+
+    void writeSkeletonLink(const std::string& skeletonName);
+    void writeBounds(const float* min, const float* max, float radius);
+    void writeSubMeshNameTable(const std::vector<std::pair<std::string, unsigned short> >& names);
+
+    //edge list of the full detail level
+    //oldFormat : MeshSerializer_v1.30 layout, without isClosed and the group triangle ranges
+    void writeEdgeList(const ExEdgeData& edgeData, bool oldFormat);
+
+    //raw values
+    void writeBool(bool value);
+    void writeShort(unsigned short value);
+    void writeInt(unsigned int value);
+    void writeFloat(float value);
+    //string terminated by a line feed
+    void writeString(const std::string& value);
+    void writeData(const void* data, size_t size);
+
+    //elements sorted by semantic and assigned to buffers like Ogre VertexDeclaration::getAutoOrganisedDeclaration
+    //the source and offset of the input elements are ignored
+    static std::vector<ExVertexElement> organiseElements(const std::vector<ExVertexElement>& elements, bool skeletalAnimation, bool vertexAnimation, bool vertexAnimationNormals);
+
+    static unsigned short getTypeSize(unsigned short type);
+
+    //bone assignments of the vertices like Ogre Mesh::_rationaliseBoneAssignments :
+    //null weights dropped, the lowest weights removed over maxWeights and the remaining ones normalized
+    static std::vector<ExBoneAssignment> rationaliseBoneAssignments(const ExVertexStore& store, const std::vector<unsigned int>& vertices, unsigned int maxWeights = 4);
+
+  private:
+    std::ofstream m_file;
+    std::vector<std::streampos> m_chunkStarts;
+    bool m_failed;
+  };
+
+}; // end of namespace
+
+#endif
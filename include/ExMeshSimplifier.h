@@ -0,0 +1,57 @@
+////////////////////////////////////////////////////////////////////////////////
+// ExMeshSimplifier.h
+// Start Date : October 17, 2026
+////////////////////////////////////////////////////////////////////////////////
+/*********************************************************************************
+*                                                                                *
+*   This program is free software; you can redistribute it and/or modify         *
+*   it under the terms of the GNU Lesser General Public License as published by  *
+*   the Free Software Foundation; either version 2 of the License, or            *
+*   (at your option) any later version.                                          *
+*                                                                                *
+**********************************************************************************/
+
+#ifndef _EXMESHSIMPLIFIER_H
+#define _EXMESHSIMPLIFIER_H
+
+// Quadric error mesh simplification for the LOD levels, no Max or Ogre dependency.
+#include <stddef.h>
+#include <vector>
+#include "ExVertexStore.h"
+
+namespace EasyOgreExporter
+{
+  class ExSimplifyOptions
+  {
+  public:
+    //constructor
+    ExSimplifyOptions()
+    {
+      normalWeight = 1.0f;
+      texCoordWeight = 1.0f;
+      skinWeight = 1.0f;
+    };
+
+    //cost of the attribute differences between the vertices merged by a collapse, 0 ignore the attribute
+    float normalWeight;
+    float texCoordWeight;
+    float skinWeight;
+  };
+
+  /**
+  * Simplify the triangle lists of a mesh by edge collapses, for index only LOD levels.
+  * The collapse cost is the quadric error (Garland and Heckbert) of the removed position plus the normal,
+  * texture coordinates and skin weights differences of the merged vertices.
+  * The vertices sharing a position only collapse together along a seam, the open borders only collapse along themselves
+  * and the positions used by several submeshes are kept, so the uv seams, hard edges and submesh boundaries stay closed.
+  * The vertices are never moved, each level can be built from the same store on its own thread.
+  * subMeshIndices : triangle lists of the submeshes using the store vertex handles
+  * ratio : part of the triangles to keep
+  * result : receive the simplified triangle lists, same vertex handles
+  * return the number of triangles kept, more than requested when no valid collapse is left
+  **/
+  size_t simplifyMesh(const ExVertexStore& store, const std::vector<std::vector<unsigned int> >& subMeshIndices, float ratio, const ExSimplifyOptions& options, std::vector<std::vector<unsigned int> >& result);
+
+}; // end of namespace
+
+#endif
@@ -0,0 +1,143 @@
+////////////////////////////////////////////////////////////////////////////////
+// ExMeshSnapshot.h
+// Start Date : October 17, 2026
+////////////////////////////////////////////////////////////////////////////////
+/*********************************************************************************
+*                                                                                *
+*   This program is free software; you can redistribute it and/or modify         *
+*   it under the terms of the GNU Lesser General Public License as published by  *
+*   the Free Software Foundation; either version 2 of the License, or            *
+*   (at your option) any later version.                                          *
+*                                                                                *
+**********************************************************************************/
+
+#ifndef _EXMESHSNAPSHOT_H
+#define _EXMESHSNAPSHOT_H
+
+// Plain copy of the Max mesh data, filled by ExMesh on the Max side.
+// Everything after the capture only reads this, so it builds without the Max SDK.
+#include <stddef.h>
+#include <string>
+#include <vector>
+
+namespace EasyOgreExporter
+{
+  // morph target positions, same vertex count as the base mesh
+  class ExMorphTarget
+  {
+  public:
+    std::string name;
+    //index of the morpher channel
+    int channel;
+    //3 floats per mesh vertex, in export space
+    std::vector<float> positions;
+
+    //constructor
+    ExMorphTarget()
+    {
+      channel = -1;
+    };
+  };
+
+  /**
+  * Mesh captured in export space (up axis, node offset and scale already applied).
+  * Per corner data use the corner index (face * 3) + corner.
+  **/
+  class ExMeshSnapshot
+  {
+  public:
+    //3 floats per mesh vertex
+    std::vector<float> positions;
+    //3 mesh vertex indices per face
+    std::vector<int> faceVertices;
+    //material id of each face
+    std::vector<int> faceMaterialIds;
+    //3 floats per corner, normalized
+    std::vector<float> cornerNormals;
+    //4 floats per corner (rgba), empty when the mesh have no vertex colors
+    std::vector<float> cornerColors;
+    //number of uv sets, the channel numbers are kept so empty channels are still stored
+    unsigned int numTexCoordSets;
+    //3 floats (uvw) per corner and uv set, v is already flipped
+    std::vector<float> cornerTexCoords;
+    //skin influences of mesh vertex v are in [influenceStart[v], influenceStart[v + 1]), empty without skin
+    std::vector<int> influenceStart;
+    std::vector<float> influenceWeights;
+    std::vector<int> influenceJoints;
+    //morph targets
+    std::vector<ExMorphTarget> morphTargets;
+
+    //constructor
+    ExMeshSnapshot()
+    {
+      numTexCoordSets = 0;
+    };
+
+    void clear()
+    {
+      positions.clear();
+      faceVertices.clear();
+      faceMaterialIds.clear();
+      cornerNormals.clear();
+      cornerColors.clear();
+      numTexCoordSets = 0;
+      cornerTexCoords.clear();
+      influenceStart.clear();
+      influenceWeights.clear();
+      influenceJoints.clear();
+      morphTargets.clear();
+    };
+
+    //free the geometry once the mesh is built, the morph targets are still used to write the poses
+    void releaseGeometry()
+    {
+      std::vector<float>().swap(positions);
+      std::vector<int>().swap(faceVertices);
+      std::vector<int>().swap(faceMaterialIds);
+      std::vector<float>().swap(cornerNormals);
+      std::vector<float>().swap(cornerColors);
+      std::vector<float>().swap(cornerTexCoords);
+      std::vector<int>().swap(influenceStart);
+      std::vector<float>().swap(influenceWeights);
+      std::vector<int>().swap(influenceJoints);
+    };
+
+    //approximate size of the captured data in bytes
+    size_t getMemorySize() const
+    {
+      size_t size = (positions.size() + cornerNormals.size() + cornerColors.size() + cornerTexCoords.size() + influenceWeights.size()) * sizeof(float);
+      size += (faceVertices.size() + faceMaterialIds.size() + influenceStart.size() + influenceJoints.size()) * sizeof(int);
+      for (size_t i = 0; i < morphTargets.size(); i++)
+        size += morphTargets[i].positions.size() * sizeof(float);
+      return size;
+    };
+
+    unsigned int getNumVertices() const
+    {
+      return positions.size() / 3;
+    };
+
+    unsigned int getNumFaces() const
+    {
+      return faceMaterialIds.size();
+    };
+
+    bool hasColors() const
+    {
+      return !cornerColors.empty();
+    };
+
+    bool hasSkin() const
+    {
+      return !influenceStart.empty();
+    };
+
+    unsigned int getNumInfluences(unsigned int v) const
+    {
+      return hasSkin() ? (influenceStart[v + 1] - influenceStart[v]) : 0;
+    };
+  };
+
+}; // end of namespace
+
+#endif
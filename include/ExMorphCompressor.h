@@ -0,0 +1,55 @@
+////////////////////////////////////////////////////////////////////////////////
+// ExMorphCompressor.h
+// Start Date : October 17, 2026
+////////////////////////////////////////////////////////////////////////////////
+/*********************************************************************************
+*                                                                                *
+*   This program is free software; you can redistribute it and/or modify         *
+*   it under the terms of the GNU Lesser General Public License as published by  *
+*   the Free Software Foundation; either version 2 of the License, or            *
+*   (at your option) any later version.                                          *
+*                                                                                *
+**********************************************************************************/
+
+#ifndef _EXMORPHCOMPRESSOR_H
+#define _EXMORPHCOMPRESSOR_H
+
+// Morph animation compression into poses, no Max or Ogre dependency.
+#include <vector>
+#include "ExMorphFrames.h"
+
+namespace EasyOgreExporter
+{
+  class ExMorphCompression
+  {
+  public:
+    //constructor
+    ExMorphCompression()
+    {
+      numPoses = 0;
+      maxError = 0.0f;
+    };
+
+    unsigned int numPoses;
+    //offsets of each pose from the base positions, 3 floats per frame source vertex
+    std::vector<float> poses;
+    //weight of each pose on each frame, numPoses floats per frame
+    std::vector<float> weights;
+    //largest difference on a coordinate between a frame and its reconstruction
+    float maxError;
+  };
+
+  /**
+  * Compress morph frames into poses blended by a weight per frame, by truncated SVD of the frame offsets from the base positions.
+  * The Gram matrix of the offsets (frames * frames) is computed on the thread pool and its eigenvectors are found
+  * by power iterations orthogonal to the previous ones, each pose is the normalized projection of the offsets on one of them.
+  * Poses are added until the reconstruction error on each coordinate is under tolerance or maxPoses are used,
+  * then each pose is scaled so its largest weight is 1.
+  * basePositions : 3 floats per frame source vertex, the positions the poses are added to
+  * return false when the tolerance is not reached, the result keeps the maxPoses poses
+  **/
+  bool compressMorphFrames(const ExMorphFrames& frames, const float* basePositions, float tolerance, unsigned int maxPoses, unsigned int numThreads, ExMorphCompression& result);
+
+}; // end of namespace
+
+#endif
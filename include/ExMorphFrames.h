@@ -0,0 +1,132 @@
+////////////////////////////////////////////////////////////////////////////////
+// ExMorphFrames.h
+// Start Date : October 17, 2026
+////////////////////////////////////////////////////////////////////////////////
+/*********************************************************************************
+*                                                                                *
+*   This program is free software; you can redistribute it and/or modify         *
+*   it under the terms of the GNU Lesser General Public License as published by  *
+*   the Free Software Foundation; either version 2 of the License, or            *
+*   (at your option) any later version.                                          *
+*                                                                                *
+**********************************************************************************/
+
+#ifndef _EXMORPHFRAMES_H
+#define _EXMORPHFRAMES_H
+
+// Sampled vertex positions of a morph animation, no Max or Ogre dependency.
+#include <stddef.h>
+#include <vector>
+#include "ExVertexStore.h"
+
+namespace EasyOgreExporter
+{
+  /**
+  * Largest absolute difference between two float arrays.
+  * The arrays are compared by blocks with independent lanes so the compiler can vectorize the loop,
+  * the comparison stops after the first block going over limit and return its difference.
+  **/
+  float maxAbsDifference(const float* a, const float* b, size_t count, float limit);
+
+  /**
+  * Largest absolute difference between a float array and the linear interpolation a + (b - a) * t.
+  * Same blocks and early exit as maxAbsDifference.
+  **/
+  float maxInterpolationError(const float* a, const float* b, float t, const float* values, size_t count, float limit);
+
+  /**
+  * Sparse offsets of a morph target from store vertices, the vertices moved by epsilon or less on each coordinate are skipped.
+  * vertices : store vertices of the pose target
+  * targetPositions : 3 floats per source vertex, indexed by the store max id
+  * indices : receive the index in vertices of each moved vertex
+  * offsets : receive 3 floats per moved vertex
+  **/
+  void getMorphOffsets(const ExVertexStore& store, const std::vector<unsigned int>& vertices, const float* targetPositions, float epsilon, std::vector<unsigned int>& indices, std::vector<float>& offsets);
+
+  /**
+  * Positions of the mesh vertices on each sampled time, so each time is evaluated once
+  * and the key reduction, the change detection and the tracks all read the same frames.
+  * The output vertices sharing a source vertex are stored once, each frame is a compact array of 3 floats per source vertex.
+  **/
+  class ExMorphFrames
+  {
+  public:
+    //constructor
+    ExMorphFrames();
+
+    //source vertex of each output vertex, clear the frames
+    void setVertices(const std::vector<int>& outputSources);
+
+    //distinct source vertices in frame order
+    const std::vector<int>& getSourceVertices() const
+    {
+      return m_sources;
+    };
+
+    unsigned int getNumSourceVertices() const
+    {
+      return m_sources.size();
+    };
+
+    //add a frame and return its positions to fill, 3 floats per source vertex
+    //the pointer is valid until the next frame is added
+    float* addFrame(int time);
+
+    unsigned int getNumFrames() const
+    {
+      return m_times.size();
+    };
+
+    int getTime(unsigned int frame) const
+    {
+      return m_times[frame];
+    };
+
+    //3 floats per source vertex
+    const float* getFrame(unsigned int frame) const
+    {
+      return &m_positions[frame * m_sources.size() * 3];
+    };
+
+    //index of the source vertex of an output vertex in the frames
+    unsigned int getSourceIndex(unsigned int vertex) const
+    {
+      return m_frameIndex[vertex];
+    };
+
+    //position of an output vertex, 3 floats
+    const float* getPosition(unsigned int frame, unsigned int vertex) const
+    {
+      return &m_positions[((frame * m_sources.size()) + m_frameIndex[vertex]) * 3];
+    };
+
+    //remove the frames equal to the previous kept frame and the next frame, within tolerance on each coordinate
+    //return the number of frames removed
+    unsigned int removeStaticFrames(float tolerance);
+
+    //remove the frames reproduced within tolerance on each coordinate by the time interpolation of the frames kept around them
+    //greedy : from each kept frame the next kept frame is the farthest one interpolating all the frames between them
+    //return the number of frames removed
+    unsigned int reduceFrames(float tolerance);
+
+    void clear();
+
+  private:
+    //keep the frame at index from in index to, to <= from
+    void moveFrame(unsigned int from, unsigned int to);
+
+    //true when the frames between first and last are interpolated within tolerance
+    bool isInterpolated(unsigned int first, unsigned int last, float tolerance) const;
+
+    //keep the listed frames, in increasing order
+    void keepFrames(const std::vector<unsigned int>& kept);
+
+    std::vector<int> m_sources;
+    std::vector<unsigned int> m_frameIndex;
+    std::vector<int> m_times;
+    std::vector<float> m_positions;
+  };
+
+}; // end of namespace
+
+#endif
@@ -18,6 +18,7 @@
 
 #include "paramList.h"
 #include "ExMaterialSet.h"
+#include "ExExportCache.h"
 
 namespace EasyOgreExporter
 {
@@ -41,11 +42,34 @@ namespace EasyOgreExporter
       void setHasError(bool state);
       bool hasError();
 
-		  bool writeEntityData(IGameNode* pGameNode, IGameObject* pGameObject, IGameMesh* pGameMesh, std::vector<ExMaterial*>& lmat);
+      // capture the Max data of a mesh node
+      ExMesh* createMesh(IGameNode* pGameNode, IGameMesh* pGameMesh);
+      // called on the meshes in the scene order before their processing, load the skeleton animations
+      // return false when the mesh file is shared with a previous mesh or kept from the previous export, prepareMesh can be skipped
+      bool checkMeshCache(ExMesh* mesh, IGameNode* pGameNode);
+		  bool writeEntityData(ExMesh* mesh, IGameNode* pGameNode, std::vector<ExMaterial*>& lmat);
+      // resolve the materials of an instance on its master mesh, no geometry is processed
+      bool writeInstanceData(IGameNode* pGameNode, std::vector<ExMaterial*>& lmat);
+      ExMaterial* loadMaterial(IGameMaterial* pGameMaterial);
+
+      // scene wide instance map, filled during the scene traversal
+      // return the master of the node instances, the first one registered
+      INode* registerInstance(INode* node);
+      INode* getInstanceMaster(INode* node);
+      // mesh resource name of the node master, or of the identical mesh it shares
+      std::string getInstanceMeshName(IGameNode* pGameNode);
+      void logSharedMeshes();
       bool writeMaterialFile();
+      // files written by the previous export, saved by saveExportCache
+      ExExportCache& getExportCache();
+      void saveExportCache();
       ExMaterialSet* getMaterialSet();
       ParamList getParams();
 
+      // decode transform of the meshes with quantized positions, applied by the scene
+      void setMeshPositionTransform(const std::string& meshName, Point3 offset, Point3 scale);
+      bool getMeshPositionTransform(const std::string& meshName, Point3& offset, Point3& scale);
+
 	  private:
       ParamList mParams;
       ExMaterialSet* mMaterialSet;
@@ -54,6 +78,27 @@ namespace EasyOgreExporter
       std::vector<INode*> mSkinNodeList;
       std::vector<DWORD> mSkinLastStateList;
       bool mHasError;
+      std::map<std::string, std::pair<Point3, Point3> > mMeshPositionTransforms;
+      std::map<INode*, INode*> mInstanceMasters;
+      std::map<INode*, std::vector<int> > mInstanceMaterialIds;
+      // written meshes by fingerprint, their file size, and the mesh names sharing them
+      std::map<std::string, std::string> mSharedMeshes;
+      std::map<std::string, unsigned long long> mSharedMeshSizes;
+      std::map<std::string, std::string> mMeshAliases;
+      // fingerprints found by checkMeshCache, and the Max material id of each submesh of the shared meshes
+      std::set<std::string> mCheckedFingerprints;
+      std::map<std::string, std::vector<int> > mSharedMeshMaterialIds;
+      int mNumSharedMeshes;
+      unsigned long long mSharedMeshesBytes;
+      // incremental export, hashes of the parameters changing the meshes and of the animation ranges
+      ExExportCache mExportCache;
+      std::string mParamsHash;
+      std::string mAnimRangesHash;
+      // meshes kept from the previous export by checkMeshCache
+      std::set<std::string> mCachedMeshes;
+
+      void computeCacheHashes();
+      std::string getMeshCacheHash(ExMesh* mesh);
 	};
 
 }; // end of namespace
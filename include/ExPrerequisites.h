@@ -94,7 +94,8 @@ namespace EasyOgreExporter
   class ExMaterialSet;
   class ExMaterial;
   class ExBone;
-  class ExVertex;
+  class ExVertexStore;
+  class ExMesh;
 }
 
 #endif
@@ -89,8 +89,10 @@ namespace EasyOgreExporter
       TiXmlDocument* xmlDoc;
       TiXmlElement *sceneElement;
       TiXmlElement *nodesElement;
+      std::vector<std::pair<TiXmlElement*, std::string> > m_meshEntities;
       
       void initXmlDocument();
+      void applyMeshPositionTransforms();
 
 		  std::string getLightTypeString(ExOgreLightType type);
       std::string getBoolString(bool value);
@@ -77,13 +77,19 @@ namespace EasyOgreExporter
 		std::vector<ExBone>& getJoints();
 		//get animations
 		std::vector<ExAnimation>& getAnimations();
+    //transforms from the bind pose to each sampled time of the loaded clips in mesh space, 12 floats per joint
+    const std::vector<float>& getSkinPoses();
 		//restore skeleton pose
 		void restorePose();
 		//write to an OGRE binary skeleton
 		bool writeOgreBinary();
+    //path of the OGRE binary skeleton
+    std::string getFilePath();
+    //hash of the joints and loaded animations, for the export cache
+    std::string getCacheHash();
 
-    const std::vector<float> getWeightList(int index);
-    const std::vector<int> getJointList(int index);
+    const std::vector<float>& getWeightList(int index);
+    const std::vector<int>& getJointList(int index);
 
 	private:
 
@@ -103,6 +109,8 @@ namespace EasyOgreExporter
     IGameSkin* m_pGameSkin;
     std::vector<ExBone> m_joints;
 		std::vector<ExAnimation> m_animations;
+    std::vector<Matrix3> m_invBindMeshTMs;
+    std::vector<float> m_skinPoses;
 		std::vector<int> m_roots;
     std::vector< std::vector<float> > m_weights;
 		std::vector< std::vector<int> > m_jointIds;
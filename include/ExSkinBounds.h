@@ -0,0 +1,69 @@
+////////////////////////////////////////////////////////////////////////////////
+// ExSkinBounds.h
+// Start Date : October 17, 2026
+////////////////////////////////////////////////////////////////////////////////
+/*********************************************************************************
+*                                                                                *
+*   This program is free software; you can redistribute it and/or modify         *
+*   it under the terms of the GNU Lesser General Public License as published by  *
+*   the Free Software Foundation; either version 2 of the License, or            *
+*   (at your option) any later version.                                          *
+*                                                                                *
+**********************************************************************************/
+
+#ifndef _EXSKINBOUNDS_H
+#define _EXSKINBOUNDS_H
+
+// Bounds of a skinned mesh over its animations, no Max or Ogre dependency.
+#include <vector>
+#include "ExVertexStore.h"
+
+namespace EasyOgreExporter
+{
+  /**
+  * Small bounding sphere of store vertices, Ritter algorithm.
+  * The sphere starts on the two farthest extreme points found from an arbitrary vertex and grows over the outside vertices,
+  * the result is usually within a few percent of the minimal sphere.
+  * center : receive 3 floats
+  * return false when there is no vertex
+  **/
+  bool computeBoundingSphere(const ExVertexStore& store, const std::vector<unsigned int>& vertices, float* center, float& radius);
+
+  /**
+  * Bind pose extents of the vertices moved by each bone, to bound a skinned mesh in any pose.
+  * A skinned vertex is a weighted average of its bone transforms, so it stays in the bounds of the vertices
+  * of its bones each moved by their bone transform : each pose only transforms one box and one sphere per bone.
+  **/
+  class ExSkinBounds
+  {
+  public:
+    //numBones : bones of the skeleton, the influences of other bones are ignored
+    ExSkinBounds(const ExVertexStore& store, unsigned int numBones);
+
+    //extend the bounds with a pose
+    //skinMatrices : numBones affine transforms from the bind pose to the pose, 12 floats each
+    //  as the 4 rows of a Max Matrix3, p' = p.x * row0 + p.y * row1 + p.z * row2 + row3
+    //boundsMin, boundsMax : 3 floats
+    //radius : distance of the farthest position from the origin
+    void addPose(const float* skinMatrices, float* boundsMin, float* boundsMax, float& radius) const;
+
+    //bones moving at least one vertex
+    unsigned int getNumUsedBones() const;
+
+  private:
+    class BoneExtent
+    {
+    public:
+      unsigned int bone;
+      float min[3];
+      float max[3];
+      float center[3];
+      float radius;
+    };
+
+    std::vector<BoneExtent> m_extents;
+  };
+
+}; // end of namespace
+
+#endif
@@ -0,0 +1,36 @@
+////////////////////////////////////////////////////////////////////////////////
+// ExTangentGenerator.h
+// Start Date : October 17, 2026
+////////////////////////////////////////////////////////////////////////////////
+/*********************************************************************************
+*                                                                                *
+*   This program is free software; you can redistribute it and/or modify         *
+*   it under the terms of the GNU Lesser General Public License as published by  *
+*   the Free Software Foundation; either version 2 of the License, or            *
+*   (at your option) any later version.                                          *
+*                                                                                *
+**********************************************************************************/
+
+#ifndef _EXTANGENTGENERATOR_H
+#define _EXTANGENTGENERATOR_H
+
+// Per corner tangent space on a mesh snapshot, no Max or Ogre dependency.
+#include <vector>
+#include "ExMeshSnapshot.h"
+
+namespace EasyOgreExporter
+{
+  /**
+  * Compute the tangents of the mesh corners the same way as MikkTSpace.
+  * Each triangle tangent is the direction of the u axis on its surface, it is projected on the corner normal
+  * and weighted by the corner angle, then summed over the corners sharing the position, normal, uv and handedness.
+  * The handedness comes from the sign of the triangle uv area, so the mirrored uvs get their own tangents.
+  * texCoordSet : uv set used for the tangent space
+  * weldTolerance : max difference of the corners sharing a tangent, same as the vertex weld
+  * cornerTangents : receive 4 floats per corner, the tangent and its handedness, binormal = w * cross(normal, tangent)
+  **/
+  void computeTangents(const ExMeshSnapshot& snapshot, unsigned int texCoordSet, float weldTolerance, std::vector<float>& cornerTangents);
+
+}; // end of namespace
+
+#endif
@@ -0,0 +1,87 @@
+////////////////////////////////////////////////////////////////////////////////
+// ExThreadPool.h
+// Start Date : October 17, 2026
+////////////////////////////////////////////////////////////////////////////////
+/*********************************************************************************
+*                                                                                *
+*   This program is free software; you can redistribute it and/or modify         *
+*   it under the terms of the GNU Lesser General Public License as published by  *
+*   the Free Software Foundation; either version 2 of the License, or            *
+*   (at your option) any later version.                                          *
+*                                                                                *
+**********************************************************************************/
+
+#ifndef _EXTHREADPOOL_H
+#define _EXTHREADPOOL_H
+
+// Job pool on std::thread, no Max or Ogre dependency.
+// Visual Studio 2008 and 2010 have no std::thread, the pool runs the jobs on the calling thread there.
+#if defined(_MSC_VER) && (_MSC_VER < 1700)
+#define EX_SERIAL_THREADPOOL
+#endif
+
+#include <stddef.h>
+#include <vector>
+#ifndef EX_SERIAL_THREADPOOL
+#include <deque>
+#include <exception>
+#include <mutex>
+#endif
+
+namespace EasyOgreExporter
+{
+  /**
+  * Job given to the pool, run is called once for each index of the job list.
+  **/
+  class ExPoolJob
+  {
+  public:
+    virtual ~ExPoolJob() {};
+    virtual void run(size_t index) = 0;
+  };
+
+  /**
+  * Work stealing pool running a list of independent jobs.
+  * Each worker starts on its own contiguous range of jobs, takes them from the back of its queue
+  * and steals from the front of the other queues once it is empty, so long jobs do not stall the others.
+  * The jobs write their own results, the order they run in does not change the output.
+  **/
+  class ExThreadPool
+  {
+  public:
+    //constructor
+    //numThreads : number of workers, the calling thread included. 0 use the number of hardware threads
+    ExThreadPool(unsigned int numThreads = 0);
+
+    //destructor
+    ~ExThreadPool();
+
+    unsigned int getNumThreads() const;
+
+    //call job.run(i) for each i in [0, count) and return when all the jobs are done
+    //the first exception thrown by a job is thrown again here
+    void run(size_t count, ExPoolJob& job);
+
+  private:
+    unsigned int m_numThreads;
+
+#ifndef EX_SERIAL_THREADPOOL
+    class WorkQueue
+    {
+    public:
+      std::mutex lock;
+      std::deque<size_t> jobs;
+    };
+
+    bool popJob(unsigned int worker, size_t& job);
+    void workerLoop(unsigned int worker, ExPoolJob* job);
+
+    std::vector<WorkQueue*> m_queues;
+    std::mutex m_errorLock;
+    std::exception_ptr m_error;
+#endif
+  };
+
+}; // end of namespace
+
+#endif
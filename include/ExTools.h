@@ -1111,85 +1111,6 @@ inline TriObject* getTriObjectFromNode(INode *Node, TimeValue T, bool &Delete)
 	}
 }
 
-inline bool IsMorphKeyEqual(const std::vector<int> vertices, Mesh firstMesh, Mesh secondMesh)
-{
-  bool equal = true;
-  Point3 pos1;
-  Point3 pos2;
-  for(int v = 0; v < vertices.size() && equal; v++)
-  {
-    pos1 = firstMesh.getVert(vertices[v]);
-    pos2 = secondMesh.getVert(vertices[v]);
-    if(pos1.Equals(pos2) == 0)
-      equal = false;
-  }
-  return equal;
-}
-
-inline void OptimizeMeshAnimation(INode* maxNode, std::vector<int> &animKeys, const std::vector<int> vertices)
-{
-  if (animKeys.size() > 2)
-  {
-    bool delPrevTri = false;
-    bool delKeyTri = false;
-    bool delNextTri = false;
-    TriObject* prevTriObj = 0;
-    TriObject* keyTriObj = 0;
-    TriObject* nextTriObj = 0;
-    Mesh prevMesh;
-    Mesh keyMesh;
-    Mesh nextMesh;
-
-    for (int i = 0; i < animKeys.size(); i++)
-    {
-      if (animKeys.size() > i + 2)
-      {
-        //get the mesh in the current state
-        prevTriObj = getTriObjectFromNode(maxNode, animKeys[i], delPrevTri);
-        if(prevTriObj)
-          prevMesh = prevTriObj->GetMesh();
-
-        keyTriObj = getTriObjectFromNode(maxNode, animKeys[i + 1], delKeyTri);
-        if(keyTriObj)
-          keyMesh = keyTriObj->GetMesh();
-
-        nextTriObj = getTriObjectFromNode(maxNode, animKeys[i + 2], delNextTri);
-        if(nextTriObj)
-          nextMesh = nextTriObj->GetMesh();
-
-        if(IsMorphKeyEqual(vertices, keyMesh, prevMesh) && IsMorphKeyEqual(vertices, keyMesh, nextMesh))
-        {
-          //remove the key
-          animKeys.erase(animKeys.begin() + (i + 1));
-          i--;
-        }
-
-        //free the tree object
-        if(delPrevTri && prevTriObj)
-        {
-          prevTriObj->DeleteThis();
-          prevTriObj = 0;
-          delPrevTri = false;
-        }
-
-        if(delKeyTri && keyTriObj)
-        {
-          keyTriObj->DeleteThis();
-          keyTriObj = 0;
-          delKeyTri = false;
-        }
-
-        if(delNextTri && nextTriObj)
-        {
-          nextTriObj->DeleteThis();
-          nextTriObj = 0;
-          delNextTri = false;
-        }
-      }
-    }
-  }
-}
-
 inline std::vector<int> GetPointAnimationsKeysTime(IGameNode* pGameNode, Interval animRange, bool resample, int framestep)
 {
   std::vector<int> animKeys;
@@ -1241,39 +1162,6 @@ inline std::vector<int> GetPointAnimationsKeysTime(IGameNode* pGameNode, Interva
   return animKeys;
 }
 
-inline std::string getFirstInstanceName(IGameNode* pGameNode)
-{
-  INodeTab nodeInstances;
-  IInstanceMgr* instMgr = IInstanceMgr::GetInstanceMgr();
-  
-  //Get nodes instances
-  instMgr->GetInstances(*(pGameNode->GetMaxNode()), nodeInstances);
-
-  std::string nodeName;
-#ifdef UNICODE
-	std::wstring pNodeName_w = nodeInstances[nodeInstances.Count() - 1]->GetName();
-	nodeName.assign(pNodeName_w.begin(), pNodeName_w.end());
-#else
-	nodeName = nodeInstances[nodeInstances.Count() - 1]->GetName();
-#endif
-
-  return nodeName;
-}
-
-inline bool isFirstInstance(IGameNode* pGameNode)
-{
-  INodeTab nodeInstances;
-  IInstanceMgr* instMgr = IInstanceMgr::GetInstanceMgr();
-  
-  //Get nodes instances
-  instMgr->GetInstances(*(pGameNode->GetMaxNode()), nodeInstances);
-
-  if(nodeInstances[nodeInstances.Count() - 1] == pGameNode->GetMaxNode())
-    return true;
-  
-  return false;
-}
-
 inline bool useSpaceWarpModifier(INode* node)
 {
   return (node->GetProperty(PROPID_HAS_WSM) != 0);
@@ -0,0 +1,67 @@
+////////////////////////////////////////////////////////////////////////////////
+// ExVertexCompressor.h
+// Start Date : October 17, 2026
+////////////////////////////////////////////////////////////////////////////////
+/*********************************************************************************
+*                                                                                *
+*   This program is free software; you can redistribute it and/or modify         *
+*   it under the terms of the GNU Lesser General Public License as published by  *
+*   the Free Software Foundation; either version 2 of the License, or            *
+*   (at your option) any later version.                                          *
+*                                                                                *
+**********************************************************************************/
+
+#ifndef _EXVERTEXCOMPRESSOR_H
+#define _EXVERTEXCOMPRESSOR_H
+
+// Re-encode the Ogre vertex buffers with smaller formats, no Max dependency.
+#include "Ogre.h"
+
+namespace EasyOgreExporter
+{
+  /**
+  * Vertex buffers compression.
+  * Positions are quantized on 16 bits relative to the mesh bounds, normals are packed in 10-10-10-2
+  * and uvs are stored as half floats. Each attribute is only compressed if its quantization error stay under the error budget.
+  * The compression run on the final float buffers, after the LOD, edges and tangents generation that need float data.
+  **/
+  class ExVertexCompressor
+  {
+  public:
+    //constructor
+    //maxError : max error allowed on each attribute component, in mesh units for the positions
+    ExVertexCompressor(float maxError);
+
+    //destructor
+    ~ExVertexCompressor();
+
+    //select the attributes to compress
+    //bounds : mesh bounds, used for all the vertex data of the mesh so they share the same decode transform
+    void setup(const Ogre::AxisAlignedBox& bounds, bool positions, bool normals, bool texCoords);
+
+    //re-encode the vertex data, return false if nothing was compressed
+    bool compress(Ogre::VertexData* vdata);
+
+    //positions decode transform, position = offset + scale * stored value
+    bool hasPositionTransform() const;
+    Ogre::Vector3 getPositionOffset() const;
+    Ogre::Vector3 getPositionScale() const;
+
+    //size of a vertex in bytes for all the buffers
+    static size_t getVertexSize(const Ogre::VertexDeclaration* decl);
+
+  private:
+    Ogre::VertexElementType getCompressedType(const Ogre::VertexElement& elem, Ogre::VertexData* vdata) const;
+    float getMaxTexCoord(const Ogre::VertexElement& elem, Ogre::VertexData* vdata) const;
+
+    float m_maxError;
+    bool m_positions;
+    bool m_normals;
+    bool m_texCoords;
+    Ogre::Vector3 m_posOffset;
+    Ogre::Vector3 m_posScale;
+  };
+
+}; // end of namespace
+
+#endif
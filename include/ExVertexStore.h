@@ -0,0 +1,143 @@
+////////////////////////////////////////////////////////////////////////////////
+// ExVertexStore.h
+// Start Date : October 17, 2026
+////////////////////////////////////////////////////////////////////////////////
+/*********************************************************************************
+*                                                                                *
+*   This program is free software; you can redistribute it and/or modify         *
+*   it under the terms of the GNU Lesser General Public License as published by  *
+*   the Free Software Foundation; either version 2 of the License, or            *
+*   (at your option) any later version.                                          *
+*                                                                                *
+**********************************************************************************/
+
+#ifndef _EXVERTEXSTORE_H
+#define _EXVERTEXSTORE_H
+
+// Mesh vertices stored as one contiguous array per attribute, no Max or Ogre dependency.
+#include <stddef.h>
+#include <vector>
+
+namespace EasyOgreExporter
+{
+  /**
+  * Structure of arrays vertex storage.
+  * The attribute strides are fixed for the whole mesh so adding a vertex never allocate per vertex,
+  * vertices are referenced by a 32 bits handle (their index in the store).
+  **/
+  class ExVertexStore
+  {
+  public:
+    //constructor
+    ExVertexStore();
+
+    //destructor
+    ~ExVertexStore();
+
+    //set the attribute strides, clear the store
+    //numTexCoords : number of uv sets per vertex
+    //numInfluences : number of bone weights / indices per vertex
+    //tangents : store a tangent with its handedness per vertex
+    void setLayout(unsigned int numTexCoords, unsigned int numInfluences, bool tangents = false);
+
+    void reserve(unsigned int numVertices);
+    void clear();
+
+    //add a vertex and return its handle
+    //texCoords : numTexCoords * 2 floats
+    //weights, bones : numInfluences values, or null for no influence
+    //tangent : 4 floats when the layout has tangents, or null for the x axis
+    unsigned int addVertex(int maxId, const float* pos, const float* normal, const float* color, const float* texCoords, const float* weights, const int* bones, const float* tangent = 0);
+
+    //reorder the vertices, vertex i receive the source vertex order[i]
+    //vertices not referenced in order are dropped
+    void reorder(const std::vector<int>& order);
+
+    //exchange the content of two stores without copy
+    void swap(ExVertexStore& other);
+
+    unsigned int size() const
+    {
+      return m_maxIds.size();
+    };
+
+    unsigned int getNumTexCoords() const
+    {
+      return m_numTexCoords;
+    };
+
+    unsigned int getNumInfluences() const
+    {
+      return m_numInfluences;
+    };
+
+    bool hasTangents() const
+    {
+      return m_hasTangents;
+    };
+
+    //index of the source vertex in the Max mesh
+    int getMaxId(unsigned int v) const
+    {
+      return m_maxIds[v];
+    };
+
+    //3 floats
+    const float* getPosition(unsigned int v) const
+    {
+      return &m_positions[v * 3];
+    };
+
+    //3 floats
+    const float* getNormal(unsigned int v) const
+    {
+      return &m_normals[v * 3];
+    };
+
+    //4 floats, rgba
+    const float* getColor(unsigned int v) const
+    {
+      return &m_colors[v * 4];
+    };
+
+    //2 floats
+    const float* getTexCoord(unsigned int v, unsigned int set) const
+    {
+      return &m_texCoords[((v * m_numTexCoords) + set) * 2];
+    };
+
+    //numInfluences values, unused influences have a 0 weight
+    const float* getWeights(unsigned int v) const
+    {
+      return m_numInfluences ? &m_weights[v * m_numInfluences] : 0;
+    };
+
+    const int* getBoneIndices(unsigned int v) const
+    {
+      return m_numInfluences ? &m_boneIndices[v * m_numInfluences] : 0;
+    };
+
+    //4 floats, the tangent and its handedness (1 or -1), binormal = w * cross(normal, tangent)
+    const float* getTangent(unsigned int v) const
+    {
+      return m_hasTangents ? &m_tangents[v * 4] : 0;
+    };
+
+  private:
+    unsigned int m_numTexCoords;
+    unsigned int m_numInfluences;
+    bool m_hasTangents;
+
+    std::vector<int> m_maxIds;
+    std::vector<float> m_positions;
+    std::vector<float> m_normals;
+    std::vector<float> m_colors;
+    std::vector<float> m_texCoords;
+    std::vector<float> m_weights;
+    std::vector<int> m_boneIndices;
+    std::vector<float> m_tangents;
+  };
+
+}; // end of namespace
+
+#endif
@@ -0,0 +1,78 @@
+////////////////////////////////////////////////////////////////////////////////
+// ExVertexWelder.h
+// Start Date : October 17, 2026
+////////////////////////////////////////////////////////////////////////////////
+/*********************************************************************************
+*                                                                                *
+*   This program is free software; you can redistribute it and/or modify         *
+*   it under the terms of the GNU Lesser General Public License as published by  *
+*   the Free Software Foundation; either version 2 of the License, or            *
+*   (at your option) any later version.                                          *
+*                                                                                *
+**********************************************************************************/
+
+#ifndef _EXVERTEXWELDER_H
+#define _EXVERTEXWELDER_H
+
+// No Max or Ogre dependency here, the welder only works on raw float data
+// so it can be built and profiled outside of 3ds Max with synthetic meshes.
+#include <vector>
+
+namespace EasyOgreExporter
+{
+  /**
+  * Weld mesh corners into unique vertices.
+  * Positions are quantized with the weld tolerance and hashed into an open addressing table,
+  * a cheap fingerprint of the attributes is checked before the full compare.
+  **/
+  class ExVertexWelder
+  {
+  public:
+    //constructor
+    //tolerance : max difference allowed on each position / attribute component
+    //attribStride : number of floats stored per vertex after the position (normal, color, uv...)
+    //expectedVertices : hint used to size the hash table
+    ExVertexWelder(float tolerance, unsigned int attribStride, unsigned int expectedVertices = 0);
+
+    //destructor
+    ~ExVertexWelder();
+
+    //return the index of the welded vertex, the vertex is added if no match is found
+    int addVertex(const float* pos, const float* attribs);
+
+    //return the index of the matching vertex or -1
+    int findVertex(const float* pos, const float* attribs) const;
+
+    unsigned int getNumVertices() const;
+    unsigned int getAttribStride() const;
+    float getTolerance() const;
+    const float* getPosition(int index) const;
+    const float* getAttributes(int index) const;
+
+    void clear();
+
+  private:
+    unsigned long long getCellHash(const float* pos) const;
+    unsigned int getFingerprint(const float* attribs) const;
+    bool isEqual(int index, const float* pos, const float* attribs) const;
+    int findSlot(unsigned long long hash, unsigned int fingerprint, const float* pos, const float* attribs, int& vertex) const;
+    void resizeTable(unsigned int numSlots);
+
+    float m_tolerance;
+    float m_invTolerance;
+    unsigned int m_attribStride;
+
+    //welded vertices data
+    std::vector<float> m_positions;
+    std::vector<float> m_attribs;
+    std::vector<unsigned long long> m_cellHashes;
+    std::vector<unsigned int> m_fingerprints;
+
+    //open addressing table, vertex index or -1 for empty slots
+    std::vector<int> m_table;
+    unsigned int m_tableMask;
+  };
+
+}; // end of namespace
+
+#endif
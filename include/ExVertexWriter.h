@@ -0,0 +1,75 @@
+////////////////////////////////////////////////////////////////////////////////
+// ExVertexWriter.h
+// Start Date : October 17, 2026
+////////////////////////////////////////////////////////////////////////////////
+/*********************************************************************************
+*                                                                                *
+*   This program is free software; you can redistribute it and/or modify         *
+*   it under the terms of the GNU Lesser General Public License as published by  *
+*   the Free Software Foundation; either version 2 of the License, or            *
+*   (at your option) any later version.                                          *
+*                                                                                *
+**********************************************************************************/
+
+#ifndef _EXVERTEXWRITER_H
+#define _EXVERTEXWRITER_H
+
+// Fill the Ogre vertex buffers from an ExVertexStore, no Max dependency.
+#include "Ogre.h"
+#include "ExVertexStore.h"
+
+namespace EasyOgreExporter
+{
+  /**
+  * Layout first vertex buffer writer.
+  * The final auto organised declaration is computed before any data is written,
+  * then each element is streamed from the store attribute arrays into its buffer with a copy routine per format.
+  **/
+  class ExVertexWriter
+  {
+  public:
+    //constructor
+    ExVertexWriter(const ExVertexStore& store);
+
+    //destructor
+    ~ExVertexWriter();
+
+    //attributes to write, the position is always written
+    void setNormals(bool normals);
+    void setColors(bool colors);
+    void setNumTexCoords(unsigned int numTexCoords);
+
+    //write the store tangents, if it has some
+    //asTexCoord : in the texture coordinates following the uv sets instead of VES_TANGENT
+    //parity : 4 floats with the handedness in w
+    void setTangents(bool asTexCoord, bool parity);
+
+    //write the store bone influences as UBYTE4 blend indices, and as float or normalized UBYTE4 blend weights
+    void setBlendWeights(bool blendWeights, bool bytes);
+
+    //create the declaration, the buffers and their bindings in vdata
+    //vertices : handles of the store vertices in output order
+    //skeletalAnimation, vertexAnimation : expected mesh animation types, used to organise the buffers
+    void write(Ogre::VertexData* vdata, const std::vector<unsigned int>& vertices, bool skeletalAnimation, bool vertexAnimation);
+
+    //size of a vertex in bytes for all the buffers
+    size_t getVertexSize() const;
+
+  private:
+    void writeElement(const Ogre::VertexElement& elem, unsigned char* pBase, size_t stride, const std::vector<unsigned int>& vertices);
+
+    const ExVertexStore& m_store;
+    bool m_normals;
+    bool m_colors;
+    unsigned int m_numTexCoords;
+    bool m_tangents;
+    bool m_tangentsAsTexCoord;
+    bool m_tangentParity;
+    bool m_blendWeights;
+    bool m_blendWeightsBytes;
+    size_t m_vertexSize;
+  };
+
+}; // end of namespace
+
+#endif
@@ -51,6 +51,24 @@ public:
   void loadExportConf(std::string path, ParamList &param);
 };
 
+// node to export, found on the main thread and written once its mesh is processed
+class ExportedNode
+{
+public:
+  IGameNode* pGameNode;
+  // the game object itself is released once found and acquired again to capture and write the node
+  IGameObject::ObjectTypes gameType;
+  // index of the exported node holding the scene parent, -1 for the scene root
+  int parent;
+  ExMesh* mesh;
+  // instance of an other exported mesh, no geometry captured
+  bool instance;
+  // mesh with faces, captured when its batch is processed
+  bool geometry;
+  // the mesh processing failed, its entity is not written
+  bool failed;
+};
+
 class OgreExporter 
 {
 public:
@@ -68,10 +86,13 @@ private:
 	IGameScene* pIGame;
   std::vector<INode*> lFoundBones;
   int nodeCount;
+  std::vector<ExportedNode> exportedNodes;
 
   void initIGameConf(std::string path);
   void saveExportConf(std::string path);
-  bool exportNode(IGameNode* pGameNode, TiXmlElement* parent);
+  bool exportNode(IGameNode* pGameNode, int parent);
+  void captureMesh(ExportedNode& exportedNode);
+  TiXmlElement* writeNode(ExportedNode& exportedNode, TiXmlElement* parent);
   void LoadSkinBones(IGameNode* pGameNode);
   bool IsSkinnedBone(IGameNode* pGameNode);
   bool IsNodeToExport(IGameNode* pGameNode);
@@ -41,6 +41,12 @@ namespace EasyOgreExporter
     SHADER_ALL_MULTI
 	} ShaderMode;
 
+  typedef enum
+  {
+    LOD_DISTANCE,
+    LOD_PIXEL_COUNT
+  } LodStrategyType;
+
 	typedef enum
 	{
     TOGRE_LASTEST,
@@ -58,11 +64,75 @@ namespace EasyOgreExporter
 		// class members
 		bool exportMesh, exportMaterial, exportCameras, exportLights, lightingOff, exportAll,
 			exportVertNorm, exportVertCol, exportSkeleton, exportSkelAnims, exportVertAnims, exportPoses, 
-			useSharedGeom, copyTextures, tangentsSplitMirrored, tangentsSplitRotated, tangentsUseParity, 
+			useSharedGeom, copyTextures, tangentsUseParity, 
 			buildTangents, buildEdges, resampleAnims, yUpAxis, exportScene, generateLOD, convertToDDS, enableLogs;
 
 		float lum;	// Length Unit Multiplier
 
+    // Max distance on each vertex component to weld two vertices
+    float weldTolerance;
+
+    // Reorder the submeshes index buffers for the post transform vertex cache
+    bool optimizeIndexBuffers;
+    unsigned int vertexCacheSize;
+
+    // Split the materials using more than maxSubMeshVertices vertices in spatial chunks so they keep 16 bits indices (mobile targets)
+    // each chunk is a submesh, so a draw call. Never done on the shared geometry, which has no base vertex
+    bool splitSubMeshes;
+    unsigned int maxSubMeshVertices;
+
+    // Sort the opaque submeshes triangle clusters to reduce the overdraw, the ACMR can grow up to overdrawThreshold
+    bool optimizeOverdraw;
+    float overdrawThreshold;
+
+    // Use compressed vertex formats when the error stay under compressionError (positions need the scene export)
+    bool compressVertices;
+    float compressionError;
+
+    // Number of threads processing the meshes, 0 use all the hardware threads
+    unsigned int numThreads;
+
+    // Write identical meshes once and share the file between their entities
+    bool deduplicateMeshes;
+
+    // Skip the files unchanged since the previous export, forceRebuild ignores the previous export
+    // forceRebuild only applies to the export it is checked for, it is not saved in the config
+    bool exportCache;
+    bool forceRebuild;
+
+    // LOD levels, each level keeps lodReduction of the triangles of the previous one
+    // the first level is used from lodDistance bounding radius or under lodScreenRatio of the screen,
+    // the next ones when the screen size drop by the same factor as the triangles
+    unsigned int lodLevels;
+    float lodReduction;
+    LodStrategyType lodStrategy;
+    float lodDistance;
+    float lodScreenRatio;
+
+    // Stream the mesh files without building Ogre meshes when no Ogre processing is needed
+    bool nativeMeshSerializer;
+
+    // Bone influences kept per vertex (1 to 4), the weights left are renormalized
+    // blendElements also write them in the vertices as UBYTE4 indices and float or normalized UBYTE4 weights (Ogre 1.10 and up),
+    // the indices are in the Ogre blend index map (used bones sorted by handle). Ogre 1.x discards these elements on load,
+    // Mesh::compileBoneAssignments rebuilds them from the bone assignment chunks, so they only serve other mesh readers
+    unsigned int maxBoneInfluences;
+    bool blendElements;
+    bool blendWeightsByte;
+
+    // Max distance on each vertex coordinate between a morph key and its interpolation by the keys kept around it,
+    // 0 only remove the keys equal to their neighbours
+    float morphKeyTolerance;
+
+    // Write the vertex animations as poses blended by weight tracks, with the fewest poses keeping the error
+    // on each vertex coordinate under morphCompressionTolerance, up to morphCompressionMaxPoses per animation
+    bool compressMorphAnimation;
+    float morphCompressionTolerance;
+    unsigned int morphCompressionMaxPoses;
+
+    // Morpher poses only keep the vertices moved by more than poseEpsilon on a coordinate
+    float poseEpsilon;
+
 		std::string outputDir, meshOutputDir, materialOutputDir, programOutputDir, texOutputDir, sceneFilename, resPrefix;
 
 		std::vector<std::string> writtenMaterials;
@@ -105,6 +175,33 @@ namespace EasyOgreExporter
       resampleAnims = false;
       resampleStep = 1;
       generateLOD = false;
+      weldTolerance = 0.000001f;
+      optimizeIndexBuffers = true;
+      vertexCacheSize = 32;
+      splitSubMeshes = false;
+      maxSubMeshVertices = 65535;
+      optimizeOverdraw = false;
+      overdrawThreshold = 1.05f;
+      compressVertices = false;
+      compressionError = 0.001f;
+      numThreads = 0;
+      deduplicateMeshes = true;
+      exportCache = true;
+      forceRebuild = false;
+      nativeMeshSerializer = true;
+      maxBoneInfluences = 4;
+      blendElements = false;
+      blendWeightsByte = true;
+      morphKeyTolerance = 0.0f;
+      compressMorphAnimation = false;
+      morphCompressionTolerance = 0.001f;
+      morphCompressionMaxPoses = 32;
+      poseEpsilon = 0.000001f;
+      lodLevels = 4;
+      lodReduction = 0.5f;
+      lodStrategy = LOD_PIXEL_COUNT;
+      lodDistance = 10.0f;
+      lodScreenRatio = 0.25f;
 
       outputDir = "";
       meshOutputDir = "";
@@ -116,8 +213,6 @@ namespace EasyOgreExporter
 		  
 			buildEdges = true;
 			buildTangents = true;
-			tangentsSplitMirrored = false;
-			tangentsSplitRotated = false;
 			tangentsUseParity = false;
 			tangentSemantic = TS_TANGENT;
 			currentRootJoints.clear();
@@ -153,6 +248,33 @@ namespace EasyOgreExporter
       resampleAnims = source.resampleAnims;
       resampleStep = source.resampleStep;
       generateLOD = source.generateLOD;
+      weldTolerance = source.weldTolerance;
+      optimizeIndexBuffers = source.optimizeIndexBuffers;
+      vertexCacheSize = source.vertexCacheSize;
+      splitSubMeshes = source.splitSubMeshes;
+      maxSubMeshVertices = source.maxSubMeshVertices;
+      optimizeOverdraw = source.optimizeOverdraw;
+      overdrawThreshold = source.overdrawThreshold;
+      compressVertices = source.compressVertices;
+      compressionError = source.compressionError;
+      numThreads = source.numThreads;
+      deduplicateMeshes = source.deduplicateMeshes;
+      exportCache = source.exportCache;
+      forceRebuild = source.forceRebuild;
+      nativeMeshSerializer = source.nativeMeshSerializer;
+      maxBoneInfluences = source.maxBoneInfluences;
+      blendElements = source.blendElements;
+      blendWeightsByte = source.blendWeightsByte;
+      morphKeyTolerance = source.morphKeyTolerance;
+      compressMorphAnimation = source.compressMorphAnimation;
+      morphCompressionTolerance = source.morphCompressionTolerance;
+      morphCompressionMaxPoses = source.morphCompressionMaxPoses;
+      poseEpsilon = source.poseEpsilon;
+      lodLevels = source.lodLevels;
+      lodReduction = source.lodReduction;
+      lodStrategy = source.lodStrategy;
+      lodDistance = source.lodDistance;
+      lodScreenRatio = source.lodScreenRatio;
      
       outputDir = source.outputDir;
 			meshOutputDir = source.meshOutputDir;
@@ -164,8 +286,6 @@ namespace EasyOgreExporter
       			
 			buildEdges = source.buildEdges;
 			buildTangents = source.buildTangents;
-			tangentsSplitMirrored = source.tangentsSplitMirrored;
-			tangentsSplitRotated = source.tangentsSplitRotated;
 			tangentsUseParity = source.tangentsUseParity;
 			tangentSemantic = source.tangentSemantic;
 			yUpAxis = source.yUpAxis;
@@ -235,6 +355,38 @@ namespace EasyOgreExporter
       }
     }
 
+    // Header of the mesh files written for getOgreVersion
+    std::string getOgreVersionTag()
+    {
+      switch(meshVersion)
+      {
+        case TOGRE_LASTEST:
+        case TOGRE_1_10:
+          return "[MeshSerializer_v1.100]";
+
+		    case TOGRE_1_8:
+          return "[MeshSerializer_v1.8]";
+
+        case TOGRE_1_7:
+          return "[MeshSerializer_v1.41]";
+
+        case TOGRE_1_4:
+          return "[MeshSerializer_v1.40]";
+
+        case TOGRE_1_0:
+          return "[MeshSerializer_v1.30]";
+
+        default:
+          return "[MeshSerializer_v1.100]";
+      }
+    }
+
+    // normalized UBYTE4 blend weights need the Ogre 1.10 vertex element types
+    bool useByteBlendWeights()
+    {
+      return blendWeightsByte && ((meshVersion == TOGRE_LASTEST) || (meshVersion == TOGRE_1_10));
+    }
+
     Ogre::SkeletonVersion getSkeletonVersion()
     {
       switch(meshVersion)
@@ -21,8 +21,6 @@
 #define IDC_SHAREDGEOM                  1016
 #define IDC_EDGELIST                    1017
 #define IDC_TANGENT                     1018
-#define IDC_SPLITMIRROR                 1019
-#define IDC_SPLITROT                    1020
 #define IDC_STOREPARITY                 1021
 #define IDC_CHECK1                      1022
 #define IDC_GENLOD                      1022
@@ -40,6 +38,8 @@
 #define IDC_RESAMPLE_SPIN               1031
 #define IDC_RESAMPLE_ANIMS2             1032
 #define IDC_LOGS                        1032
+#define IDC_COMPRESSVERT                1033
+#define IDC_FORCEREBUILD                1034
 
 // Next default values for new objects
 // 
@@ -47,7 +47,7 @@
 #ifndef APSTUDIO_READONLY_SYMBOLS
 #define _APS_NEXT_RESOURCE_VALUE        103
 #define _APS_NEXT_COMMAND_VALUE         40001
-#define _APS_NEXT_CONTROL_VALUE         1031
+#define _APS_NEXT_CONTROL_VALUE         1035
 #define _APS_NEXT_SYMED_VALUE           104
 #endif
 #endif
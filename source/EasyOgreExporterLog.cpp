@@ -14,13 +14,10 @@
 **********************************************************************************/
 
 #include "EasyOgreExporterLog.h"
+#include "ExThreadPool.h"
 
 #include <stdio.h>
-#ifdef WIN32
-	#include <stdarg.h>
-#else
-	#include <varargs.h>
-#endif
+#include <stdarg.h>
 
 #include <iostream>
 #include <fstream>
@@ -31,6 +28,11 @@ namespace EasyOgreExporter
 // The full path to the log file.
 std::string EasyOgreExporterLogFile::_logPath;
 
+#ifndef EX_SERIAL_THREADPOOL
+// Serialize the writes, the meshes are processed on several threads.
+static std::mutex _logLock;
+#endif
+
 // Sets the full path to the log file.
 void EasyOgreExporterLogFile::SetPath(const std::string& logPath)
 {
@@ -58,11 +60,18 @@ void EasyOgreExporterLogFile::Log(const char* format, ...)
 	char buffer[4096];
   
 	va_start(argList, format);
+#ifdef WIN32
 	vsprintf_s(buffer, 4096, format, argList);
+#else
+	vsnprintf(buffer, 4096, format, argList);
+#endif
 	va_end(argList);
 
 	if(_logPath.size() > 0)
 	{
+#ifndef EX_SERIAL_THREADPOOL
+		std::lock_guard<std::mutex> guard(_logLock);
+#endif
 		std::ofstream output(_logPath.c_str(), std::ios_base::app);
 		if(output)
 		{
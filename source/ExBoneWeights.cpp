@@ -0,0 +1,168 @@
+////////////////////////////////////////////////////////////////////////////////
+// ExBoneWeights.cpp
+// Start Date : October 17, 2026
+////////////////////////////////////////////////////////////////////////////////
+/*********************************************************************************
+*                                                                                *
+*   This program is free software; you can redistribute it and/or modify         *
+*   it under the terms of the GNU Lesser General Public License as published by  *
+*   the Free Software Foundation; either version 2 of the License, or            *
+*   (at your option) any later version.                                          *
+*                                                                                *
+**********************************************************************************/
+
+#include "ExBoneWeights.h"
+#include <math.h>
+#include <vector>
+
+namespace EasyOgreExporter
+{
+  unsigned int reduceInfluences(const float* weights, const int* bones, unsigned int count, unsigned int maxInfluences, float* outWeights, int* outBones, float& removedWeight)
+  {
+    removedWeight = 0.0f;
+    for (unsigned int k = 0; k < maxInfluences; k++)
+    {
+      outWeights[k] = 0.0f;
+      outBones[k] = 0;
+    }
+
+    // merge the weights of a same bone, few influences so a linear search is enough
+    std::vector<float> mergedWeights;
+    std::vector<int> mergedBones;
+    mergedWeights.reserve(count);
+    mergedBones.reserve(count);
+    float total = 0.0f;
+    for (unsigned int i = 0; i < count; i++)
+    {
+      if (!(weights[i] > 0.0f))
+        continue;
+
+      total += weights[i];
+      unsigned int j = 0;
+      while ((j < mergedBones.size()) && (mergedBones[j] != bones[i]))
+        j++;
+
+      if (j < mergedBones.size())
+      {
+        mergedWeights[j] += weights[i];
+      }
+      else
+      {
+        mergedWeights.push_back(weights[i]);
+        mergedBones.push_back(bones[i]);
+      }
+    }
+
+    unsigned int numBones = mergedBones.size();
+    if (total <= 0.0f)
+      return 0;
+
+    // keep the largest weights in decreasing order, the first bone wins on equal weights
+    unsigned int numKept = (numBones < maxInfluences) ? numBones : maxInfluences;
+    float kept = 0.0f;
+    for (unsigned int k = 0; k < numKept; k++)
+    {
+      unsigned int best = k;
+      for (unsigned int j = k + 1; j < numBones; j++)
+      {
+        if (mergedWeights[j] > mergedWeights[best])
+          best = j;
+      }
+      float w = mergedWeights[best];
+      int b = mergedBones[best];
+      mergedWeights[best] = mergedWeights[k];
+      mergedBones[best] = mergedBones[k];
+      mergedWeights[k] = w;
+      mergedBones[k] = b;
+
+      outWeights[k] = w;
+      outBones[k] = b;
+      kept += w;
+    }
+
+    removedWeight = (total - kept) / total;
+    float scale = 1.0f / kept;
+    for (unsigned int k = 0; k < numKept; k++)
+      outWeights[k] *= scale;
+
+    return numBones;
+  }
+
+  void quantizeWeights(const float* weights, unsigned int count, unsigned char* out)
+  {
+    float total = 0.0f;
+    for (unsigned int k = 0; k < count; k++)
+      total += (weights[k] > 0.0f) ? weights[k] : 0.0f;
+
+    if (total <= 0.0f)
+    {
+      for (unsigned int k = 0; k < count; k++)
+        out[k] = 0;
+      return;
+    }
+
+    // round down, then give the units left to the largest remainders
+    std::vector<float> remainders(count);
+    int left = 255;
+    for (unsigned int k = 0; k < count; k++)
+    {
+      float value = (weights[k] > 0.0f) ? (weights[k] * 255.0f / total) : 0.0f;
+      float units = floorf(value);
+      out[k] = (unsigned char)units;
+      remainders[k] = value - units;
+      left -= out[k];
+    }
+
+    for (; left > 0; left--)
+    {
+      unsigned int best = 0;
+      for (unsigned int k = 1; k < count; k++)
+      {
+        if (remainders[k] > remainders[best])
+          best = k;
+      }
+      out[best]++;
+      remainders[best] = -1.0f;
+    }
+  }
+
+  unsigned int buildBlendIndexMap(const ExVertexStore& store, const std::vector<unsigned int>& vertices, std::vector<int>& blendIndices)
+  {
+    blendIndices.clear();
+    unsigned int numInfluences = store.getNumInfluences();
+    for (size_t i = 0; i < vertices.size(); i++)
+    {
+      const float* weights = store.getWeights(vertices[i]);
+      const int* bones = store.getBoneIndices(vertices[i]);
+      for (unsigned int k = 0; k < numInfluences; k++)
+      {
+        if ((weights[k] <= 0.0f) || (bones[k] < 0))
+          continue;
+
+        if (bones[k] >= (int)blendIndices.size())
+          blendIndices.resize(bones[k] + 1, -1);
+        blendIndices[bones[k]] = 0;
+      }
+    }
+
+    // rank of the used bones in handle order
+    unsigned int numUsed = 0;
+    for (size_t b = 0; b < blendIndices.size(); b++)
+    {
+      if (blendIndices[b] >= 0)
+        blendIndices[b] = numUsed++;
+    }
+    return numUsed;
+  }
+
+  void packBlendIndices(const float* weights, const int* bones, unsigned int count, const std::vector<int>& blendIndices, unsigned char* out)
+  {
+    for (unsigned int k = 0; k < 4; k++)
+    {
+      out[k] = 0;
+      if ((k < count) && (weights[k] > 0.0f) && (bones[k] >= 0) && (bones[k] < (int)blendIndices.size()) && (blendIndices[bones[k]] >= 0))
+        out[k] = (unsigned char)blendIndices[bones[k]];
+    }
+  }
+
+}; //end of namespace
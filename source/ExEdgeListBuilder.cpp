@@ -0,0 +1,382 @@
+////////////////////////////////////////////////////////////////////////////////
+// ExEdgeListBuilder.cpp
+// Start Date : October 17, 2026
+////////////////////////////////////////////////////////////////////////////////
+/*********************************************************************************
+*                                                                                *
+*   This program is free software; you can redistribute it and/or modify         *
+*   it under the terms of the GNU Lesser General Public License as published by  *
+*   the Free Software Foundation; either version 2 of the License, or            *
+*   (at your option) any later version.                                          *
+*                                                                                *
+**********************************************************************************/
+
+#include "ExEdgeListBuilder.h"
+#include "ExThreadPool.h"
+#include <string.h>
+#include <algorithm>
+
+namespace EasyOgreExporter
+{
+  static const unsigned int INVALID_INDEX = 0xffffffff;
+  static const unsigned long long EMPTY_KEY = 0xffffffffffffffffULL;
+  static const unsigned long long NO_VALUE = 0xffffffffffffffffULL;
+
+  // 64 bits finalizer from MurmurHash3
+  static inline unsigned long long mixHash64(unsigned long long h)
+  {
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
+  }
+
+  static inline unsigned long long edgeKey(unsigned int from, unsigned int to)
+  {
+    return ((unsigned long long)from << 32) | to;
+  }
+
+  // flat open addressing map from a directed edge to its edge
+  // the connected edges keep their key with no value, like a removed entry
+  class ExEdgeMap
+  {
+  public:
+    ExEdgeMap(size_t maxEdges)
+    {
+      size_t numSlots = 16;
+      while (numSlots < (maxEdges * 2))
+        numSlots <<= 1;
+
+      m_keys.assign(numSlots, EMPTY_KEY);
+      m_values.assign(numSlots, NO_VALUE);
+      m_mask = numSlots - 1;
+    };
+
+    //slot of the key, or the empty slot where it goes
+    size_t findSlot(unsigned long long key) const
+    {
+      size_t slot = (size_t)(mixHash64(key) & m_mask);
+      while ((m_keys[slot] != EMPTY_KEY) && (m_keys[slot] != key))
+        slot = (slot + 1) & m_mask;
+      return slot;
+    };
+
+    std::vector<unsigned long long> m_keys;
+    std::vector<unsigned long long> m_values;
+    size_t m_mask;
+  };
+
+  // sort the index sets by vertex set, keeping their order inside a vertex set
+  class ExVertexSetOrder
+  {
+  public:
+    ExVertexSetOrder(const std::vector<unsigned int>& indexVertexSets) : m_indexVertexSets(indexVertexSets)
+    {
+    };
+
+    bool operator()(unsigned int a, unsigned int b) const
+    {
+      return m_indexVertexSets[a] < m_indexVertexSets[b];
+    };
+
+  private:
+    const std::vector<unsigned int>& m_indexVertexSets;
+  };
+
+  // triangles, face normals and edges of one index set, run by the pool
+  class ExIndexSetEdgesJob : public ExPoolJob
+  {
+  public:
+    ExIndexSetEdgesJob(const ExVertexStore& store, const std::vector<const std::vector<unsigned int>*>& vertexSets, const std::vector<const std::vector<unsigned int>*>& indexSets,
+                       const std::vector<unsigned int>& indexVertexSets, const std::vector<unsigned int>& triStart, const std::vector<unsigned int>& positionIds,
+                       ExEdgeData& data, std::vector<std::vector<ExEdge> >& setEdges, std::vector<std::vector<unsigned int> >& setOpenEdges) :
+      m_store(store), m_vertexSets(vertexSets), m_indexSets(indexSets), m_indexVertexSets(indexVertexSets), m_triStart(triStart), m_positionIds(positionIds),
+      m_data(data), m_setEdges(setEdges), m_setOpenEdges(setOpenEdges)
+    {
+    };
+
+    void run(size_t s)
+    {
+      const std::vector<unsigned int>& indices = *m_indexSets[s];
+      const std::vector<unsigned int>& vertices = *m_vertexSets[m_indexVertexSets[s]];
+      unsigned int numSetTriangles = indices.size() / 3;
+      std::vector<ExEdge>& edges = m_setEdges[s];
+      edges.reserve(numSetTriangles * 3 / 2 + 1);
+      std::vector<unsigned char> inMap;
+      inMap.reserve(edges.capacity());
+      ExEdgeMap edgeMap(numSetTriangles * 3);
+
+      for (unsigned int t = 0; t < numSetTriangles; t++)
+      {
+        unsigned int triIndex = m_triStart[s] + t;
+        ExEdgeTriangle& tri = m_data.triangles[triIndex];
+        tri.indexSet = s;
+        tri.vertexSet = m_indexVertexSets[s];
+        for (int k = 0; k < 3; k++)
+        {
+          tri.vertIndex[k] = indices[(t * 3) + k];
+          tri.sharedVertIndex[k] = m_positionIds[vertices[tri.vertIndex[k]]];
+        }
+
+        // face normal without normalization and the plane distance
+        const float* p0 = m_store.getPosition(vertices[tri.vertIndex[0]]);
+        const float* p1 = m_store.getPosition(vertices[tri.vertIndex[1]]);
+        const float* p2 = m_store.getPosition(vertices[tri.vertIndex[2]]);
+        float e1[3] = {p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2]};
+        float e2[3] = {p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2]};
+        float* normal = &m_data.faceNormals[triIndex * 4];
+        normal[0] = (e1[1] * e2[2]) - (e1[2] * e2[1]);
+        normal[1] = (e1[2] * e2[0]) - (e1[0] * e2[2]);
+        normal[2] = (e1[0] * e2[1]) - (e1[1] * e2[0]);
+        normal[3] = -((normal[0] * p0[0]) + (normal[1] * p0[1]) + (normal[2] * p0[2]));
+
+        // no edge on the degenerated triangles
+        if ((tri.sharedVertIndex[0] == tri.sharedVertIndex[1]) || (tri.sharedVertIndex[1] == tri.sharedVertIndex[2]) || (tri.sharedVertIndex[2] == tri.sharedVertIndex[0]))
+          continue;
+
+        for (int k = 0; k < 3; k++)
+        {
+          int next = (k + 1) % 3;
+          unsigned int shared0 = tri.sharedVertIndex[k];
+          unsigned int shared1 = tri.sharedVertIndex[next];
+
+          // the other side of an edge goes the other way
+          size_t slot = edgeMap.findSlot(edgeKey(shared1, shared0));
+          if (edgeMap.m_values[slot] != NO_VALUE)
+          {
+            unsigned int e = (unsigned int)edgeMap.m_values[slot];
+            edges[e].triIndex[1] = triIndex;
+            edges[e].degenerate = false;
+            edgeMap.m_values[slot] = NO_VALUE;
+            inMap[e] = 0;
+            continue;
+          }
+
+          ExEdge edge;
+          edge.triIndex[0] = triIndex;
+          edge.triIndex[1] = INVALID_INDEX;
+          edge.vertIndex[0] = tri.vertIndex[k];
+          edge.vertIndex[1] = tri.vertIndex[next];
+          edge.sharedVertIndex[0] = shared0;
+          edge.sharedVertIndex[1] = shared1;
+          edge.degenerate = true;
+
+          // a second edge going the same way is kept out of the map
+          slot = edgeMap.findSlot(edgeKey(shared0, shared1));
+          bool added = (edgeMap.m_values[slot] == NO_VALUE);
+          if (added)
+          {
+            edgeMap.m_keys[slot] = edgeKey(shared0, shared1);
+            edgeMap.m_values[slot] = edges.size();
+          }
+          inMap.push_back(added ? 1 : 0);
+          edges.push_back(edge);
+        }
+      }
+
+      for (unsigned int e = 0; e < edges.size(); e++)
+      {
+        if (inMap[e])
+          m_setOpenEdges[s].push_back(e);
+      }
+    };
+
+  private:
+    const ExVertexStore& m_store;
+    const std::vector<const std::vector<unsigned int>*>& m_vertexSets;
+    const std::vector<const std::vector<unsigned int>*>& m_indexSets;
+    const std::vector<unsigned int>& m_indexVertexSets;
+    const std::vector<unsigned int>& m_triStart;
+    const std::vector<unsigned int>& m_positionIds;
+    ExEdgeData& m_data;
+    std::vector<std::vector<ExEdge> >& m_setEdges;
+    std::vector<std::vector<unsigned int> >& m_setOpenEdges;
+  };
+
+  ExEdgeListBuilder::ExEdgeListBuilder(const ExVertexStore& store) : m_store(store)
+  {
+  }
+
+  ExEdgeListBuilder::~ExEdgeListBuilder()
+  {
+    m_vertexSets.clear();
+    m_indexSets.clear();
+    m_indexVertexSets.clear();
+  }
+
+  unsigned int ExEdgeListBuilder::addVertexSet(const std::vector<unsigned int>& vertices)
+  {
+    m_vertexSets.push_back(&vertices);
+    return m_vertexSets.size() - 1;
+  }
+
+  void ExEdgeListBuilder::addIndexSet(const std::vector<unsigned int>& indices, unsigned int vertexSet)
+  {
+    m_indexSets.push_back(&indices);
+    m_indexVertexSets.push_back(vertexSet);
+  }
+
+  void ExEdgeListBuilder::weldPositions(std::vector<unsigned int>& positionIds)
+  {
+    size_t numUsed = 0;
+    for (size_t vs = 0; vs < m_vertexSets.size(); vs++)
+      numUsed += m_vertexSets[vs]->size();
+
+    size_t numSlots = 16;
+    while (numSlots < (numUsed * 2))
+      numSlots <<= 1;
+
+    // the table holds the first vertex of each position, the same bits are the same position, -0 is 0
+    std::vector<unsigned int> table(numSlots, INVALID_INDEX);
+    std::vector<unsigned int> keys;
+    keys.reserve(numUsed * 3);
+    positionIds.assign(m_store.size(), INVALID_INDEX);
+    unsigned int numPositions = 0;
+    for (size_t vs = 0; vs < m_vertexSets.size(); vs++)
+    {
+      const std::vector<unsigned int>& vertices = *m_vertexSets[vs];
+      for (size_t i = 0; i < vertices.size(); i++)
+      {
+        unsigned int handle = vertices[i];
+        if (positionIds[handle] != INVALID_INDEX)
+          continue;
+
+        unsigned int bits[3];
+        const float* pos = m_store.getPosition(handle);
+        for (int k = 0; k < 3; k++)
+        {
+          float value = pos[k] + 0.0f;
+          memcpy(&bits[k], &value, sizeof(float));
+        }
+
+        unsigned long long h = mixHash64(bits[0] * 0x9e3779b97f4a7c15ULL);
+        h = mixHash64(h ^ (bits[1] * 0xc2b2ae3d27d4eb4fULL));
+        h = mixHash64(h ^ (bits[2] * 0x165667b19e3779f9ULL));
+        size_t slot = (size_t)(h & (numSlots - 1));
+        while (table[slot] != INVALID_INDEX)
+        {
+          const unsigned int* other = &keys[table[slot] * 3];
+          if ((other[0] == bits[0]) && (other[1] == bits[1]) && (other[2] == bits[2]))
+            break;
+          slot = (slot + 1) & (numSlots - 1);
+        }
+
+        if (table[slot] == INVALID_INDEX)
+        {
+          table[slot] = numPositions++;
+          keys.insert(keys.end(), bits, bits + 3);
+        }
+        positionIds[handle] = table[slot];
+      }
+    }
+  }
+
+  void ExEdgeListBuilder::build(ExEdgeData& data, unsigned int numThreads)
+  {
+    data.triangles.clear();
+    data.faceNormals.clear();
+    data.edgeGroups.clear();
+    data.isClosed = true;
+
+    std::vector<unsigned int> positionIds;
+    weldPositions(positionIds);
+
+    // triangles sorted by vertex set then index set, like Ogre, each index set gets its triangles range
+    unsigned int numIndexSets = m_indexSets.size();
+    std::vector<unsigned int> setOrder(numIndexSets);
+    for (unsigned int s = 0; s < numIndexSets; s++)
+      setOrder[s] = s;
+    std::stable_sort(setOrder.begin(), setOrder.end(), ExVertexSetOrder(m_indexVertexSets));
+
+    std::vector<unsigned int> triStart(numIndexSets);
+    unsigned int numTriangles = 0;
+    for (unsigned int i = 0; i < numIndexSets; i++)
+    {
+      triStart[setOrder[i]] = numTriangles;
+      numTriangles += m_indexSets[setOrder[i]]->size() / 3;
+    }
+
+    data.triangles.resize(numTriangles);
+    data.faceNormals.resize(numTriangles * 4);
+    data.edgeGroups.resize(m_vertexSets.size());
+    for (unsigned int vs = 0; vs < m_vertexSets.size(); vs++)
+    {
+      data.edgeGroups[vs].vertexSet = vs;
+      data.edgeGroups[vs].triStart = 0;
+      data.edgeGroups[vs].triCount = 0;
+    }
+    for (unsigned int i = numIndexSets; i > 0; i--)
+    {
+      unsigned int s = setOrder[i - 1];
+      ExEdgeGroup& group = data.edgeGroups[m_indexVertexSets[s]];
+      group.triStart = triStart[s];
+      group.triCount += m_indexSets[s]->size() / 3;
+    }
+
+    // triangles, face normals and edges of each index set, the edges are matched inside the index set only
+    std::vector<std::vector<ExEdge> > setEdges(numIndexSets);
+    std::vector<std::vector<unsigned int> > setOpenEdges(numIndexSets);
+    ExThreadPool pool(numThreads);
+    ExIndexSetEdgesJob job(m_store, m_vertexSets, m_indexSets, m_indexVertexSets, triStart, positionIds, data, setEdges, setOpenEdges);
+    pool.run(numIndexSets, job);
+
+    // match the edges left open between the index sets, in the triangles order
+    size_t numOpenEdges = 0;
+    for (unsigned int s = 0; s < numIndexSets; s++)
+      numOpenEdges += setOpenEdges[s].size();
+
+    ExEdgeMap openMap(numOpenEdges);
+    std::vector<std::vector<unsigned char> > removed(numIndexSets);
+    for (unsigned int i = 0; i < numIndexSets; i++)
+    {
+      unsigned int s = setOrder[i];
+      std::vector<ExEdge>& edges = setEdges[s];
+      removed[s].assign(edges.size(), 0);
+      for (size_t j = 0; j < setOpenEdges[s].size(); j++)
+      {
+        unsigned int e = setOpenEdges[s][j];
+        ExEdge& edge = edges[e];
+        size_t slot = openMap.findSlot(edgeKey(edge.sharedVertIndex[1], edge.sharedVertIndex[0]));
+        if (openMap.m_values[slot] != NO_VALUE)
+        {
+          unsigned long long value = openMap.m_values[slot];
+          ExEdge& other = setEdges[(unsigned int)(value >> 32)][(unsigned int)(value & 0xffffffff)];
+          other.triIndex[1] = edge.triIndex[0];
+          other.degenerate = false;
+          openMap.m_values[slot] = NO_VALUE;
+          removed[s][e] = 1;
+          continue;
+        }
+
+        slot = openMap.findSlot(edgeKey(edge.sharedVertIndex[0], edge.sharedVertIndex[1]));
+        if (openMap.m_values[slot] == NO_VALUE)
+        {
+          openMap.m_keys[slot] = edgeKey(edge.sharedVertIndex[0], edge.sharedVertIndex[1]);
+          openMap.m_values[slot] = ((unsigned long long)s << 32) | e;
+        }
+      }
+    }
+
+    for (size_t slot = 0; slot < openMap.m_values.size(); slot++)
+    {
+      if (openMap.m_values[slot] != NO_VALUE)
+        data.isClosed = false;
+    }
+
+    // edges of each vertex set in the triangles order
+    for (unsigned int i = 0; i < numIndexSets; i++)
+    {
+      unsigned int s = setOrder[i];
+      std::vector<ExEdge>& groupEdges = data.edgeGroups[m_indexVertexSets[s]].edges;
+      for (size_t e = 0; e < setEdges[s].size(); e++)
+      {
+        if (!removed[s][e])
+          groupEdges.push_back(setEdges[s][e]);
+      }
+      setEdges[s].clear();
+    }
+  }
+
+}; //end of namespace
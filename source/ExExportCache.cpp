@@ -0,0 +1,146 @@
+////////////////////////////////////////////////////////////////////////////////
+// ExExportCache.cpp
+// Start Date : October 17, 2026
+////////////////////////////////////////////////////////////////////////////////
+/*********************************************************************************
+*                                                                                *
+*   This program is free software; you can redistribute it and/or modify         *
+*   it under the terms of the GNU Lesser General Public License as published by  *
+*   the Free Software Foundation; either version 2 of the License, or            *
+*   (at your option) any later version.                                          *
+*                                                                                *
+**********************************************************************************/
+
+#include "ExExportCache.h"
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <fstream>
+#include <sstream>
+
+namespace EasyOgreExporter
+{
+  //first line of the manifest, change it when the hashed content changes
+  static const char* CACHE_HEADER = "EasyOgreExporter export cache 1";
+
+  ExExportCache::ExExportCache()
+  {
+    m_numSkipped = 0;
+    m_numWritten = 0;
+  }
+
+  void ExExportCache::load(const std::string& path, bool forceRebuild)
+  {
+    m_path = path;
+    m_entries.clear();
+    m_numSkipped = 0;
+    m_numWritten = 0;
+
+    if (forceRebuild)
+      return;
+
+    std::ifstream input(path.c_str());
+    if (!input)
+      return;
+
+    std::string line;
+    if (!std::getline(input, line) || (line != CACHE_HEADER))
+      return;
+
+    //hash, file and data separated by tabs, file names can not contain one
+    while (std::getline(input, line))
+    {
+      size_t fileStart = line.find('\t');
+      if (fileStart == std::string::npos)
+        continue;
+
+      size_t dataStart = line.find('\t', fileStart + 1);
+      if (dataStart == std::string::npos)
+        continue;
+
+      Entry entry;
+      entry.hash = line.substr(0, fileStart);
+      entry.data = line.substr(dataStart + 1);
+      m_entries[line.substr(fileStart + 1, dataStart - fileStart - 1)] = entry;
+    }
+  }
+
+  bool ExExportCache::save()
+  {
+    if (m_path.empty())
+      return false;
+
+    std::ofstream output(m_path.c_str());
+    if (!output)
+      return false;
+
+    output << CACHE_HEADER << "\n";
+    for (std::map<std::string, Entry>::iterator it = m_entries.begin(); it != m_entries.end(); it++)
+      output << it->second.hash << "\t" << it->first << "\t" << it->second.data << "\n";
+
+    output.close();
+    return true;
+  }
+
+  bool ExExportCache::isUpToDate(const std::string& file, const std::string& hash, std::string* data)
+  {
+    if (hash.empty())
+      return false;
+
+    std::map<std::string, Entry>::iterator it = m_entries.find(file);
+    if ((it == m_entries.end()) || (it->second.hash != hash))
+      return false;
+
+    //deleted or replaced by hand
+    std::ifstream output(file.c_str(), std::ios::in | std::ios::binary);
+    if (!output)
+      return false;
+
+    if (data)
+      *data = it->second.data;
+
+    m_numSkipped++;
+    return true;
+  }
+
+  void ExExportCache::update(const std::string& file, const std::string& hash, const std::string& data)
+  {
+    m_numWritten++;
+    if (hash.empty())
+    {
+      invalidate(file);
+      return;
+    }
+
+    Entry entry;
+    entry.hash = hash;
+    entry.data = data;
+    m_entries[file] = entry;
+  }
+
+  void ExExportCache::invalidate(const std::string& file)
+  {
+    m_entries.erase(file);
+  }
+
+  unsigned int ExExportCache::getNumSkipped() const
+  {
+    return m_numSkipped;
+  }
+
+  unsigned int ExExportCache::getNumWritten() const
+  {
+    return m_numWritten;
+  }
+
+  std::string ExExportCache::getFileStamp(const std::string& path)
+  {
+    struct stat info;
+    if (stat(path.c_str(), &info) != 0)
+      return std::string();
+
+    std::stringstream stamp;
+    stamp << (unsigned long long)info.st_size << ":" << (long long)info.st_mtime;
+    return stamp.str();
+  }
+
+}; //end of namespace
@@ -0,0 +1,135 @@
+////////////////////////////////////////////////////////////////////////////////
+// ExHash.cpp
+// Start Date : October 17, 2026
+////////////////////////////////////////////////////////////////////////////////
+/*********************************************************************************
+*                                                                                *
+*   This program is free software; you can redistribute it and/or modify         *
+*   it under the terms of the GNU Lesser General Public License as published by  *
+*   the Free Software Foundation; either version 2 of the License, or            *
+*   (at your option) any later version.                                          *
+*                                                                                *
+**********************************************************************************/
+
+#include "ExHash.h"
+#include <string.h>
+
+namespace EasyOgreExporter
+{
+  static const unsigned long long PRIME0 = 0x9e3779b185ebca87ULL;
+  static const unsigned long long PRIME1 = 0xc2b2ae3d27d4eb4fULL;
+  static const unsigned long long PRIME2 = 0x165667b19e3779f9ULL;
+  static const unsigned long long PRIME3 = 0x85ebca77c2b2ae63ULL;
+
+  static inline unsigned long long rotl64(unsigned long long x, int r)
+  {
+    return (x << r) | (x >> (64 - r));
+  }
+
+  // 64 bits finalizer from MurmurHash3
+  static inline unsigned long long fmix64(unsigned long long h)
+  {
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
+  }
+
+  ExHasher::ExHasher()
+  {
+    m_lane0 = PRIME2;
+    m_lane1 = PRIME3;
+    m_length = 0;
+    m_tailSize = 0;
+  }
+
+  void ExHasher::addWord(unsigned long long word)
+  {
+    m_lane0 = rotl64(m_lane0 ^ (word * PRIME0), 31) * PRIME1;
+    m_lane1 = rotl64(m_lane1 ^ (word * PRIME2), 27) * PRIME3 + m_lane0;
+  }
+
+  void ExHasher::add(const void* data, size_t size)
+  {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    m_length += size;
+
+    //complete the pending word first
+    if (m_tailSize > 0)
+    {
+      size_t count = 8 - m_tailSize;
+      if (count > size)
+        count = size;
+      memcpy(m_tail + m_tailSize, bytes, count);
+      m_tailSize += (unsigned int)count;
+      bytes += count;
+      size -= count;
+      if (m_tailSize < 8)
+        return;
+
+      unsigned long long word;
+      memcpy(&word, m_tail, 8);
+      addWord(word);
+      m_tailSize = 0;
+    }
+
+    while (size >= 8)
+    {
+      unsigned long long word;
+      memcpy(&word, bytes, 8);
+      addWord(word);
+      bytes += 8;
+      size -= 8;
+    }
+
+    memcpy(m_tail, bytes, size);
+    m_tailSize = (unsigned int)size;
+  }
+
+  void ExHasher::addInt(long long value)
+  {
+    add(&value, sizeof(value));
+  }
+
+  void ExHasher::addFloat(float value)
+  {
+    add(&value, sizeof(value));
+  }
+
+  void ExHasher::addString(const std::string& value)
+  {
+    addArray(value.c_str(), value.size());
+  }
+
+  std::string ExHasher::toString() const
+  {
+    unsigned long long lane0 = m_lane0;
+    unsigned long long lane1 = m_lane1;
+
+    //pending bytes padded with zeros
+    if (m_tailSize > 0)
+    {
+      unsigned char tail[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+      memcpy(tail, m_tail, m_tailSize);
+      unsigned long long word;
+      memcpy(&word, tail, 8);
+      lane0 = rotl64(lane0 ^ (word * PRIME0), 31) * PRIME1;
+      lane1 = rotl64(lane1 ^ (word * PRIME2), 27) * PRIME3 + lane0;
+    }
+
+    unsigned long long h0 = fmix64(lane0 ^ m_length);
+    unsigned long long h1 = fmix64(lane1 + h0);
+
+    static const char digits[] = "0123456789abcdef";
+    std::string str(32, '0');
+    for (int i = 0; i < 16; i++)
+    {
+      str[15 - i] = digits[(h0 >> (i * 4)) & 0xf];
+      str[31 - i] = digits[(h1 >> (i * 4)) & 0xf];
+    }
+    return str;
+  }
+
+}; //end of namespace
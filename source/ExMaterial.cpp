@@ -1610,7 +1610,7 @@ namespace EasyOgreExporter
 	}
 
 	// Write material data to an Ogre material script file
-	bool ExMaterial::writeOgreScript(std::ofstream &outMaterial, ExShader* vsAmbShader, ExShader* fpAmbShader, ExShader* vsLightShader, ExShader* fpLightShader)
+	bool ExMaterial::writeOgreScript(std::ostream &outMaterial, ExShader* vsAmbShader, ExShader* fpAmbShader, ExShader* vsLightShader, ExShader* fpLightShader)
 	{
     ParamList params = m_converter->getParams();
 
@@ -1635,7 +1635,7 @@ namespace EasyOgreExporter
 		return true;
 	}
 
-	void ExMaterial::writeMaterialTechnique(std::ofstream &outMaterial, int lod, ExShader* vsAmbShader, ExShader* fpAmbShader, ExShader* vsLightShader, ExShader* fpLightShader)
+	void ExMaterial::writeMaterialTechnique(std::ostream &outMaterial, int lod, ExShader* vsAmbShader, ExShader* fpAmbShader, ExShader* vsLightShader, ExShader* fpLightShader)
 	{
 		//Start technique description
 		outMaterial << "\ttechnique ";
@@ -1696,7 +1696,7 @@ namespace EasyOgreExporter
     }
 	}
 
-	void ExMaterial::writeMaterialPass(std::ofstream &outMaterial, int lod, ExShader* vsShader, ExShader* fpShader, ExShader::ShaderPass pass)
+	void ExMaterial::writeMaterialPass(std::ostream &outMaterial, int lod, ExShader* vsShader, ExShader* fpShader, ExShader::ShaderPass pass)
 	{
     ParamList params = m_converter->getParams();
 
@@ -19,12 +19,15 @@
 
 #include "ExMaterial.h"
 #include "ExMaterialSet.h"
+#include "ExHash.h"
 #include <nvtt/nvtt.h>
 
 namespace EasyOgreExporter
 {
   ExMaterialSet::ExMaterialSet(ExOgreConverter* converter)
   {
+    m_converter = converter;
+
 		//create a default material
 		m_default = new ExMaterial(converter, 0, "");
 	};
@@ -218,21 +221,47 @@ namespace EasyOgreExporter
 		return NULL;
 	};
 	
+  //write a generated script, the file is kept when the previous export wrote the same content
+  static bool writeScriptFile(ExExportCache& exportCache, const std::string& filePath, const std::string& content, bool useCache)
+  {
+    std::string hash;
+    if (useCache)
+    {
+      ExHasher hasher;
+      hasher.addString(content);
+      hash = hasher.toString();
+    }
+
+    if (exportCache.isUpToDate(filePath, hash))
+    {
+      EasyOgreExporterLog("Info: file %s unchanged, keep the previous file\n", filePath.c_str());
+      return true;
+    }
+
+    std::ofstream outFile(filePath.c_str());
+    if (!outFile)
+    {
+      EasyOgreExporterLog("Error opening file: %s\n", filePath.c_str());
+      exportCache.invalidate(filePath);
+      return false;
+    }
+
+    outFile << content;
+    outFile.close();
+    exportCache.update(filePath, hash);
+    return true;
+  }
+
 	//write materials to Ogre Script
 	bool ExMaterialSet::writeOgreScript(ParamList &params)
   {
 		bool stat = false;
     std::string msg;
+    ExExportCache& exportCache = m_converter->getExportCache();
 
-    std::ofstream outMaterial;
-	  
+    //the scripts are generated in memory and only written when their content changed
+    std::stringstream outMaterial;
     std::string filePath = makeOutputPath(params.outputDir, params.materialOutputDir, params.sceneFilename, "material");
-	  outMaterial.open(filePath.c_str());
-	  if (!outMaterial)
-	  {
-			EasyOgreExporterLog("Error opening file: %s\n", filePath.c_str());
-		  return false;
-	  }
 
 		for (int i=0; i<m_materials.size(); i++)
 		{
@@ -259,28 +288,16 @@ namespace EasyOgreExporter
       
       m_materials[i]->writeOgreScript(outMaterial, vsAmbShader ,fpAmbShader, vsLightShader, fpLightShader);
 		}
-    outMaterial.close();
+
+    if (!writeScriptFile(exportCache, filePath, outMaterial.str(), params.exportCache))
+      return false;
 
     if(params.exportProgram != SHADER_NONE && (m_Shaders.size() > 0))
     {
-      std::ofstream outShaderCG;
-      std::ofstream outProgram;
-  	  
+      std::stringstream outShaderCG;
+      std::stringstream outProgram;
       std::string cgFilePath = makeOutputPath(params.outputDir, params.programOutputDir, optimizeFileName(params.sceneFilename), "cg");
-	    outShaderCG.open(cgFilePath.c_str());
-	    if (!outShaderCG)
-	    {
-			  EasyOgreExporterLog("Error opening file: %s\n", cgFilePath.c_str());
-		    return false;
-	    }
-      
       std::string prFilePath = makeOutputPath(params.outputDir, params.programOutputDir, optimizeFileName(params.sceneFilename), "program");
-	    outProgram.open(prFilePath.c_str());
-	    if (!outProgram)
-	    {
-			  EasyOgreExporterLog("Error opening file: %s\n", prFilePath.c_str());
-		    return false;
-	    }
 
       for (int i = 0; i < m_Shaders.size(); i++)
       {
@@ -288,18 +305,8 @@ namespace EasyOgreExporter
 
         if (!glesContent.empty())
         {
-          std::ofstream outShaderGles;
           std::string glesFilePath = makeOutputPath(params.outputDir, params.programOutputDir, optimizeFileName(m_Shaders[i]->getName()) + ((m_Shaders[i]->getType() == ExShader::ShaderType::ST_VSLIGHT) ? "VP" : "FP"), "glsles");
-          outShaderGles.open(glesFilePath.c_str());
-          if (!outShaderGles)
-          {
-            EasyOgreExporterLog("Error opening file: %s\n", glesFilePath.c_str());
-          }
-          else
-          {
-            outShaderGles << glesContent;
-            outShaderGles.close();
-          }
+          writeScriptFile(exportCache, glesFilePath, glesContent, params.exportCache);
         }
 
         outShaderCG << m_Shaders[i]->getContent();
@@ -309,8 +316,9 @@ namespace EasyOgreExporter
         outProgram << "\n";
       }
 
-      outShaderCG.close();
-      outProgram.close();
+      if (!writeScriptFile(exportCache, cgFilePath, outShaderCG.str(), params.exportCache) ||
+          !writeScriptFile(exportCache, prFilePath, outProgram.str(), params.exportCache))
+        return false;
     }
 
     
@@ -344,14 +352,38 @@ namespace EasyOgreExporter
   #ifdef UNICODE
 			  std::wstring absFilename_w;
 			  absFilename_w.assign(tex.absFilename[k].begin(),tex.absFilename[k].end());
-			  if(params.convertToDDS && (texExt != "dds") && DoesFileExist(absFilename_w.data()))
+			  bool convertDDS = (params.convertToDDS && (texExt != "dds") && DoesFileExist(absFilename_w.data())) ? true : false;
   #else
-              if(params.convertToDDS && (texExt != "dds") && DoesFileExist(tex.absFilename[k].c_str()))
+              bool convertDDS = (params.convertToDDS && (texExt != "dds") && DoesFileExist(tex.absFilename[k].c_str())) ? true : false;
   #endif
+              // DDS extension
+              if(convertDDS)
+                destFile = makeOutputPath(params.outputDir, params.texOutputDir, texName.substr(0, texName.find_last_of(".")), "DDS");
+
+              //source file unchanged since the previous export
+              std::string texHash;
+              std::string texStamp = params.exportCache ? ExExportCache::getFileStamp(tex.absFilename[k]) : std::string();
+              if (!texStamp.empty())
+              {
+                ExHasher hasher;
+                hasher.addString(tex.absFilename[k]);
+                hasher.addString(texStamp);
+                hasher.addInt(convertDDS ? 1 : 0);
+                hasher.addInt(params.maxTextureSize);
+                hasher.addInt(params.maxMipmaps);
+                texHash = hasher.toString();
+              }
+
+              if(exportCache.isUpToDate(destFile, texHash))
+              {
+                EasyOgreExporterLog("Info: texture file %s unchanged, keep the previous file\n", destFile.c_str());
+                lTexDone.push_back(tex.absFilename[k]);
+                continue;
+              }
+
+              if(convertDDS)
               {
                 ddsMode = -1;
-                // DDS extension
-                destFile = makeOutputPath(params.outputDir, params.texOutputDir, texName.substr(0, texName.find_last_of(".")), "DDS");
 
                 //load bitmap
                 BMMRES status;
@@ -565,6 +597,7 @@ namespace EasyOgreExporter
                 }
               }
 
+              bool written = (ddsMode == 1) ? true : false;
 			        if(ddsMode <= 0)
 			        {
                 if (ddsMode == -1)
@@ -576,13 +609,19 @@ namespace EasyOgreExporter
 				        absFilename_w.assign(tex.absFilename[k].begin(),tex.absFilename[k].end());
 				        std::wstring destFile_w;
 				        destFile_w.assign(destFile.begin(),destFile.end());
-				        if(!CopyFile(absFilename_w.data(), destFile_w.data(), false))
+				        written = CopyFile(absFilename_w.data(), destFile_w.data(), false) ? true : false;
   #else
-				        if(!CopyFile(tex.absFilename[k].c_str(), destFile.c_str(), false))
+				        written = CopyFile(tex.absFilename[k].c_str(), destFile.c_str(), false) ? true : false;
   #endif
+				        if(!written)
 					        EasyOgreExporterLog("Error while copying texture file %s to %s\n", tex.absFilename[k].c_str(), destFile.c_str());
 			        }
 
+              if(written)
+                exportCache.update(destFile, texHash);
+              else
+                exportCache.invalidate(destFile);
+
               lTexDone.push_back(tex.absFilename[k]);
             }
 		      }
@@ -16,13 +16,21 @@
 #include "ExMaterial.h"
 #include "EasyOgreExporterLog.h"
 #include "ExTools.h"
-#include "MeshLodGenerator/OgreMeshLodGenerator.h"
+#include "ExMeshBuilder.h"
+#include "ExHash.h"
+#include "ExVertexWriter.h"
+#include "ExVertexCompressor.h"
+#include "ExMeshSerializer.h"
+#include "ExEdgeListBuilder.h"
+#include "ExMeshSimplifier.h"
+#include "ExMorphCompressor.h"
+#include "ExSkinBounds.h"
+#include "ExBoneWeights.h"
+#include "ExThreadPool.h"
 #include "OgreDistanceLodStrategy.h"
 #include "OgrePixelCountLodStrategy.h"
 #include "IFrameTagManager.h"
 
-//TODO bounding on skeleton
-
 namespace EasyOgreExporter
 {
   ExMesh::ExMesh(ExOgreConverter* converter, IGameNode* pGameNode, IGameMesh* pGameMesh, const std::string& name)
@@ -38,6 +46,12 @@ namespace EasyOgreExporter
     m_pMorphR3 = 0;
     m_SphereRadius = 0;
     m_numTextureChannel = 0;
+    m_blendElements = false;
+    m_morphError = false;
+    m_prepared = false;
+    m_writeReady = false;
+    m_nativeWritten = false;
+    m_nativeResult = false;
     numOfVertices = 0;
 
     haveVertexColor = (pGameMesh->GetNumberOfColorVerts() > 0) ? true : false;
@@ -83,7 +97,13 @@ namespace EasyOgreExporter
 
       //update the mesh normals
       mMesh->buildNormals();
-      prepareMesh(mMesh);
+
+      //copy the Max data, the processing only use the snapshot
+      captureSnapshot(mMesh);
+      if (m_pMorphR3 && m_params.exportPoses)
+        captureMorphTargets();
+      loadMaterials();
+      computeContentHash();
 
       //free the tree object
       if (delTri && triObj)
@@ -108,7 +128,7 @@ namespace EasyOgreExporter
       delete m_pSkeleton;
 
     m_vertices.clear();
-    m_faces.clear();
+    m_faceVertices.clear();
     m_subList.clear();
   }
 
@@ -128,69 +148,102 @@ namespace EasyOgreExporter
     m_SphereRadius = std::max(m_SphereRadius, pos.Length());
   }
 
-  std::vector<ExFace> ExMesh::GetFacesByMaterialId(int matId)
+  void ExMesh::updateSkinBounds()
   {
-    std::vector<ExFace> faces;
-    for (int i = 0; i < m_faces.size(); i++)
-    {
-      if (m_faces[i].iMaterialId == matId)
-        faces.push_back(m_faces[i]);
-    }
+    const std::vector<float>& skinPoses = getSkeleton()->getSkinPoses();
+    unsigned int numBones = getSkeleton()->getJoints().size();
+    if ((numBones == 0) || (m_vertices.getNumInfluences() == 0) || skinPoses.empty())
+      return;
+
+    ExSkinBounds skinBounds(m_vertices, numBones);
+    float minB[3] = {m_Bounding.pmin.x, m_Bounding.pmin.y, m_Bounding.pmin.z};
+    float maxB[3] = {m_Bounding.pmax.x, m_Bounding.pmax.y, m_Bounding.pmax.z};
+    size_t numPoses = skinPoses.size() / (numBones * 12);
+    for (size_t i = 0; i < numPoses; i++)
+      skinBounds.addPose(&skinPoses[i * numBones * 12], minB, maxB, m_SphereRadius);
 
-    return faces;
+    m_Bounding.pmin = Point3(minB[0], minB[1], minB[2]);
+    m_Bounding.pmax = Point3(maxB[0], maxB[1], maxB[2]);
+    EasyOgreExporterLog("Info : bounds of %d skinned poses on %d bones, radius %f\n", (int)numPoses, (int)skinBounds.getNumUsedBones(), m_SphereRadius);
   }
 
-  void ExMesh::prepareMesh(Mesh* mMesh)
+  void ExMesh::captureSnapshot(Mesh* mMesh)
   {
-    INode* node = m_GameNode->GetMaxNode();
     int numFaces = mMesh->getNumFaces();
+    int numVerts = mMesh->getNumVerts();
     UVVert* vAlpha = mMesh->mapSupport(-VDATA_ALPHA) ? mMesh->mapVerts(-VDATA_ALPHA) : 0;
     int numMapChannels = mMesh->getNumMaps();
-    std::vector<int> matIds;
 
     // use the 3dsMax channel numbers so we keep the correct channel for material
     m_numTextureChannel = numMapChannels - 1;
+    EasyOgreExporterLog("Info: Number of map channel (UV) found in this mesh : %i\n", m_numTextureChannel);
+
+    m_snapshot.clear();
 
-    /*
-    //count texture channels
-    (mMesh->numTVerts > 0) ? 1 : 0;
-    for (size_t chan = 2; chan < numMapChannels; chan++)
+    // number of uv sets stored on each vertex
+    int numVertexUV = ((mMesh->numTVerts > 0) || (numMapChannels > 1)) ? 1 : 0;
+    if (numMapChannels > 2)
+      numVertexUV += numMapChannels - 2;
+    m_snapshot.numTexCoordSets = numVertexUV;
+
+    // vertices position in export space
+    m_snapshot.positions.resize(numVerts * 3);
+    for (int v = 0; v < numVerts; v++)
     {
-      if(mMesh->mapSupport(chan))
-        m_numTextureChannel++;
+      Point3 pos = mMesh->getVert(v);
+      if (m_params.yUpAxis)
+      {
+        float py = pos.y;
+        pos.y = pos.z;
+        pos.z = -py;
+      };
+      pos = offsetTM.PointTransform(pos);
+
+      //apply scale
+      pos *= m_params.lum;
+
+      m_snapshot.positions[(v * 3)] = pos.x;
+      m_snapshot.positions[(v * 3) + 1] = pos.y;
+      m_snapshot.positions[(v * 3) + 2] = pos.z;
     }
-    */
-    EasyOgreExporterLog("Info: Number of map channel (UV) found in this mesh : %i\n", m_numTextureChannel);
 
-    // prepare faces table
-    m_faces.resize(numFaces);
+    // vertices bone weight and joint ids
+    if (getSkeleton())
+    {
+      m_snapshot.influenceStart.resize(numVerts + 1);
+      for (int v = 0; v < numVerts; v++)
+      {
+        const std::vector<float>& lWeight = getSkeleton()->getWeightList(v);
+        const std::vector<int>& lBoneIndex = getSkeleton()->getJointList(v);
+        m_snapshot.influenceStart[v] = m_snapshot.influenceWeights.size();
+        for (size_t k = 0; k < lWeight.size(); k++)
+        {
+          m_snapshot.influenceWeights.push_back(lWeight[k]);
+          m_snapshot.influenceJoints.push_back((k < lBoneIndex.size()) ? lBoneIndex[k] : 0);
+        }
+      }
+      m_snapshot.influenceStart[numVerts] = m_snapshot.influenceWeights.size();
+    }
 
-    std::multimap<long int, int> hash_table; //For fast lookup of vertices
+    // faces and per corner attributes
+    bool useColors = (haveVertexColor && mMesh->vcFace) ? true : false;
+    m_snapshot.faceVertices.resize(numFaces * 3);
+    m_snapshot.faceMaterialIds.resize(numFaces);
+    m_snapshot.cornerNormals.resize(numFaces * 3 * 3);
+    if (useColors)
+      m_snapshot.cornerColors.resize(numFaces * 3 * 4);
+    m_snapshot.cornerTexCoords.resize(numFaces * 3 * numVertexUV * 3);
 
     for (int i = 0; i < numFaces; ++i)
     {
       Face face = mMesh->faces[i];
-      m_faces[i].vertices.resize(3);
-      m_faces[i].iMaxId = i;
-      m_faces[i].iMaterialId = mMesh->getFaceMtlIndex(i);
-      matIds.push_back(m_faces[i].iMaterialId);
+      m_snapshot.faceMaterialIds[i] = mMesh->getFaceMtlIndex(i);
 
       for (size_t j = 0; j < 3; j++)
       {
+        int corner = (i * 3) + j;
         DWORD vIndex = face.getVert(j);
-        ExVertex vertex(vIndex);
-
-        Point3 pos = mMesh->getVert(vIndex);
-        if (m_params.yUpAxis)
-        {
-          float py = pos.y;
-          pos.y = pos.z;
-          pos.z = -py;
-        };
-        pos = offsetTM.PointTransform(pos);
-
-        //apply scale
-        pos *= m_params.lum;
+        m_snapshot.faceVertices[corner] = vIndex;
 
         Point3 normal = GetVertexNormals(mMesh, i, j, vIndex);
         if (m_params.yUpAxis)
@@ -200,10 +253,14 @@ namespace EasyOgreExporter
           normal.z = -py;
         };
         normal = offsetTM.VectorTransform(normal);
+        normal = normal.Normalize();
+
+        float* vnorm = &m_snapshot.cornerNormals[corner * 3];
+        vnorm[0] = normal.x;
+        vnorm[1] = normal.y;
+        vnorm[2] = normal.z;
 
-        Point3 color(0, 0, 0);
-        Point4 fullColor(0, 0, 0, 1);
-        if (haveVertexColor && mMesh->vcFace)
+        if (useColors)
         {
           TVFace& vcface = mMesh->vcFace[i];
           const int VertexColorIndex = vcface.t[j];
@@ -213,29 +270,19 @@ namespace EasyOgreExporter
           {
             alpha = vAlpha[VertexColorIndex].x;
           }
-          color = mMesh->vertCol[VertexColorIndex];
+          Point3 color = mMesh->vertCol[VertexColorIndex];
 
           if ((color.x == -1) && (color.x == -1) && (color.x == -1))
             color.x = color.y = color.z = 1;
 
-          fullColor = Point4(color.x, color.y, color.z, alpha);
+          float* vcolor = &m_snapshot.cornerColors[corner * 4];
+          vcolor[0] = color.x;
+          vcolor[1] = color.y;
+          vcolor[2] = color.z;
+          vcolor[3] = alpha;
         }
 
-        vertex.vPos = pos;
-        vertex.vNorm = normal.Normalize();
-        vertex.vColor = fullColor;
-
-        //update bounding box
-        updateBounds(pos);
-
-        if (getSkeleton())
-        {
-          // save vertex bone weight
-          vertex.lWeight = getSkeleton()->getWeightList(vIndex);
-
-          // save joint ids
-          vertex.lBoneIndex = getSkeleton()->getJointList(vIndex);
-        }
+        float* uvw = numVertexUV ? &m_snapshot.cornerTexCoords[corner * numVertexUV * 3] : 0;
 
         //default UV
         if (mMesh->numTVerts > 0)
@@ -243,13 +290,16 @@ namespace EasyOgreExporter
           //bad test
           //Point3 uv = (mMesh->numTVerts > vIndex) ? mMesh->tVerts[mMesh->tvFace[i].t[j]] : Point3(0.0f, 0.0f, 0.0f);
           Point3 uv = mMesh->tVerts[mMesh->tvFace[i].t[j]];
-          uv.y = 1.0f - uv.y;
-          vertex.lTexCoords.push_back(uv);
+          *uvw++ = uv.x;
+          *uvw++ = 1.0f - uv.y;
+          *uvw++ = uv.z;
         }
         else if (numMapChannels > 1)
         {
           //add an empty uv to correspond to the max channel id
-          vertex.lTexCoords.push_back(Point3(0.0f, 0.0f, 0.0f));
+          *uvw++ = 0.0f;
+          *uvw++ = 0.0f;
+          *uvw++ = 0.0f;
         }
 
         //extra textures channel
@@ -262,85 +312,355 @@ namespace EasyOgreExporter
             uv = mMesh->mapVerts(chan)[tvFace.t[j]];
             uv.y = 1.0f - uv.y;
           }
-          vertex.lTexCoords.push_back(uv);
+          *uvw++ = uv.x;
+          *uvw++ = uv.y;
+          *uvw++ = uv.z;
         }
+      }
+    } // Loop faces.
+  }
 
-        //look if the vertex is already added
-        int sameFound = -1;
-        int m_vertices_size = m_vertices.size();
-
-        const static float sensivity_multiplier = 1.0f / 0.000001f; //sensivity taken from the ExVertex comparison code
-        long int key = (int)(vertex.vPos.x*sensivity_multiplier + 0.5f) + (int)(vertex.vPos.y*sensivity_multiplier + 0.5f) + (int)(vertex.vPos.z*sensivity_multiplier + 0.5f); //Hashing function
-        if (hash_table.count(key))
+  void ExMesh::captureMorphTargets()
+  {
+    // Disable all skin Modifiers.
+    std::vector<Modifier*> disabledSkinModifiers;
+    IGameObject* pGameObject = m_GameNode->GetIGameObject();
+    if (pGameObject)
+    {
+      int numModifiers = pGameObject->GetNumModifiers();
+      for (int i = 0; i < numModifiers; ++i)
+      {
+        IGameModifier* pGameModifier = pGameObject->GetIGameModifier(i);
+        if (pGameModifier)
         {
-          std::multimap<long int, int>::iterator itr;
-          std::multimap<long int, int>::iterator lastElement;
-          itr = hash_table.find(key);
-          lastElement = hash_table.upper_bound(key);
-
-          for (; itr != lastElement; ++itr)
+          if (pGameModifier->IsSkin())
           {
-            if (m_vertices[itr->second] == vertex)
+            Modifier* pModifier = pGameModifier->GetMaxModifier();
+            if (pModifier)
             {
-              sameFound = itr->second;
-              break;
+              if (pModifier->IsEnabled())
+              {
+                disabledSkinModifiers.push_back(pModifier);
+                pModifier->DisableMod();
+              }
             }
           }
         }
+      }
+    }
 
-        //add vertex
-        if (sameFound == -1)
-        {
-          hash_table.insert(std::multimap<long int, int>::value_type(key, m_vertices_size));
-          m_vertices.push_back(vertex);
-          m_faces[i].vertices[j] = m_vertices_size; //  instead of (m_vertices.size() -1)
-        }
-        else
+    for (int i = 0; i < m_pMorphR3->chanBank.size() && i < MR3_NUM_CHANNELS; ++i)
+    {
+      morphChannel* pMorphChannel = &m_pMorphR3->chanBank[i];
+      if (!pMorphChannel->mActive)
+        continue;
+
+      pMorphChannel->rebuildChannel();
+
+#ifdef UNICODE
+      std::wstring posename_w = pMorphChannel->mName;
+      std::string posename;
+      posename.assign(posename_w.begin(), posename_w.end());
+#else
+      std::string posename = pMorphChannel->mName;
+#endif
+      int numMorphVertices = pMorphChannel->mNumPoints;
+      //poses can have spaces before or after the name
+      trim(posename);
+
+      if (numMorphVertices != numOfVertices)
+      {
+        MessageBox(GetCOREInterface()->GetMAXHWnd(), _T("Morph targets have failed to export because the morph vertex count did not match the base mesh.  Collapse the modifier stack prior to export, as smoothing is not supported with morph target export."), _T("Morph Target Export Failed."), MB_OK);
+        m_morphError = true;
+        break;
+      }
+
+      EasyOgreExporterLog("Exporting Morph target: %s with %d vertices.\n", posename.c_str(), numMorphVertices);
+
+      // capture the target in export space
+      size_t numPoints = pMorphChannel->mPoints.size();
+      m_snapshot.morphTargets.push_back(ExMorphTarget());
+      ExMorphTarget& target = m_snapshot.morphTargets.back();
+      target.name = posename;
+      target.channel = i;
+      target.positions.resize(numPoints * 3);
+      for (size_t k = 0; k < numPoints; ++k)
+      {
+        Point3 pos = pMorphChannel->mPoints[k];
+        if (m_params.yUpAxis)
         {
-          m_faces[i].vertices[j] = sameFound;
+          float vy = pos.y;
+          pos.y = pos.z;
+          pos.z = -vy;
         }
+        pos = offsetTM.PointTransform(pos);
+
+        // apply scale
+        pos *= m_params.lum;
+
+        target.positions[(k * 3)] = pos.x;
+        target.positions[(k * 3) + 1] = pos.y;
+        target.positions[(k * 3) + 2] = pos.z;
       }
-    } // Loop faces.
+    }
 
-    //sort submesh
+    // Re-enable skin modifiers.
+    for (int i = 0; i < disabledSkinModifiers.size(); ++i)
+    {
+      disabledSkinModifiers[i]->EnableMod();
+    }
+  }
+
+  void ExMesh::loadMaterials()
+  {
+    //distinct material ids of the faces, in ascending order
+    std::vector<int> matIds(m_snapshot.faceMaterialIds);
     std::sort(matIds.begin(), matIds.end());
     matIds.erase(std::unique(matIds.begin(), matIds.end()), matIds.end());
 
+    //get the material by matId
     IGameMaterial* nodeMtl = m_GameNode->GetNodeMaterial();
-    for (int matid = 0; matid < matIds.size(); matid++)
+    for (int i = 0; i < matIds.size(); i++)
     {
-      std::vector<ExFace> faces = GetFacesByMaterialId(matIds[matid]);
+      IGameMaterial* mat = GetSubMaterialByID(nodeMtl, matIds[i]);
+      m_materials[matIds[i]] = m_converter->loadMaterial(mat);
+    }
+  }
 
-      //get the material by matId
-      IGameMaterial* mat = GetSubMaterialByID(nodeMtl, matIds[matid]);
+  void ExMesh::prepareMesh()
+  {
+    ExMeshBuilder builder(m_snapshot);
+    //tangents from the first uv set, before the weld so the handedness splits are welded and optimized like the other attributes
+    if (m_params.buildTangents)
+      builder.setTangentTexCoordSet(0);
+    unsigned int maxInfluences = (m_params.maxBoneInfluences < 1) ? 1 : ((m_params.maxBoneInfluences > 4) ? 4 : m_params.maxBoneInfluences);
+    builder.setMaxInfluences(maxInfluences);
+    //the shared geometry has no base vertex, its chunks would still need 32 bits indices
+    bool splitSubMeshes = m_params.splitSubMeshes && !m_params.useSharedGeom && (m_params.maxSubMeshVertices > 0);
+    builder.build(m_params.weldTolerance, splitSubMeshes ? m_params.maxSubMeshVertices : 0);
+
+    //vertices with their bone influences reduced, the first ones are listed
+    const std::vector<ExInfluenceReport>& reduced = builder.getReducedInfluences();
+    if (!reduced.empty())
+    {
+      EasyOgreExporterLog("Warning: %s has %d vertices with more than %d bone influences, the weights left are renormalized\n", m_name.c_str(), (int)reduced.size(), maxInfluences);
+      for (size_t i = 0; (i < reduced.size()) && (i < 32); i++)
+        EasyOgreExporterLog("  vertex %d : %d influences, %.2f%% of the weight removed\n", reduced[i].vertex, reduced[i].numInfluences, reduced[i].removedWeight * 100.0f);
+      if (reduced.size() > 32)
+        EasyOgreExporterLog("  and %d more vertices\n", (int)reduced.size() - 32);
+    }
 
-      ExMaterial* pMaterial = loadMaterial(mat);
-      ExSubMesh submesh(matid, pMaterial);
+    //materials loaded with the snapshot, no Max call here
+    std::vector<ExMaterial*> materials(builder.getNumSubMeshes());
+    for (int sub = 0; sub < materials.size(); sub++)
+    {
+      std::map<int, ExMaterial*>::const_iterator it = m_materials.find(builder.getSubMesh(sub).materialId);
+      materials[sub] = (it != m_materials.end()) ? it->second : 0;
+    }
 
-      //construct a list of faces with the correct indices
-      for (int fi = 0; fi < faces.size(); fi++)
+    if (m_params.optimizeIndexBuffers)
+    {
+      for (int sub = 0; sub < materials.size(); sub++)
       {
-        //get global face
-        ExFace face = faces[fi];
+        //overdraw only matter when the depth buffer is written
+        //alpha rejected materials are still depth written
+        ExMaterial* pMaterial = materials[sub];
+        bool isBlended = pMaterial && (pMaterial->m_isTransparent || (pMaterial->m_bPreMultipliedAlpha && pMaterial->m_hasAlpha));
+        builder.optimizeSubMesh(sub, m_params.vertexCacheSize, m_params.optimizeOverdraw && !isBlended, m_params.overdrawThreshold);
+      }
+
+      //shared geometry use the global vertices, order them by first use in the submeshes
+      if (m_params.useSharedGeom)
+        builder.optimizeSharedVertices();
+    }
 
-        ExFace sface;
-        sface.iMaxId = face.iMaxId;
-        sface.vertices.resize(3);
+    //bounding box of the base pose
+    if (builder.hasBounds())
+    {
+      const float* minB = builder.getBoundsMin();
+      const float* maxB = builder.getBoundsMax();
+      m_Bounding.pmin = Point3(minB[0], minB[1], minB[2]);
+      m_Bounding.pmax = Point3(maxB[0], maxB[1], maxB[2]);
+      m_SphereRadius = builder.getRadius();
+    }
 
-        for (size_t j = 0; j < 3; j++)
-        {
-          //get the vertex from the global vertices list
-          ExVertex vertex(m_vertices[face.vertices[j]]);
-          ExVertex svertex(vertex);
+    //take the builder arrays, the faces stay flat index ranges
+    m_vertices.swap(builder.getVertices());
+    if (m_params.useSharedGeom)
+      m_faceVertices.swap(builder.getFaceVertices());
 
-          submesh.m_vertices.push_back(svertex);
-          sface.vertices[j] = submesh.m_vertices.size() - 1;
-        }
+    //submeshes with the local indices
+    m_subList.reserve(materials.size());
+    for (int sub = 0; sub < materials.size(); sub++)
+    {
+      ExBuiltSubMesh& built = builder.getSubMesh(sub);
+      m_subList.push_back(ExSubMesh(sub, materials[sub]));
+      ExSubMesh& submesh = m_subList.back();
+      submesh.m_matId = built.materialId;
+      submesh.m_vertices.swap(built.vertices);
+      submesh.m_faces.swap(built.faces);
+      submesh.m_indices.swap(built.indices);
+    }
+
+    //the builder is done with the snapshot, only the morph targets are read by the writing
+    m_snapshot.releaseGeometry();
+    m_prepared = true;
+  }
+
+  bool ExMesh::isPrepared()
+  {
+    return m_prepared;
+  }
+
+  size_t ExMesh::getSnapshotSize()
+  {
+    return m_snapshot.getMemorySize();
+  }
+
+  void ExMesh::setCachedSubMeshes(const std::vector<int>& matIds)
+  {
+    m_subList.clear();
+    for (int sub = 0; sub < matIds.size(); sub++)
+    {
+      std::map<int, ExMaterial*>::const_iterator it = m_materials.find(matIds[sub]);
+      m_subList.push_back(ExSubMesh(sub, (it != m_materials.end()) ? it->second : 0));
+      m_subList.back().m_matId = matIds[sub];
+    }
+  }
+
+  void ExMesh::computeContentHash()
+  {
+    //the processing only depends on the snapshot and the parameters, so the hash is known before it
+    ExHasher hasher;
+    hasher.addInt(m_numTextureChannel);
+    hasher.addInt(haveVertexColor ? 1 : 0);
+    hasher.addInt(haveVertexAlpha ? 1 : 0);
+
+    hasher.addVector(m_snapshot.positions);
+    hasher.addVector(m_snapshot.faceVertices);
+    hasher.addVector(m_snapshot.faceMaterialIds);
+    hasher.addVector(m_snapshot.cornerNormals);
+    hasher.addVector(m_snapshot.cornerColors);
+    hasher.addInt(m_snapshot.numTexCoordSets);
+    hasher.addVector(m_snapshot.cornerTexCoords);
+    hasher.addVector(m_snapshot.influenceStart);
+    hasher.addVector(m_snapshot.influenceWeights);
+    hasher.addVector(m_snapshot.influenceJoints);
+
+    hasher.addInt(m_snapshot.morphTargets.size());
+    for (size_t i = 0; i < m_snapshot.morphTargets.size(); i++)
+    {
+      hasher.addString(m_snapshot.morphTargets[i].name);
+      hasher.addVector(m_snapshot.morphTargets[i].positions);
+    }
+    hasher.addInt(m_morphError ? 1 : 0);
+
+    //material bound to each Max material id
+    hasher.addInt(m_materials.size());
+    for (std::map<int, ExMaterial*>::const_iterator it = m_materials.begin(); it != m_materials.end(); it++)
+    {
+      hasher.addInt(it->first);
+      hasher.addString(it->second ? it->second->getName() : std::string());
+    }
+
+    m_contentHash = hasher.toString();
+  }
 
-        submesh.m_faces.push_back(sface);
+  std::string ExMesh::getFingerprint()
+  {
+    //meshes linked to a skeleton or with vertex animations are named after their node
+    if (m_pSkeleton || m_pMorphR3 || (m_params.exportVertAnims && GetVertexAnimState(m_GameNode->GetMaxNode())))
+      return std::string();
+
+    BOOL ignoreLOD = FALSE;
+    float compressionError = m_params.compressionError;
+    int lodLevels = m_params.lodLevels;
+    float lodReduction = m_params.lodReduction;
+    BOOL ignoreEdges = FALSE;
+    getObjectProperties(ignoreLOD, compressionError, lodLevels, lodReduction, ignoreEdges);
+
+    ExHasher hasher;
+    hasher.addString(m_contentHash);
+    hasher.addInt(ignoreLOD ? 1 : 0);
+    hasher.addFloat(compressionError);
+    hasher.addInt(lodLevels);
+    hasher.addFloat(lodReduction);
+    hasher.addInt(ignoreEdges ? 1 : 0);
+    return hasher.toString();
+  }
+
+  std::string ExMesh::getCacheHash()
+  {
+    //vertex animations are only known once sampled, the mesh is always written
+    if (!m_pMorphR3 && m_params.exportVertAnims && GetVertexAnimState(m_GameNode->GetMaxNode()))
+      return std::string();
+
+    BOOL ignoreLOD = FALSE;
+    float compressionError = m_params.compressionError;
+    int lodLevels = m_params.lodLevels;
+    float lodReduction = m_params.lodReduction;
+    BOOL ignoreEdges = FALSE;
+    getObjectProperties(ignoreLOD, compressionError, lodLevels, lodReduction, ignoreEdges);
+
+    ExHasher hasher;
+    hasher.addString(m_contentHash);
+    hasher.addInt(ignoreLOD ? 1 : 0);
+    hasher.addFloat(compressionError);
+    hasher.addInt(lodLevels);
+    hasher.addFloat(lodReduction);
+    hasher.addInt(ignoreEdges ? 1 : 0);
+    hasher.addString(m_pSkeleton ? optimizeFileName(m_name + ".skeleton") : std::string());
+    //the skinned bounds use the skeleton animations, they must be loaded before
+    hasher.addString(m_pSkeleton ? m_pSkeleton->getCacheHash() : std::string());
+
+    if (m_pMorphR3 && m_params.exportPoses)
+    {
+      //the clips of the motion mixer are only known once sampled
+      if (TheMaxMixerManager.GetMaxMixer(m_GameNode->GetMaxNode()))
+        return std::string();
+
+      //the morph targets are in the content hash, add their weights on each frame
+      Interval animRange = GetCOREInterface()->GetAnimRange();
+      for (int i = 0; i < m_snapshot.morphTargets.size(); ++i)
+      {
+        morphChannel& channel = m_pMorphR3->chanBank[m_snapshot.morphTargets[i].channel];
+        IParamBlock* paramBlock = channel.cblock;
+        for (TimeValue t = animRange.Start(); t <= animRange.End(); t += GetTicksPerFrame())
+        {
+          float weight = 0.0f;
+          Interval valid;
+          paramBlock->GetValue(0, t, weight, valid);
+          hasher.addFloat(weight);
+        }
       }
-      m_subList.push_back(submesh);
     }
+    return hasher.toString();
+  }
+
+  void ExMesh::getObjectProperties(BOOL& ignoreLOD, float& compressionError, int& lodLevels, float& lodReduction, BOOL& ignoreEdges)
+  {
+    //per object properties changing the mesh file
+    IPropertyContainer* pc = m_GameMesh->GetIPropertyContainer();
+    IGameProperty* pIgnoreLod = pc->QueryProperty(_T("noLOD"));
+    if (pIgnoreLod)
+      pIgnoreLod->GetPropertyValue(ignoreLOD);
+    IGameProperty* pCompressionError = pc->QueryProperty(_T("compressionError"));
+    if (pCompressionError)
+      pCompressionError->GetPropertyValue(compressionError);
+    IGameProperty* pLodLevels = pc->QueryProperty(_T("lodLevels"));
+    if (pLodLevels)
+      pLodLevels->GetPropertyValue(lodLevels);
+    IGameProperty* pLodReduction = pc->QueryProperty(_T("lodReduction"));
+    if (pLodReduction)
+      pLodReduction->GetPropertyValue(lodReduction);
+    IGameProperty* pIgnoreEdges = pc->QueryProperty(_T("noEdges"));
+    if (pIgnoreEdges)
+      pIgnoreEdges->GetPropertyValue(ignoreEdges);
+  }
+
+  const std::string& ExMesh::getName()
+  {
+    return m_name;
   }
 
   ExSkeleton* ExMesh::getSkeleton()
@@ -421,9 +741,20 @@ namespace EasyOgreExporter
     return lmat;
   }
 
-  // Write to a OGRE binary mesh
-  bool ExMesh::writeOgreBinary()
+  std::vector<int> ExMesh::getMaterialIds()
   {
+    std::vector<int> lmatIds;
+    for (int i = 0; i < m_subList.size(); i++)
+    {
+      lmatIds.push_back(m_subList[i].m_matId);
+    }
+    return lmatIds;
+  }
+
+  bool ExMesh::setupWrite()
+  {
+    m_writeSettings = ExMeshWriteSettings();
+    m_writeReady = true;
     int numVertices = m_vertices.size();
 
     // If no mesh have been exported, skip mesh creation
@@ -433,32 +764,67 @@ namespace EasyOgreExporter
       return false;
     }
 
-    // Update bounding with bone AABB
+    // Update bounding with the animated skin
     if (getSkeleton())
-    {
-      std::vector<ExAnimation> lanims = getSkeleton()->getAnimations();
-      for (size_t i = 0; i < lanims.size(); i++)
-      {
-        // Create tracks for current animation
-        for (size_t j = 0; j < lanims[i].m_tracks.size(); j++)
-        {
-          ExTrack* t = &lanims[i].m_tracks[j];
+      updateSkinBounds();
 
-          // Create keyframes for current track
-          for (size_t k = 0; k < t->m_skeletonKeyframes.size(); k++)
-          {
-            skeletonKeyframe* keyframe = &t->m_skeletonKeyframes[k];
-            updateBounds(keyframe->bbpos);
-          }
-        }
-      }
+    // per object LOD settings and vertex compression error budget
+    BOOL ignoreLOD = FALSE;
+    float compressionError = m_params.compressionError;
+    int lodLevels = m_params.lodLevels;
+    float lodReduction = m_params.lodReduction;
+    BOOL ignoreEdges = FALSE;
+    getObjectProperties(ignoreLOD, compressionError, lodLevels, lodReduction, ignoreEdges);
+
+    //edge lists are only used by the stencil shadows
+    m_writeSettings.edgeList = m_params.buildEdges && !ignoreEdges;
+    m_blendElements = useBlendElements();
+
+    m_writeSettings.meshfile = makeOutputPath(m_params.outputDir, m_params.meshOutputDir, optimizeFileName(m_name), "mesh");
+
+    // Stream the file directly when nothing needs the Ogre mesh
+    m_writeSettings.generateLOD = (numVertices > 64) && m_params.generateLOD && !ignoreLOD && (lodLevels > 0) && (lodReduction > 0.0f) && (lodReduction < 1.0f);
+    m_writeSettings.lodLevels = lodLevels;
+    m_writeSettings.lodReduction = lodReduction;
+    m_writeSettings.compressionError = compressionError;
+    bool compressVertices = m_params.compressVertices && (m_params.getOgreVersion() == Ogre::MESH_VERSION_LATEST);
+    bool hasPoses = m_params.exportPoses && m_pMorphR3;
+    bool hasMorphAnimation = !m_pMorphR3 && m_params.exportVertAnims && GetVertexAnimState(m_GameNode->GetMaxNode());
+    m_writeSettings.native = m_params.nativeMeshSerializer && !m_writeSettings.generateLOD && !compressVertices && !hasPoses && !hasMorphAnimation;
+    m_writeSettings.valid = true;
+    return m_writeSettings.native;
+  }
+
+  void ExMesh::writeNativeBinary(unsigned int numThreads)
+  {
+    //the writing release the submeshes, keep their materials like a cached mesh
+    std::vector<int> matIds = getMaterialIds();
+    m_nativeWritten = true;
+    m_nativeResult = false;
+    m_nativeResult = writeNativeMesh(m_writeSettings.meshfile, m_writeSettings.edgeList, numThreads);
+    setCachedSubMeshes(matIds);
+  }
+
+  // Write to a OGRE binary mesh
+  bool ExMesh::writeOgreBinary()
+  {
+    if (!m_writeReady)
+      setupWrite();
+    m_writeReady = false;
+
+    if (m_nativeWritten)
+    {
+      m_nativeWritten = false;
+      return m_nativeResult;
     }
 
-    BOOL ignoreLOD = FALSE;
-    IPropertyContainer* pc = m_GameMesh->GetIPropertyContainer();
-    IGameProperty* pIgnoreLod = pc->QueryProperty(_T("noLOD"));
-    if (pIgnoreLod)
-      pIgnoreLod->GetPropertyValue(ignoreLOD);
+    if (!m_writeSettings.valid)
+      return false;
+
+    const std::string& meshfile = m_writeSettings.meshfile;
+    bool edgeList = m_writeSettings.edgeList;
+    if (m_writeSettings.native)
+      return writeNativeMesh(meshfile, edgeList, m_params.numThreads);
 
     // Construct mesh
     Ogre::MeshPtr pMesh;
@@ -483,14 +849,13 @@ namespace EasyOgreExporter
     }
 
     // rebuild vertices index, it must start on 0
-    std::vector<std::vector<int>> facesIndex;
     int vertIndex = 0;
 
     //generate submesh
     EasyOgreExporterLog("Info: Create Ogre submeshs\n");
     for (int i = 0; i < m_subList.size(); i++)
     {
-      ExSubMesh subMesh = m_subList[i];
+      const ExSubMesh& subMesh = m_subList[i];
       //Generate submesh name
       std::string subName;
       std::stringstream strName;
@@ -503,21 +868,11 @@ namespace EasyOgreExporter
         continue;
       }
 
-      EasyOgreExporterLog("Info: create submesh : %s\n", subName.c_str());
+      EasyOgreExporterLog("Info: create submesh : %s with %d vertices and %d faces\n", subName.c_str(), (int)subMesh.m_vertices.size(), (int)subMesh.m_faces.size());
       Ogre::SubMesh* pSubmesh = createOgreSubmesh(subMesh);
       m_Mesh->nameSubMesh(subName, i);
     }
 
-    //ignore instanciated mesh
-    if (isFirstInstance(m_GameNode) == false)
-    {
-      EasyOgreExporterLog("Info: Ignore instanciated mesh\n");
-      Ogre::MeshManager::getSingleton().remove(pMesh->getHandle());
-      pMesh.setNull();
-      m_Mesh = 0;
-      return false;
-    }
-
     // Create poses
     if (m_params.exportPoses && m_pMorphR3)
       createPoses();
@@ -544,85 +899,21 @@ namespace EasyOgreExporter
     m_Mesh->_setBounds(bbox, false);
     m_Mesh->_setBoundingSphereRadius(m_SphereRadius);
 
-    //free up some memory
-    m_vertices.clear();
-    m_faces.clear();
-    m_subList.clear();
-
-
     //create LOD levels
     //don't do it on small meshs
-    if ((numVertices > 64) && m_params.generateLOD && !ignoreLOD)
-    {
-      EasyOgreExporterLog("Info: Generate mesh LOD\n");
-      try
-      {
-        /*
-        Ogre::LodConfig lodConfig;
-        lodConfig.levels.clear();
-        lodConfig.mesh = pMesh;
-        lodConfig.strategy = 0;
-        if (m_params.getOgreVersion() == Ogre::MESH_VERSION_LATEST)
-          lodConfig.strategy = Ogre::ScreenRatioPixelCountLodStrategy::getSingletonPtr();
-        else
-          lodConfig.strategy = Ogre::DistanceLodSphereStrategy::getSingletonPtr();
-
-        // Percentage -> parametric
-        //TODO from param
-        int nbLevels = 4;
-
-        //TODO nb level in param
-        //On distance
-        float leveldist = m_SphereRadius * 2.0f;
-
-        Ogre::Real reduction = 0.4f / (float)nbLevels;
-        Ogre::Real steps = 0.8f / (float)nbLevels;
-
-        for (int nLevel = 0; nLevel < nbLevels; nLevel++)
-        {
-          if (m_params.getOgreVersion() == Ogre::MESH_VERSION_LATEST)
-          {
-            Ogre::LodLevel lodLevel;
-            lodLevel.reductionMethod = Ogre::LodLevel::VRM_PROPORTIONAL;
-            lodLevel.reductionValue = reduction * (nLevel + 1);
-            lodLevel.distance = 1.0f - (steps * (nLevel + 1));
-            lodConfig.levels.push_back(lodLevel);
-          }
-          else
-          {
-            leveldist = (m_SphereRadius * 2.0f) * ((nLevel + 1) * nLevel);
-            //leveldist = leveldist * (nLevel + 1);
-
-            Ogre::LodLevel lodLevel;
-            lodLevel.reductionMethod = Ogre::LodLevel::VRM_PROPORTIONAL;
-            lodLevel.reductionValue = reduction * ((nLevel + 1) + (nLevel + 1));
-            lodLevel.distance = leveldist;
-            lodConfig.levels.push_back(lodLevel);
-          }
-          EasyOgreExporterLog("Info: Generate mesh LOD Level : %f\n", leveldist);
-        }
+    if (m_writeSettings.generateLOD)
+      createLodLevels(m_writeSettings.lodLevels, m_writeSettings.lodReduction);
 
-        Ogre::ProgressiveMeshGenerator pm;
-        pm.generateLodLevels(lodConfig);
-
-        //Ogre::ProgressiveMeshGenerator pm;
-        //pm.generateAutoconfiguredLodLevels(pMesh);
-        */
-
-        //OGRE 2.0
-        Ogre::MeshLodGenerator::getSingleton().generateAutoconfiguredLodLevels(pMesh);
-      }
-      catch (Ogre::Exception &e)
-      {
-        EasyOgreExporterLog("Error: Generating Mesh LOD : %s\n", e.what());
-      }
-    }
+    //free up some memory
+    m_vertices.clear();
+    m_faceVertices.clear();
+    m_subList.clear();
 
     // see somewhere that it could avoid some memory leaks
     m_Mesh->load();
 
     // Build edges list
-    if (m_params.buildEdges)
+    if (edgeList)
     {
       EasyOgreExporterLog("Info: Create mesh edge list\n");
       try
@@ -635,26 +926,6 @@ namespace EasyOgreExporter
       }
     }
 
-    // Build tangents
-    if (m_params.buildTangents)
-    {
-      EasyOgreExporterLog("Info: Create mesh tangents\n");
-      Ogre::VertexElementSemantic targetSemantic = (m_params.tangentSemantic == TS_TANGENT) ? Ogre::VES_TANGENT : Ogre::VES_TEXTURE_COORDINATES;
-      bool canBuild = true;
-      unsigned short srcTex, destTex;
-      try
-      {
-        canBuild = !m_Mesh->suggestTangentVectorBuildParams(targetSemantic, srcTex, destTex);
-      }
-      catch (Ogre::Exception e)
-      {
-        canBuild = false;
-        EasyOgreExporterLog("Error: Creating mesh tangents failed : %s\n", e.what());
-      }
-      if (canBuild)
-        m_Mesh->buildTangentVectors(targetSemantic, srcTex, destTex, m_params.tangentsSplitMirrored, m_params.tangentsSplitRotated, m_params.tangentsUseParity);
-    }
-
     // Set skeleton link (if present)
     if (m_pSkeleton && m_params.exportSkeleton)
     {
@@ -682,15 +953,12 @@ namespace EasyOgreExporter
     }
 
     // reorganize mesh buffers
+    // the buffers are written in their final layout, this only happen when the animations found differ from the expected ones
     // Shared geometry
     if (m_Mesh->sharedVertexData)
     {
       EasyOgreExporterLog("Info: Optimize mesh\n");
 
-      Ogre::VertexData* vdata = m_Mesh->getVertexDataByTrackHandle(0);
-      Ogre::VertexDeclaration* newadcl = vdata->vertexDeclaration->getAutoOrganisedDeclaration(m_Mesh->hasSkeleton(), m_Mesh->hasVertexAnimation(), m_Mesh->getSharedVertexDataAnimationIncludesNormals());
-      vdata->reorganiseBuffers(newadcl);
-
       // Automatic
       Ogre::VertexDeclaration* newDcl = m_Mesh->sharedVertexData->vertexDeclaration->getAutoOrganisedDeclaration(
         m_Mesh->hasSkeleton(), m_Mesh->hasVertexAnimation(), m_Mesh->getSharedVertexDataAnimationIncludesNormals());
@@ -704,6 +972,10 @@ namespace EasyOgreExporter
 
         m_Mesh->sharedVertexData->reorganiseBuffers(newDcl, bufferUsages);
       }
+      else
+      {
+        Ogre::HardwareBufferManager::getSingleton().destroyVertexDeclaration(newDcl);
+      }
     }
 
     // Dedicated geometry
@@ -716,10 +988,6 @@ namespace EasyOgreExporter
       {
         const bool hasVertexAnim = sm->getVertexAnimationType() != Ogre::VAT_NONE;
 
-        Ogre::VertexData* vdata = m_Mesh->getVertexDataByTrackHandle(subIdx + 1);
-        Ogre::VertexDeclaration* newadcl = vdata->vertexDeclaration->getAutoOrganisedDeclaration(m_Mesh->hasSkeleton(), hasVertexAnim, sm->getVertexAnimationIncludesNormals());
-        vdata->reorganiseBuffers(newadcl);
-
         // Automatic
         Ogre::VertexDeclaration* newDcl = sm->vertexData->vertexDeclaration->getAutoOrganisedDeclaration(
           m_Mesh->hasSkeleton(), hasVertexAnim, sm->getVertexAnimationIncludesNormals());
@@ -732,30 +1000,495 @@ namespace EasyOgreExporter
 
           sm->vertexData->reorganiseBuffers(newDcl, bufferUsages);
         }
+        else
+        {
+          Ogre::HardwareBufferManager::getSingleton().destroyVertexDeclaration(newDcl);
+        }
       }
       subIdx++;
     }
 
+    // Compress the vertex formats, only the latest mesh version support them
+    if (m_params.compressVertices && (m_params.getOgreVersion() == Ogre::MESH_VERSION_LATEST))
+      compressVertexBuffers(m_writeSettings.compressionError);
+
     // Export the binary mesh
     Ogre::MeshSerializer serializer;
-    std::string meshfile = makeOutputPath(m_params.outputDir, m_params.meshOutputDir, optimizeFileName(m_name), "mesh");
 
     EasyOgreExporterLog("Info: Write mesh file : %s\n", meshfile.c_str());
     try
     {
-      serializer.exportMesh(m_Mesh, meshfile.c_str(), m_params.getOgreVersion());
+      serializer.exportMesh(m_Mesh, meshfile.c_str(), m_params.getOgreVersion());
+    }
+    catch (Ogre::Exception &e)
+    {
+      EasyOgreExporterLog("Error: Writing mesh file : %s : %s\n", meshfile.c_str(), e.what());
+      pMesh.setNull();
+      return false;
+    }
+
+    Ogre::MeshManager::getSingleton().remove(pMesh->getHandle());
+    pMesh.setNull();
+    m_Mesh = 0;
+    return true;
+  }
+
+  bool ExMesh::writeNativeMesh(const std::string& meshfile, bool edgeList, unsigned int numThreads)
+  {
+    bool hasSkeleton = (m_pSkeleton && m_params.exportSkeleton) ? true : false;
+
+    // Vertex format, organised like the Ogre path with no vertex animation
+    std::vector<ExVertexElement> elements;
+    ExVertexElement elem;
+    elem.source = 0;
+    elem.offset = 0;
+    elem.index = 0;
+    elem.type = EX_VET_FLOAT3;
+    elem.semantic = EX_VES_POSITION;
+    elements.push_back(elem);
+
+    if (m_params.exportVertNorm)
+    {
+      elem.semantic = EX_VES_NORMAL;
+      elements.push_back(elem);
+    }
+
+    if (m_params.exportVertCol && haveVertexColor)
+    {
+      elem.type = EX_VET_COLOUR;
+      elem.semantic = EX_VES_DIFFUSE;
+      elements.push_back(elem);
+    }
+
+    unsigned int numTexCoords = (m_numTextureChannel < m_vertices.getNumTexCoords()) ? m_numTextureChannel : m_vertices.getNumTexCoords();
+    for (unsigned int i = 0; i < numTexCoords; i++)
+    {
+      elem.type = EX_VET_FLOAT2;
+      elem.semantic = EX_VES_TEXTURE_COORDINATES;
+      elem.index = i;
+      elements.push_back(elem);
+    }
+
+    //tangents, in the texture coordinates following the uv sets for the shaders reading them there
+    if (m_vertices.hasTangents())
+    {
+      elem.type = m_params.tangentsUseParity ? EX_VET_FLOAT4 : EX_VET_FLOAT3;
+      elem.semantic = (m_params.tangentSemantic == TS_TANGENT) ? EX_VES_TANGENT : EX_VES_TEXTURE_COORDINATES;
+      elem.index = (m_params.tangentSemantic == TS_TANGENT) ? 0 : numTexCoords;
+      elements.push_back(elem);
+    }
+
+    //packed bone influences, the bone assignments are still written for the Ogre blend index map
+    if (m_blendElements)
+    {
+      elem.index = 0;
+      elem.type = EX_VET_UBYTE4;
+      elem.semantic = EX_VES_BLEND_INDICES;
+      elements.push_back(elem);
+      elem.type = m_params.useByteBlendWeights() ? EX_VET_UBYTE4_NORM : (EX_VET_FLOAT1 + m_vertices.getNumInfluences() - 1);
+      elem.semantic = EX_VES_BLEND_WEIGHTS;
+      elements.push_back(elem);
+    }
+    elements = ExMeshSerializer::organiseElements(elements, hasSkeleton, false, false);
+
+    // same colour packing as Ogre getBestColourVertexElementType
+#ifdef _WIN32
+    bool colourARGB = true;
+#else
+    bool colourARGB = false;
+#endif
+
+    EasyOgreExporterLog("Info: Write mesh file : %s\n", meshfile.c_str());
+    ExMeshSerializer serializer;
+    if (!serializer.open(meshfile, m_params.getOgreVersionTag()))
+    {
+      EasyOgreExporterLog("Error: Writing mesh file : %s\n", meshfile.c_str());
+      return false;
+    }
+
+    serializer.beginMesh(hasSkeleton);
+
+    // the edge list use the vertex sets and the triangles written, like Ogre Mesh::buildEdgeList
+    ExEdgeListBuilder edgeBuilder(m_vertices);
+    std::vector<std::vector<unsigned int> > edgeIndices(edgeList ? m_subList.size() : 0);
+
+    // Write shared geometry data
+    bool useSharedGeom = m_params.useSharedGeom && (numOfVertices > 0);
+    std::vector<unsigned int> sharedVertices;
+    if (useSharedGeom)
+    {
+      EasyOgreExporterLog("Info: Create Ogre shared geometry\n");
+      sharedVertices.resize(m_vertices.size());
+      for (unsigned int i = 0; i < sharedVertices.size(); i++)
+        sharedVertices[i] = i;
+
+      serializer.writeGeometry(m_vertices, sharedVertices, elements, colourARGB);
+      if (edgeList)
+        edgeBuilder.addVertexSet(sharedVertices);
+    }
+
+    //generate submesh
+    EasyOgreExporterLog("Info: Create Ogre submeshs\n");
+    std::vector<std::pair<std::string, unsigned short> > subNames;
+    for (int i = 0; i < m_subList.size(); i++)
+    {
+      const ExSubMesh& subMesh = m_subList[i];
+      std::stringstream strName;
+      strName << subMesh.id;
+
+      if (subMesh.m_faces.size() <= 0)
+      {
+        EasyOgreExporterLog("Warning: No faces found in submesh %d\n", subMesh.id);
+        continue;
+      }
+
+      EasyOgreExporterLog("Info: create submesh : %s with %d vertices and %d faces\n", strName.str().c_str(), (int)subMesh.m_vertices.size(), (int)subMesh.m_faces.size());
+
+      std::vector<unsigned int> indices;
+      indices.reserve(subMesh.m_faces.size() * 3);
+      for (size_t j = 0; j < subMesh.m_faces.size(); j++)
+      {
+        const int* face = getSubMeshFace(subMesh, j);
+        indices.push_back(face[0]);
+        indices.push_back(face[1]);
+        indices.push_back(face[2]);
+      }
+
+      serializer.beginSubMesh(subMesh.m_mat ? subMesh.m_mat->getName() : std::string(), useSharedGeom, indices);
+      if (edgeList)
+      {
+        edgeIndices[i].swap(indices);
+        edgeBuilder.addIndexSet(edgeIndices[i], useSharedGeom ? 0 : edgeBuilder.addVertexSet(subMesh.m_vertices));
+      }
+      indices.clear();
+
+      if (!useSharedGeom)
+        serializer.writeGeometry(m_vertices, subMesh.m_vertices, elements, colourARGB);
+
+      serializer.writeSubMeshOperation(EX_OT_TRIANGLE_LIST);
+
+      if (!useSharedGeom && getSkeleton())
+        serializer.writeBoneAssignments(EX_M_SUBMESH_BONE_ASSIGNMENT, ExMeshSerializer::rationaliseBoneAssignments(m_vertices, subMesh.m_vertices));
+
+      serializer.endChunk();
+
+      // the name keep the index in the submesh list like the Ogre path, a later submesh with the same name replace it
+      std::vector<std::pair<std::string, unsigned short> >::iterator nameIt = subNames.begin();
+      while ((nameIt != subNames.end()) && (nameIt->first != strName.str()))
+        nameIt++;
+      if (nameIt != subNames.end())
+        nameIt->second = (unsigned short)i;
+      else
+        subNames.push_back(std::pair<std::string, unsigned short>(strName.str(), (unsigned short)i));
+    }
+
+    // Set skeleton link (if present)
+    if (hasSkeleton)
+    {
+      EasyOgreExporterLog("Info: Link Ogre skeleton\n");
+      serializer.writeSkeletonLink(optimizeFileName(m_name + ".skeleton"));
+    }
+
+    if (useSharedGeom && getSkeleton())
+      serializer.writeBoneAssignments(EX_M_MESH_BONE_ASSIGNMENT, ExMeshSerializer::rationaliseBoneAssignments(m_vertices, sharedVertices));
+
+    EasyOgreExporterLog("Info: Create mesh bounding box\n");
+    Point3 bmin = m_Bounding.Min();
+    Point3 bmax = m_Bounding.Max();
+    float fmin[3] = {bmin.x, bmin.y, bmin.z};
+    float fmax[3] = {bmax.x, bmax.y, bmax.z};
+    serializer.writeBounds(fmin, fmax, m_SphereRadius);
+
+    if (!subNames.empty())
+      serializer.writeSubMeshNameTable(subNames);
+
+    // Build edges list
+    if (edgeList)
+    {
+      EasyOgreExporterLog("Info: Create mesh edge list\n");
+      ExEdgeData edgeData;
+      edgeBuilder.build(edgeData, numThreads);
+      edgeIndices.clear();
+      serializer.writeEdgeList(edgeData, m_params.meshVersion == TOGRE_1_0);
+    }
+
+    serializer.endChunk();
+
+    //free up some memory
+    m_vertices.clear();
+    m_faceVertices.clear();
+    m_subList.clear();
+
+    if (!serializer.close())
+    {
+      EasyOgreExporterLog("Error: Writing mesh file : %s\n", meshfile.c_str());
+      return false;
+    }
+    return true;
+  }
+
+  //simplify the base mesh to one LOD level, level l keeps reduction^(l + 1) of the triangles
+  class ExLodLevelJob : public ExPoolJob
+  {
+  public:
+    ExLodLevelJob(const ExVertexStore& store, const std::vector<std::vector<unsigned int> >& baseIndices, float reduction, const ExSimplifyOptions& options,
+                  std::vector<std::vector<std::vector<unsigned int> > >& levels, std::vector<size_t>& levelFaces) :
+      m_store(store), m_baseIndices(baseIndices), m_reduction(reduction), m_options(options), m_levels(levels), m_levelFaces(levelFaces)
+    {
+    };
+
+    void run(size_t l)
+    {
+      m_levelFaces[l] = simplifyMesh(m_store, m_baseIndices, powf(m_reduction, (float)(l + 1)), m_options, m_levels[l]);
+    };
+
+  private:
+    const ExVertexStore& m_store;
+    const std::vector<std::vector<unsigned int> >& m_baseIndices;
+    float m_reduction;
+    const ExSimplifyOptions& m_options;
+    std::vector<std::vector<std::vector<unsigned int> > >& m_levels;
+    std::vector<size_t>& m_levelFaces;
+  };
+
+  void ExMesh::createLodLevels(int numLevels, float reduction)
+  {
+    // triangle lists of the Ogre submeshes using the vertex handles
+    std::vector<int> ogreSubMeshes;
+    std::vector<std::vector<unsigned int> > baseIndices;
+    size_t numFaces = 0;
+    for (int i = 0; i < m_subList.size(); i++)
+    {
+      const ExSubMesh& subMesh = m_subList[i];
+      if (subMesh.m_faces.size() <= 0)
+        continue;
+
+      ogreSubMeshes.push_back(i);
+      baseIndices.push_back(std::vector<unsigned int>());
+      std::vector<unsigned int>& indices = baseIndices.back();
+      indices.reserve(subMesh.m_faces.size() * 3);
+      for (size_t j = 0; j < subMesh.m_faces.size(); j++)
+      {
+        const int* face = getSubMeshFace(subMesh, j);
+        for (size_t k = 0; k < 3; k++)
+          indices.push_back(m_faceVertices.empty() ? subMesh.m_vertices[face[k]] : face[k]);
+      }
+      numFaces += subMesh.m_faces.size();
+    }
+
+    // each level is simplified from the base mesh on its own thread
+    EasyOgreExporterLog("Info: Generate %d mesh LOD levels\n", numLevels);
+    std::vector<std::vector<std::vector<unsigned int> > > levels(numLevels);
+    std::vector<size_t> levelFaces(numLevels, 0);
+    ExSimplifyOptions options;
+    ExThreadPool pool(m_params.numThreads);
+    try
+    {
+      ExLodLevelJob job(m_vertices, baseIndices, reduction, options, levels, levelFaces);
+      pool.run(numLevels, job);
+    }
+    catch (std::exception& e)
+    {
+      EasyOgreExporterLog("Error: Generating Mesh LOD : %s\n", e.what());
+      return;
+    }
+
+    // only keep the levels removing triangles, a submesh fully collapsed keep its previous level
+    std::vector<int> keptLevels;
+    size_t prevFaces = numFaces;
+    for (int l = 0; l < numLevels; l++)
+    {
+      if ((levelFaces[l] == 0) || (levelFaces[l] >= prevFaces))
+        continue;
+
+      for (size_t s = 0; s < baseIndices.size(); s++)
+      {
+        if (levels[l][s].empty())
+          levels[l][s] = keptLevels.empty() ? baseIndices[s] : levels[keptLevels.back()][s];
+      }
+      keptLevels.push_back(l);
+      prevFaces = levelFaces[l];
+    }
+
+    if (keptLevels.empty())
+    {
+      EasyOgreExporterLog("Warning: The mesh can not be simplified, no LOD generated\n");
+      return;
+    }
+
+    Ogre::LodStrategy* strategy = 0;
+    if (m_params.lodStrategy == LOD_DISTANCE)
+      strategy = Ogre::DistanceLodSphereStrategy::getSingletonPtr();
+    else
+      strategy = Ogre::ScreenRatioPixelCountLodStrategy::getSingletonPtr();
+
+    m_Mesh->setLodStrategy(strategy);
+    m_Mesh->_setLodInfo(keptLevels.size() + 1);
+
+    // the screen size of the mesh drop as much as its triangles from one level to the next
+    for (size_t n = 0; n < keptLevels.size(); n++)
+    {
+      float scale = powf(reduction, (float)keptLevels[n]);
+      Ogre::MeshLodUsage usage;
+      if (m_params.lodStrategy == LOD_DISTANCE)
+        usage.userValue = m_params.lodDistance * m_SphereRadius / sqrtf(scale);
+      else
+        usage.userValue = m_params.lodScreenRatio * scale;
+      usage.value = strategy->transformUserValue(usage.userValue);
+      usage.edgeData = 0;
+      m_Mesh->_setLodUsage(n + 1, usage);
+
+      EasyOgreExporterLog("Info: Mesh LOD level %d : %d faces from %f\n", (int)(n + 1), (int)levelFaces[keptLevels[n]], usage.userValue);
+    }
+
+    std::vector<int> localIndex;
+    for (size_t s = 0; s < ogreSubMeshes.size(); s++)
+    {
+      const ExSubMesh& subMesh = m_subList[ogreSubMeshes[s]];
+
+      // back to the submesh vertices
+      if (!m_Mesh->sharedVertexData)
+      {
+        localIndex.resize(m_vertices.size());
+        for (size_t i = 0; i < subMesh.m_vertices.size(); i++)
+          localIndex[subMesh.m_vertices[i]] = i;
+      }
+
+      for (size_t n = 0; n < keptLevels.size(); n++)
+      {
+        std::vector<unsigned int>& indices = levels[keptLevels[n]][s];
+        unsigned int maxIndex = 0;
+        for (size_t i = 0; i < indices.size(); i++)
+        {
+          if (!m_Mesh->sharedVertexData)
+            indices[i] = localIndex[indices[i]];
+          if (indices[i] > maxIndex)
+            maxIndex = indices[i];
+        }
+        bool bUse32BitIndexes = (maxIndex > 65535) ? true : false;
+
+        Ogre::IndexData* indexData = new Ogre::IndexData();
+        indexData->indexStart = 0;
+        indexData->indexCount = indices.size();
+        indexData->indexBuffer = Ogre::HardwareBufferManager::getSingleton().createIndexBuffer(
+          bUse32BitIndexes ? Ogre::HardwareIndexBuffer::IT_32BIT : Ogre::HardwareIndexBuffer::IT_16BIT,
+          indexData->indexCount,
+          Ogre::HardwareBuffer::HBU_STATIC_WRITE_ONLY);
+
+        if (bUse32BitIndexes)
+        {
+          Ogre::uint32* pIdx = static_cast<Ogre::uint32*>(indexData->indexBuffer->lock(Ogre::HardwareBuffer::HBL_DISCARD));
+          for (size_t i = 0; i < indices.size(); i++)
+            *pIdx++ = static_cast<Ogre::uint32>(indices[i]);
+          indexData->indexBuffer->unlock();
+        }
+        else
+        {
+          Ogre::uint16* pIdx = static_cast<Ogre::uint16*>(indexData->indexBuffer->lock(Ogre::HardwareBuffer::HBL_DISCARD));
+          for (size_t i = 0; i < indices.size(); i++)
+            *pIdx++ = static_cast<Ogre::uint16>(indices[i]);
+          indexData->indexBuffer->unlock();
+        }
+        m_Mesh->_setSubMeshLodFaceList(s, n + 1, indexData);
+      }
+    }
+  }
+
+  void ExMesh::compressVertexBuffers(float maxError)
+  {
+    // positions are decoded by the scene node, they must stay in float for skinning, vertex animations and stencil shadows
+    bool compressPositions = m_params.exportScene && !m_Mesh->hasSkeleton() && !m_Mesh->hasVertexAnimation() && !m_params.buildEdges;
+    // software skinning need float normals
+    bool compressNormals = !m_Mesh->hasSkeleton();
+
+    ExVertexCompressor compressor(maxError);
+    compressor.setup(m_Mesh->getBounds(), compressPositions, compressNormals, true);
+
+    size_t sizeBefore = 0;
+    size_t sizeAfter = 0;
+    size_t numVertices = 0;
+    bool compressed = false;
+
+    std::vector<Ogre::VertexData*> vdatas;
+    if (m_Mesh->sharedVertexData)
+      vdatas.push_back(m_Mesh->sharedVertexData);
+
+    for (unsigned short i = 0; i < m_Mesh->getNumSubMeshes(); i++)
+    {
+      Ogre::SubMesh* sm = m_Mesh->getSubMesh(i);
+      if (!sm->useSharedVertices)
+        vdatas.push_back(sm->vertexData);
+    }
+
+    for (size_t i = 0; i < vdatas.size(); i++)
+    {
+      Ogre::VertexData* vdata = vdatas[i];
+      sizeBefore += ExVertexCompressor::getVertexSize(vdata->vertexDeclaration) * vdata->vertexCount;
+      if (compressor.compress(vdata))
+        compressed = true;
+
+      sizeAfter += ExVertexCompressor::getVertexSize(vdata->vertexDeclaration) * vdata->vertexCount;
+      numVertices += vdata->vertexCount;
+    }
+
+    if (!compressed || (numVertices == 0))
+      return;
+
+    EasyOgreExporterLog("Info: Vertex compression %.1f -> %.1f bytes per vertex\n", (float)sizeBefore / (float)numVertices, (float)sizeAfter / (float)numVertices);
+
+    // bounds in the quantized space, the scene node apply the decode transform
+    if (compressor.hasPositionTransform())
+    {
+      Ogre::Vector3 offset = compressor.getPositionOffset();
+      Ogre::Vector3 scale = compressor.getPositionScale();
+      Ogre::AxisAlignedBox bbox = m_Mesh->getBounds();
+      Ogre::Vector3 qmin = (bbox.getMinimum() - offset) / scale;
+      Ogre::Vector3 qmax = (bbox.getMaximum() - offset) / scale;
+
+      Ogre::AxisAlignedBox qbbox;
+      qbbox.setExtents(qmin, qmax);
+      m_Mesh->_setBounds(qbbox, false);
+      m_Mesh->_setBoundingSphereRadius(std::max(qmin.length(), qmax.length()));
+
+      m_converter->setMeshPositionTransform(m_name, Point3(offset.x, offset.y, offset.z), Point3(scale.x, scale.y, scale.z));
+      EasyOgreExporterLog("Info: Quantized positions, decode offset %f %f %f scale %f %f %f\n", offset.x, offset.y, offset.z, scale.x, scale.y, scale.z);
     }
-    catch (Ogre::Exception &e)
+  }
+
+  void ExMesh::sampleMorphFrames(const std::vector<int>& animKeys, ExMorphFrames& frames)
+  {
+    INode* node = m_GameNode->GetMaxNode();
+    const std::vector<int>& sources = frames.getSourceVertices();
+    for (size_t i = 0; i < animKeys.size(); i++)
     {
-      EasyOgreExporterLog("Error: Writing mesh file : %s : %s\n", meshfile.c_str(), e.what());
-      pMesh.setNull();
-      return false;
-    }
+      //get the mesh in the current state
+      bool delTri = false;
+      TriObject* triObj = getTriObjectFromNode(node, animKeys[i], delTri);
+      if (!triObj)
+        continue;
 
-    Ogre::MeshManager::getSingleton().remove(pMesh->getHandle());
-    pMesh.setNull();
-    m_Mesh = 0;
-    return true;
+      Mesh& mesh = triObj->GetMesh();
+      float* pFloat = frames.addFrame(animKeys[i]);
+      for (size_t v = 0; v < sources.size(); v++)
+      {
+        Point3 pos = mesh.getVert(sources[v]);
+        if (m_params.yUpAxis)
+        {
+          float py = pos.y;
+          pos.y = pos.z;
+          pos.z = -py;
+        };
+        pos = offsetTM.PointTransform(pos) * m_params.lum;
+
+        *pFloat++ = pos.x;
+        *pFloat++ = pos.y;
+        *pFloat++ = pos.z;
+      }
+
+      //free the tree object
+      if (delTri)
+        triObj->DeleteThis();
+    }
   }
 
   bool ExMesh::exportMorphAnimation(Interval animRange, std::string name)
@@ -764,57 +1497,40 @@ namespace EasyOgreExporter
     int animLenght = animRange.End() - animRange.Start();
     float ogreLenght = (static_cast<float>(animLenght) / static_cast<float>(animRate)) / GetFrameRate();
 
-    // Compute the pivot TM
-    INode* node = m_GameNode->GetMaxNode();
     std::vector<int> animKeys = GetPointAnimationsKeysTime(m_GameNode, animRange, m_params.resampleAnims, m_params.resampleStep);
 
-    bool delTri = false;
-    TriObject* triObj = 0;
-    Mesh* mesh = 0;
-
+    //positions of the Max vertices used by the mesh, each key time is evaluated once
     std::vector<int> vertexIds;
+    vertexIds.reserve(m_vertices.size());
     for (int v = 0; v < m_vertices.size(); v++)
     {
-      vertexIds.push_back(m_vertices[v].iMaxId);
+      vertexIds.push_back(m_vertices.getMaxId(v));
     }
 
-    OptimizeMeshAnimation(node, animKeys, vertexIds);
+    ExMorphFrames frames;
+    frames.setVertices(vertexIds);
+    sampleMorphFrames(animKeys, frames);
+    animKeys.clear();
 
-    if (animKeys.size() > 0)
+    //Point3::Equals tolerance, then the keys the interpolation reproduce
+    unsigned int numSampled = frames.getNumFrames();
+    frames.removeStaticFrames(1E-6f);
+    if (m_params.morphKeyTolerance > 0.0f)
+      frames.reduceFrames(m_params.morphKeyTolerance);
+    EasyOgreExporterLog("Info : morph animation %s, %d keys kept of %d sampled\n", name.c_str(), frames.getNumFrames(), numSampled);
+
+    if (frames.getNumFrames() > 0)
     {
       //look if any key change something before export
       bool isAnimated = false;
-      for (int i = 0; i < animKeys.size() && !isAnimated; i++)
+      for (unsigned int i = 0; i < frames.getNumFrames() && !isAnimated; i++)
       {
-        //get the mesh in the current state
-        triObj = getTriObjectFromNode(node, animKeys[i], delTri);
-        if (triObj)
-          mesh = &triObj->GetMesh();
-
-        if (mesh)
-        {
-          for (int v = 0; v < m_vertices.size() && !isAnimated; v++)
-          {
-            Point3 pos = mesh->getVert(vertexIds[v]);
-            if (m_params.yUpAxis)
-            {
-              float py = pos.y;
-              pos.y = pos.z;
-              pos.z = -py;
-            };
-            pos = offsetTM.PointTransform(pos) * m_params.lum;
-            if (m_vertices[v].vPos != pos)
-              isAnimated = true;
-          }
-        }
-
-        //free the tree object
-        if (delTri && triObj)
+        for (int v = 0; v < m_vertices.size() && !isAnimated; v++)
         {
-          triObj->DeleteThis();
-          triObj = 0;
-          delTri = false;
-          mesh = 0;
+          const float* pos = frames.getPosition(i, v);
+          const float* vpos = m_vertices.getPosition(v);
+          if ((vpos[0] != pos[0]) || (vpos[1] != pos[1]) || (vpos[2] != pos[2]))
+            isAnimated = true;
         }
       }
 
@@ -833,140 +1549,131 @@ namespace EasyOgreExporter
         return false;
       }
 
-      if (m_params.useSharedGeom)
+      //update bounding box
+      for (unsigned int i = 0; i < frames.getNumFrames(); i++)
       {
-        // Create a new track
-        Ogre::VertexAnimationTrack* pTrack = pAnimation->createVertexTrack(0, m_Mesh->sharedVertexData, Ogre::VAT_MORPH);
+        const float* pos = frames.getFrame(i);
+        for (unsigned int v = 0; v < frames.getNumSourceVertices(); v++, pos += 3)
+          updateBounds(Point3(pos[0], pos[1], pos[2]));
+      }
 
-        for (int i = 0; i < animKeys.size(); i++)
+      //poses and weights replacing the key positions, a target can not mix morph and pose animations so the poses are kept over tolerance
+      ExMorphCompression compression;
+      if (m_params.compressMorphAnimation)
+      {
+        std::vector<float> basePositions(frames.getNumSourceVertices() * 3);
+        for (int v = 0; v < m_vertices.size(); v++)
         {
-          int kTime = animKeys[i];
-          float ogreTime = static_cast<float>((kTime - animRange.Start()) / static_cast<float>(animRate)) / GetFrameRate();
+          const float* vpos = m_vertices.getPosition(v);
+          std::copy(vpos, vpos + 3, basePositions.begin() + (frames.getSourceIndex(v) * 3));
+        }
 
-          //get the mesh in the current state
-          triObj = getTriObjectFromNode(node, animKeys[i], delTri);
-          if (triObj)
-            mesh = &triObj->GetMesh();
+        if (!compressMorphFrames(frames, &basePositions[0], m_params.morphCompressionTolerance, m_params.morphCompressionMaxPoses, m_params.numThreads, compression))
+          EasyOgreExporterLog("Warning : morph animation %s error %f over the tolerance with %d poses\n", name.c_str(), compression.maxError, compression.numPoses);
+        EasyOgreExporterLog("Info : morph animation %s compressed to %d poses, max error %f\n", name.c_str(), compression.numPoses, compression.maxError);
+      }
 
-          if (mesh)
-          {
-            //add key frame
-            Ogre::VertexMorphKeyFrame* pKeyframe = pTrack->createVertexMorphKeyFrame(ogreTime);
+      // one track for the shared geometry or for each submesh
+      int numTracks = m_params.useSharedGeom ? 1 : m_subList.size();
+      std::vector<unsigned int> sharedVertices;
+      if (m_params.useSharedGeom)
+      {
+        sharedVertices.resize(m_vertices.size());
+        for (int v = 0; v < m_vertices.size(); v++)
+          sharedVertices[v] = v;
+      }
 
-            // Create vertex buffer for current keyframe
-            Ogre::HardwareVertexBufferSharedPtr pBuffer = Ogre::HardwareBufferManager::getSingleton().createVertexBuffer(
-              Ogre::VertexElement::getTypeSize(Ogre::VET_FLOAT3),
-              m_vertices.size(),
-              Ogre::HardwareBuffer::HBU_STATIC, true);
-            float* pFloat = static_cast<float*>(pBuffer->lock(Ogre::HardwareBuffer::HBL_DISCARD));
+      for (int sub = 0; sub < numTracks; sub++)
+      {
+        const std::vector<unsigned int>& lvert = m_params.useSharedGeom ? sharedVertices : m_subList[sub].m_vertices;
+        Ogre::VertexData* vertexData = m_params.useSharedGeom ? m_Mesh->sharedVertexData : m_Mesh->getSubMesh(sub)->vertexData;
+        unsigned short target = m_params.useSharedGeom ? 0 : sub + 1;
 
-            // Fill the vertex buffer with vertex positions
-            for (int v = 0; v < m_vertices.size(); v++)
+        if (m_params.compressMorphAnimation)
+        {
+          // Create the poses of the target, they are added to the bind positions
+          // a pose that does not move any vertex of the target is skipped, -1 in poseIndex
+          std::vector<int> poseIndex(compression.numPoses, -1);
+          bool hasPoses = false;
+          for (unsigned int p = 0; p < compression.numPoses; p++)
+          {
+            const float* offsets = &compression.poses[p * frames.getNumSourceVertices() * 3];
+            Ogre::Pose* pPose = 0;
+            for (int v = 0; v < lvert.size(); v++)
             {
-              Point3 pos = mesh->getVert(m_vertices[v].iMaxId);
-              if (m_params.yUpAxis)
+              const float* offset = offsets + (frames.getSourceIndex(lvert[v]) * 3);
+              if ((offset[0] == 0.0f) && (offset[1] == 0.0f) && (offset[2] == 0.0f))
+                continue;
+
+              if (!pPose)
               {
-                float py = pos.y;
-                pos.y = pos.z;
-                pos.z = -py;
-              };
-              pos = offsetTM.PointTransform(pos) * m_params.lum;
-
-              //update bounding box
-              updateBounds(pos);
-
-              *pFloat++ = static_cast<float>(pos.x);
-              *pFloat++ = static_cast<float>(pos.y);
-              *pFloat++ = static_cast<float>(pos.z);
+                std::stringstream poseName;
+                poseName << name << "_pose" << p;
+                poseIndex[p] = m_Mesh->getPoseCount();
+                pPose = m_Mesh->createPose(target, poseName.str().c_str());
+                hasPoses = true;
+              }
+              pPose->addVertex(v, Ogre::Vector3(offset[0], offset[1], offset[2]));
             }
-
-            // Unlock vertex buffer
-            pBuffer->unlock();
-
-            // Set vertex buffer for current keyframe
-            pKeyframe->setVertexBuffer(pBuffer);
           }
 
-          //free the tree object
-          if (delTri && triObj)
-          {
-            triObj->DeleteThis();
-            triObj = 0;
-            delTri = false;
-            mesh = 0;
-          }
-        }
-      }
-      else
-      {
-        // create a track for each submesh
-        for (int sub = 0; sub < m_subList.size(); sub++)
-        {
-          std::vector<ExVertex> lvert = m_subList[sub].m_vertices;
-          // Create a new track
-          Ogre::VertexAnimationTrack* pTrack = pAnimation->createVertexTrack(sub + 1, m_Mesh->getSubMesh(sub)->vertexData, Ogre::VAT_MORPH);
+          // the target does not move in this animation
+          if (!hasPoses)
+            continue;
 
-          for (int i = 0; i < animKeys.size(); i++)
+          // Create a new track with the pose weights
+          Ogre::VertexAnimationTrack* pTrack = pAnimation->createVertexTrack(target, vertexData, Ogre::VAT_POSE);
+          for (unsigned int i = 0; i < frames.getNumFrames(); i++)
           {
-            int kTime = animKeys[i];
+            int kTime = frames.getTime(i);
             float ogreTime = static_cast<float>((kTime - animRange.Start()) / static_cast<float>(animRate)) / GetFrameRate();
 
-            //get the mesh in the current state
-            triObj = getTriObjectFromNode(node, animKeys[i], delTri);
-            if (triObj)
-              mesh = &triObj->GetMesh();
-
-            if (mesh)
+            //add key frame
+            Ogre::VertexPoseKeyFrame* pKeyframe = pTrack->createVertexPoseKeyFrame(ogreTime);
+            const float* weights = &compression.weights[i * compression.numPoses];
+            for (unsigned int p = 0; p < compression.numPoses; p++)
             {
-              //add key frame
-              Ogre::VertexMorphKeyFrame* pKeyframe = pTrack->createVertexMorphKeyFrame(ogreTime);
-
-              // Create vertex buffer for current keyframe
-              Ogre::HardwareVertexBufferSharedPtr pBuffer = Ogre::HardwareBufferManager::getSingleton().createVertexBuffer(
-                Ogre::VertexElement::getTypeSize(Ogre::VET_FLOAT3),
-                lvert.size(),
-                Ogre::HardwareBuffer::HBU_STATIC, true);
-              float* pFloat = static_cast<float*>(pBuffer->lock(Ogre::HardwareBuffer::HBL_DISCARD));
-
-              // Fill the vertex buffer with vertex positions
-              for (int v = 0; v < lvert.size(); v++)
-              {
-                Point3 pos = mesh->getVert(lvert[v].iMaxId);
-                if (m_params.yUpAxis)
-                {
-                  float py = pos.y;
-                  pos.y = pos.z;
-                  pos.z = -py;
-                };
-                pos = offsetTM.PointTransform(pos) * m_params.lum;
-
-                //update bounding box
-                updateBounds(pos);
-
-                *pFloat++ = pos.x;
-                *pFloat++ = pos.y;
-                *pFloat++ = pos.z;
-              }
+              if ((weights[p] != 0.0f) && (poseIndex[p] >= 0))
+                pKeyframe->addPoseReference(poseIndex[p], weights[p]);
+            }
+          }
+          continue;
+        }
 
-              // Unlock vertex buffer
-              pBuffer->unlock();
+        // Create a new track
+        Ogre::VertexAnimationTrack* pTrack = pAnimation->createVertexTrack(target, vertexData, Ogre::VAT_MORPH);
 
-              // Set vertex buffer for current keyframe
-              pKeyframe->setVertexBuffer(pBuffer);
-            }
+        for (unsigned int i = 0; i < frames.getNumFrames(); i++)
+        {
+          int kTime = frames.getTime(i);
+          float ogreTime = static_cast<float>((kTime - animRange.Start()) / static_cast<float>(animRate)) / GetFrameRate();
 
-            //free the tree object
-            if (delTri && triObj)
-            {
-              triObj->DeleteThis();
-              triObj = 0;
-              delTri = false;
-              mesh = 0;
-            }
+          //add key frame
+          Ogre::VertexMorphKeyFrame* pKeyframe = pTrack->createVertexMorphKeyFrame(ogreTime);
+
+          // Create vertex buffer for current keyframe
+          Ogre::HardwareVertexBufferSharedPtr pBuffer = Ogre::HardwareBufferManager::getSingleton().createVertexBuffer(
+            Ogre::VertexElement::getTypeSize(Ogre::VET_FLOAT3),
+            lvert.size(),
+            Ogre::HardwareBuffer::HBU_STATIC, true);
+          float* pFloat = static_cast<float*>(pBuffer->lock(Ogre::HardwareBuffer::HBL_DISCARD));
+
+          // Fill the vertex buffer with vertex positions
+          for (int v = 0; v < lvert.size(); v++)
+          {
+            const float* pos = frames.getPosition(i, lvert[v]);
+            *pFloat++ = pos[0];
+            *pFloat++ = pos[1];
+            *pFloat++ = pos[2];
           }
+
+          // Unlock vertex buffer
+          pBuffer->unlock();
+
+          // Set vertex buffer for current keyframe
+          pKeyframe->setVertexBuffer(pBuffer);
         }
       }
-      animKeys.clear();
       return true;
     }
     return false;
@@ -1114,7 +1821,7 @@ namespace EasyOgreExporter
     m_converter->restoreAllSkin();
   }
 
-  bool ExMesh::exportPosesAnimation(Interval animRange, std::string name, std::vector<morphChannel*> validChan, std::vector<std::vector<int>> poseIndexList, bool bDefault)
+  bool ExMesh::exportPosesAnimation(Interval animRange, std::string name, std::vector<morphChannel*> validChan, const std::vector<std::vector<int>>& poseIndexList, bool bDefault)
   {
     int animRate = GetTicksPerFrame();
     int animLenght = animRange.End() - animRange.Start();
@@ -1236,7 +1943,8 @@ namespace EasyOgreExporter
             IParamBlock* paramBlock = pMorphChannel->cblock;
             paramBlock->GetValue(0, kTime, weight, junkInterval);
 
-            pKeyframe->addPoseReference(pose, weight / 100.0f);
+            if (poseIndexList[0][pose] >= 0)
+              pKeyframe->addPoseReference(poseIndexList[0][pose], weight / 100.0f);
           }
         }
       }
@@ -1266,7 +1974,9 @@ namespace EasyOgreExporter
               IParamBlock* paramBlock = pMorphChannel->cblock;
               paramBlock->GetValue(0, kTime, weight, junkInterval);
 
-              pKeyframe->addPoseReference(poseIndexList[sub][pose], weight / 100.0f);
+              //no pose when the target does not move the submesh
+              if (poseIndexList[sub][pose] >= 0)
+                pKeyframe->addPoseReference(poseIndexList[sub][pose], weight / 100.0f);
             }
           }
         }
@@ -1280,156 +1990,72 @@ namespace EasyOgreExporter
   void ExMesh::createPoses()
   {
     EasyOgreExporterLog("Loading poses and poses animations...\n");
-    bool poseError = false;
     INode* node = m_GameNode->GetMaxNode();
 
-    // Disable all skin Modifiers.
-    std::vector<Modifier*> disabledSkinModifiers;
-    IGameObject* pGameObject = m_GameNode->GetIGameObject();
-    if (pGameObject)
-    {
-      int numModifiers = pGameObject->GetNumModifiers();
-      for (int i = 0; i < numModifiers; ++i)
-      {
-        IGameModifier* pGameModifier = pGameObject->GetIGameModifier(i);
-        if (pGameModifier)
-        {
-          if (pGameModifier->IsSkin())
-          {
-            Modifier* pModifier = pGameModifier->GetMaxModifier();
-            if (pModifier)
-            {
-              if (pModifier->IsEnabled())
-              {
-                disabledSkinModifiers.push_back(pModifier);
-                pModifier->DisableMod();
-              }
-            }
-          }
-        }
-      }
-    }
-
+    //morpher channels of the captured targets, to sample their weights
     std::vector<morphChannel*> validChan;
-    for (int i = 0; i < m_pMorphR3->chanBank.size() && i < MR3_NUM_CHANNELS; ++i)
-    {
-      morphChannel &pMorphChannel = m_pMorphR3->chanBank[i];
-      if (pMorphChannel.mActive)
-        validChan.push_back(&pMorphChannel);
-    }
+    for (int i = 0; i < m_snapshot.morphTargets.size(); i++)
+      validChan.push_back(&m_pMorphR3->chanBank[m_snapshot.morphTargets[i].channel]);
 
-    //index for pose animations
+    //index for pose animations of each target and channel, -1 when the channel does not move the target
     std::vector<std::vector<int>> poseIndexList;
-    poseIndexList.resize(m_subList.size());
-    int poseIndex = 0;
-
-    for (int i = 0; i < validChan.size(); i++)
+    poseIndexList.resize(m_params.useSharedGeom ? 1 : m_subList.size());
+    std::vector<unsigned int> sharedVertices;
+    if (m_params.useSharedGeom)
     {
-      morphChannel* pMorphChannel = validChan[i];
-      pMorphChannel->rebuildChannel();
-
-#ifdef UNICODE
-      std::wstring posename_w = pMorphChannel->mName;
-      std::string posename;
-      posename.assign(posename_w.begin(), posename_w.end());
-#else
-      std::string posename = pMorphChannel->mName;
-#endif
-      int numMorphVertices = pMorphChannel->mNumPoints;
-      //poses can have spaces before or after the name
-      trim(posename);
+      sharedVertices.resize(m_vertices.size());
+      for (int v = 0; v < m_vertices.size(); v++)
+        sharedVertices[v] = v;
+    }
+    std::vector<unsigned int> moved;
+    std::vector<float> offsets;
 
-      if (numMorphVertices != numOfVertices)
-      {
-        if (!poseError)
-          MessageBox(GetCOREInterface()->GetMAXHWnd(), _T("Morph targets have failed to export because the morph vertex count did not match the base mesh.  Collapse the modifier stack prior to export, as smoothing is not supported with morph target export."), _T("Morph Target Export Failed."), MB_OK);
+    for (int i = 0; i < m_snapshot.morphTargets.size(); i++)
+    {
+      const ExMorphTarget& target = m_snapshot.morphTargets[i];
+      const std::string& posename = target.name;
 
-        poseError = true;
-        break;
-      }
-      else
+      // sparse pose for each target the channel moves
+      std::stringstream movedTargets;
+      size_t numMoved = 0;
+      for (int sub = 0; sub < poseIndexList.size(); sub++)
       {
-        EasyOgreExporterLog("Exporting Morph target: %s with %d vertices.\n", posename.c_str(), numMorphVertices);
-
-        size_t numPoints = pMorphChannel->mPoints.size();
-        std::vector<Point3> vmPoints;
-        vmPoints.reserve(numPoints);
-        for (size_t k = 0; k < numPoints; ++k)
+        const std::vector<unsigned int>& verticesList = m_params.useSharedGeom ? sharedVertices : m_subList[sub].m_vertices;
+        getMorphOffsets(m_vertices, verticesList, &target.positions[0], m_params.poseEpsilon, moved, offsets);
+        if (moved.empty())
         {
-          vmPoints.push_back(pMorphChannel->mPoints[k]);
+          poseIndexList[sub].push_back(-1);
+          continue;
         }
 
-        if (m_params.useSharedGeom)
+        // Create a new pose for the ogre mesh or submesh
+        poseIndexList[sub].push_back(m_Mesh->getPoseCount());
+        Ogre::Pose* pPose = m_Mesh->createPose(m_params.useSharedGeom ? 0 : sub + 1, posename.c_str());
+        for (size_t k = 0; k < moved.size(); k++)
         {
-          // Create a new pose for the ogre mesh
-          Ogre::Pose* pPose = m_Mesh->createPose(0, posename.c_str());
-          // Set the pose attributes
-          for (int k = 0; k < m_vertices.size(); k++)
-          {
-            ExVertex vertex = m_vertices[k];
-            Point3 pos = vmPoints[vertex.iMaxId];
-            if (m_params.yUpAxis)
-            {
-              float vy = pos.y;
-              pos.y = pos.z;
-              pos.z = -vy;
-            }
-            pos = offsetTM.PointTransform(pos);
-
-            // apply scale
-            pos *= m_params.lum;
+          const float* offset = &offsets[k * 3];
+          const float* vpos = m_vertices.getPosition(verticesList[moved[k]]);
 
-            //update bounding box
-            updateBounds(pos);
-
-            // diff
-            pos -= vertex.vPos;
-            pPose->addVertex(k, Ogre::Vector3(pos.x, pos.y, pos.z));
-          }
+          //update bounding box
+          updateBounds(Point3(vpos[0] + offset[0], vpos[1] + offset[1], vpos[2] + offset[2]));
 
-          poseIndex++;
+          pPose->addVertex(moved[k], Ogre::Vector3(offset[0], offset[1], offset[2]));
         }
-        else
-        {
-          for (int sub = 0; sub < m_subList.size(); sub++)
-          {
-            std::vector<ExVertex> verticesList = m_subList[sub].m_vertices;
-            poseIndexList[sub].push_back(poseIndex);
-
-            // Create a new pose for the ogre submesh
-            Ogre::Pose* pPose = m_Mesh->createPose(sub + 1, posename.c_str());
-            // Set the pose attributes
-            for (int k = 0; k < verticesList.size(); k++)
-            {
-              ExVertex vertex = verticesList[k];
-              Point3 pos = vmPoints[vertex.iMaxId];
-              if (m_params.yUpAxis)
-              {
-                float vy = pos.y;
-                pos.y = pos.z;
-                pos.z = -vy;
-              }
-              pos = offsetTM.PointTransform(pos);
-
-              // apply scale
-              pos *= m_params.lum;
 
-              //update bounding box
-              updateBounds(pos);
-
-              // diff
-              pos -= vertex.vPos;
-              pPose->addVertex(k, Ogre::Vector3(pos.x, pos.y, pos.z));
-            }
-
-            poseIndex++;
-          }
-        }
+        numMoved += moved.size();
+        movedTargets << " " << sub;
       }
+
+      if (numMoved == 0)
+        EasyOgreExporterLog("Info : morph target %s does not move the mesh, no pose\n", posename.c_str());
+      else if (m_params.useSharedGeom)
+        EasyOgreExporterLog("Info : morph target %s moves %d of %d vertices\n", posename.c_str(), (int)numMoved, m_vertices.size());
+      else
+        EasyOgreExporterLog("Info : morph target %s moves %d vertices in the submeshes%s\n", posename.c_str(), (int)numMoved, movedTargets.str().c_str());
     }
 
     //Poses animations
-    if (m_pMorphR3->IsAnimated() && !poseError)
+    if (m_pMorphR3->IsAnimated() && !m_morphError)
     {
       //try to get animations in motion mixer
       bool useDefault = true;
@@ -1541,12 +2167,6 @@ namespace EasyOgreExporter
         }
       }
     }
-
-    // Re-enable skin modifiers.
-    for (int i = 0; i < disabledSkinModifiers.size(); ++i)
-    {
-      disabledSkinModifiers[i]->EnableMod();
-    }
   }
 
   bool ExMesh::createOgreSharedGeometry()
@@ -1560,34 +2180,33 @@ namespace EasyOgreExporter
     m_Mesh->sharedVertexData = new Ogre::VertexData();
     m_Mesh->sharedVertexData->vertexCount = m_vertices.size();
 
-    buildOgreGeometry(m_Mesh->sharedVertexData, m_vertices);
+    //the shared geometry use all the mesh vertices
+    std::vector<unsigned int> vertices(m_vertices.size());
+    for (unsigned int i = 0; i < vertices.size(); i++)
+      vertices[i] = i;
+
+    buildOgreGeometry(m_Mesh->sharedVertexData, vertices);
 
     // Write vertex bone assignements list
     if (getSkeleton())
     {
-      // Create a new vertex bone assignements list
-      Ogre::Mesh::VertexBoneAssignmentList vbas;
-      // Scan list of shared geometry vertices
-      for (int i = 0; i < m_vertices.size(); i++)
+      // The packed influences are already reduced and normalized, add them as they are
+      for (unsigned int i = 0; i < m_vertices.size(); i++)
       {
-        ExVertex vertex = m_vertices[i];
-        // Add all bone assignements for every vertex to the bone assignements list
-        for (int j = 0; j < vertex.lWeight.size(); j++)
+        const float* lWeight = m_vertices.getWeights(i);
+        const int* lBoneIndex = m_vertices.getBoneIndices(i);
+        for (unsigned int j = 0; j < m_vertices.getNumInfluences(); j++)
         {
-          Ogre::VertexBoneAssignment vba;
-          vba.vertexIndex = i;
-          vba.boneIndex = vertex.lBoneIndex[j];
-          vba.weight = vertex.lWeight[j];
-          if (vba.weight > 0.0f)
-            vbas.insert(Ogre::Mesh::VertexBoneAssignmentList::value_type(i, vba));
+          if (lWeight[j] > 0.0f)
+          {
+            Ogre::VertexBoneAssignment vba;
+            vba.vertexIndex = i;
+            vba.boneIndex = lBoneIndex[j];
+            vba.weight = lWeight[j];
+            m_Mesh->addBoneAssignment(vba);
+          }
         }
       }
-      // Rationalise the bone assignements list
-      m_Mesh->_rationaliseBoneAssignments(m_Mesh->sharedVertexData->vertexCount, vbas);
-
-      // Add bone assignements to the mesh
-      for (Ogre::Mesh::VertexBoneAssignmentList::iterator bi = vbas.begin(); bi != vbas.end(); bi++)
-        m_Mesh->addBoneAssignment(bi->second);
 
       //m_Mesh->_compileBoneAssignments(); //create empty buffer ?
       //m_Mesh->_updateCompiledBoneAssignments();
@@ -1596,7 +2215,13 @@ namespace EasyOgreExporter
     return true;
   }
 
-  Ogre::SubMesh* ExMesh::createOgreSubmesh(ExSubMesh submesh)
+  const int* ExMesh::getSubMeshFace(const ExSubMesh& submesh, size_t face)
+  {
+    //the shared geometry use the mesh handles, the dedicated one the submesh local indices
+    return m_faceVertices.empty() ? &submesh.m_indices[face * 3] : &m_faceVertices[submesh.m_faces[face] * 3];
+  }
+
+  Ogre::SubMesh* ExMesh::createOgreSubmesh(const ExSubMesh& submesh)
   {
     int numVertices = submesh.m_vertices.size();
 
@@ -1614,65 +2239,54 @@ namespace EasyOgreExporter
     pSubmesh->vertexData = new Ogre::VertexData();
     pSubmesh->vertexData->vertexCount = numVertices;
 
-    bool bUse32BitIndexes = ((numVertices > 65535) || (m_Mesh->sharedVertexData)) ? true : false;
+    // the format have no base vertex, so the shared geometry can only use 16 bits indices
+    // when the submesh only reference the first 65536 shared vertices.
+    // the shared vertices are ordered by first use, so the first submeshs (or split chunks) usually fit
+    size_t numFaces = submesh.m_faces.size();
+    int maxIndex = 0;
+    for (size_t i = 0; i < numFaces; i++)
+    {
+      const int* face = getSubMeshFace(submesh, i);
+      for (size_t j = 0; j < 3; j++)
+      {
+        if (face[j] > maxIndex)
+          maxIndex = face[j];
+      }
+    }
+    bool bUse32BitIndexes = (maxIndex > 65535) ? true : false;
 
     // Create a new index buffer
-    pSubmesh->indexData->indexCount = numVertices;
+    pSubmesh->indexData->indexCount = submesh.m_faces.size() * 3;
     pSubmesh->indexData->indexBuffer = Ogre::HardwareBufferManager::getSingleton().createIndexBuffer(
       bUse32BitIndexes ? Ogre::HardwareIndexBuffer::IT_32BIT : Ogre::HardwareIndexBuffer::IT_16BIT,
       pSubmesh->indexData->indexCount,
       Ogre::HardwareBuffer::HBU_STATIC_WRITE_ONLY);
 
-    std::vector<std::vector<int>> facesIndex;
-    facesIndex.resize(submesh.m_faces.size());
-    if (!m_Mesh->sharedVertexData)
-    {
-      // rebuild vertices index, it must start on 0
-      for (int i = 0; i < submesh.m_faces.size(); i++)
-      {
-        facesIndex[i].resize(3);
-        for (size_t j = 0; j < 3; j++)
-        {
-          facesIndex[i][j] = submesh.m_faces[i].vertices[j];
-        }
-      }
-    }
-    else
-    {
-      for (int i = 0; i < submesh.m_faces.size(); i++)
-      {
-        facesIndex[i].resize(3);
-        for (size_t j = 0; j < 3; j++)
-        {
-          facesIndex[i][j] = m_faces[submesh.m_faces[i].iMaxId].vertices[j];
-        }
-      }
-    }
-
     // Fill the index buffer with faces data
     if (bUse32BitIndexes)
     {
       Ogre::uint32* pIdx = static_cast<Ogre::uint32*>(pSubmesh->indexData->indexBuffer->lock(Ogre::HardwareBuffer::HBL_DISCARD));
-      for (int i = 0; i < facesIndex.size(); i++)
+      for (size_t i = 0; i < numFaces; i++)
       {
-        *pIdx++ = static_cast<Ogre::uint32>(facesIndex[i][0]);
-        *pIdx++ = static_cast<Ogre::uint32>(facesIndex[i][1]);
-        *pIdx++ = static_cast<Ogre::uint32>(facesIndex[i][2]);
+        const int* face = getSubMeshFace(submesh, i);
+        *pIdx++ = static_cast<Ogre::uint32>(face[0]);
+        *pIdx++ = static_cast<Ogre::uint32>(face[1]);
+        *pIdx++ = static_cast<Ogre::uint32>(face[2]);
       }
       pSubmesh->indexData->indexBuffer->unlock();
     }
     else
     {
       Ogre::uint16* pIdx = static_cast<Ogre::uint16*>(pSubmesh->indexData->indexBuffer->lock(Ogre::HardwareBuffer::HBL_DISCARD));
-      for (int i = 0; i < facesIndex.size(); i++)
+      for (size_t i = 0; i < numFaces; i++)
       {
-        *pIdx++ = static_cast<Ogre::uint16>(facesIndex[i][0]);
-        *pIdx++ = static_cast<Ogre::uint16>(facesIndex[i][1]);
-        *pIdx++ = static_cast<Ogre::uint16>(facesIndex[i][2]);
+        const int* face = getSubMeshFace(submesh, i);
+        *pIdx++ = static_cast<Ogre::uint16>(face[0]);
+        *pIdx++ = static_cast<Ogre::uint16>(face[1]);
+        *pIdx++ = static_cast<Ogre::uint16>(face[2]);
       }
       pSubmesh->indexData->indexBuffer->unlock();
     }
-    facesIndex.clear();
 
     if (!m_Mesh->sharedVertexData)
     {
@@ -1682,196 +2296,61 @@ namespace EasyOgreExporter
       // Write vertex bone assignements list
       if (getSkeleton())
       {
-        // Create a new vertex bone assignements list
-        Ogre::SubMesh::VertexBoneAssignmentList vbas;
-
-        // Scan list of geometry vertices
-        for (int i = 0; i < submesh.m_vertices.size(); i++)
+        // The packed influences are already reduced and normalized, add them as they are
+        for (unsigned int i = 0; i < submesh.m_vertices.size(); i++)
         {
-          ExVertex vertex = submesh.m_vertices[i];
-          // Add all bone assignements for every vertex to the bone assignements list
-          for (int j = 0; j < vertex.lWeight.size(); j++)
+          const float* lWeight = m_vertices.getWeights(submesh.m_vertices[i]);
+          const int* lBoneIndex = m_vertices.getBoneIndices(submesh.m_vertices[i]);
+          for (unsigned int j = 0; j < m_vertices.getNumInfluences(); j++)
           {
-            Ogre::VertexBoneAssignment vba;
-            vba.vertexIndex = i;
-            vba.boneIndex = vertex.lBoneIndex[j];
-            vba.weight = vertex.lWeight[j];
-            if (vba.weight > 0.0f)
-              vbas.insert(Ogre::SubMesh::VertexBoneAssignmentList::value_type(i, vba));
+            if (lWeight[j] > 0.0f)
+            {
+              Ogre::VertexBoneAssignment vba;
+              vba.vertexIndex = i;
+              vba.boneIndex = lBoneIndex[j];
+              vba.weight = lWeight[j];
+              pSubmesh->addBoneAssignment(vba);
+            }
           }
         }
-
-        // Rationalise the bone assignements list
-        pSubmesh->parent->_rationaliseBoneAssignments(pSubmesh->vertexData->vertexCount, vbas);
-        // Add bone assignements to the submesh
-        for (Ogre::SubMesh::VertexBoneAssignmentList::iterator bi = vbas.begin(); bi != vbas.end(); bi++)
-        {
-          pSubmesh->addBoneAssignment(bi->second);
-        }
         //pSubmesh->_compileBoneAssignments(); //create empty buffer ?
       }
     }
     return pSubmesh;
   }
 
-  void ExMesh::buildOgreGeometry(Ogre::VertexData* vdata, std::vector<ExVertex> verticesList)
+  bool ExMesh::useBlendElements()
   {
-    // A VertexDeclaration declares the format of a set of vertex inputs,
-    Ogre::VertexDeclaration* decl = vdata->vertexDeclaration;
-    // A VertexBufferBinding records the state of all the vertex buffer bindings required to
-    // provide a vertex declaration with the input data it needs for the vertex elements.
-    Ogre::VertexBufferBinding* bind = vdata->vertexBufferBinding;
-
-    size_t vBufSegmentSize = 0;
-    size_t texSegmentSize = 0;
-
-    // Create the vertex declaration (the format of vertices).
-    // Add vertex position
-    decl->addElement(0, vBufSegmentSize, Ogre::VET_FLOAT3, Ogre::VES_POSITION);
-    vBufSegmentSize += Ogre::VertexElement::getTypeSize(Ogre::VET_FLOAT3);
-
-    // Add vertex normal
-    if (m_params.exportVertNorm)
-    {
-      decl->addElement(0, vBufSegmentSize, Ogre::VET_FLOAT3, Ogre::VES_NORMAL);
-      vBufSegmentSize += Ogre::VertexElement::getTypeSize(Ogre::VET_FLOAT3);
-    }
+    if (!m_params.blendElements || !getSkeleton() || !m_params.exportSkeleton || (m_vertices.getNumInfluences() == 0))
+      return false;
 
-    // Add vertex colour
-    if (m_params.exportVertCol && haveVertexColor)
-    {
-      decl->addElement(0, vBufSegmentSize, Ogre::VET_COLOUR, Ogre::VES_DIFFUSE);
-      vBufSegmentSize += Ogre::VertexElement::getTypeSize(Ogre::VET_COLOUR);
-    }
+    //the blend indices are written on bytes, each vertex set uses a part of the bones used by the whole mesh
+    std::vector<unsigned int> vertices(m_vertices.size());
+    for (unsigned int i = 0; i < vertices.size(); i++)
+      vertices[i] = i;
 
-    // Add texture coordinates
-    //use VET_FLOAT2 to make ogre able to generate tangent ^^
-    int countTex = 0;
-    for (size_t i = 0; i < m_numTextureChannel; i++)
+    std::vector<int> blendIndices;
+    if (buildBlendIndexMap(m_vertices, vertices, blendIndices) > 256)
     {
-      decl->addElement(1, texSegmentSize, Ogre::VET_FLOAT2, Ogre::VES_TEXTURE_COORDINATES, countTex);
-      texSegmentSize += Ogre::VertexElement::getTypeSize(Ogre::VET_FLOAT2);
-      countTex++;
+      EasyOgreExporterLog("Warning: more than 256 bones used, no blend indices and weights in the vertices\n");
+      return false;
     }
-
-    // Now create the vertex buffers.
-    Ogre::HardwareVertexBufferSharedPtr vbuf = Ogre::HardwareBufferManager::getSingletonPtr()
-      ->createVertexBuffer(vBufSegmentSize, vdata->vertexCount, Ogre::HardwareBuffer::HBU_STATIC_WRITE_ONLY, false);
-    Ogre::HardwareVertexBufferSharedPtr texBuf = Ogre::HardwareBufferManager::getSingletonPtr()
-      ->createVertexBuffer(texSegmentSize, vdata->vertexCount, Ogre::HardwareBuffer::HBU_STATIC_WRITE_ONLY, false);
-
-    // Bind them.
-    bind->setBinding(0, vbuf);
-    bind->setBinding(1, texBuf);
-
-    // Lock them. pVert & pTexVert are pointers to the start of the hardware buffers.
-    unsigned char* pVert = static_cast<unsigned char*>(vbuf->lock(Ogre::HardwareBuffer::HBL_DISCARD));
-    unsigned char* pTexVert = static_cast<unsigned char*>(texBuf->lock(Ogre::HardwareBuffer::HBL_DISCARD));
-    Ogre::ARGB* pCol;
-    float* pFloat;
-
-    // Get the element lists for the buffers.
-    Ogre::VertexDeclaration::VertexElementList elems = decl->findElementsBySource(0);
-    Ogre::VertexDeclaration::VertexElementList texElems = decl->findElementsBySource(1);
-
-    // Buffers are set up, so iterate the vertices.
-    int iTexCoord = 0;
-    for (int i = 0; i < verticesList.size(); ++i)
-    {
-      ExVertex vertex = verticesList[i];
-
-      Ogre::VertexDeclaration::VertexElementList::const_iterator elemItr, elemEnd;
-      elemEnd = elems.end();
-      for (elemItr = elems.begin(); elemItr != elemEnd; ++elemItr)
-      {
-        // VertexElement corresponds to a part of a vertex definition eg. position, normal
-        const Ogre::VertexElement& elem = *elemItr;
-        switch (elem.getSemantic())
-        {
-        case Ogre::VES_POSITION:
-        {
-          elem.baseVertexPointerToElement(pVert, &pFloat);
-          *pFloat++ = vertex.vPos.x;
-          *pFloat++ = vertex.vPos.y;
-          *pFloat++ = vertex.vPos.z;
-          //EasyOgreExporterLog("Info: vertex %d pos : %f %f %f\n", i, vertex.vPos.x, vertex.vPos.y, vertex.vPos.z);
-        }
-        break;
-        case Ogre::VES_NORMAL:
-        {
-          elem.baseVertexPointerToElement(pVert, &pFloat);
-          *pFloat++ = vertex.vNorm.x;
-          *pFloat++ = vertex.vNorm.y;
-          *pFloat++ = vertex.vNorm.z;
-          //EasyOgreExporterLog("Info: vertex %d normal : %f %f %f\n", i, vertex.vNorm.x, vertex.vNorm.y, vertex.vNorm.z);
-        }
-        break;
-        case Ogre::VES_DIFFUSE:
-        {
-          elem.baseVertexPointerToElement(pVert, &pCol);
-          Ogre::ColourValue cv(vertex.vColor.x, vertex.vColor.y, vertex.vColor.z, vertex.vColor.w);
-          *pCol = Ogre::VertexElement::convertColourValue(cv, Ogre::VertexElement::getBestColourVertexElementType());
-          //EasyOgreExporterLog("Info: vertex %d color : %f %f %f %f\n", i, vertex.vColor.x, vertex.vColor.y, vertex.vColor.z, vertex.vColor.w);
-        }
-        break;
-        default:
-          break;
-        } // Deal with an individual vertex element (position or normal).
-      } // Loop positions and normals.
-
-      iTexCoord = 0;
-      elemEnd = texElems.end();
-      for (elemItr = texElems.begin(); elemItr != elemEnd; ++elemItr)
-      {
-        // VertexElement corresponds to a part of a vertex definition eg. tex coord
-        const Ogre::VertexElement& elem = *elemItr;
-        switch (elem.getSemantic())
-        {
-        case Ogre::VES_TEXTURE_COORDINATES:
-        {
-          elem.baseVertexPointerToElement(pTexVert, &pFloat);
-          *pFloat++ = vertex.lTexCoords[iTexCoord].x;
-          *pFloat++ = vertex.lTexCoords[iTexCoord].y;
-          //*pFloat++ = vertex.lTexCoords[iTexCoord].z;
-          //EasyOgreExporterLog("Info: vertex %d tex coord %d : %f %f\n", i, iTexCoord, vertex.lTexCoords[iTexCoord].x, vertex.lTexCoords[iTexCoord].y);
-          iTexCoord++;
-        }
-        break;
-        default:
-          break;
-        } // Deal with an individual vertex element (tex coords).
-      } // Loop tex coords.
-
-      pVert += vbuf->getVertexSize();
-      pTexVert += texBuf->getVertexSize();
-    } // Loop vertices.
-    vbuf->unlock();
-    texBuf->unlock();
+    return true;
   }
 
-  ExMaterial* ExMesh::loadMaterial(IGameMaterial* pGameMaterial)
+  void ExMesh::buildOgreGeometry(Ogre::VertexData* vdata, const std::vector<unsigned int>& vertices)
   {
-    ExMaterial* pMaterial = 0;
-
-    //try to load the material if it has already been created
-    pMaterial = m_converter->getMaterialSet()->getMaterial(pGameMaterial);
-
-    //otherwise create the material
-    if (!pMaterial && !pGameMaterial)
-    {
-      // add the default material
-      m_converter->getMaterialSet()->addMaterial();
-      pMaterial = m_converter->getMaterialSet()->getMaterial(0);
-    }
-    else if (!pMaterial)
-    {
-      pMaterial = new ExMaterial(m_converter, pGameMaterial, m_params.resPrefix);
-      m_converter->getMaterialSet()->addMaterial(pMaterial);
-      pMaterial->load();
-    }
-
-    //loading complete
-    return pMaterial;
+    // Expected animation types, so the buffers are written in their final layout
+    bool hasSkeletalAnimation = (getSkeleton() && m_params.exportSkeleton) ? true : false;
+    bool hasVertexAnimation = (m_pMorphR3 && m_params.exportPoses) || (!m_pMorphR3 && m_params.exportVertAnims && GetVertexAnimState(m_GameNode->GetMaxNode()));
+
+    ExVertexWriter writer(m_vertices);
+    writer.setNormals(m_params.exportVertNorm);
+    writer.setColors(m_params.exportVertCol && haveVertexColor);
+    writer.setNumTexCoords(m_numTextureChannel);
+    writer.setTangents(m_params.tangentSemantic != TS_TANGENT, m_params.tangentsUseParity);
+    writer.setBlendWeights(m_blendElements, m_params.useByteBlendWeights());
+    writer.write(vdata, vertices, hasSkeletalAnimation, hasVertexAnimation);
   }
 
 }; //end of namespace
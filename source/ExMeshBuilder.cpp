@@ -0,0 +1,349 @@
+////////////////////////////////////////////////////////////////////////////////
+// ExMeshBuilder.cpp
+// Start Date : October 17, 2026
+////////////////////////////////////////////////////////////////////////////////
+/*********************************************************************************
+*                                                                                *
+*   This program is free software; you can redistribute it and/or modify         *
+*   it under the terms of the GNU Lesser General Public License as published by  *
+*   the Free Software Foundation; either version 2 of the License, or            *
+*   (at your option) any later version.                                          *
+*                                                                                *
+**********************************************************************************/
+
+#include "ExMeshBuilder.h"
+#include "ExVertexWelder.h"
+#include "ExMeshOptimizer.h"
+#include "ExTangentGenerator.h"
+#include "ExBoneWeights.h"
+#include "EasyOgreExporterLog.h"
+#include <math.h>
+#include <algorithm>
+
+namespace EasyOgreExporter
+{
+  ExMeshBuilder::ExMeshBuilder(const ExMeshSnapshot& snapshot) : m_snapshot(snapshot)
+  {
+    m_tangentTexCoordSet = -1;
+    m_maxInfluences = 4;
+    m_hasBounds = false;
+    m_radius = 0.0f;
+    for (int k = 0; k < 3; k++)
+    {
+      m_boundsMin[k] = 0.0f;
+      m_boundsMax[k] = 0.0f;
+    }
+  }
+
+  ExMeshBuilder::~ExMeshBuilder()
+  {
+    m_vertices.clear();
+    m_faceVertices.clear();
+    m_subMeshes.clear();
+    m_reducedInfluences.clear();
+  }
+
+  void ExMeshBuilder::extendBounds(const float* pos)
+  {
+    if (!m_hasBounds)
+    {
+      for (int k = 0; k < 3; k++)
+      {
+        m_boundsMin[k] = pos[k];
+        m_boundsMax[k] = pos[k];
+      }
+      m_hasBounds = true;
+    }
+    else
+    {
+      for (int k = 0; k < 3; k++)
+      {
+        m_boundsMin[k] = std::min(m_boundsMin[k], pos[k]);
+        m_boundsMax[k] = std::max(m_boundsMax[k], pos[k]);
+      }
+    }
+
+    m_radius = std::max(m_radius, sqrtf((pos[0] * pos[0]) + (pos[1] * pos[1]) + (pos[2] * pos[2])));
+  }
+
+  void ExMeshBuilder::build(float weldTolerance, unsigned int maxSubMeshVertices)
+  {
+    weldCorners(weldTolerance);
+    buildSubMeshes(maxSubMeshVertices);
+  }
+
+  void ExMeshBuilder::weldCorners(float weldTolerance)
+  {
+    unsigned int numFaces = m_snapshot.getNumFaces();
+    unsigned int numTexCoords = m_snapshot.numTexCoordSets;
+
+    // packed bone influences of the mesh vertices, at most m_maxInfluences per vertex
+    unsigned int numInfluences = 0;
+    std::vector<float> packedWeights;
+    std::vector<int> packedBones;
+    m_reducedInfluences.clear();
+    if (m_snapshot.hasSkin() && (m_maxInfluences > 0))
+    {
+      unsigned int numMeshVertices = m_snapshot.getNumVertices();
+      packedWeights.resize(numMeshVertices * m_maxInfluences);
+      packedBones.resize(numMeshVertices * m_maxInfluences);
+      for (unsigned int v = 0; v < numMeshVertices; v++)
+      {
+        int start = m_snapshot.influenceStart[v];
+        unsigned int count = m_snapshot.getNumInfluences(v);
+        float removedWeight = 0.0f;
+        unsigned int numBones = reduceInfluences(count ? &m_snapshot.influenceWeights[start] : 0, count ? &m_snapshot.influenceJoints[start] : 0, count, m_maxInfluences,
+                                                 &packedWeights[v * m_maxInfluences], &packedBones[v * m_maxInfluences], removedWeight);
+
+        numInfluences = std::max(numInfluences, std::min(numBones, m_maxInfluences));
+        if (numBones > m_maxInfluences)
+        {
+          ExInfluenceReport report;
+          report.vertex = v;
+          report.numInfluences = numBones;
+          report.removedWeight = removedWeight;
+          m_reducedInfluences.push_back(report);
+        }
+      }
+    }
+
+    // tangents of the corners, computed before the weld so the mirrored uvs split the vertices
+    bool hasTangents = false;
+    std::vector<float> cornerTangents;
+    if (m_tangentTexCoordSet >= 0)
+    {
+      if (m_tangentTexCoordSet < (int)numTexCoords)
+      {
+        computeTangents(m_snapshot, m_tangentTexCoordSet, weldTolerance, cornerTangents);
+        hasTangents = true;
+      }
+      else
+      {
+        EasyOgreExporterLog("Warning: no texture coordinates to build the tangents\n");
+      }
+    }
+
+    m_vertices.setLayout(numTexCoords, numInfluences, hasTangents);
+    m_vertices.reserve(numFaces);
+    m_faceVertices.resize(numFaces * 3);
+
+    // weld identical corners, attributes are normal, color, uvs and tangent
+    ExVertexWelder welder(weldTolerance, 3 + 4 + (numTexCoords * 3) + (hasTangents ? 4 : 0), numFaces);
+    std::vector<float> attribs(welder.getAttribStride());
+    std::vector<float> texCoords(numTexCoords * 2 + 1);
+    const float defaultColor[4] = {0.0f, 0.0f, 0.0f, 1.0f};
+
+    for (unsigned int corner = 0; corner < numFaces * 3; corner++)
+    {
+      int vIndex = m_snapshot.faceVertices[corner];
+      const float* vpos = &m_snapshot.positions[vIndex * 3];
+      const float* vnorm = &m_snapshot.cornerNormals[corner * 3];
+      const float* vcolor = m_snapshot.hasColors() ? &m_snapshot.cornerColors[corner * 4] : defaultColor;
+
+      //update bounding box
+      extendBounds(vpos);
+
+      //welder attributes, normal, color, uvw and tangent
+      int attr = 0;
+      for (int k = 0; k < 3; k++)
+        attribs[attr++] = vnorm[k];
+      for (int k = 0; k < 4; k++)
+        attribs[attr++] = vcolor[k];
+
+      for (unsigned int set = 0; set < numTexCoords; set++)
+      {
+        const float* uvw = &m_snapshot.cornerTexCoords[((corner * numTexCoords) + set) * 3];
+        texCoords[(set * 2)] = uvw[0];
+        texCoords[(set * 2) + 1] = uvw[1];
+        attribs[attr++] = uvw[0];
+        attribs[attr++] = uvw[1];
+        attribs[attr++] = uvw[2];
+      }
+
+      const float* vtangent = hasTangents ? &cornerTangents[corner * 4] : 0;
+      if (vtangent)
+      {
+        for (int k = 0; k < 4; k++)
+          attribs[attr++] = vtangent[k];
+      }
+
+      //look if the vertex is already added
+      unsigned int vIdx = welder.addVertex(vpos, &attribs[0]);
+
+      //add vertex
+      if (vIdx == m_vertices.size())
+      {
+        // packed bone weights and joint ids, sorted by weight so the first numInfluences ones are the used ones
+        const float* weights = numInfluences ? &packedWeights[vIndex * m_maxInfluences] : 0;
+        const int* bones = numInfluences ? &packedBones[vIndex * m_maxInfluences] : 0;
+        m_vertices.addVertex(vIndex, vpos, vnorm, vcolor, &texCoords[0], weights, bones, vtangent);
+      }
+
+      m_faceVertices[corner] = vIdx;
+    }
+  }
+
+  void ExMeshBuilder::buildSubMeshes(unsigned int maxSubMeshVertices)
+  {
+    m_subMeshes.clear();
+
+    //sort submesh, group the faces by material in one pass
+    std::vector<int> matIds;
+    std::vector<int> matFaceStart;
+    std::vector<int> matFaces;
+    bucketFaces(m_snapshot.faceMaterialIds, matIds, matFaceStart, matFaces);
+
+    std::vector<int> remapTable;
+    std::vector<int> globalIndices;
+    std::vector<int> localIndices;
+    std::vector<int> usedVertices;
+    std::vector<int> chunkFaces;
+    std::vector<int> chunkStart;
+    for (size_t matid = 0; matid < matIds.size(); matid++)
+    {
+      //faces range of the material
+      const int* faces = &matFaces[0] + matFaceStart[matid];
+      int numMatFaces = matFaceStart[matid + 1] - matFaceStart[matid];
+
+      //global vertices used by the material faces
+      globalIndices.resize(numMatFaces * 3);
+      for (int fi = 0; fi < numMatFaces; fi++)
+      {
+        for (size_t j = 0; j < 3; j++)
+          globalIndices[(fi * 3) + j] = m_faceVertices[(faces[fi] * 3) + j];
+      }
+
+      //keep only the referenced welded vertices with a compact local index
+      remapIndices(globalIndices, m_vertices.size(), localIndices, usedVertices, remapTable);
+
+      //split the faces in spatial chunks when they use too many vertices for 16 bits indices
+      chunkFaces.assign(faces, faces + numMatFaces);
+      chunkStart.clear();
+      chunkStart.push_back(0);
+      chunkStart.push_back(numMatFaces);
+      if ((maxSubMeshVertices > 0) && (usedVertices.size() > maxSubMeshVertices))
+      {
+        std::vector<int> triangleOrder;
+        splitTriangles(globalIndices, m_vertices.getPosition(0), m_vertices.size(), maxSubMeshVertices, triangleOrder, chunkStart);
+        for (int fi = 0; fi < numMatFaces; fi++)
+          chunkFaces[fi] = faces[triangleOrder[fi]];
+
+        EasyOgreExporterLog("Info: submesh with %d vertices split in %d submeshs to use 16 bits indices\n", (int)usedVertices.size(), (int)chunkStart.size() - 1);
+      }
+
+      for (size_t chunk = 0; (chunk + 1) < chunkStart.size(); chunk++)
+      {
+        const int* subFaces = &chunkFaces[0] + chunkStart[chunk];
+        int numSubFaces = chunkStart[chunk + 1] - chunkStart[chunk];
+
+        m_subMeshes.push_back(ExBuiltSubMesh());
+        ExBuiltSubMesh& submesh = m_subMeshes.back();
+        submesh.materialId = matIds[matid];
+
+        //the unsplit submesh can reuse the material indices
+        if (chunkStart.size() > 2)
+        {
+          globalIndices.resize(numSubFaces * 3);
+          for (int fi = 0; fi < numSubFaces; fi++)
+          {
+            for (size_t j = 0; j < 3; j++)
+              globalIndices[(fi * 3) + j] = m_faceVertices[(subFaces[fi] * 3) + j];
+          }
+          remapIndices(globalIndices, m_vertices.size(), localIndices, usedVertices, remapTable);
+        }
+
+        submesh.faces.assign(subFaces, subFaces + numSubFaces);
+        submesh.indices.assign(localIndices.begin(), localIndices.begin() + (numSubFaces * 3));
+        submesh.vertices.assign(usedVertices.begin(), usedVertices.end());
+      }
+    }
+  }
+
+  void ExMeshBuilder::optimizeSubMesh(unsigned int sub, unsigned int cacheSize, bool overdraw, float overdrawThreshold)
+  {
+    ExBuiltSubMesh& submesh = m_subMeshes[sub];
+    std::vector<int>& indices = submesh.indices;
+    int numVertices = submesh.vertices.size();
+    std::vector<int> triangleOrder;
+    std::vector<int> vertexOrder;
+
+    float atvrBefore = 0.0f;
+    float acmrBefore = computeACMR(indices, numVertices, cacheSize, &atvrBefore);
+
+    optimizeVertexCache(indices, numVertices, cacheSize, &triangleOrder);
+
+    if (overdraw)
+    {
+      std::vector<float> positions(numVertices * 3);
+      for (int v = 0; v < numVertices; v++)
+      {
+        const float* pos = m_vertices.getPosition(submesh.vertices[v]);
+        positions[(v * 3)] = pos[0];
+        positions[(v * 3) + 1] = pos[1];
+        positions[(v * 3) + 2] = pos[2];
+      }
+
+      std::vector<int> clusterOrder;
+      float acmrCache = computeACMR(indices, numVertices, cacheSize);
+      optimizeOverdraw(indices, &positions[0], numVertices, cacheSize, overdrawThreshold, &clusterOrder);
+      float acmrOverdraw = computeACMR(indices, numVertices, cacheSize);
+      EasyOgreExporterLog("Info: submesh %d overdraw clusters sorted, ACMR %.3f -> %.3f\n", sub, acmrCache, acmrOverdraw);
+
+      for (size_t fi = 0; fi < clusterOrder.size(); fi++)
+        clusterOrder[fi] = triangleOrder[clusterOrder[fi]];
+      triangleOrder.swap(clusterOrder);
+    }
+
+    optimizeVertexFetch(indices, numVertices, vertexOrder);
+
+    float atvrAfter = 0.0f;
+    float acmrAfter = computeACMR(indices, vertexOrder.size(), cacheSize, &atvrAfter);
+    EasyOgreExporterLog("Info: submesh %d vertex cache ACMR %.3f -> %.3f, ATVR %.3f -> %.3f\n", sub, acmrBefore, acmrAfter, atvrBefore, atvrAfter);
+
+    //apply the new faces order
+    std::vector<int> faces(submesh.faces.size());
+    for (size_t fi = 0; fi < faces.size(); fi++)
+      faces[fi] = submesh.faces[triangleOrder[fi]];
+    submesh.faces.swap(faces);
+
+    //apply the new vertices order
+    std::vector<unsigned int> vertices(vertexOrder.size());
+    for (size_t v = 0; v < vertexOrder.size(); v++)
+      vertices[v] = submesh.vertices[vertexOrder[v]];
+    submesh.vertices.swap(vertices);
+  }
+
+  void ExMeshBuilder::optimizeSharedVertices()
+  {
+    std::vector<int> indices;
+    std::vector<int> vertexOrder;
+    for (size_t sub = 0; sub < m_subMeshes.size(); sub++)
+    {
+      const std::vector<int>& faces = m_subMeshes[sub].faces;
+      for (size_t fi = 0; fi < faces.size(); fi++)
+      {
+        for (size_t j = 0; j < 3; j++)
+          indices.push_back(m_faceVertices[(faces[fi] * 3) + j]);
+      }
+    }
+
+    optimizeVertexFetch(indices, m_vertices.size(), vertexOrder);
+
+    std::vector<int> newIndex(m_vertices.size(), -1);
+    for (size_t v = 0; v < vertexOrder.size(); v++)
+      newIndex[vertexOrder[v]] = v;
+    m_vertices.reorder(vertexOrder);
+
+    for (size_t i = 0; i < m_faceVertices.size(); i++)
+      m_faceVertices[i] = newIndex[m_faceVertices[i]];
+
+    //keep the submeshes handles valid
+    for (size_t sub = 0; sub < m_subMeshes.size(); sub++)
+    {
+      std::vector<unsigned int>& handles = m_subMeshes[sub].vertices;
+      for (size_t v = 0; v < handles.size(); v++)
+        handles[v] = newIndex[handles[v]];
+    }
+  }
+
+}; //end of namespace
@@ -0,0 +1,554 @@
+////////////////////////////////////////////////////////////////////////////////
+// ExMeshOptimizer.cpp
+// Start Date : October 17, 2026
+////////////////////////////////////////////////////////////////////////////////
+/*********************************************************************************
+*                                                                                *
+*   This program is free software; you can redistribute it and/or modify         *
+*   it under the terms of the GNU Lesser General Public License as published by  *
+*   the Free Software Foundation; either version 2 of the License, or            *
+*   (at your option) any later version.                                          *
+*                                                                                *
+**********************************************************************************/
+
+#include "ExMeshOptimizer.h"
+#include <math.h>
+#include <algorithm>
+
+namespace EasyOgreExporter
+{
+  void bucketFaces(const std::vector<int>& faceKeys, std::vector<int>& keys, std::vector<int>& bucketStart, std::vector<int>& faceOrder)
+  {
+    keys.clear();
+    bucketStart.clear();
+    faceOrder.resize(faceKeys.size());
+    if (faceKeys.empty())
+    {
+      bucketStart.push_back(0);
+      return;
+    }
+
+    int minKey = faceKeys[0];
+    int maxKey = faceKeys[0];
+    for (size_t i = 1; i < faceKeys.size(); i++)
+    {
+      minKey = std::min(minKey, faceKeys[i]);
+      maxKey = std::max(maxKey, faceKeys[i]);
+    }
+
+    //count the faces per key, max material ids are 16 bits so the table stay small
+    std::vector<int> counts((maxKey - minKey) + 1, 0);
+    for (size_t i = 0; i < faceKeys.size(); i++)
+      counts[faceKeys[i] - minKey]++;
+
+    //turn the counts into write offsets, only keep the used keys
+    int offset = 0;
+    for (size_t k = 0; k < counts.size(); k++)
+    {
+      if (counts[k] == 0)
+        continue;
+
+      keys.push_back((int)k + minKey);
+      bucketStart.push_back(offset);
+      int count = counts[k];
+      counts[k] = offset;
+      offset += count;
+    }
+    bucketStart.push_back(offset);
+
+    for (size_t i = 0; i < faceKeys.size(); i++)
+      faceOrder[counts[faceKeys[i] - minKey]++] = i;
+  }
+
+  void remapIndices(const std::vector<int>& indices, unsigned int numVertices, std::vector<int>& localIndices, std::vector<int>& usedVertices, std::vector<int>& remapTable)
+  {
+    if (remapTable.size() < numVertices)
+      remapTable.resize(numVertices, -1);
+
+    localIndices.resize(indices.size());
+    usedVertices.clear();
+
+    for (size_t i = 0; i < indices.size(); i++)
+    {
+      int gIdx = indices[i];
+      if (remapTable[gIdx] == -1)
+      {
+        remapTable[gIdx] = usedVertices.size();
+        usedVertices.push_back(gIdx);
+      }
+      localIndices[i] = remapTable[gIdx];
+    }
+
+    //only reset the used entries, the table is shared by all the sub sets
+    for (size_t i = 0; i < usedVertices.size(); i++)
+      remapTable[usedVertices[i]] = -1;
+  }
+
+  struct CentroidLess
+  {
+    const float* centroids;
+    int axis;
+
+    bool operator()(int a, int b) const
+    {
+      return centroids[(a * 3) + axis] < centroids[(b * 3) + axis];
+    }
+  };
+
+  // number of distinct vertices used by a range of triangles, marks is a per vertex stamp table
+  static unsigned int countTrianglesVertices(const std::vector<int>& indices, const int* triangles, size_t numTriangles, std::vector<unsigned int>& marks, unsigned int& stamp)
+  {
+    stamp++;
+    unsigned int count = 0;
+    for (size_t t = 0; t < numTriangles; t++)
+    {
+      for (int k = 0; k < 3; k++)
+      {
+        int v = indices[(triangles[t] * 3) + k];
+        if (marks[v] != stamp)
+        {
+          marks[v] = stamp;
+          count++;
+        }
+      }
+    }
+    return count;
+  }
+
+  static void splitTrianglesRange(const std::vector<int>& indices, const std::vector<float>& centroids, unsigned int maxVertices, std::vector<int>& triangleOrder, size_t start, size_t end, std::vector<int>& chunkStart, std::vector<unsigned int>& marks, unsigned int& stamp)
+  {
+    if ((end - start < 2) || (countTrianglesVertices(indices, &triangleOrder[start], end - start, marks, stamp) <= maxVertices))
+    {
+      chunkStart.push_back(start);
+      return;
+    }
+
+    //largest axis of the centroids bounds
+    float bmin[3] = {centroids[triangleOrder[start] * 3], centroids[(triangleOrder[start] * 3) + 1], centroids[(triangleOrder[start] * 3) + 2]};
+    float bmax[3] = {bmin[0], bmin[1], bmin[2]};
+    for (size_t t = start + 1; t < end; t++)
+    {
+      const float* c = &centroids[triangleOrder[t] * 3];
+      for (int k = 0; k < 3; k++)
+      {
+        bmin[k] = std::min(bmin[k], c[k]);
+        bmax[k] = std::max(bmax[k], c[k]);
+      }
+    }
+
+    CentroidLess less;
+    less.centroids = &centroids[0];
+    less.axis = 0;
+    for (int k = 1; k < 3; k++)
+    {
+      if ((bmax[k] - bmin[k]) > (bmax[less.axis] - bmin[less.axis]))
+        less.axis = k;
+    }
+
+    size_t middle = start + ((end - start) / 2);
+    std::nth_element(triangleOrder.begin() + start, triangleOrder.begin() + middle, triangleOrder.begin() + end, less);
+
+    splitTrianglesRange(indices, centroids, maxVertices, triangleOrder, start, middle, chunkStart, marks, stamp);
+    splitTrianglesRange(indices, centroids, maxVertices, triangleOrder, middle, end, chunkStart, marks, stamp);
+  }
+
+  void splitTriangles(const std::vector<int>& indices, const float* positions, unsigned int numVertices, unsigned int maxVertices, std::vector<int>& triangleOrder, std::vector<int>& chunkStart)
+  {
+    size_t numTriangles = indices.size() / 3;
+    triangleOrder.resize(numTriangles);
+    chunkStart.clear();
+
+    std::vector<float> centroids(numTriangles * 3);
+    for (size_t t = 0; t < numTriangles; t++)
+    {
+      triangleOrder[t] = t;
+      const float* p0 = &positions[indices[t * 3] * 3];
+      const float* p1 = &positions[indices[(t * 3) + 1] * 3];
+      const float* p2 = &positions[indices[(t * 3) + 2] * 3];
+      for (int k = 0; k < 3; k++)
+        centroids[(t * 3) + k] = (p0[k] + p1[k] + p2[k]) / 3.0f;
+    }
+
+    //a triangle can not be split, keep at least 3 vertices per chunk
+    maxVertices = std::max(maxVertices, 3u);
+
+    std::vector<unsigned int> marks(numVertices, 0);
+    unsigned int stamp = 0;
+    if (numTriangles > 0)
+      splitTrianglesRange(indices, centroids, maxVertices, triangleOrder, 0, numTriangles, chunkStart, marks, stamp);
+
+    chunkStart.push_back(numTriangles);
+  }
+
+  // scoring from "Linear-Speed Vertex Cache Optimisation", Tom Forsyth
+  static const unsigned int MAX_VERTEX_CACHE_SIZE = 64;
+
+  static float getVertexScore(int cachePosition, unsigned int remainingTriangles, unsigned int cacheSize)
+  {
+    //no triangle left to draw with this vertex
+    if (remainingTriangles == 0)
+      return -1.0f;
+
+    float score = 0.0f;
+    if (cachePosition >= 0)
+    {
+      //the last triangle vertices get a fixed score so the next triangle do not favor one of them
+      if (cachePosition < 3)
+      {
+        score = 0.75f;
+      }
+      else
+      {
+        float scaler = 1.0f / (float)(cacheSize - 3);
+        score = pow(1.0f - (float)(cachePosition - 3) * scaler, 1.5f);
+      }
+    }
+
+    //boost the vertices with few triangles left to get rid of them
+    score += 2.0f * pow((float)remainingTriangles, -0.5f);
+    return score;
+  }
+
+  void optimizeVertexCache(std::vector<int>& indices, unsigned int numVertices, unsigned int cacheSize, std::vector<int>* triangleOrder)
+  {
+    size_t numTriangles = indices.size() / 3;
+    if (triangleOrder)
+      triangleOrder->resize(numTriangles);
+
+    if (cacheSize < 4)
+      cacheSize = 4;
+    if (cacheSize > MAX_VERTEX_CACHE_SIZE)
+      cacheSize = MAX_VERTEX_CACHE_SIZE;
+
+    //vertex to triangles adjacency
+    std::vector<unsigned int> offsets(numVertices + 1, 0);
+    std::vector<unsigned int> remaining(numVertices, 0);
+    for (size_t i = 0; i < numTriangles * 3; i++)
+      remaining[indices[i]]++;
+
+    for (unsigned int v = 0; v < numVertices; v++)
+      offsets[v + 1] = offsets[v] + remaining[v];
+
+    std::vector<unsigned int> adjacency(numTriangles * 3);
+    std::vector<unsigned int> fill(offsets.begin(), offsets.end() - 1);
+    for (size_t i = 0; i < numTriangles * 3; i++)
+      adjacency[fill[indices[i]]++] = i / 3;
+
+    std::vector<int> cachePosition(numVertices, -1);
+    std::vector<float> vertexScore(numVertices);
+    for (unsigned int v = 0; v < numVertices; v++)
+      vertexScore[v] = getVertexScore(-1, remaining[v], cacheSize);
+
+    std::vector<float> triangleScore(numTriangles);
+    std::vector<char> emitted(numTriangles, 0);
+    int bestTriangle = -1;
+    float bestScore = -1.0f;
+    for (size_t t = 0; t < numTriangles; t++)
+    {
+      triangleScore[t] = vertexScore[indices[t * 3]] + vertexScore[indices[t * 3 + 1]] + vertexScore[indices[t * 3 + 2]];
+      if (triangleScore[t] > bestScore)
+      {
+        bestScore = triangleScore[t];
+        bestTriangle = t;
+      }
+    }
+
+    std::vector<int> cache;
+    std::vector<int> newCache;
+    cache.reserve(cacheSize + 3);
+    newCache.reserve(cacheSize + 3);
+
+    std::vector<int> newIndices(numTriangles * 3);
+    size_t cursor = 0;
+
+    for (size_t n = 0; n < numTriangles; n++)
+    {
+      //nothing usable in the cache, take the next triangle left
+      if (bestTriangle < 0)
+      {
+        while (emitted[cursor])
+          cursor++;
+        bestTriangle = cursor;
+      }
+
+      const int* tri = &indices[bestTriangle * 3];
+      newIndices[n * 3] = tri[0];
+      newIndices[n * 3 + 1] = tri[1];
+      newIndices[n * 3 + 2] = tri[2];
+      if (triangleOrder)
+        (*triangleOrder)[n] = bestTriangle;
+      emitted[bestTriangle] = 1;
+
+      //remove the triangle from the vertices adjacency
+      for (int k = 0; k < 3; k++)
+      {
+        int v = tri[k];
+        unsigned int* vadj = &adjacency[offsets[v]];
+        for (unsigned int a = 0; a < remaining[v]; a++)
+        {
+          if (vadj[a] == (unsigned int)bestTriangle)
+          {
+            vadj[a] = vadj[remaining[v] - 1];
+            remaining[v]--;
+            break;
+          }
+        }
+      }
+
+      //the triangle vertices go at the top of the LRU cache
+      newCache.clear();
+      for (int k = 0; k < 3; k++)
+      {
+        if ((k == 0) || ((tri[k] != tri[0]) && (k == 1 || tri[k] != tri[1])))
+          newCache.push_back(tri[k]);
+      }
+      for (size_t c = 0; c < cache.size(); c++)
+      {
+        int v = cache[c];
+        if ((v != tri[0]) && (v != tri[1]) && (v != tri[2]))
+          newCache.push_back(v);
+      }
+
+      //update the vertices scores, including the ones pushed out of the cache
+      for (size_t c = 0; c < newCache.size(); c++)
+      {
+        int v = newCache[c];
+        cachePosition[v] = (c < cacheSize) ? (int)c : -1;
+        vertexScore[v] = getVertexScore(cachePosition[v], remaining[v], cacheSize);
+      }
+
+      //update the triangles scores and find the best one around the cache
+      bestTriangle = -1;
+      bestScore = -1.0f;
+      for (size_t c = 0; c < newCache.size(); c++)
+      {
+        int v = newCache[c];
+        const unsigned int* vadj = &adjacency[offsets[v]];
+        for (unsigned int a = 0; a < remaining[v]; a++)
+        {
+          unsigned int t = vadj[a];
+          triangleScore[t] = vertexScore[indices[t * 3]] + vertexScore[indices[t * 3 + 1]] + vertexScore[indices[t * 3 + 2]];
+          if (triangleScore[t] > bestScore)
+          {
+            bestScore = triangleScore[t];
+            bestTriangle = t;
+          }
+        }
+      }
+
+      if (newCache.size() > cacheSize)
+        newCache.resize(cacheSize);
+      cache.swap(newCache);
+    }
+
+    indices.swap(newIndices);
+  }
+
+  // FIFO cache simulation step, return the number of misses of the triangle
+  static inline unsigned int cacheTriangle(const int* tri, std::vector<unsigned int>& timestamps, unsigned int& time, unsigned int cacheSize)
+  {
+    unsigned int misses = 0;
+    for (int k = 0; k < 3; k++)
+    {
+      if ((time - timestamps[tri[k]]) > cacheSize)
+      {
+        timestamps[tri[k]] = time++;
+        misses++;
+      }
+    }
+    return misses;
+  }
+
+  struct OverdrawCluster
+  {
+    size_t start;
+    size_t end;
+    float sortKey;
+
+    bool operator<(const OverdrawCluster& b) const
+    {
+      //higher occlusion potential first
+      return sortKey > b.sortKey;
+    }
+  };
+
+  void optimizeOverdraw(std::vector<int>& indices, const float* positions, unsigned int numVertices, unsigned int cacheSize, float threshold, std::vector<int>* triangleOrder)
+  {
+    size_t numTriangles = indices.size() / 3;
+    if (triangleOrder)
+    {
+      triangleOrder->resize(numTriangles);
+      for (size_t t = 0; t < numTriangles; t++)
+        (*triangleOrder)[t] = t;
+    }
+
+    if (numTriangles < 2)
+      return;
+
+    //hard boundaries, where the cache has been fully reset
+    std::vector<size_t> hardBounds;
+    std::vector<unsigned int> timestamps(numVertices, 0);
+    unsigned int time = cacheSize + 1;
+    for (size_t t = 0; t < numTriangles; t++)
+    {
+      if ((cacheTriangle(&indices[t * 3], timestamps, time, cacheSize) == 3) || (t == 0))
+        hardBounds.push_back(t);
+    }
+    hardBounds.push_back(numTriangles);
+
+    //soft boundaries, split each hard cluster as long as the ACMR stay under the threshold
+    std::vector<OverdrawCluster> clusters;
+    for (size_t h = 0; h + 1 < hardBounds.size(); h++)
+    {
+      size_t start = hardBounds[h];
+      size_t end = hardBounds[h + 1];
+
+      timestamps.assign(numVertices, 0);
+      time = cacheSize + 1;
+      unsigned int clusterMisses = 0;
+      for (size_t t = start; t < end; t++)
+        clusterMisses += cacheTriangle(&indices[t * 3], timestamps, time, cacheSize);
+
+      float clusterThreshold = threshold * (float)clusterMisses / (float)(end - start);
+
+      timestamps.assign(numVertices, 0);
+      time = cacheSize + 1;
+      unsigned int misses = 0;
+      size_t softStart = start;
+      for (size_t t = start; t < end; t++)
+      {
+        misses += cacheTriangle(&indices[t * 3], timestamps, time, cacheSize);
+        if ((t + 1 < end) && ((float)misses / (float)(t + 1 - softStart) <= clusterThreshold))
+        {
+          OverdrawCluster cluster;
+          cluster.start = softStart;
+          cluster.end = t + 1;
+          cluster.sortKey = 0.0f;
+          clusters.push_back(cluster);
+
+          //the next cluster start with an empty cache
+          timestamps.assign(numVertices, 0);
+          time = cacheSize + 1;
+          misses = 0;
+          softStart = t + 1;
+        }
+      }
+
+      OverdrawCluster cluster;
+      cluster.start = softStart;
+      cluster.end = end;
+      cluster.sortKey = 0.0f;
+      clusters.push_back(cluster);
+    }
+
+    if (clusters.size() < 2)
+      return;
+
+    //mesh centroid
+    float meshCenter[3] = {0.0f, 0.0f, 0.0f};
+    for (size_t i = 0; i < numTriangles * 3; i++)
+    {
+      const float* p = &positions[indices[i] * 3];
+      meshCenter[0] += p[0];
+      meshCenter[1] += p[1];
+      meshCenter[2] += p[2];
+    }
+    for (int k = 0; k < 3; k++)
+      meshCenter[k] /= (float)(numTriangles * 3);
+
+    //cluster area weighted centroid and normal
+    for (size_t c = 0; c < clusters.size(); c++)
+    {
+      float center[3] = {0.0f, 0.0f, 0.0f};
+      float normal[3] = {0.0f, 0.0f, 0.0f};
+      float area = 0.0f;
+      for (size_t t = clusters[c].start; t < clusters[c].end; t++)
+      {
+        const float* p0 = &positions[indices[t * 3] * 3];
+        const float* p1 = &positions[indices[t * 3 + 1] * 3];
+        const float* p2 = &positions[indices[t * 3 + 2] * 3];
+
+        float e1[3] = {p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2]};
+        float e2[3] = {p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2]};
+        float n[3] = {e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0]};
+        float triArea = sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+
+        for (int k = 0; k < 3; k++)
+        {
+          center[k] += (p0[k] + p1[k] + p2[k]) * (triArea / 3.0f);
+          normal[k] += n[k];
+        }
+        area += triArea;
+      }
+
+      float nlen = sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+      if ((area > 0.0f) && (nlen > 0.0f))
+      {
+        float key = 0.0f;
+        for (int k = 0; k < 3; k++)
+          key += ((center[k] / area) - meshCenter[k]) * (normal[k] / nlen);
+        clusters[c].sortKey = key;
+      }
+    }
+
+    std::stable_sort(clusters.begin(), clusters.end());
+
+    std::vector<int> newIndices;
+    newIndices.reserve(numTriangles * 3);
+    size_t n = 0;
+    for (size_t c = 0; c < clusters.size(); c++)
+    {
+      for (size_t t = clusters[c].start; t < clusters[c].end; t++)
+      {
+        newIndices.insert(newIndices.end(), indices.begin() + (t * 3), indices.begin() + (t * 3) + 3);
+        if (triangleOrder)
+          (*triangleOrder)[n] = t;
+        n++;
+      }
+    }
+    indices.swap(newIndices);
+  }
+
+  void optimizeVertexFetch(std::vector<int>& indices, unsigned int numVertices, std::vector<int>& vertexOrder)
+  {
+    std::vector<int> remapTable;
+    std::vector<int> newIndices;
+    remapIndices(indices, numVertices, newIndices, vertexOrder, remapTable);
+    indices.swap(newIndices);
+  }
+
+  float computeACMR(const std::vector<int>& indices, unsigned int numVertices, unsigned int cacheSize, float* atvr)
+  {
+    size_t numTriangles = indices.size() / 3;
+    if (numTriangles == 0)
+    {
+      if (atvr)
+        *atvr = 0.0f;
+      return 0.0f;
+    }
+
+    //a vertex is in the FIFO cache if it was pushed during the last cacheSize misses
+    std::vector<unsigned int> timestamps(numVertices, 0);
+    unsigned int time = cacheSize + 1;
+    unsigned int misses = 0;
+    unsigned int numUsed = 0;
+    for (size_t i = 0; i < numTriangles * 3; i++)
+    {
+      int v = indices[i];
+      if (timestamps[v] == 0)
+        numUsed++;
+
+      if ((time - timestamps[v]) > cacheSize)
+      {
+        timestamps[v] = time++;
+        misses++;
+      }
+    }
+
+    if (atvr)
+      *atvr = (numUsed > 0) ? (float)misses / (float)numUsed : 0.0f;
+
+    return (float)misses / (float)numTriangles;
+  }
+
+}; //end of namespace
@@ -0,0 +1,563 @@
+////////////////////////////////////////////////////////////////////////////////
+// ExMeshSerializer.cpp
+// Start Date : October 17, 2026
+////////////////////////////////////////////////////////////////////////////////
+/*********************************************************************************
+*                                                                                *
+*   This program is free software; you can redistribute it and/or modify         *
+*   it under the terms of the GNU Lesser General Public License as published by  *
+*   the Free Software Foundation; either version 2 of the License, or            *
+*   (at your option) any later version.                                          *
+*                                                                                *
+**********************************************************************************/
+
+#include "ExMeshSerializer.h"
+#include "ExBoneWeights.h"
+#include <float.h>
+#include <math.h>
+#include <string.h>
+#include <algorithm>
+
+namespace EasyOgreExporter
+{
+  //vertices converted at once in the staging buffer
+  static const size_t STAGING_VERTICES = 4096;
+
+  //Ogre VertexElementLess, by semantic then index
+  static bool elementLess(const ExVertexElement& e1, const ExVertexElement& e2)
+  {
+    if (e1.semantic != e2.semantic)
+      return e1.semantic < e2.semantic;
+    return e1.index < e2.index;
+  }
+
+  static bool assignmentLess(const ExBoneAssignment& a1, const ExBoneAssignment& a2)
+  {
+    return a1.weight < a2.weight;
+  }
+
+  //Ogre ColourValue::getAsARGB / getAsABGR, no rounding
+  static inline unsigned int packColour(const float* col, bool argb)
+  {
+    unsigned int r = static_cast<unsigned char>(col[0] * 255);
+    unsigned int g = static_cast<unsigned char>(col[1] * 255);
+    unsigned int b = static_cast<unsigned char>(col[2] * 255);
+    unsigned int a = static_cast<unsigned char>(col[3] * 255);
+    if (argb)
+      return (a << 24) | (r << 16) | (g << 8) | b;
+    return (a << 24) | (b << 16) | (g << 8) | r;
+  }
+
+  ExMeshSerializer::ExMeshSerializer()
+  {
+    m_failed = false;
+  }
+
+  ExMeshSerializer::~ExMeshSerializer()
+  {
+    if (m_file.is_open())
+      m_file.close();
+  }
+
+  bool ExMeshSerializer::open(const std::string& path, const std::string& version)
+  {
+    m_chunkStarts.clear();
+    m_failed = false;
+    m_file.open(path.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!m_file)
+      return false;
+
+    //the header has no size
+    writeShort(EX_M_HEADER);
+    writeString(version);
+    return !m_failed;
+  }
+
+  bool ExMeshSerializer::close()
+  {
+    if (!m_chunkStarts.empty())
+      m_failed = true;
+
+    m_file.close();
+    if (m_file.fail())
+      m_failed = true;
+
+    return !m_failed;
+  }
+
+  void ExMeshSerializer::beginChunk(unsigned short id)
+  {
+    m_chunkStarts.push_back(m_file.tellp());
+    writeShort(id);
+    //patched by endChunk
+    writeInt(0);
+  }
+
+  void ExMeshSerializer::endChunk()
+  {
+    if (m_chunkStarts.empty())
+    {
+      m_failed = true;
+      return;
+    }
+
+    //the size include the chunk header
+    std::streampos start = m_chunkStarts.back();
+    m_chunkStarts.pop_back();
+    std::streampos end = m_file.tellp();
+    unsigned int size = static_cast<unsigned int>(end - start);
+
+    m_file.seekp(start + std::streamoff(sizeof(unsigned short)));
+    writeInt(size);
+    m_file.seekp(end);
+    if (!m_file)
+      m_failed = true;
+  }
+
+  void ExMeshSerializer::beginMesh(bool skeletallyAnimated)
+  {
+    beginChunk(EX_M_MESH);
+    writeBool(skeletallyAnimated);
+  }
+
+  void ExMeshSerializer::beginSubMesh(const std::string& material, bool useSharedVertices, const std::vector<unsigned int>& indices)
+  {
+    beginChunk(EX_M_SUBMESH);
+    writeString(material);
+    writeBool(useSharedVertices);
+
+    unsigned int maxIndex = 0;
+    for (size_t i = 0; i < indices.size(); i++)
+    {
+      if (indices[i] > maxIndex)
+        maxIndex = indices[i];
+    }
+
+    bool use32BitIndexes = (maxIndex > 65535) ? true : false;
+    writeInt(static_cast<unsigned int>(indices.size()));
+    writeBool(use32BitIndexes);
+
+    if (indices.empty())
+      return;
+
+    if (use32BitIndexes)
+    {
+      writeData(&indices[0], indices.size() * sizeof(unsigned int));
+    }
+    else
+    {
+      std::vector<unsigned short> indices16(indices.begin(), indices.end());
+      writeData(&indices16[0], indices16.size() * sizeof(unsigned short));
+    }
+  }
+
+  void ExMeshSerializer::writeSubMeshOperation(unsigned short operationType)
+  {
+    beginChunk(EX_M_SUBMESH_OPERATION);
+    writeShort(operationType);
+    endChunk();
+  }
+
+  void ExMeshSerializer::writeGeometry(const ExVertexStore& store, const std::vector<unsigned int>& vertices, const std::vector<ExVertexElement>& elements, bool colourARGB)
+  {
+    size_t numVertices = vertices.size();
+    beginChunk(EX_M_GEOMETRY);
+    writeInt(static_cast<unsigned int>(numVertices));
+
+    beginChunk(EX_M_GEOMETRY_VERTEX_DECLARATION);
+    unsigned short maxSource = 0;
+    for (size_t i = 0; i < elements.size(); i++)
+    {
+      const ExVertexElement& elem = elements[i];
+      beginChunk(EX_M_GEOMETRY_VERTEX_ELEMENT);
+      writeShort(elem.source);
+      writeShort(elem.type);
+      writeShort(elem.semantic);
+      writeShort(elem.offset);
+      writeShort(elem.index);
+      endChunk();
+
+      if (elem.source > maxSource)
+        maxSource = elem.source;
+    }
+    endChunk();
+
+    //one buffer per source, filled one element at a time in the staging buffer
+    std::vector<unsigned char> staging;
+    unsigned int numInfluences = store.getNumInfluences();
+
+    //the blend indices go through the index map Ogre builds from the bone assignments of these vertices
+    std::vector<int> blendIndices;
+    for (size_t i = 0; i < elements.size(); i++)
+    {
+      if (elements[i].semantic == EX_VES_BLEND_INDICES)
+      {
+        buildBlendIndexMap(store, vertices, blendIndices);
+        break;
+      }
+    }
+    for (unsigned short source = 0; !elements.empty() && (source <= maxSource); source++)
+    {
+      size_t stride = 0;
+      for (size_t i = 0; i < elements.size(); i++)
+      {
+        if (elements[i].source == source)
+          stride += getTypeSize(elements[i].type);
+      }
+
+      if (stride == 0)
+        continue;
+
+      beginChunk(EX_M_GEOMETRY_VERTEX_BUFFER);
+      writeShort(source);
+      writeShort(static_cast<unsigned short>(stride));
+
+      beginChunk(EX_M_GEOMETRY_VERTEX_BUFFER_DATA);
+      staging.resize(stride * std::min(numVertices, STAGING_VERTICES));
+      for (size_t first = 0; first < numVertices; first += STAGING_VERTICES)
+      {
+        size_t count = std::min(numVertices - first, STAGING_VERTICES);
+        for (size_t i = 0; i < elements.size(); i++)
+        {
+          const ExVertexElement& elem = elements[i];
+          if (elem.source != source)
+            continue;
+
+          unsigned char* pDest = &staging[elem.offset];
+          for (size_t v = first; v < (first + count); v++, pDest += stride)
+          {
+            unsigned int handle = vertices[v];
+            switch (elem.semantic)
+            {
+            case EX_VES_POSITION:
+              memcpy(pDest, store.getPosition(handle), 3 * sizeof(float));
+              break;
+
+            case EX_VES_NORMAL:
+              memcpy(pDest, store.getNormal(handle), 3 * sizeof(float));
+              break;
+
+            case EX_VES_DIFFUSE:
+            {
+              unsigned int colour = packColour(store.getColor(handle), colourARGB);
+              memcpy(pDest, &colour, sizeof(unsigned int));
+            }
+            break;
+
+            case EX_VES_TEXTURE_COORDINATES:
+              if (elem.type == EX_VET_FLOAT2)
+                memcpy(pDest, store.getTexCoord(handle, elem.index), 2 * sizeof(float));
+              else
+                memcpy(pDest, store.getTangent(handle), getTypeSize(elem.type));
+              break;
+
+            case EX_VES_TANGENT:
+              memcpy(pDest, store.getTangent(handle), getTypeSize(elem.type));
+              break;
+
+            case EX_VES_BLEND_INDICES:
+              packBlendIndices(store.getWeights(handle), store.getBoneIndices(handle), std::min(numInfluences, 4u), blendIndices, pDest);
+              break;
+
+            case EX_VES_BLEND_WEIGHTS:
+            {
+              const float* weights = store.getWeights(handle);
+              if (elem.type == EX_VET_UBYTE4_NORM)
+              {
+                memset(pDest, 0, 4);
+                quantizeWeights(weights, std::min(numInfluences, 4u), pDest);
+              }
+              else
+              {
+                unsigned int numWeights = getTypeSize(elem.type) / sizeof(float);
+                float* pFloat = reinterpret_cast<float*>(pDest);
+                for (unsigned int k = 0; k < numWeights; k++)
+                  pFloat[k] = (k < numInfluences) ? weights[k] : 0.0f;
+              }
+            }
+            break;
+
+            default:
+              memset(pDest, 0, getTypeSize(elem.type));
+              break;
+            }
+          }
+        }
+        writeData(&staging[0], stride * count);
+      }
+      endChunk();
+      endChunk();
+    }
+    endChunk();
+  }
+
+  void ExMeshSerializer::writeBoneAssignments(unsigned short chunkId, const std::vector<ExBoneAssignment>& assignments)
+  {
+    for (size_t i = 0; i < assignments.size(); i++)
+    {
+      beginChunk(chunkId);
+      writeInt(assignments[i].vertexIndex);
+      writeShort(assignments[i].boneIndex);
+      writeFloat(assignments[i].weight);
+      endChunk();
+    }
+  }
+
+  void ExMeshSerializer::writeSkeletonLink(const std::string& skeletonName)
+  {
+    beginChunk(EX_M_MESH_SKELETON_LINK);
+    writeString(skeletonName);
+    endChunk();
+  }
+
+  void ExMeshSerializer::writeBounds(const float* min, const float* max, float radius)
+  {
+    beginChunk(EX_M_MESH_BOUNDS);
+    writeData(min, 3 * sizeof(float));
+    writeData(max, 3 * sizeof(float));
+    writeFloat(radius);
+    endChunk();
+  }
+
+  void ExMeshSerializer::writeSubMeshNameTable(const std::vector<std::pair<std::string, unsigned short> >& names)
+  {
+    beginChunk(EX_M_SUBMESH_NAME_TABLE);
+    for (size_t i = 0; i < names.size(); i++)
+    {
+      beginChunk(EX_M_SUBMESH_NAME_TABLE_ELEMENT);
+      writeShort(names[i].second);
+      writeString(names[i].first);
+      endChunk();
+    }
+    endChunk();
+  }
+
+  void ExMeshSerializer::writeEdgeList(const ExEdgeData& edgeData, bool oldFormat)
+  {
+    beginChunk(EX_M_EDGE_LISTS);
+    beginChunk(EX_M_EDGE_LIST_LOD);
+    writeShort(0);
+    //not a manual level
+    writeBool(false);
+    if (!oldFormat)
+      writeBool(edgeData.isClosed);
+    writeInt(edgeData.triangles.size());
+    writeInt(edgeData.edgeGroups.size());
+
+    for (size_t t = 0; t < edgeData.triangles.size(); t++)
+    {
+      const ExEdgeTriangle& tri = edgeData.triangles[t];
+      writeInt(tri.indexSet);
+      writeInt(tri.vertexSet);
+      writeData(tri.vertIndex, 3 * sizeof(unsigned int));
+      writeData(tri.sharedVertIndex, 3 * sizeof(unsigned int));
+      writeData(&edgeData.faceNormals[t * 4], 4 * sizeof(float));
+    }
+
+    for (size_t g = 0; g < edgeData.edgeGroups.size(); g++)
+    {
+      const ExEdgeGroup& group = edgeData.edgeGroups[g];
+      beginChunk(EX_M_EDGE_GROUP);
+      writeInt(group.vertexSet);
+      if (!oldFormat)
+      {
+        writeInt(group.triStart);
+        writeInt(group.triCount);
+      }
+      writeInt(group.edges.size());
+      for (size_t e = 0; e < group.edges.size(); e++)
+      {
+        const ExEdge& edge = group.edges[e];
+        writeData(edge.triIndex, 2 * sizeof(unsigned int));
+        writeData(edge.vertIndex, 2 * sizeof(unsigned int));
+        writeData(edge.sharedVertIndex, 2 * sizeof(unsigned int));
+        writeBool(edge.degenerate);
+      }
+      endChunk();
+    }
+    endChunk();
+    endChunk();
+  }
+
+  void ExMeshSerializer::writeBool(bool value)
+  {
+    //Ogre write a bool on one byte
+    char byte = value ? 1 : 0;
+    writeData(&byte, 1);
+  }
+
+  void ExMeshSerializer::writeShort(unsigned short value)
+  {
+    writeData(&value, sizeof(unsigned short));
+  }
+
+  void ExMeshSerializer::writeInt(unsigned int value)
+  {
+    writeData(&value, sizeof(unsigned int));
+  }
+
+  void ExMeshSerializer::writeFloat(float value)
+  {
+    writeData(&value, sizeof(float));
+  }
+
+  void ExMeshSerializer::writeString(const std::string& value)
+  {
+    writeData(value.c_str(), value.size());
+    writeData("\n", 1);
+  }
+
+  void ExMeshSerializer::writeData(const void* data, size_t size)
+  {
+    if (size == 0)
+      return;
+
+    m_file.write(static_cast<const char*>(data), size);
+    if (!m_file)
+      m_failed = true;
+  }
+
+  std::vector<ExVertexElement> ExMeshSerializer::organiseElements(const std::vector<ExVertexElement>& elements, bool skeletalAnimation, bool vertexAnimation, bool vertexAnimationNormals)
+  {
+    std::vector<ExVertexElement> elems = elements;
+    std::stable_sort(elems.begin(), elems.end(), elementLess);
+
+    unsigned short offset = 0;
+    unsigned short buffer = 0;
+    unsigned short prevSemantic = EX_VES_POSITION;
+    for (size_t i = 0; i < elems.size(); i++)
+    {
+      ExVertexElement& elem = elems[i];
+      bool splitWithPrev = false;
+      bool splitWithNext = false;
+      switch (elem.semantic)
+      {
+      case EX_VES_POSITION:
+        //positions alone when only they are vertex animated
+        splitWithNext = vertexAnimation && !vertexAnimationNormals;
+        break;
+
+      case EX_VES_NORMAL:
+        splitWithPrev = (prevSemantic == EX_VES_BLEND_WEIGHTS) || (prevSemantic == EX_VES_BLEND_INDICES);
+        splitWithNext = skeletalAnimation || (vertexAnimation && vertexAnimationNormals);
+        break;
+
+      case EX_VES_BLEND_WEIGHTS:
+        splitWithPrev = true;
+        break;
+
+      case EX_VES_BLEND_INDICES:
+        splitWithNext = true;
+        break;
+
+      default:
+        //animated positions without normals stay alone
+        splitWithPrev = (prevSemantic == EX_VES_POSITION) && (skeletalAnimation || vertexAnimation);
+        break;
+      }
+
+      if (splitWithPrev && offset)
+      {
+        buffer++;
+        offset = 0;
+      }
+
+      prevSemantic = elem.semantic;
+      elem.source = buffer;
+      elem.offset = offset;
+
+      if (splitWithNext)
+      {
+        buffer++;
+        offset = 0;
+      }
+      else
+      {
+        offset += getTypeSize(elem.type);
+      }
+    }
+    return elems;
+  }
+
+  unsigned short ExMeshSerializer::getTypeSize(unsigned short type)
+  {
+    switch (type)
+    {
+    case EX_VET_FLOAT1:
+      return sizeof(float);
+    case EX_VET_FLOAT2:
+      return 2 * sizeof(float);
+    case EX_VET_FLOAT3:
+      return 3 * sizeof(float);
+    case EX_VET_FLOAT4:
+      return 4 * sizeof(float);
+    case EX_VET_COLOUR:
+    case EX_VET_UBYTE4:
+    case EX_VET_UBYTE4_NORM:
+      return sizeof(unsigned int);
+    default:
+      return 0;
+    }
+  }
+
+  std::vector<ExBoneAssignment> ExMeshSerializer::rationaliseBoneAssignments(const ExVertexStore& store, const std::vector<unsigned int>& vertices, unsigned int maxWeights)
+  {
+    std::vector<ExBoneAssignment> assignments;
+    std::vector<ExBoneAssignment> vertexAssignments;
+    std::vector<ExBoneAssignment> sorted;
+    unsigned int numInfluences = store.getNumInfluences();
+    if (numInfluences == 0)
+      return assignments;
+
+    for (size_t i = 0; i < vertices.size(); i++)
+    {
+      const float* weights = store.getWeights(vertices[i]);
+      const int* bones = store.getBoneIndices(vertices[i]);
+
+      vertexAssignments.clear();
+      for (unsigned int j = 0; j < numInfluences; j++)
+      {
+        if (weights[j] > 0.0f)
+        {
+          ExBoneAssignment vba;
+          vba.vertexIndex = static_cast<unsigned int>(i);
+          vba.boneIndex = static_cast<unsigned short>(bones[j]);
+          vba.weight = weights[j];
+          vertexAssignments.push_back(vba);
+        }
+      }
+
+      //remove the lowest weights, the first added first on equal weights
+      if (vertexAssignments.size() > maxWeights)
+      {
+        sorted = vertexAssignments;
+        std::stable_sort(sorted.begin(), sorted.end(), assignmentLess);
+        for (size_t k = 0; k < (sorted.size() - maxWeights); k++)
+        {
+          for (size_t l = 0; l < vertexAssignments.size(); l++)
+          {
+            if ((vertexAssignments[l].boneIndex == sorted[k].boneIndex) && (vertexAssignments[l].weight == sorted[k].weight))
+            {
+              vertexAssignments.erase(vertexAssignments.begin() + l);
+              break;
+            }
+          }
+        }
+      }
+
+      float totalWeight = 0.0f;
+      for (size_t k = 0; k < vertexAssignments.size(); k++)
+        totalWeight += vertexAssignments[k].weight;
+
+      if (fabs(1.0f - totalWeight) > FLT_EPSILON)
+      {
+        for (size_t k = 0; k < vertexAssignments.size(); k++)
+          vertexAssignments[k].weight = vertexAssignments[k].weight / totalWeight;
+      }
+
+      assignments.insert(assignments.end(), vertexAssignments.begin(), vertexAssignments.end());
+    }
+    return assignments;
+  }
+
+}; //end of namespace
@@ -0,0 +1,734 @@
+////////////////////////////////////////////////////////////////////////////////
+// ExMeshSimplifier.cpp
+// Start Date : October 17, 2026
+////////////////////////////////////////////////////////////////////////////////
+/*********************************************************************************
+*                                                                                *
+*   This program is free software; you can redistribute it and/or modify         *
+*   it under the terms of the GNU Lesser General Public License as published by  *
+*   the Free Software Foundation; either version 2 of the License, or            *
+*   (at your option) any later version.                                          *
+*                                                                                *
+**********************************************************************************/
+
+#include "ExMeshSimplifier.h"
+#include <math.h>
+#include <string.h>
+#include <algorithm>
+#include <unordered_map>
+
+namespace EasyOgreExporter
+{
+  static const unsigned int INVALID_INDEX = 0xffffffff;
+
+  //weight of the planes keeping the open borders, relative to the faces planes
+  static const double BORDER_WEIGHT = 10.0;
+
+  //attribute costs against the squared distances of the mesh scaled to a unit size
+  static const double ATTRIBUTE_SCALE = 0.01;
+
+  //a pass stops once the costs go over this factor of the cost expected to reach the target
+  static const double PASS_ERROR_FACTOR = 1.5;
+
+  static const unsigned int MAX_PASSES = 100;
+
+  // plane quadric, the error of a point is its weighted squared distance to the planes
+  class ExQuadric
+  {
+  public:
+    ExQuadric()
+    {
+      a2 = b2 = c2 = d2 = ab = ac = ad = bc = bd = cd = w = 0.0;
+    };
+
+    void addPlane(double a, double b, double c, double d, double weight)
+    {
+      a2 += a * a * weight;
+      b2 += b * b * weight;
+      c2 += c * c * weight;
+      d2 += d * d * weight;
+      ab += a * b * weight;
+      ac += a * c * weight;
+      ad += a * d * weight;
+      bc += b * c * weight;
+      bd += b * d * weight;
+      cd += c * d * weight;
+      w += weight;
+    };
+
+    void add(const ExQuadric& q)
+    {
+      a2 += q.a2;
+      b2 += q.b2;
+      c2 += q.c2;
+      d2 += q.d2;
+      ab += q.ab;
+      ac += q.ac;
+      ad += q.ad;
+      bc += q.bc;
+      bd += q.bd;
+      cd += q.cd;
+      w += q.w;
+    };
+
+    double eval(const float* p) const
+    {
+      double x = p[0];
+      double y = p[1];
+      double z = p[2];
+      double err = (a2 * x * x) + (b2 * y * y) + (c2 * z * z) + d2 +
+        2.0 * ((ab * x * y) + (ac * x * z) + (ad * x) + (bc * y * z) + (bd * y) + (cd * z));
+      return (err > 0.0) ? err : 0.0;
+    };
+
+    double a2, b2, c2, d2, ab, ac, ad, bc, bd, cd;
+    //sum of the planes weights (area of the faces)
+    double w;
+  };
+
+  class ExPositionKey
+  {
+  public:
+    unsigned int bits[3];
+
+    bool operator==(const ExPositionKey& b) const
+    {
+      return (bits[0] == b.bits[0]) && (bits[1] == b.bits[1]) && (bits[2] == b.bits[2]);
+    };
+  };
+
+  class ExPositionKeyHash
+  {
+  public:
+    size_t operator()(const ExPositionKey& k) const
+    {
+      return (k.bits[0] * 73856093u) ^ (k.bits[1] * 19349663u) ^ (k.bits[2] * 83492791u);
+    };
+  };
+
+  //Visual Studio 2008 only has the TR1 hash map
+#if defined(_MSC_VER) && (_MSC_VER < 1600)
+  typedef std::tr1::unordered_map<ExPositionKey, unsigned int, ExPositionKeyHash> ExPositionMap;
+#else
+  typedef std::unordered_map<ExPositionKey, unsigned int, ExPositionKeyHash> ExPositionMap;
+#endif
+
+  class ExCollapse
+  {
+  public:
+    unsigned int from;
+    unsigned int to;
+    double cost;
+
+    bool operator<(const ExCollapse& b) const
+    {
+      return cost < b.cost;
+    };
+  };
+
+  static inline void sub3(const float* a, const float* b, double* r)
+  {
+    r[0] = (double)a[0] - b[0];
+    r[1] = (double)a[1] - b[1];
+    r[2] = (double)a[2] - b[2];
+  }
+
+  static inline void cross3(const double* a, const double* b, double* r)
+  {
+    r[0] = (a[1] * b[2]) - (a[2] * b[1]);
+    r[1] = (a[2] * b[0]) - (a[0] * b[2]);
+    r[2] = (a[0] * b[1]) - (a[1] * b[0]);
+  }
+
+  static inline double dot3(const double* a, const double* b)
+  {
+    return (a[0] * b[0]) + (a[1] * b[1]) + (a[2] * b[2]);
+  }
+
+  static inline unsigned long long edgeKey(unsigned int a, unsigned int b)
+  {
+    return ((unsigned long long)a << 32) | b;
+  }
+
+  // working state of one simplification, nothing is shared between the levels
+  class ExSimplifier
+  {
+  public:
+    ExSimplifier(const ExVertexStore& store, const ExSimplifyOptions& options) :
+      m_store(store),
+      m_options(options)
+    {
+    };
+
+    size_t run(const std::vector<std::vector<unsigned int> >& subMeshIndices, float ratio, std::vector<std::vector<unsigned int> >& result);
+
+  private:
+    void buildPositions(const std::vector<std::vector<unsigned int> >& subMeshIndices);
+    void buildQuadrics();
+    void buildAdjacency();
+    bool hasEdge(unsigned int a, unsigned int b) const;
+    unsigned int findTarget(unsigned int vertex, unsigned int position) const;
+    double getAttributeCost(unsigned int a, unsigned int b) const;
+    bool canCollapse(unsigned int from, unsigned int to, double& cost) const;
+    bool hasFlip(unsigned int from, unsigned int to) const;
+    unsigned int collapsePass(size_t target);
+
+    const float* getPosition(unsigned int p) const
+    {
+      return &m_positions[p * 3];
+    };
+
+    const ExVertexStore& m_store;
+    const ExSimplifyOptions& m_options;
+
+    //current triangles and their submesh
+    std::vector<unsigned int> m_triangles;
+    std::vector<unsigned int> m_triangleSubMesh;
+
+    //position of each vertex, and the vertices of each position
+    std::vector<unsigned int> m_vertexPosition;
+    std::vector<unsigned int> m_siblingStart;
+    std::vector<unsigned int> m_siblings;
+
+    //positions scaled to a unit size, submesh using them (-1 for several)
+    std::vector<float> m_positions;
+    std::vector<int> m_positionSubMesh;
+    std::vector<ExQuadric> m_quadrics;
+
+    //triangles of each vertex
+    std::vector<unsigned int> m_adjacencyStart;
+    std::vector<unsigned int> m_adjacency;
+
+    //sorted directed position edges, open border neighbors and locked positions
+    std::vector<unsigned long long> m_edges;
+    std::vector<unsigned int> m_borderCount;
+    std::vector<unsigned int> m_borderNeighbors;
+    std::vector<unsigned char> m_locked;
+
+    std::vector<unsigned int> m_remap;
+  };
+
+  void ExSimplifier::buildPositions(const std::vector<std::vector<unsigned int> >& subMeshIndices)
+  {
+    unsigned int numVertices = m_store.size();
+    m_vertexPosition.assign(numVertices, INVALID_INDEX);
+    m_positions.clear();
+    m_positionSubMesh.clear();
+    m_triangles.clear();
+    m_triangleSubMesh.clear();
+
+    ExPositionMap positionMap;
+    for (size_t s = 0; s < subMeshIndices.size(); s++)
+    {
+      const std::vector<unsigned int>& indices = subMeshIndices[s];
+      for (size_t i = 0; (i + 2) < indices.size(); i += 3)
+      {
+        for (int k = 0; k < 3; k++)
+        {
+          unsigned int v = indices[i + k];
+          unsigned int p = m_vertexPosition[v];
+          if (p == INVALID_INDEX)
+          {
+            const float* pos = m_store.getPosition(v);
+            ExPositionKey key;
+            memcpy(key.bits, pos, sizeof(key.bits));
+            //-0 and 0 are the same position
+            for (int c = 0; c < 3; c++)
+            {
+              if (key.bits[c] == 0x80000000)
+                key.bits[c] = 0;
+            }
+
+            std::pair<ExPositionMap::iterator, bool> ins = positionMap.insert(std::make_pair(key, (unsigned int)m_positionSubMesh.size()));
+            if (ins.second)
+            {
+              m_positions.insert(m_positions.end(), pos, pos + 3);
+              m_positionSubMesh.push_back((int)s);
+            }
+            p = ins.first->second;
+            m_vertexPosition[v] = p;
+          }
+
+          if (m_positionSubMesh[p] != (int)s)
+            m_positionSubMesh[p] = -1;
+
+          m_triangles.push_back(v);
+        }
+        m_triangleSubMesh.push_back((unsigned int)s);
+      }
+    }
+
+    unsigned int numPositions = m_positionSubMesh.size();
+    m_siblingStart.assign(numPositions + 1, 0);
+    for (unsigned int v = 0; v < numVertices; v++)
+    {
+      if (m_vertexPosition[v] != INVALID_INDEX)
+        m_siblingStart[m_vertexPosition[v] + 1]++;
+    }
+    for (unsigned int p = 0; p < numPositions; p++)
+      m_siblingStart[p + 1] += m_siblingStart[p];
+
+    m_siblings.resize(m_siblingStart[numPositions]);
+    std::vector<unsigned int> fill(m_siblingStart.begin(), m_siblingStart.end() - 1);
+    for (unsigned int v = 0; v < numVertices; v++)
+    {
+      if (m_vertexPosition[v] != INVALID_INDEX)
+        m_siblings[fill[m_vertexPosition[v]]++] = v;
+    }
+
+    //unit size so the costs do not depend on the scene scale
+    if (numPositions == 0)
+      return;
+
+    float minPos[3] = {m_positions[0], m_positions[1], m_positions[2]};
+    float maxPos[3] = {m_positions[0], m_positions[1], m_positions[2]};
+    for (size_t i = 0; i < m_positions.size(); i += 3)
+    {
+      for (int c = 0; c < 3; c++)
+      {
+        minPos[c] = std::min(minPos[c], m_positions[i + c]);
+        maxPos[c] = std::max(maxPos[c], m_positions[i + c]);
+      }
+    }
+
+    float extent = std::max(maxPos[0] - minPos[0], std::max(maxPos[1] - minPos[1], maxPos[2] - minPos[2]));
+    float scale = (extent > 0.0f) ? (1.0f / extent) : 1.0f;
+    for (size_t i = 0; i < m_positions.size(); i += 3)
+    {
+      for (int c = 0; c < 3; c++)
+        m_positions[i + c] = (m_positions[i + c] - minPos[c]) * scale;
+    }
+  }
+
+  void ExSimplifier::buildQuadrics()
+  {
+    m_quadrics.assign(m_positionSubMesh.size(), ExQuadric());
+
+    size_t numTriangles = m_triangles.size() / 3;
+    for (size_t t = 0; t < numTriangles; t++)
+    {
+      unsigned int p[3];
+      for (int k = 0; k < 3; k++)
+        p[k] = m_vertexPosition[m_triangles[(t * 3) + k]];
+
+      double e1[3], e2[3], n[3];
+      sub3(getPosition(p[1]), getPosition(p[0]), e1);
+      sub3(getPosition(p[2]), getPosition(p[0]), e2);
+      cross3(e1, e2, n);
+      double len = sqrt(dot3(n, n));
+      if (len <= 0.0)
+        continue;
+
+      n[0] /= len;
+      n[1] /= len;
+      n[2] /= len;
+
+      const float* a = getPosition(p[0]);
+      double d = -((n[0] * a[0]) + (n[1] * a[1]) + (n[2] * a[2]));
+      double area = len * 0.5;
+      for (int k = 0; k < 3; k++)
+        m_quadrics[p[k]].addPlane(n[0], n[1], n[2], d, area);
+
+      //planes through the open borders, orthogonal to the face
+      for (int k = 0; k < 3; k++)
+      {
+        unsigned int pa = p[k];
+        unsigned int pb = p[(k + 1) % 3];
+        if (hasEdge(pb, pa))
+          continue;
+
+        double e[3], m[3];
+        sub3(getPosition(pb), getPosition(pa), e);
+        cross3(e, n, m);
+        double mlen = sqrt(dot3(m, m));
+        if (mlen <= 0.0)
+          continue;
+
+        m[0] /= mlen;
+        m[1] /= mlen;
+        m[2] /= mlen;
+        const float* pos = getPosition(pa);
+        double md = -((m[0] * pos[0]) + (m[1] * pos[1]) + (m[2] * pos[2]));
+        double weight = dot3(e, e) * BORDER_WEIGHT;
+        m_quadrics[pa].addPlane(m[0], m[1], m[2], md, weight);
+        m_quadrics[pb].addPlane(m[0], m[1], m[2], md, weight);
+      }
+    }
+  }
+
+  void ExSimplifier::buildAdjacency()
+  {
+    unsigned int numVertices = m_store.size();
+    unsigned int numPositions = m_positionSubMesh.size();
+    size_t numTriangles = m_triangles.size() / 3;
+
+    //triangles of each vertex
+    m_adjacencyStart.assign(numVertices + 1, 0);
+    for (size_t i = 0; i < m_triangles.size(); i++)
+      m_adjacencyStart[m_triangles[i] + 1]++;
+    for (unsigned int v = 0; v < numVertices; v++)
+      m_adjacencyStart[v + 1] += m_adjacencyStart[v];
+
+    m_adjacency.resize(m_triangles.size());
+    std::vector<unsigned int> fill(m_adjacencyStart.begin(), m_adjacencyStart.end() - 1);
+    for (size_t i = 0; i < m_triangles.size(); i++)
+      m_adjacency[fill[m_triangles[i]]++] = (unsigned int)(i / 3);
+
+    //directed position edges
+    m_edges.resize(m_triangles.size());
+    for (size_t t = 0; t < numTriangles; t++)
+    {
+      for (int k = 0; k < 3; k++)
+      {
+        unsigned int pa = m_vertexPosition[m_triangles[(t * 3) + k]];
+        unsigned int pb = m_vertexPosition[m_triangles[(t * 3) + ((k + 1) % 3)]];
+        m_edges[(t * 3) + k] = edgeKey(pa, pb);
+      }
+    }
+    std::sort(m_edges.begin(), m_edges.end());
+
+    //open borders, a position on more than one border or on a non manifold edge is locked
+    m_borderCount.assign(numPositions, 0);
+    m_borderNeighbors.assign(numPositions * 2, INVALID_INDEX);
+    m_locked.assign(numPositions, 0);
+    for (size_t i = 0; i < m_edges.size(); i++)
+    {
+      unsigned int pa = (unsigned int)(m_edges[i] >> 32);
+      unsigned int pb = (unsigned int)(m_edges[i] & 0xffffffff);
+      if ((i > 0) && (m_edges[i - 1] == m_edges[i]))
+      {
+        m_locked[pa] = 1;
+        m_locked[pb] = 1;
+        continue;
+      }
+
+      if (hasEdge(pb, pa))
+        continue;
+
+      unsigned int ends[2] = {pa, pb};
+      for (int e = 0; e < 2; e++)
+      {
+        unsigned int p = ends[e];
+        if (m_borderCount[p] < 2)
+          m_borderNeighbors[(p * 2) + m_borderCount[p]] = ends[1 - e];
+        m_borderCount[p]++;
+      }
+    }
+
+    for (unsigned int p = 0; p < numPositions; p++)
+    {
+      if ((m_positionSubMesh[p] < 0) || (m_borderCount[p] > 2))
+        m_locked[p] = 1;
+    }
+  }
+
+  bool ExSimplifier::hasEdge(unsigned int a, unsigned int b) const
+  {
+    return std::binary_search(m_edges.begin(), m_edges.end(), edgeKey(a, b));
+  }
+
+  unsigned int ExSimplifier::findTarget(unsigned int vertex, unsigned int position) const
+  {
+    //a vertex of the position sharing a face with the vertex, so the attributes stay continuous
+    for (unsigned int i = m_adjacencyStart[vertex]; i < m_adjacencyStart[vertex + 1]; i++)
+    {
+      const unsigned int* tri = &m_triangles[m_adjacency[i] * 3];
+      for (int k = 0; k < 3; k++)
+      {
+        if (m_vertexPosition[tri[k]] == position)
+          return tri[k];
+      }
+    }
+    return INVALID_INDEX;
+  }
+
+  double ExSimplifier::getAttributeCost(unsigned int a, unsigned int b) const
+  {
+    if (a == b)
+      return 0.0;
+
+    double cost = 0.0;
+    if (m_options.normalWeight > 0.0f)
+    {
+      const float* na = m_store.getNormal(a);
+      const float* nb = m_store.getNormal(b);
+      double d = 1.0 - ((na[0] * nb[0]) + (na[1] * nb[1]) + (na[2] * nb[2]));
+      cost += m_options.normalWeight * std::max(d, 0.0);
+    }
+
+    if (m_options.texCoordWeight > 0.0f)
+    {
+      for (unsigned int set = 0; set < m_store.getNumTexCoords(); set++)
+      {
+        const float* ta = m_store.getTexCoord(a, set);
+        const float* tb = m_store.getTexCoord(b, set);
+        double du = ta[0] - tb[0];
+        double dv = ta[1] - tb[1];
+        cost += m_options.texCoordWeight * ((du * du) + (dv * dv));
+      }
+    }
+
+    //weights moved from one bone to another
+    unsigned int numInfluences = m_store.getNumInfluences();
+    if ((m_options.skinWeight > 0.0f) && (numInfluences > 0))
+    {
+      const float* wa = m_store.getWeights(a);
+      const float* wb = m_store.getWeights(b);
+      const int* ba = m_store.getBoneIndices(a);
+      const int* bb = m_store.getBoneIndices(b);
+      double diff = 0.0;
+      for (unsigned int i = 0; i < numInfluences; i++)
+      {
+        double match = 0.0;
+        for (unsigned int j = 0; j < numInfluences; j++)
+        {
+          if (bb[j] == ba[i])
+            match += wb[j];
+        }
+        if (wa[i] > 0.0f)
+          diff += fabs(wa[i] - match);
+      }
+
+      for (unsigned int j = 0; j < numInfluences; j++)
+      {
+        bool found = false;
+        for (unsigned int i = 0; (i < numInfluences) && !found; i++)
+          found = (ba[i] == bb[j]) && (wa[i] > 0.0f);
+        if (!found)
+          diff += wb[j];
+      }
+      cost += m_options.skinWeight * diff;
+    }
+    return cost;
+  }
+
+  bool ExSimplifier::canCollapse(unsigned int from, unsigned int to, double& cost) const
+  {
+    if (m_locked[from])
+      return false;
+
+    //a border position only slides along its border
+    if (m_borderCount[from] > 0)
+    {
+      if ((m_borderNeighbors[from * 2] != to) && (m_borderNeighbors[(from * 2) + 1] != to))
+        return false;
+    }
+
+    //every vertex of the position needs a vertex to merge with on the other side of the edge
+    double attributeCost = 0.0;
+    for (unsigned int i = m_siblingStart[from]; i < m_siblingStart[from + 1]; i++)
+    {
+      unsigned int v = m_siblings[i];
+      if (m_adjacencyStart[v] == m_adjacencyStart[v + 1])
+        continue;
+
+      unsigned int target = findTarget(v, to);
+      if (target == INVALID_INDEX)
+        return false;
+
+      attributeCost = std::max(attributeCost, getAttributeCost(v, target));
+    }
+
+    const ExQuadric& q = m_quadrics[from];
+    cost = q.eval(getPosition(to)) + (attributeCost * q.w * ATTRIBUTE_SCALE);
+    return true;
+  }
+
+  bool ExSimplifier::hasFlip(unsigned int from, unsigned int to) const
+  {
+    const float* newPos = getPosition(to);
+    for (unsigned int i = m_siblingStart[from]; i < m_siblingStart[from + 1]; i++)
+    {
+      unsigned int v = m_siblings[i];
+      for (unsigned int j = m_adjacencyStart[v]; j < m_adjacencyStart[v + 1]; j++)
+      {
+        const unsigned int* tri = &m_triangles[m_adjacency[j] * 3];
+        unsigned int p[3] = {m_vertexPosition[tri[0]], m_vertexPosition[tri[1]], m_vertexPosition[tri[2]]};
+
+        //the faces on the edge are removed
+        if ((p[0] == to) || (p[1] == to) || (p[2] == to))
+          continue;
+
+        const float* pos[3];
+        const float* moved[3];
+        for (int k = 0; k < 3; k++)
+        {
+          pos[k] = getPosition(p[k]);
+          moved[k] = (p[k] == from) ? newPos : pos[k];
+        }
+
+        double e1[3], e2[3], n0[3], n1[3];
+        sub3(pos[1], pos[0], e1);
+        sub3(pos[2], pos[0], e2);
+        cross3(e1, e2, n0);
+        sub3(moved[1], moved[0], e1);
+        sub3(moved[2], moved[0], e2);
+        cross3(e1, e2, n1);
+        if (dot3(n0, n1) <= 0.0)
+          return true;
+      }
+    }
+    return false;
+  }
+
+  unsigned int ExSimplifier::collapsePass(size_t target)
+  {
+    buildAdjacency();
+
+    size_t numTriangles = m_triangles.size() / 3;
+    std::vector<ExCollapse> collapses;
+    collapses.reserve(m_triangles.size());
+    for (size_t t = 0; t < numTriangles; t++)
+    {
+      for (int k = 0; k < 3; k++)
+      {
+        unsigned int pa = m_vertexPosition[m_triangles[(t * 3) + k]];
+        unsigned int pb = m_vertexPosition[m_triangles[(t * 3) + ((k + 1) % 3)]];
+        if (pa == pb)
+          continue;
+
+        //the inner edges are seen from both faces, keep one
+        if ((pa > pb) && hasEdge(pb, pa))
+          continue;
+
+        double costAB = 0.0;
+        double costBA = 0.0;
+        bool canAB = canCollapse(pa, pb, costAB);
+        bool canBA = canCollapse(pb, pa, costBA);
+        ExCollapse collapse;
+        if (canAB && (!canBA || (costAB <= costBA)))
+        {
+          collapse.from = pa;
+          collapse.to = pb;
+          collapse.cost = costAB;
+          collapses.push_back(collapse);
+        }
+        else if (canBA)
+        {
+          collapse.from = pb;
+          collapse.to = pa;
+          collapse.cost = costBA;
+          collapses.push_back(collapse);
+        }
+      }
+    }
+
+    if (collapses.empty())
+      return 0;
+
+    std::sort(collapses.begin(), collapses.end());
+
+    //a collapse removes about two faces
+    size_t toRemove = numTriangles - target;
+    size_t goal = std::min(std::max(toRemove / 2, (size_t)1), collapses.size());
+    double errorLimit = collapses[goal - 1].cost * PASS_ERROR_FACTOR;
+
+    //the faces around a collapse are not touched again in the same pass, so the flip tests stay valid
+    std::vector<unsigned char> passLocked(m_positionSubMesh.size(), 0);
+    m_remap.assign(m_store.size(), INVALID_INDEX);
+    unsigned int numCollapses = 0;
+    size_t removed = 0;
+    for (size_t c = 0; (c < collapses.size()) && (removed < toRemove); c++)
+    {
+      const ExCollapse& collapse = collapses[c];
+      if ((c >= goal) && (collapse.cost > errorLimit))
+        break;
+
+      if (passLocked[collapse.from] || passLocked[collapse.to])
+        continue;
+
+      if (hasFlip(collapse.from, collapse.to))
+        continue;
+
+      for (unsigned int i = m_siblingStart[collapse.from]; i < m_siblingStart[collapse.from + 1]; i++)
+      {
+        unsigned int v = m_siblings[i];
+        if (m_adjacencyStart[v] == m_adjacencyStart[v + 1])
+          continue;
+
+        m_remap[v] = findTarget(v, collapse.to);
+
+        for (unsigned int j = m_adjacencyStart[v]; j < m_adjacencyStart[v + 1]; j++)
+        {
+          const unsigned int* tri = &m_triangles[m_adjacency[j] * 3];
+          bool onEdge = false;
+          for (int k = 0; k < 3; k++)
+          {
+            passLocked[m_vertexPosition[tri[k]]] = 1;
+            onEdge = onEdge || (m_vertexPosition[tri[k]] == collapse.to);
+          }
+          if (onEdge)
+            removed++;
+        }
+      }
+      m_quadrics[collapse.to].add(m_quadrics[collapse.from]);
+      numCollapses++;
+    }
+
+    if (numCollapses == 0)
+      return 0;
+
+    //remap the faces and remove the collapsed ones
+    size_t numKept = 0;
+    for (size_t t = 0; t < numTriangles; t++)
+    {
+      unsigned int tri[3];
+      for (int k = 0; k < 3; k++)
+      {
+        unsigned int v = m_triangles[(t * 3) + k];
+        tri[k] = (m_remap[v] != INVALID_INDEX) ? m_remap[v] : v;
+      }
+
+      unsigned int p0 = m_vertexPosition[tri[0]];
+      unsigned int p1 = m_vertexPosition[tri[1]];
+      unsigned int p2 = m_vertexPosition[tri[2]];
+      if ((p0 == p1) || (p1 == p2) || (p0 == p2))
+        continue;
+
+      m_triangles[(numKept * 3)] = tri[0];
+      m_triangles[(numKept * 3) + 1] = tri[1];
+      m_triangles[(numKept * 3) + 2] = tri[2];
+      m_triangleSubMesh[numKept] = m_triangleSubMesh[t];
+      numKept++;
+    }
+    m_triangles.resize(numKept * 3);
+    m_triangleSubMesh.resize(numKept);
+    return numCollapses;
+  }
+
+  size_t ExSimplifier::run(const std::vector<std::vector<unsigned int> >& subMeshIndices, float ratio, std::vector<std::vector<unsigned int> >& result)
+  {
+    buildPositions(subMeshIndices);
+    size_t numTriangles = m_triangles.size() / 3;
+    size_t target = (size_t)(numTriangles * std::max(ratio, 0.0f));
+
+    if (target < numTriangles)
+    {
+      //the border planes need the edges
+      buildAdjacency();
+      buildQuadrics();
+
+      for (unsigned int pass = 0; (pass < MAX_PASSES) && ((m_triangles.size() / 3) > target); pass++)
+      {
+        if (collapsePass(target) == 0)
+          break;
+      }
+    }
+
+    result.clear();
+    result.resize(subMeshIndices.size());
+    for (size_t t = 0; t < m_triangleSubMesh.size(); t++)
+    {
+      std::vector<unsigned int>& indices = result[m_triangleSubMesh[t]];
+      indices.insert(indices.end(), m_triangles.begin() + (t * 3), m_triangles.begin() + ((t + 1) * 3));
+    }
+    return m_triangleSubMesh.size();
+  }
+
+  size_t simplifyMesh(const ExVertexStore& store, const std::vector<std::vector<unsigned int> >& subMeshIndices, float ratio, const ExSimplifyOptions& options, std::vector<std::vector<unsigned int> >& result)
+  {
+    ExSimplifier simplifier(store, options);
+    return simplifier.run(subMeshIndices, ratio, result);
+  }
+
+}; //end of namespace
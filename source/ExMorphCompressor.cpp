@@ -0,0 +1,291 @@
+////////////////////////////////////////////////////////////////////////////////
+// ExMorphCompressor.cpp
+// Start Date : October 17, 2026
+////////////////////////////////////////////////////////////////////////////////
+/*********************************************************************************
+*                                                                                *
+*   This program is free software; you can redistribute it and/or modify         *
+*   it under the terms of the GNU Lesser General Public License as published by  *
+*   the Free Software Foundation; either version 2 of the License, or            *
+*   (at your option) any later version.                                          *
+*                                                                                *
+**********************************************************************************/
+
+#include "ExMorphCompressor.h"
+#include "ExThreadPool.h"
+#include <math.h>
+#include <algorithm>
+
+namespace EasyOgreExporter
+{
+  //values of the position arrays processed by one job
+  static const size_t VALUE_BLOCK_SIZE = 4096;
+  //power iterations of one eigenvector
+  static const unsigned int MAX_POWER_ITERATIONS = 200;
+
+  // dot product with independent partial sums, so the additions do not wait on each other
+  static double dotProduct(const float* a, const float* b, size_t count)
+  {
+    double sums[4] = {0.0, 0.0, 0.0, 0.0};
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+      for (size_t k = 0; k < 4; k++)
+        sums[k] += (double)a[i + k] * (double)b[i + k];
+    }
+    for (; i < count; i++)
+      sums[0] += (double)a[i] * (double)b[i];
+    return (sums[0] + sums[1]) + (sums[2] + sums[3]);
+  }
+
+  // remove from v its components on the previous unit vectors
+  static void orthogonalize(std::vector<double>& v, const std::vector<std::vector<double> >& previous)
+  {
+    for (size_t p = 0; p < previous.size(); p++)
+    {
+      const std::vector<double>& u = previous[p];
+      double d = 0.0;
+      for (size_t i = 0; i < v.size(); i++)
+        d += v[i] * u[i];
+      for (size_t i = 0; i < v.size(); i++)
+        v[i] -= u[i] * d;
+    }
+  }
+
+  static double normalize(std::vector<double>& v)
+  {
+    double len = 0.0;
+    for (size_t i = 0; i < v.size(); i++)
+      len += v[i] * v[i];
+    len = sqrt(len);
+    if (len > 0.0)
+    {
+      for (size_t i = 0; i < v.size(); i++)
+        v[i] /= len;
+    }
+    return len;
+  }
+
+  // unit eigenvector of the largest eigenvalue of gram orthogonal to the previous ones, false when nothing is left
+  static bool findEigenVector(const std::vector<double>& gram, size_t n, const std::vector<std::vector<double> >& previous, std::vector<double>& v, double& eigenValue)
+  {
+    //start on the frame with the largest energy left
+    v.assign(n, 0.0);
+    for (size_t i = 0; i < n; i++)
+      v[i] = gram[(i * n) + i];
+    orthogonalize(v, previous);
+    if (normalize(v) <= 0.0)
+      return false;
+
+    std::vector<double> w(n);
+    eigenValue = 0.0;
+    for (unsigned int it = 0; it < MAX_POWER_ITERATIONS; it++)
+    {
+      for (size_t i = 0; i < n; i++)
+      {
+        const double* row = &gram[i * n];
+        double sum = 0.0;
+        for (size_t j = 0; j < n; j++)
+          sum += row[j] * v[j];
+        w[i] = sum;
+      }
+      orthogonalize(w, previous);
+      eigenValue = normalize(w);
+      if (eigenValue <= 0.0)
+        return false;
+
+      double change = 0.0;
+      for (size_t i = 0; i < n; i++)
+        change = std::max(change, fabs(w[i] - v[i]));
+      v.swap(w);
+      if (change < 1e-9)
+        break;
+    }
+    return true;
+  }
+
+  //one row of the symmetric Gram matrix of the offsets
+  class ExGramRowJob : public ExPoolJob
+  {
+  public:
+    ExGramRowJob(const float* residual, size_t numFrames, size_t numValues, double* gram) :
+      m_residual(residual), m_numFrames(numFrames), m_numValues(numValues), m_gram(gram)
+    {
+    };
+
+    void run(size_t i)
+    {
+      const float* a = &m_residual[i * m_numValues];
+      for (size_t j = i; j < m_numFrames; j++)
+      {
+        double sum = dotProduct(a, &m_residual[j * m_numValues], m_numValues);
+        m_gram[(i * m_numFrames) + j] = sum;
+        m_gram[(j * m_numFrames) + i] = sum;
+      }
+    };
+
+  private:
+    const float* m_residual;
+    size_t m_numFrames;
+    size_t m_numValues;
+    double* m_gram;
+  };
+
+  //block of the pose direction, the residual projected on the eigenvector
+  class ExPoseBlockJob : public ExPoolJob
+  {
+  public:
+    ExPoseBlockJob(const float* residual, size_t numFrames, size_t numValues, const double* u, float* pose) :
+      m_residual(residual), m_numFrames(numFrames), m_numValues(numValues), m_u(u), m_pose(pose)
+    {
+    };
+
+    void run(size_t block)
+    {
+      size_t start = block * VALUE_BLOCK_SIZE;
+      size_t end = std::min(m_numValues, start + VALUE_BLOCK_SIZE);
+      std::vector<double> sums(end - start, 0.0);
+      for (size_t f = 0; f < m_numFrames; f++)
+      {
+        const float* offsets = &m_residual[(f * m_numValues) + start];
+        for (size_t k = 0; k < sums.size(); k++)
+          sums[k] += m_u[f] * offsets[k];
+      }
+      for (size_t k = 0; k < sums.size(); k++)
+        m_pose[start + k] = (float)sums[k];
+    };
+
+  private:
+    const float* m_residual;
+    size_t m_numFrames;
+    size_t m_numValues;
+    const double* m_u;
+    float* m_pose;
+  };
+
+  //weight of a frame by projection of its residual, then remove the pose from it
+  class ExProjectFrameJob : public ExPoolJob
+  {
+  public:
+    ExProjectFrameJob(float* residual, size_t numValues, const float* pose, float* weights, float* frameErrors) :
+      m_residual(residual), m_numValues(numValues), m_pose(pose), m_weights(weights), m_frameErrors(frameErrors)
+    {
+    };
+
+    void run(size_t f)
+    {
+      float* offsets = &m_residual[f * m_numValues];
+      m_weights[f] = (float)dotProduct(offsets, m_pose, m_numValues);
+
+      float error = 0.0f;
+      for (size_t k = 0; k < m_numValues; k++)
+      {
+        offsets[k] -= m_weights[f] * m_pose[k];
+        error = std::max(error, fabsf(offsets[k]));
+      }
+      m_frameErrors[f] = error;
+    };
+
+  private:
+    float* m_residual;
+    size_t m_numValues;
+    const float* m_pose;
+    float* m_weights;
+    float* m_frameErrors;
+  };
+
+  bool compressMorphFrames(const ExMorphFrames& frames, const float* basePositions, float tolerance, unsigned int maxPoses, unsigned int numThreads, ExMorphCompression& result)
+  {
+    size_t numFrames = frames.getNumFrames();
+    size_t numValues = frames.getNumSourceVertices() * 3;
+    result.numPoses = 0;
+    result.poses.clear();
+    result.weights.clear();
+    result.maxError = 0.0f;
+    if ((numFrames == 0) || (numValues == 0))
+      return true;
+
+    //offsets from the base, reduced to the residual as the poses are added
+    std::vector<float> residual(numFrames * numValues);
+    for (size_t f = 0; f < numFrames; f++)
+    {
+      const float* frame = frames.getFrame(f);
+      float* offsets = &residual[f * numValues];
+      for (size_t i = 0; i < numValues; i++)
+      {
+        offsets[i] = frame[i] - basePositions[i];
+        result.maxError = std::max(result.maxError, fabsf(offsets[i]));
+      }
+    }
+
+    if (result.maxError <= tolerance)
+      return true;
+
+    ExThreadPool pool(numThreads);
+
+    //symmetric Gram matrix of the offsets, one row per job
+    std::vector<double> gram(numFrames * numFrames);
+    ExGramRowJob gramJob(&residual[0], numFrames, numValues, &gram[0]);
+    pool.run(numFrames, gramJob);
+
+    size_t numBlocks = (numValues + VALUE_BLOCK_SIZE - 1) / VALUE_BLOCK_SIZE;
+    std::vector<std::vector<double> > eigenVectors;
+    std::vector<std::vector<float> > poseWeights;
+    std::vector<float> frameErrors(numFrames);
+    while ((result.maxError > tolerance) && (result.numPoses < maxPoses))
+    {
+      std::vector<double> u;
+      double eigenValue = 0.0;
+      if (!findEigenVector(gram, numFrames, eigenVectors, u, eigenValue))
+        break;
+      eigenVectors.push_back(u);
+
+      //pose direction, the residual projected on the eigenvector
+      result.poses.resize((result.numPoses + 1) * numValues);
+      float* pose = &result.poses[result.numPoses * numValues];
+      ExPoseBlockJob poseJob(&residual[0], numFrames, numValues, &u[0], pose);
+      pool.run(numBlocks, poseJob);
+
+      double len = sqrt(dotProduct(pose, pose, numValues));
+      if (len <= 0.0)
+      {
+        result.poses.resize(result.numPoses * numValues);
+        break;
+      }
+      for (size_t k = 0; k < numValues; k++)
+        pose[k] = (float)(pose[k] / len);
+
+      //weights by projection of the residual, then remove the pose from it
+      std::vector<float> weights(numFrames);
+      ExProjectFrameJob projectJob(&residual[0], numValues, pose, &weights[0], &frameErrors[0]);
+      pool.run(numFrames, projectJob);
+
+      poseWeights.push_back(weights);
+      result.numPoses++;
+      result.maxError = *std::max_element(frameErrors.begin(), frameErrors.end());
+    }
+
+    //largest weight of each pose to 1
+    result.weights.resize(numFrames * result.numPoses);
+    for (unsigned int p = 0; p < result.numPoses; p++)
+    {
+      std::vector<float>& weights = poseWeights[p];
+      float scale = 0.0f;
+      for (size_t f = 0; f < numFrames; f++)
+        scale = std::max(scale, fabsf(weights[f]));
+
+      float* pose = &result.poses[p * numValues];
+      if (scale > 0.0f)
+      {
+        for (size_t k = 0; k < numValues; k++)
+          pose[k] *= scale;
+      }
+
+      for (size_t f = 0; f < numFrames; f++)
+        result.weights[(f * result.numPoses) + p] = (scale > 0.0f) ? (weights[f] / scale) : 0.0f;
+    }
+
+    return result.maxError <= tolerance;
+  }
+
+}; //end of namespace
@@ -0,0 +1,221 @@
+////////////////////////////////////////////////////////////////////////////////
+// ExMorphFrames.cpp
+// Start Date : October 17, 2026
+////////////////////////////////////////////////////////////////////////////////
+/*********************************************************************************
+*                                                                                *
+*   This program is free software; you can redistribute it and/or modify         *
+*   it under the terms of the GNU Lesser General Public License as published by  *
+*   the Free Software Foundation; either version 2 of the License, or            *
+*   (at your option) any later version.                                          *
+*                                                                                *
+**********************************************************************************/
+
+#include "ExMorphFrames.h"
+#include <math.h>
+#include <string.h>
+#include <algorithm>
+#include <map>
+
+namespace EasyOgreExporter
+{
+  //floats compared between two checks of the limit, and independent maximums in a block
+  static const size_t DIFF_BLOCK_SIZE = 256;
+  static const size_t DIFF_LANES = 8;
+
+  float maxAbsDifference(const float* a, const float* b, size_t count, float limit)
+  {
+    float lanes[DIFF_LANES] = {0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f};
+    float maxDiff = 0.0f;
+    size_t i = 0;
+    while (i < count)
+    {
+      size_t blockEnd = std::min(count, i + DIFF_BLOCK_SIZE);
+      for (; i + DIFF_LANES <= blockEnd; i += DIFF_LANES)
+      {
+        for (size_t k = 0; k < DIFF_LANES; k++)
+        {
+          float d = fabsf(a[i + k] - b[i + k]);
+          lanes[k] = (d > lanes[k]) ? d : lanes[k];
+        }
+      }
+
+      //tail of the array
+      for (; i < blockEnd; i++)
+        maxDiff = std::max(maxDiff, fabsf(a[i] - b[i]));
+
+      for (size_t k = 0; k < DIFF_LANES; k++)
+        maxDiff = std::max(maxDiff, lanes[k]);
+
+      if (maxDiff > limit)
+        return maxDiff;
+    }
+    return maxDiff;
+  }
+
+  float maxInterpolationError(const float* a, const float* b, float t, const float* values, size_t count, float limit)
+  {
+    float lanes[DIFF_LANES] = {0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f};
+    float maxDiff = 0.0f;
+    size_t i = 0;
+    while (i < count)
+    {
+      size_t blockEnd = std::min(count, i + DIFF_BLOCK_SIZE);
+      for (; i + DIFF_LANES <= blockEnd; i += DIFF_LANES)
+      {
+        for (size_t k = 0; k < DIFF_LANES; k++)
+        {
+          float d = fabsf(a[i + k] + ((b[i + k] - a[i + k]) * t) - values[i + k]);
+          lanes[k] = (d > lanes[k]) ? d : lanes[k];
+        }
+      }
+
+      //tail of the array
+      for (; i < blockEnd; i++)
+        maxDiff = std::max(maxDiff, fabsf(a[i] + ((b[i] - a[i]) * t) - values[i]));
+
+      for (size_t k = 0; k < DIFF_LANES; k++)
+        maxDiff = std::max(maxDiff, lanes[k]);
+
+      if (maxDiff > limit)
+        return maxDiff;
+    }
+    return maxDiff;
+  }
+
+  void getMorphOffsets(const ExVertexStore& store, const std::vector<unsigned int>& vertices, const float* targetPositions, float epsilon, std::vector<unsigned int>& indices, std::vector<float>& offsets)
+  {
+    indices.clear();
+    offsets.clear();
+    for (size_t i = 0; i < vertices.size(); i++)
+    {
+      const float* vpos = store.getPosition(vertices[i]);
+      const float* tpos = targetPositions + (store.getMaxId(vertices[i]) * 3);
+      float offset[3] = {tpos[0] - vpos[0], tpos[1] - vpos[1], tpos[2] - vpos[2]};
+      if ((fabsf(offset[0]) <= epsilon) && (fabsf(offset[1]) <= epsilon) && (fabsf(offset[2]) <= epsilon))
+        continue;
+
+      indices.push_back(i);
+      offsets.insert(offsets.end(), offset, offset + 3);
+    }
+  }
+
+  ExMorphFrames::ExMorphFrames()
+  {
+  }
+
+  void ExMorphFrames::setVertices(const std::vector<int>& outputSources)
+  {
+    clear();
+
+    std::map<int, unsigned int> sourceIndex;
+    m_frameIndex.resize(outputSources.size());
+    for (size_t v = 0; v < outputSources.size(); v++)
+    {
+      std::pair<std::map<int, unsigned int>::iterator, bool> inserted = sourceIndex.insert(std::make_pair(outputSources[v], (unsigned int)m_sources.size()));
+      if (inserted.second)
+        m_sources.push_back(outputSources[v]);
+      m_frameIndex[v] = inserted.first->second;
+    }
+  }
+
+  float* ExMorphFrames::addFrame(int time)
+  {
+    size_t frameSize = m_sources.size() * 3;
+    m_times.push_back(time);
+    m_positions.resize(m_times.size() * frameSize, 0.0f);
+    return &m_positions[(m_times.size() - 1) * frameSize];
+  }
+
+  void ExMorphFrames::moveFrame(unsigned int from, unsigned int to)
+  {
+    if (from == to)
+      return;
+
+    size_t frameSize = m_sources.size() * 3;
+    m_times[to] = m_times[from];
+    if (frameSize > 0)
+      memcpy(&m_positions[to * frameSize], &m_positions[from * frameSize], frameSize * sizeof(float));
+  }
+
+  unsigned int ExMorphFrames::removeStaticFrames(float tolerance)
+  {
+    unsigned int numFrames = m_times.size();
+    if (numFrames <= 2)
+      return 0;
+
+    size_t frameSize = m_sources.size() * 3;
+    std::vector<unsigned int> kept;
+    kept.push_back(0);
+    for (unsigned int f = 1; f < numFrames; f++)
+    {
+      if ((f + 1 < numFrames) &&
+          (maxAbsDifference(getFrame(f), getFrame(kept.back()), frameSize, tolerance) <= tolerance) &&
+          (maxAbsDifference(getFrame(f), getFrame(f + 1), frameSize, tolerance) <= tolerance))
+        continue;
+
+      kept.push_back(f);
+    }
+
+    keepFrames(kept);
+    return numFrames - kept.size();
+  }
+
+  bool ExMorphFrames::isInterpolated(unsigned int first, unsigned int last, float tolerance) const
+  {
+    size_t frameSize = m_sources.size() * 3;
+    float duration = (float)(m_times[last] - m_times[first]);
+    if (duration <= 0.0f)
+      return false;
+
+    //the last frame added is the most likely to fail
+    for (unsigned int f = last - 1; f > first; f--)
+    {
+      float t = (float)(m_times[f] - m_times[first]) / duration;
+      if (maxInterpolationError(getFrame(first), getFrame(last), t, getFrame(f), frameSize, tolerance) > tolerance)
+        return false;
+    }
+    return true;
+  }
+
+  void ExMorphFrames::keepFrames(const std::vector<unsigned int>& kept)
+  {
+    for (size_t i = 0; i < kept.size(); i++)
+      moveFrame(kept[i], i);
+
+    m_times.resize(kept.size());
+    m_positions.resize(kept.size() * m_sources.size() * 3);
+  }
+
+  unsigned int ExMorphFrames::reduceFrames(float tolerance)
+  {
+    unsigned int numFrames = m_times.size();
+    if (numFrames <= 2)
+      return 0;
+
+    std::vector<unsigned int> kept;
+    kept.push_back(0);
+    unsigned int first = 0;
+    while (first + 1 < numFrames)
+    {
+      unsigned int last = first + 1;
+      while ((last + 1 < numFrames) && isInterpolated(first, last + 1, tolerance))
+        last++;
+
+      kept.push_back(last);
+      first = last;
+    }
+
+    keepFrames(kept);
+    return numFrames - kept.size();
+  }
+
+  void ExMorphFrames::clear()
+  {
+    m_sources.clear();
+    m_frameIndex.clear();
+    m_times.clear();
+    m_positions.clear();
+  }
+
+}; //end of namespace
@@ -15,7 +15,9 @@
 #include "ExOgreConverter.h"
 #include "EasyOgreExporterLog.h"
 #include "ExMesh.h"
+#include "ExHash.h"
 #include "decomp.h"
+#include "IFrameTagManager.h"
 
 namespace EasyOgreExporter
 {
@@ -25,6 +27,13 @@ namespace EasyOgreExporter
     mParams = params;
     pIGame = pIGameScene;
     mMaterialSet = new ExMaterialSet(this);
+    mNumSharedMeshes = 0;
+    mSharedMeshesBytes = 0;
+
+    //manifest next to the scene file
+    computeCacheHashes();
+    if (mParams.exportCache)
+      mExportCache.load(makeOutputPath(mParams.outputDir, "", mParams.sceneFilename, "exportcache"), mParams.forceRebuild);
 	}
 
 	// destructor
@@ -42,15 +51,213 @@ namespace EasyOgreExporter
     return mMaterialSet;
   }
 
+  ExExportCache& ExOgreConverter::getExportCache()
+  {
+    return mExportCache;
+  }
+
+  void ExOgreConverter::saveExportCache()
+  {
+    if (!mParams.exportCache)
+      return;
+
+    EasyOgreExporterLog("Info: %d files unchanged since the previous export, %d files written\n", mExportCache.getNumSkipped(), mExportCache.getNumWritten());
+    if (!mExportCache.save())
+      EasyOgreExporterLog("Warning: could not write the export cache, the next export will rebuild everything\n");
+  }
+
+  void ExOgreConverter::computeCacheHashes()
+  {
+    //parameters changing the mesh and skeleton files
+    ExHasher params;
+    params.addFloat(mParams.lum);
+    params.addInt(mParams.exportVertNorm);
+    params.addInt(mParams.exportVertCol);
+    params.addInt(mParams.exportSkeleton);
+    params.addInt(mParams.exportSkelAnims);
+    params.addInt(mParams.exportVertAnims);
+    params.addInt(mParams.exportPoses);
+    params.addInt(mParams.exportScene);
+    params.addInt(mParams.useSharedGeom);
+    params.addInt(mParams.buildTangents);
+    params.addInt(mParams.tangentSemantic);
+    params.addInt(mParams.tangentsUseParity);
+    params.addInt(mParams.buildEdges);
+    params.addInt(mParams.generateLOD);
+    params.addInt(mParams.lodLevels);
+    params.addFloat(mParams.lodReduction);
+    params.addInt(mParams.lodStrategy);
+    params.addFloat(mParams.lodDistance);
+    params.addFloat(mParams.lodScreenRatio);
+    params.addInt(mParams.maxBoneInfluences);
+    params.addInt(mParams.blendElements);
+    params.addInt(mParams.useByteBlendWeights());
+    params.addInt(mParams.resampleAnims);
+    params.addInt(mParams.resampleStep);
+    params.addFloat(mParams.morphKeyTolerance);
+    params.addInt(mParams.compressMorphAnimation);
+    params.addFloat(mParams.morphCompressionTolerance);
+    params.addInt(mParams.morphCompressionMaxPoses);
+    params.addFloat(mParams.poseEpsilon);
+    params.addInt(mParams.yUpAxis);
+    params.addInt(mParams.meshVersion);
+    params.addString(mParams.resPrefix);
+    params.addFloat(mParams.weldTolerance);
+    params.addInt(mParams.optimizeIndexBuffers);
+    params.addInt(mParams.vertexCacheSize);
+    params.addInt(mParams.splitSubMeshes && !mParams.useSharedGeom);
+    params.addInt(mParams.maxSubMeshVertices);
+    params.addInt(mParams.optimizeOverdraw);
+    params.addFloat(mParams.overdrawThreshold);
+    params.addInt(mParams.compressVertices);
+    params.addFloat(mParams.compressionError);
+    //the native and Ogre writers order the submesh name table differently
+    params.addInt(mParams.nativeMeshSerializer);
+    mParamsHash = params.toString();
+
+    //timeline and frame tags used to cut the animations
+    ExHasher anims;
+    Interval animRange = GetCOREInterface()->GetAnimRange();
+    anims.addInt(animRange.Start());
+    anims.addInt(animRange.End());
+    anims.addInt(GetTicksPerFrame());
+    anims.addInt(GetFrameRate());
+
+    IFrameTagManager* frameTagMgr = static_cast<IFrameTagManager*>(GetCOREInterface(FRAMETAGMANAGER_INTERFACE));
+    int cnt = frameTagMgr->GetTagCount();
+    anims.addInt(cnt);
+    for (int i = 0; i < cnt; i++)
+    {
+      DWORD t = frameTagMgr->GetTagID(i);
+      anims.addInt(frameTagMgr->GetLockIDByID(t));
+      anims.addInt(frameTagMgr->GetTimeByID(t, FALSE));
+#ifdef UNICODE
+      std::wstring name_w = frameTagMgr->GetNameByID(t);
+      std::string name_s;
+      name_s.assign(name_w.begin(), name_w.end());
+      anims.addString(name_s);
+#else
+      anims.addString(std::string(frameTagMgr->GetNameByID(t)));
+#endif
+    }
+    mAnimRangesHash = anims.toString();
+  }
+
   ParamList ExOgreConverter::getParams()
   {
     return mParams;
   }
 
-  bool ExOgreConverter::writeEntityData(IGameNode* pGameNode, IGameObject* pGameObject, IGameMesh* pGameMesh, std::vector<ExMaterial*>& lmat)
+  void ExOgreConverter::setMeshPositionTransform(const std::string& meshName, Point3 offset, Point3 scale)
   {
-    bool ret = false;
+    mMeshPositionTransforms[meshName] = std::make_pair(offset, scale);
+  }
+
+  bool ExOgreConverter::getMeshPositionTransform(const std::string& meshName, Point3& offset, Point3& scale)
+  {
+    std::map<std::string, std::pair<Point3, Point3> >::iterator it = mMeshPositionTransforms.find(meshName);
+    if (it == mMeshPositionTransforms.end())
+      return false;
+
+    offset = it->second.first;
+    scale = it->second.second;
+    return true;
+  }
+
+  ExMaterial* ExOgreConverter::loadMaterial(IGameMaterial* pGameMaterial)
+  {
+    ExMaterial* pMaterial = 0;
+
+    //try to load the material if it has already been created
+    pMaterial = mMaterialSet->getMaterial(pGameMaterial);
+
+    //otherwise create the material
+    if (!pMaterial && !pGameMaterial)
+    {
+      // add the default material
+      mMaterialSet->addMaterial();
+      pMaterial = mMaterialSet->getMaterial(0);
+    }
+    else if (!pMaterial)
+    {
+      pMaterial = new ExMaterial(this, pGameMaterial, mParams.resPrefix);
+      mMaterialSet->addMaterial(pMaterial);
+      pMaterial->load();
+    }
+
+    //loading complete
+    return pMaterial;
+  }
+
+  INode* ExOgreConverter::registerInstance(INode* node)
+  {
+    std::map<INode*, INode*>::iterator it = mInstanceMasters.find(node);
+    if (it != mInstanceMasters.end())
+      return it->second;
+
+    //first node of its instance group found by the scene traversal, it becomes the master of all the group
+    INodeTab nodeInstances;
+    IInstanceMgr::GetInstanceMgr()->GetInstances(*node, nodeInstances);
+    for (int i = 0; i < nodeInstances.Count(); i++)
+      mInstanceMasters[nodeInstances[i]] = node;
+
+    mInstanceMasters[node] = node;
+    return node;
+  }
+
+  INode* ExOgreConverter::getInstanceMaster(INode* node)
+  {
+    std::map<INode*, INode*>::iterator it = mInstanceMasters.find(node);
+    return (it != mInstanceMasters.end()) ? it->second : node;
+  }
+
+  std::string ExOgreConverter::getInstanceMeshName(IGameNode* pGameNode)
+  {
+    INode* master = getInstanceMaster(pGameNode->GetMaxNode());
+    std::string meshName = mParams.resPrefix;
+#ifdef UNICODE
+    std::wstring name_w = master->GetName();
+    std::string name_s;
+    name_s.assign(name_w.begin(), name_w.end());
+    meshName.append(name_s);
+#else
+    meshName.append(master->GetName());
+#endif
+    meshName = optimizeResourceName(meshName);
+
+    //identical meshes use the first written one
+    std::map<std::string, std::string>::iterator it = mMeshAliases.find(meshName);
+    return (it != mMeshAliases.end()) ? it->second : meshName;
+  }
+
+  void ExOgreConverter::logSharedMeshes()
+  {
+    if (mNumSharedMeshes > 0)
+      EasyOgreExporterLog("Info: %d meshes deduplicated, %llu bytes saved\n", mNumSharedMeshes, mSharedMeshesBytes);
+  }
+
+  bool ExOgreConverter::writeInstanceData(IGameNode* pGameNode, std::vector<ExMaterial*>& lmat)
+  {
+    INode* master = getInstanceMaster(pGameNode->GetMaxNode());
+    std::map<INode*, std::vector<int> >::iterator it = mInstanceMaterialIds.find(master);
+    if (it == mInstanceMaterialIds.end())
+    {
+      EasyOgreExporterLog("Warning : instance skipped, the instanciated mesh was not exported.\n");
+      return false;
+    }
+
+    //the instances share the geometry, only resolve the node materials on the master submeshes ids
+    EasyOgreExporterLog("Info: Ignore instanciated mesh\n");
+    IGameMaterial* nodeMtl = pGameNode->GetNodeMaterial();
+    lmat.clear();
+    for (size_t i = 0; i < it->second.size(); i++)
+      lmat.push_back(loadMaterial(GetSubMaterialByID(nodeMtl, it->second[i])));
+
+    return true;
+  }
 
+  ExMesh* ExOgreConverter::createMesh(IGameNode* pGameNode, IGameMesh* pGameMesh)
+  {
     std::string meshName = mParams.resPrefix;
 #ifdef UNICODE
 	std::wstring name_w = pGameNode->GetName();
@@ -61,47 +268,198 @@ namespace EasyOgreExporter
     meshName.append(pGameNode->GetName());
 #endif
     meshName = optimizeResourceName(meshName);
-    ExMesh* mesh = new ExMesh(this, pGameNode, pGameMesh, meshName);
-    
-    lmat = mesh->getMaterials();
+    return new ExMesh(this, pGameNode, pGameMesh, meshName);
+  }
 
-    if (!isFirstInstance(pGameNode))
+  //mesh cache data, the Max material id of each submesh then the quantized positions decode transform if any
+  static std::string makeMeshCacheData(const std::vector<int>& matIds, bool hasTransform, Point3 offset, Point3 scale)
+  {
+    std::stringstream data;
+    data.precision(9);
+    data << matIds.size();
+    for (size_t i = 0; i < matIds.size(); i++)
+      data << " " << matIds[i];
+    if (hasTransform)
+      data << " " << offset.x << " " << offset.y << " " << offset.z << " " << scale.x << " " << scale.y << " " << scale.z;
+    return data.str();
+  }
+
+  static bool readMeshCacheData(const std::string& cacheData, std::vector<int>& matIds, bool& hasTransform, Point3& offset, Point3& scale)
+  {
+    std::stringstream data(cacheData);
+    size_t numSubMeshes = 0;
+    if (!(data >> numSubMeshes))
+      return false;
+
+    matIds.resize(numSubMeshes);
+    for (size_t i = 0; i < numSubMeshes; i++)
     {
-      EasyOgreExporterLog("Info: Ignore instanciated mesh\n");
-      ret = true;
+      if (!(data >> matIds[i]))
+        return false;
     }
-    else
+    hasTransform = (data >> offset.x >> offset.y >> offset.z >> scale.x >> scale.y >> scale.z) ? true : false;
+    return true;
+  }
+
+  std::string ExOgreConverter::getMeshCacheHash(ExMesh* mesh)
+  {
+    std::string cacheHash = mParams.exportCache ? mesh->getCacheHash() : std::string();
+    if (cacheHash.empty())
+      return cacheHash;
+
+    ExHasher hasher;
+    hasher.addString(mParamsHash);
+    hasher.addString(mAnimRangesHash);
+    hasher.addString(cacheHash);
+    return hasher.toString();
+  }
+
+  bool ExOgreConverter::checkMeshCache(ExMesh* mesh, IGameNode* pGameNode)
+  {
+    //the skinned bounds and the cache hashes use the skeleton animations
+    if (mParams.exportSkeleton && mesh->getSkeleton())
+      mesh->getSkeleton()->loadAnims(pGameNode);
+
+    if (!mParams.exportMesh)
+      return true;
+
+    //identical to a previous mesh, it will share its file
+    std::string fingerprint = mParams.deduplicateMeshes ? mesh->getFingerprint() : std::string();
+    if (!fingerprint.empty() && !mCheckedFingerprints.insert(fingerprint).second)
+      return false;
+
+    //the key only depends on the snapshot and the parameters, so it is checked before the processing
+    std::string meshfile = makeOutputPath(mParams.outputDir, mParams.meshOutputDir, optimizeFileName(mesh->getName()), "mesh");
+    std::string cacheData;
+    if (!mExportCache.isUpToDate(meshfile, getMeshCacheHash(mesh), &cacheData))
+      return true;
+
+    std::vector<int> matIds;
+    bool hasTransform = false;
+    Point3 offset;
+    Point3 scale;
+    if (!readMeshCacheData(cacheData, matIds, hasTransform, offset, scale))
+    {
+      mExportCache.invalidate(meshfile);
+      return true;
+    }
+
+    mesh->setCachedSubMeshes(matIds);
+    if (hasTransform)
+      setMeshPositionTransform(mesh->getName(), offset, scale);
+    mCachedMeshes.insert(mesh->getName());
+    return false;
+  }
+
+  bool ExOgreConverter::writeEntityData(ExMesh* mesh, IGameNode* pGameNode, std::vector<ExMaterial*>& lmat)
+  {
+    bool ret = false;
+
+    if (mParams.exportMesh)
     {
-      if (mParams.exportMesh)
+      // Write skeleton binary, its animations are loaded by checkMeshCache
+      if (mParams.exportSkeleton && mesh->getSkeleton())
       {
-        // Write skeleton binary
-        if (mParams.exportSkeleton && mesh->getSkeleton())
+        ExSkeleton* skeleton = mesh->getSkeleton();
+        std::string skeletonHash;
+        if (mParams.exportCache)
         {
-          // Load skeleton animations
-          mesh->getSkeleton()->loadAnims(pGameNode);
+          ExHasher hasher;
+          hasher.addString(mParamsHash);
+          hasher.addString(mAnimRangesHash);
+          hasher.addString(skeleton->getCacheHash());
+          skeletonHash = hasher.toString();
+        }
 
+        std::string skeletonFile = skeleton->getFilePath();
+        if (mExportCache.isUpToDate(skeletonFile, skeletonHash))
+        {
+          EasyOgreExporterLog("Info: Skeleton %s unchanged, keep the previous file\n", skeletonFile.c_str());
+        }
+        else
+        {
           EasyOgreExporterLog("Writing skeleton binary...\n");
-          if (!mesh->getSkeleton()->writeOgreBinary())
+          if (!skeleton->writeOgreBinary())
           {
             EasyOgreExporterLog("Error writing skeleton binary file\n");
+            mExportCache.invalidate(skeletonFile);
+          }
+          else
+          {
+            mExportCache.update(skeletonFile, skeletonHash);
           }
         }
+      }
 
-        #ifdef UNICODE
-          MSTR nodeName = pGameNode->GetName();
-          EasyOgreExporterLog("Writing %ls mesh binary...\n", nodeName.data());
-        #else
-          EasyOgreExporterLog("Writing %s mesh binary...\n", pGameNode->GetName());
-        #endif
-      
+      #ifdef UNICODE
+        MSTR nodeName = pGameNode->GetName();
+        EasyOgreExporterLog("Writing %ls mesh binary...\n", nodeName.data());
+      #else
+        EasyOgreExporterLog("Writing %s mesh binary...\n", pGameNode->GetName());
+      #endif
+    
+      //identical mesh already written for an other node
+      std::string fingerprint = mParams.deduplicateMeshes ? mesh->getFingerprint() : std::string();
+      std::map<std::string, std::string>::iterator itShared = mSharedMeshes.find(fingerprint);
+      std::string meshfile = makeOutputPath(mParams.outputDir, mParams.meshOutputDir, optimizeFileName(mesh->getName()), "mesh");
+      if (!fingerprint.empty() && (itShared != mSharedMeshes.end()))
+      {
+        EasyOgreExporterLog("Info: Mesh %s is identical to %s, the mesh file is shared\n", mesh->getName().c_str(), itShared->second.c_str());
+        if (!mesh->isPrepared())
+          mesh->setCachedSubMeshes(mSharedMeshMaterialIds[fingerprint]);
+        mMeshAliases[mesh->getName()] = itShared->second;
+        mNumSharedMeshes++;
+        mSharedMeshesBytes += mSharedMeshSizes[itShared->second];
+        ret = true;
+      }
+      else if (mCachedMeshes.find(mesh->getName()) != mCachedMeshes.end())
+      {
+        EasyOgreExporterLog("Info: Mesh %s unchanged, keep the previous file\n", meshfile.c_str());
+        ret = true;
+      }
+      else
+      {
+        //skipped by checkMeshCache for a shared mesh that could not be written
+        if (!mesh->isPrepared())
+          mesh->prepareMesh();
+
+        //the submeshes are released by the writing
+        std::vector<int> matIds = mesh->getMaterialIds();
+        std::string meshHash = getMeshCacheHash(mesh);
+        Point3 offset;
+        Point3 scale;
         if (!(ret = mesh->writeOgreBinary()))
         {
           EasyOgreExporterLog("Warning : Mesh skipped, see previous log to know why.\n");
+          mExportCache.invalidate(meshfile);
         }
+        else
+        {
+          bool hasTransform = getMeshPositionTransform(mesh->getName(), offset, scale);
+          mExportCache.update(meshfile, meshHash, makeMeshCacheData(matIds, hasTransform, offset, scale));
+        }
+        mesh->setCachedSubMeshes(matIds);
+      }
+
+      if (ret && !fingerprint.empty() && (itShared == mSharedMeshes.end()))
+      {
+        mSharedMeshes[fingerprint] = mesh->getName();
+        mSharedMeshMaterialIds[fingerprint] = mesh->getMaterialIds();
+
+        std::ifstream file(meshfile.c_str(), std::ios::in | std::ios::binary | std::ios::ate);
+        mSharedMeshSizes[mesh->getName()] = file ? (unsigned long long)file.tellg() : 0;
       }
     }
+    else if (!mesh->isPrepared())
+    {
+      mesh->prepareMesh();
+    }
+
+    lmat = mesh->getMaterials();
+
+    //materials ids used by the instances of this mesh
+    mInstanceMaterialIds[pGameNode->GetMaxNode()] = mesh->getMaterialIds();
 
-    delete mesh;
     return ret;
   }
 
@@ -446,9 +446,7 @@ namespace EasyOgreExporter
     pEntityElement->SetAttribute("name", entityName.c_str());
     pEntityElement->SetAttribute("id", id_counter);
 
-    std::string instName = mParams.resPrefix;
-    instName.append(getFirstInstanceName(pGameNode));
-    instName = optimizeResourceName(instName);
+    std::string instName = m_converter->getInstanceMeshName(pGameNode);
     
     std::string meshPath = optimizeFileName(instName + ".mesh");
 
@@ -458,6 +456,7 @@ namespace EasyOgreExporter
       pEntityElement->SetDoubleAttribute("renderingDistance", renderDistance);
 
     parent->LinkEndChild(pEntityElement);
+    m_meshEntities.push_back(std::make_pair(pEntityElement, instName));
 
     // user Data
     IPropertyContainer* upc = pGameMesh->GetIPropertyContainer();
@@ -704,8 +703,57 @@ namespace EasyOgreExporter
 		return pLightElement;
   }
 
+  // the meshes are written after their first instance entity, so the quantized positions transforms are applied at the end
+  void ExScene::applyMeshPositionTransforms()
+  {
+    for (size_t i = 0; i < m_meshEntities.size(); i++)
+    {
+      Point3 offset;
+      Point3 scale;
+      if (!m_converter->getMeshPositionTransform(m_meshEntities[i].second, offset, scale))
+        continue;
+
+      TiXmlElement* pEntityElement = m_meshEntities[i].first;
+      TiXmlElement* pParentElement = pEntityElement->Parent()->ToElement();
+      if (!pParentElement)
+        continue;
+
+      // move the entity in a child node with the decode transform, so the children of its node are not scaled
+      TiXmlElement pDecodeElement("node");
+      std::string nodeName = pParentElement->Attribute("name") ? pParentElement->Attribute("name") : "";
+      pDecodeElement.SetAttribute("name", (nodeName + "_decode").c_str());
+      pDecodeElement.SetAttribute("id", id_counter);
+      pDecodeElement.SetAttribute("isTarget", "false");
+
+      TiXmlElement* pPositionElement = new TiXmlElement("position");
+      pPositionElement->SetDoubleAttribute("x", offset.x);
+      pPositionElement->SetDoubleAttribute("y", offset.y);
+      pPositionElement->SetDoubleAttribute("z", offset.z);
+      pDecodeElement.LinkEndChild(pPositionElement);
+
+      TiXmlElement* pRotationElement = new TiXmlElement("rotation");
+      pRotationElement->SetDoubleAttribute("qx", 0.0);
+      pRotationElement->SetDoubleAttribute("qy", 0.0);
+      pRotationElement->SetDoubleAttribute("qz", 0.0);
+      pRotationElement->SetDoubleAttribute("qw", 1.0);
+      pDecodeElement.LinkEndChild(pRotationElement);
+
+      TiXmlElement* pScaleElement = new TiXmlElement("scale");
+      pScaleElement->SetDoubleAttribute("x", scale.x);
+      pScaleElement->SetDoubleAttribute("y", scale.y);
+      pScaleElement->SetDoubleAttribute("z", scale.z);
+      pDecodeElement.LinkEndChild(pScaleElement);
+
+      pDecodeElement.LinkEndChild(pEntityElement->Clone());
+      pParentElement->ReplaceChild(pEntityElement, pDecodeElement);
+      id_counter++;
+    }
+    m_meshEntities.clear();
+  }
+
 	bool ExScene::writeSceneFile()
 	{    
+    applyMeshPositionTransforms();
 		return xmlDoc->SaveFile(scenePath.c_str());
 	}
 
@@ -22,6 +22,7 @@
 #include "ExSkeleton.h"
 #include "EasyOgreExporterLog.h"
 #include "decomp.h"
+#include "ExHash.h"
 #include "BipedApi.h"
 #include "IMixer.h"
 #include "iskin.h"
@@ -56,15 +57,17 @@ namespace EasyOgreExporter
     m_weights.clear();
     m_jointIds.clear();
 		m_animations.clear();
+    m_invBindMeshTMs.clear();
+    m_skinPoses.clear();
 		m_restorePose = "";
 	}
 
-  const std::vector<float> ExSkeleton::getWeightList(int index)
+  const std::vector<float>& ExSkeleton::getWeightList(int index)
   {
     return m_weights[index];
   }
 
-  const std::vector<int> ExSkeleton::getJointList(int index)
+  const std::vector<int>& ExSkeleton::getJointList(int index)
   {
     return m_jointIds[index];
   }
@@ -471,6 +474,12 @@ namespace EasyOgreExporter
 		// clear animations list
 		m_animations.clear();
 
+    // joints in mesh space at the bind pose, for the skin poses of the mesh bounds
+    m_skinPoses.clear();
+    m_invBindMeshTMs.resize(m_joints.size());
+    for (size_t j = 0; j < m_joints.size(); j++)
+      m_invBindMeshTMs[j] = Inverse(GetLocalMatrix(m_joints[j].pNode, m_pGameNode->GetMaxNode(), offsetTM, m_params.yUpAxis, GetFirstFrame()));
+
     //load clips from mixer
     IMixer* mixer = 0;
     IBipMaster* bipMaster = GetBipedMasterInterface(m_pGameSkin);
@@ -664,6 +673,17 @@ namespace EasyOgreExporter
 
 				//add keyframe to joint track
 				animTracks[j].addSkeletonKeyframe(key);
+
+        //skin transform of the joint in mesh space
+        Matrix3 skinTM = m_invBindMeshTMs[j] * GetLocalMatrix(m_joints[j].pNode, m_pGameNode->GetMaxNode(), offsetTM, m_params.yUpAxis, times[i]);
+        skinTM.SetRow(3, skinTM.GetRow(3) * m_params.lum);
+        for (int row = 0; row < 4; row++)
+        {
+          Point3 value = skinTM.GetRow(row);
+          m_skinPoses.push_back(value.x);
+          m_skinPoses.push_back(value.y);
+          m_skinPoses.push_back(value.z);
+        }
 			}
 		}
 		// add created tracks to current clip
@@ -723,7 +743,6 @@ namespace EasyOgreExporter
     key.trans = trans;
 		key.rot = rot;
 		key.scale = scale;
-    key.bbpos = sap.t * m_params.lum;
 
 		return key;
 	}
@@ -746,6 +765,12 @@ namespace EasyOgreExporter
 		return m_animations;
 	}
 
+	// Get the sampled skin transforms
+	const std::vector<float>& ExSkeleton::getSkinPoses()
+	{
+		return m_skinPoses;
+	}
+
 	// Write to an OGRE binary skeleton
 	bool ExSkeleton::writeOgreBinary()
 	{
@@ -781,7 +806,7 @@ namespace EasyOgreExporter
 		// Export skeleton binary
 		Ogre::SkeletonSerializer serializer;
 
-    std::string filePath = makeOutputPath(m_params.outputDir, m_params.meshOutputDir, m_name, "skeleton");
+    std::string filePath = getFilePath();
 		serializer.exportSkeleton(pSkeleton.getPointer(), filePath.c_str(), m_params.getSkeletonVersion());
 		pSkeleton.setNull();
 
@@ -789,6 +814,55 @@ namespace EasyOgreExporter
 		return true;
 	}
 
+	std::string ExSkeleton::getFilePath()
+	{
+		return makeOutputPath(m_params.outputDir, m_params.meshOutputDir, m_name, "skeleton");
+	}
+
+	std::string ExSkeleton::getCacheHash()
+	{
+		ExHasher hasher;
+		hasher.addString(m_name);
+
+		hasher.addInt(m_joints.size());
+		for (int i = 0; i < m_joints.size(); i++)
+		{
+			ExBone& bone = m_joints[i];
+			hasher.addString(bone.name);
+			hasher.addInt(bone.parentIndex);
+			for (int row = 0; row < 4; row++)
+			{
+				Point3 value = bone.bindMatrix.GetRow(row);
+				hasher.add(&value, sizeof(Point3));
+			}
+		}
+
+		//sampled keyframes, they change with the animation controllers
+		hasher.addInt(m_animations.size());
+		for (int i = 0; i < m_animations.size(); i++)
+		{
+			ExAnimation& anim = m_animations[i];
+			hasher.addString(anim.m_name);
+			hasher.addFloat(anim.m_length);
+			hasher.addInt(anim.m_tracks.size());
+			for (int j = 0; j < anim.m_tracks.size(); j++)
+			{
+				ExTrack& track = anim.m_tracks[j];
+				hasher.addString(track.m_bone);
+				hasher.addInt(track.m_skeletonKeyframes.size());
+				for (int k = 0; k < track.m_skeletonKeyframes.size(); k++)
+				{
+					skeletonKeyframe& key = track.m_skeletonKeyframes[k];
+					hasher.addFloat(key.time);
+					hasher.add(&key.trans, sizeof(Point3));
+					hasher.add(&key.rot, sizeof(Quat));
+					hasher.add(&key.scale, sizeof(Point3));
+				}
+			}
+		}
+		return hasher.toString();
+	}
+
 	// Write joints to an Ogre skeleton
 	bool ExSkeleton::createOgreBones(Ogre::SkeletonPtr pSkeleton)
 	{
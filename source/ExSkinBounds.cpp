@@ -0,0 +1,177 @@
+////////////////////////////////////////////////////////////////////////////////
+// ExSkinBounds.cpp
+// Start Date : October 17, 2026
+////////////////////////////////////////////////////////////////////////////////
+/*********************************************************************************
+*                                                                                *
+*   This program is free software; you can redistribute it and/or modify         *
+*   it under the terms of the GNU Lesser General Public License as published by  *
+*   the Free Software Foundation; either version 2 of the License, or            *
+*   (at your option) any later version.                                          *
+*                                                                                *
+**********************************************************************************/
+
+#include "ExSkinBounds.h"
+#include <math.h>
+#include <algorithm>
+
+namespace EasyOgreExporter
+{
+  static inline float distanceSquared(const float* a, const float* b)
+  {
+    float d[3] = {a[0] - b[0], a[1] - b[1], a[2] - b[2]};
+    return (d[0] * d[0]) + (d[1] * d[1]) + (d[2] * d[2]);
+  }
+
+  static unsigned int farthestVertex(const ExVertexStore& store, const std::vector<unsigned int>& vertices, const float* from)
+  {
+    unsigned int farthest = vertices[0];
+    float farthestDist = -1.0f;
+    for (size_t i = 0; i < vertices.size(); i++)
+    {
+      float dist = distanceSquared(store.getPosition(vertices[i]), from);
+      if (dist > farthestDist)
+      {
+        farthestDist = dist;
+        farthest = vertices[i];
+      }
+    }
+    return farthest;
+  }
+
+  bool computeBoundingSphere(const ExVertexStore& store, const std::vector<unsigned int>& vertices, float* center, float& radius)
+  {
+    if (vertices.empty())
+      return false;
+
+    //initial sphere on the diameter between two extreme points
+    const float* a = store.getPosition(farthestVertex(store, vertices, store.getPosition(vertices[0])));
+    const float* b = store.getPosition(farthestVertex(store, vertices, a));
+    for (int k = 0; k < 3; k++)
+      center[k] = (a[k] + b[k]) * 0.5f;
+    radius = sqrtf(distanceSquared(a, b)) * 0.5f;
+
+    //grow toward the outside vertices, the new sphere touch the vertex and the opposite side of the old one
+    float radiusSquared = radius * radius;
+    for (size_t i = 0; i < vertices.size(); i++)
+    {
+      const float* p = store.getPosition(vertices[i]);
+      float distSquared = distanceSquared(p, center);
+      if (distSquared <= radiusSquared)
+        continue;
+
+      float dist = sqrtf(distSquared);
+      float newRadius = (radius + dist) * 0.5f;
+      float shift = (newRadius - radius) / dist;
+      for (int k = 0; k < 3; k++)
+        center[k] += (p[k] - center[k]) * shift;
+      radius = newRadius;
+      radiusSquared = radius * radius;
+    }
+
+    //rounding of the last moves
+    for (size_t i = 0; i < vertices.size(); i++)
+      radius = std::max(radius, sqrtf(distanceSquared(store.getPosition(vertices[i]), center)));
+
+    return true;
+  }
+
+  ExSkinBounds::ExSkinBounds(const ExVertexStore& store, unsigned int numBones)
+  {
+    //vertices moved by each bone
+    std::vector<std::vector<unsigned int> > boneVertices(numBones);
+    unsigned int numInfluences = store.getNumInfluences();
+    for (unsigned int v = 0; v < store.size(); v++)
+    {
+      const float* weights = store.getWeights(v);
+      const int* bones = store.getBoneIndices(v);
+      for (unsigned int j = 0; j < numInfluences; j++)
+      {
+        if ((weights[j] > 0.0f) && (bones[j] >= 0) && ((unsigned int)bones[j] < numBones))
+          boneVertices[bones[j]].push_back(v);
+      }
+    }
+
+    for (unsigned int bone = 0; bone < numBones; bone++)
+    {
+      const std::vector<unsigned int>& vertices = boneVertices[bone];
+      BoneExtent extent;
+      extent.bone = bone;
+      if (!computeBoundingSphere(store, vertices, extent.center, extent.radius))
+        continue;
+
+      const float* first = store.getPosition(vertices[0]);
+      for (int k = 0; k < 3; k++)
+      {
+        extent.min[k] = first[k];
+        extent.max[k] = first[k];
+      }
+
+      for (size_t i = 1; i < vertices.size(); i++)
+      {
+        const float* pos = store.getPosition(vertices[i]);
+        for (int k = 0; k < 3; k++)
+        {
+          extent.min[k] = std::min(extent.min[k], pos[k]);
+          extent.max[k] = std::max(extent.max[k], pos[k]);
+        }
+      }
+      m_extents.push_back(extent);
+    }
+  }
+
+  void ExSkinBounds::addPose(const float* skinMatrices, float* boundsMin, float* boundsMax, float& radius) const
+  {
+    for (size_t i = 0; i < m_extents.size(); i++)
+    {
+      const BoneExtent& extent = m_extents[i];
+      const float* m = skinMatrices + (extent.bone * 12);
+
+      //transformed box, each axis takes the smallest and largest contribution of the input axes (Arvo)
+      float tmin[3];
+      float tmax[3];
+      for (int k = 0; k < 3; k++)
+      {
+        tmin[k] = m[9 + k];
+        tmax[k] = m[9 + k];
+        for (int j = 0; j < 3; j++)
+        {
+          float a = m[(j * 3) + k] * extent.min[j];
+          float b = m[(j * 3) + k] * extent.max[j];
+          tmin[k] += std::min(a, b);
+          tmax[k] += std::max(a, b);
+        }
+        boundsMin[k] = std::min(boundsMin[k], tmin[k]);
+        boundsMax[k] = std::max(boundsMax[k], tmax[k]);
+      }
+
+      //transformed sphere, the radius is scaled by a bound of the largest axis scale sqrt(|M|1 * |M|inf)
+      float center[3];
+      for (int k = 0; k < 3; k++)
+        center[k] = (extent.center[0] * m[k]) + (extent.center[1] * m[3 + k]) + (extent.center[2] * m[6 + k]) + m[9 + k];
+
+      float norm1 = 0.0f;
+      float normInf = 0.0f;
+      for (int k = 0; k < 3; k++)
+      {
+        norm1 = std::max(norm1, fabsf(m[(k * 3)]) + fabsf(m[(k * 3) + 1]) + fabsf(m[(k * 3) + 2]));
+        normInf = std::max(normInf, fabsf(m[k]) + fabsf(m[3 + k]) + fabsf(m[6 + k]));
+      }
+      float sphereRadius = sqrtf((center[0] * center[0]) + (center[1] * center[1]) + (center[2] * center[2])) + (extent.radius * sqrtf(norm1 * normInf));
+
+      //farthest corner of the box, both bound the vertices of the bone
+      float corner[3];
+      for (int k = 0; k < 3; k++)
+        corner[k] = std::max(fabsf(tmin[k]), fabsf(tmax[k]));
+      float boxRadius = sqrtf((corner[0] * corner[0]) + (corner[1] * corner[1]) + (corner[2] * corner[2]));
+
+      radius = std::max(radius, std::min(sphereRadius, boxRadius));
+    }
+  }
+
+  unsigned int ExSkinBounds::getNumUsedBones() const
+  {
+    return m_extents.size();
+  }
+
+}; //end of namespace
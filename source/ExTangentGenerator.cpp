@@ -0,0 +1,272 @@
+////////////////////////////////////////////////////////////////////////////////
+// ExTangentGenerator.cpp
+// Start Date : October 17, 2026
+////////////////////////////////////////////////////////////////////////////////
+/*********************************************************************************
+*                                                                                *
+*   This program is free software; you can redistribute it and/or modify         *
+*   it under the terms of the GNU Lesser General Public License as published by  *
+*   the Free Software Foundation; either version 2 of the License, or            *
+*   (at your option) any later version.                                          *
+*                                                                                *
+**********************************************************************************/
+
+#include "ExTangentGenerator.h"
+#include "ExVertexWelder.h"
+#include <math.h>
+#include <float.h>
+#include <algorithm>
+
+namespace EasyOgreExporter
+{
+  //faces or corners computed together, the block arrays are laid out by component so the compiler can vectorize the loops
+  static const unsigned int TANGENT_BLOCK_SIZE = 64;
+
+  static inline float dot3(const float* a, const float* b)
+  {
+    return (a[0] * b[0]) + (a[1] * b[1]) + (a[2] * b[2]);
+  }
+
+  // remove the normal component of v, n is normalized
+  static inline void projectOnPlane(const float* n, float* v)
+  {
+    float d = dot3(n, v);
+    v[0] -= n[0] * d;
+    v[1] -= n[1] * d;
+    v[2] -= n[2] * d;
+  }
+
+  // return false when the vector is too small to get a direction
+  static inline bool normalize3(float* v)
+  {
+    float len = sqrtf(dot3(v, v));
+    if (len <= FLT_MIN)
+      return false;
+
+    float inv = 1.0f / len;
+    v[0] *= inv;
+    v[1] *= inv;
+    v[2] *= inv;
+    return true;
+  }
+
+  // any unit vector orthogonal to n
+  static void orthogonalVector(const float* n, float* v)
+  {
+    float axis[3] = {0.0f, 0.0f, 0.0f};
+    if ((fabs(n[0]) <= fabs(n[1])) && (fabs(n[0]) <= fabs(n[2])))
+      axis[0] = 1.0f;
+    else if (fabs(n[1]) <= fabs(n[2]))
+      axis[1] = 1.0f;
+    else
+      axis[2] = 1.0f;
+
+    v[0] = axis[0];
+    v[1] = axis[1];
+    v[2] = axis[2];
+    projectOnPlane(n, v);
+    if (!normalize3(v))
+    {
+      v[0] = 1.0f;
+      v[1] = 0.0f;
+      v[2] = 0.0f;
+    }
+  }
+
+  // projectOnPlane on a block of vectors
+  static void projectBlock(const float* nx, const float* ny, const float* nz, float* x, float* y, float* z, unsigned int count)
+  {
+    for (unsigned int i = 0; i < count; i++)
+    {
+      float d = (nx[i] * x[i]) + (ny[i] * y[i]) + (nz[i] * z[i]);
+      x[i] -= nx[i] * d;
+      y[i] -= ny[i] * d;
+      z[i] -= nz[i] * d;
+    }
+  }
+
+  // normalize3 on a block of vectors, valid is cleared for the vectors too small to get a direction
+  static void normalizeBlock(float* x, float* y, float* z, unsigned char* valid, unsigned int count)
+  {
+    for (unsigned int i = 0; i < count; i++)
+    {
+      float len = sqrtf((x[i] * x[i]) + (y[i] * y[i]) + (z[i] * z[i]));
+      bool ok = len > FLT_MIN;
+      float inv = 1.0f / (ok ? len : 1.0f);
+      x[i] *= inv;
+      y[i] *= inv;
+      z[i] *= inv;
+      valid[i] = (ok && valid[i]) ? 1 : 0;
+    }
+  }
+
+  void computeTangents(const ExMeshSnapshot& snapshot, unsigned int texCoordSet, float weldTolerance, std::vector<float>& cornerTangents)
+  {
+    unsigned int numFaces = snapshot.getNumFaces();
+    unsigned int numCorners = numFaces * 3;
+    unsigned int numSets = snapshot.numTexCoordSets;
+    const float* positions = snapshot.positions.empty() ? 0 : &snapshot.positions[0];
+    const float* normals = snapshot.cornerNormals.empty() ? 0 : &snapshot.cornerNormals[0];
+    const float* texCoords = snapshot.cornerTexCoords.empty() ? 0 : &snapshot.cornerTexCoords[0];
+    const int* faceVertices = snapshot.faceVertices.empty() ? 0 : &snapshot.faceVertices[0];
+
+    cornerTangents.assign(numCorners * 4, 0.0f);
+    if (numFaces == 0)
+      return;
+
+    // triangle tangents, first pass on the faces only
+    std::vector<float> faceTangentX(numFaces);
+    std::vector<float> faceTangentY(numFaces);
+    std::vector<float> faceTangentZ(numFaces);
+    std::vector<unsigned char> faceOrient(numFaces);
+    std::vector<unsigned char> faceValid(numFaces);
+    float e1x[TANGENT_BLOCK_SIZE], e1y[TANGENT_BLOCK_SIZE], e1z[TANGENT_BLOCK_SIZE];
+    float e2x[TANGENT_BLOCK_SIZE], e2y[TANGENT_BLOCK_SIZE], e2z[TANGENT_BLOCK_SIZE];
+    float t21x[TANGENT_BLOCK_SIZE], t21y[TANGENT_BLOCK_SIZE], t31x[TANGENT_BLOCK_SIZE], t31y[TANGENT_BLOCK_SIZE];
+    for (unsigned int first = 0; first < numFaces; first += TANGENT_BLOCK_SIZE)
+    {
+      unsigned int count = std::min(numFaces - first, TANGENT_BLOCK_SIZE);
+
+      // gather the triangle edges and uv deltas
+      for (unsigned int i = 0; i < count; i++)
+      {
+        unsigned int f = first + i;
+        const float* p0 = &positions[faceVertices[(f * 3)] * 3];
+        const float* p1 = &positions[faceVertices[(f * 3) + 1] * 3];
+        const float* p2 = &positions[faceVertices[(f * 3) + 2] * 3];
+        const float* uv0 = &texCoords[((((f * 3)) * numSets) + texCoordSet) * 3];
+        const float* uv1 = &texCoords[((((f * 3) + 1) * numSets) + texCoordSet) * 3];
+        const float* uv2 = &texCoords[((((f * 3) + 2) * numSets) + texCoordSet) * 3];
+
+        e1x[i] = p1[0] - p0[0];
+        e1y[i] = p1[1] - p0[1];
+        e1z[i] = p1[2] - p0[2];
+        e2x[i] = p2[0] - p0[0];
+        e2y[i] = p2[1] - p0[1];
+        e2z[i] = p2[2] - p0[2];
+        t21x[i] = uv1[0] - uv0[0];
+        t21y[i] = uv1[1] - uv0[1];
+        t31x[i] = uv2[0] - uv0[0];
+        t31y[i] = uv2[1] - uv0[1];
+      }
+
+      //dP/du scaled by the uv area
+      float* tx = &faceTangentX[first];
+      float* ty = &faceTangentY[first];
+      float* tz = &faceTangentZ[first];
+      unsigned char* orient = &faceOrient[first];
+      unsigned char* valid = &faceValid[first];
+      for (unsigned int i = 0; i < count; i++)
+      {
+        float signedArea = (t21x[i] * t31y[i]) - (t21y[i] * t31x[i]);
+        tx[i] = (t31y[i] * e1x[i]) - (t21y[i] * e2x[i]);
+        ty[i] = (t31y[i] * e1y[i]) - (t21y[i] * e2y[i]);
+        tz[i] = (t31y[i] * e1z[i]) - (t21y[i] * e2z[i]);
+        orient[i] = (signedArea > 0.0f) ? 1 : 0;
+        valid[i] = (fabsf(signedArea) > FLT_MIN) ? 1 : 0;
+      }
+      normalizeBlock(tx, ty, tz, valid, count);
+
+      //the mirrored uvs get the opposite direction
+      for (unsigned int i = 0; i < count; i++)
+      {
+        float sign = orient[i] ? 1.0f : -1.0f;
+        tx[i] *= sign;
+        ty[i] *= sign;
+        tz[i] *= sign;
+      }
+    }
+
+    // group the corners sharing the position, normal, uv and handedness, like the vertices of the MikkTSpace interface
+    ExVertexWelder welder(weldTolerance, 3 + 2 + 1, numCorners);
+    std::vector<int> cornerGroups(numCorners);
+    for (unsigned int corner = 0; corner < numCorners; corner++)
+    {
+      const float* uv = &texCoords[((corner * numSets) + texCoordSet) * 3];
+      const float* n = &normals[corner * 3];
+      float attribs[6] = {n[0], n[1], n[2], uv[0], uv[1], faceOrient[corner / 3] ? 1.0f : -1.0f};
+      cornerGroups[corner] = welder.addVertex(&positions[faceVertices[corner] * 3], attribs);
+    }
+
+    // sum the projected triangle tangents weighted by the corner angle
+    std::vector<float> groupTangents(welder.getNumVertices() * 3, 0.0f);
+    float nx[TANGENT_BLOCK_SIZE], ny[TANGENT_BLOCK_SIZE], nz[TANGENT_BLOCK_SIZE];
+    float tx[TANGENT_BLOCK_SIZE], ty[TANGENT_BLOCK_SIZE], tz[TANGENT_BLOCK_SIZE];
+    float angles[TANGENT_BLOCK_SIZE];
+    unsigned char valid[TANGENT_BLOCK_SIZE];
+    for (unsigned int first = 0; first < numCorners; first += TANGENT_BLOCK_SIZE)
+    {
+      unsigned int count = std::min(numCorners - first, TANGENT_BLOCK_SIZE);
+
+      // gather the corner normal, its 2 edges and the triangle tangent
+      for (unsigned int i = 0; i < count; i++)
+      {
+        unsigned int corner = first + i;
+        unsigned int f = corner / 3;
+        unsigned int k = corner - (f * 3);
+        const float* n = &normals[corner * 3];
+        const float* p = &positions[faceVertices[corner] * 3];
+        const float* pNext = &positions[faceVertices[(f * 3) + ((k + 1) % 3)] * 3];
+        const float* pPrev = &positions[faceVertices[(f * 3) + ((k + 2) % 3)] * 3];
+
+        nx[i] = n[0];
+        ny[i] = n[1];
+        nz[i] = n[2];
+        e1x[i] = pNext[0] - p[0];
+        e1y[i] = pNext[1] - p[1];
+        e1z[i] = pNext[2] - p[2];
+        e2x[i] = pPrev[0] - p[0];
+        e2y[i] = pPrev[1] - p[1];
+        e2z[i] = pPrev[2] - p[2];
+        tx[i] = faceTangentX[f];
+        ty[i] = faceTangentY[f];
+        tz[i] = faceTangentZ[f];
+        valid[i] = faceValid[f];
+      }
+
+      // corner angle between the edges projected on the normal plane
+      projectBlock(nx, ny, nz, e1x, e1y, e1z, count);
+      projectBlock(nx, ny, nz, e2x, e2y, e2z, count);
+      normalizeBlock(e1x, e1y, e1z, valid, count);
+      normalizeBlock(e2x, e2y, e2z, valid, count);
+      for (unsigned int i = 0; i < count; i++)
+      {
+        float cosAngle = (e1x[i] * e2x[i]) + (e1y[i] * e2y[i]) + (e1z[i] * e2z[i]);
+        cosAngle = (cosAngle > 1.0f) ? 1.0f : ((cosAngle < -1.0f) ? -1.0f : cosAngle);
+        angles[i] = acosf(cosAngle);
+      }
+
+      projectBlock(nx, ny, nz, tx, ty, tz, count);
+      normalizeBlock(tx, ty, tz, valid, count);
+
+      // scatter to the corner groups
+      for (unsigned int i = 0; i < count; i++)
+      {
+        if (!valid[i])
+          continue;
+
+        float* sum = &groupTangents[cornerGroups[first + i] * 3];
+        sum[0] += tx[i] * angles[i];
+        sum[1] += ty[i] * angles[i];
+        sum[2] += tz[i] * angles[i];
+      }
+    }
+
+    // orthonormalize on each corner normal, the degenerated corners get any tangent
+    for (unsigned int corner = 0; corner < numCorners; corner++)
+    {
+      const float* n = &normals[corner * 3];
+      const float* sum = &groupTangents[cornerGroups[corner] * 3];
+      float* tangent = &cornerTangents[corner * 4];
+      tangent[0] = sum[0];
+      tangent[1] = sum[1];
+      tangent[2] = sum[2];
+      projectOnPlane(n, tangent);
+      if (!normalize3(tangent))
+        orthogonalVector(n, tangent);
+
+      tangent[3] = faceOrient[corner / 3] ? 1.0f : -1.0f;
+    }
+  }
+
+}; //end of namespace
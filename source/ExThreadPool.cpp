@@ -0,0 +1,149 @@
+////////////////////////////////////////////////////////////////////////////////
+// ExThreadPool.cpp
+// Start Date : October 17, 2026
+////////////////////////////////////////////////////////////////////////////////
+/*********************************************************************************
+*                                                                                *
+*   This program is free software; you can redistribute it and/or modify         *
+*   it under the terms of the GNU Lesser General Public License as published by  *
+*   the Free Software Foundation; either version 2 of the License, or            *
+*   (at your option) any later version.                                          *
+*                                                                                *
+**********************************************************************************/
+
+#include "ExThreadPool.h"
+#ifndef EX_SERIAL_THREADPOOL
+#include <thread>
+#endif
+
+namespace EasyOgreExporter
+{
+#ifdef EX_SERIAL_THREADPOOL
+  ExThreadPool::ExThreadPool(unsigned int numThreads)
+  {
+    m_numThreads = 1;
+  }
+
+  ExThreadPool::~ExThreadPool()
+  {
+  }
+
+  unsigned int ExThreadPool::getNumThreads() const
+  {
+    return m_numThreads;
+  }
+
+  void ExThreadPool::run(size_t count, ExPoolJob& job)
+  {
+    //no threads, the jobs run in order and the first exception stops them
+    for (size_t i = 0; i < count; i++)
+      job.run(i);
+  }
+
+#else
+  ExThreadPool::ExThreadPool(unsigned int numThreads)
+  {
+    m_numThreads = numThreads;
+    if (m_numThreads == 0)
+      m_numThreads = std::thread::hardware_concurrency();
+    if (m_numThreads == 0)
+      m_numThreads = 1;
+
+    for (unsigned int i = 0; i < m_numThreads; i++)
+      m_queues.push_back(new WorkQueue());
+  }
+
+  ExThreadPool::~ExThreadPool()
+  {
+    for (size_t i = 0; i < m_queues.size(); i++)
+      delete m_queues[i];
+    m_queues.clear();
+  }
+
+  unsigned int ExThreadPool::getNumThreads() const
+  {
+    return m_numThreads;
+  }
+
+  bool ExThreadPool::popJob(unsigned int worker, size_t& job)
+  {
+    //own queue first, from the back
+    {
+      WorkQueue* queue = m_queues[worker];
+      std::lock_guard<std::mutex> guard(queue->lock);
+      if (!queue->jobs.empty())
+      {
+        job = queue->jobs.back();
+        queue->jobs.pop_back();
+        return true;
+      }
+    }
+
+    //steal from the front of the next workers
+    for (unsigned int i = 1; i < m_numThreads; i++)
+    {
+      WorkQueue* queue = m_queues[(worker + i) % m_numThreads];
+      std::lock_guard<std::mutex> guard(queue->lock);
+      if (!queue->jobs.empty())
+      {
+        job = queue->jobs.front();
+        queue->jobs.pop_front();
+        return true;
+      }
+    }
+
+    //jobs are never added while running, all the queues are empty
+    return false;
+  }
+
+  void ExThreadPool::workerLoop(unsigned int worker, ExPoolJob* job)
+  {
+    size_t index = 0;
+    while (popJob(worker, index))
+    {
+      try
+      {
+        job->run(index);
+      }
+      catch (...)
+      {
+        std::lock_guard<std::mutex> guard(m_errorLock);
+        if (!m_error)
+          m_error = std::current_exception();
+      }
+    }
+  }
+
+  void ExThreadPool::run(size_t count, ExPoolJob& job)
+  {
+    if (count == 0)
+      return;
+
+    m_error = std::exception_ptr();
+
+    //contiguous ranges, in reverse order so each worker pops its jobs in ascending order
+    unsigned int numWorkers = (count < m_numThreads) ? (unsigned int)count : m_numThreads;
+    for (unsigned int i = 0; i < numWorkers; i++)
+    {
+      size_t start = (count * i) / numWorkers;
+      size_t end = (count * (i + 1)) / numWorkers;
+      for (size_t j = end; j > start; j--)
+        m_queues[i]->jobs.push_back(j - 1);
+    }
+
+    //the calling thread is the first worker
+    std::vector<std::thread> threads;
+    for (unsigned int i = 1; i < numWorkers; i++)
+      threads.push_back(std::thread(&ExThreadPool::workerLoop, this, i, &job));
+
+    workerLoop(0, &job);
+
+    for (size_t i = 0; i < threads.size(); i++)
+      threads[i].join();
+
+    if (m_error)
+      std::rethrow_exception(m_error);
+  }
+#endif
+
+}; //end of namespace
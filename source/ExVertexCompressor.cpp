@@ -0,0 +1,281 @@
+////////////////////////////////////////////////////////////////////////////////
+// ExVertexCompressor.cpp
+// Start Date : October 17, 2026
+////////////////////////////////////////////////////////////////////////////////
+/*********************************************************************************
+*                                                                                *
+*   This program is free software; you can redistribute it and/or modify         *
+*   it under the terms of the GNU Lesser General Public License as published by  *
+*   the Free Software Foundation; either version 2 of the License, or            *
+*   (at your option) any later version.                                          *
+*                                                                                *
+**********************************************************************************/
+
+#include "ExVertexCompressor.h"
+#include "OgreBitwise.h"
+
+// normalized integer formats are available since Ogre 1.11, half floats since Ogre 13
+#define EX_OGRE_HAS_NORM_TYPES (OGRE_VERSION >= ((1 << 16) | (11 << 8)))
+#define EX_OGRE_HAS_HALF_TYPES (OGRE_VERSION >= (13 << 16))
+
+namespace EasyOgreExporter
+{
+  static inline short quantizeSNorm16(float v)
+  {
+    v = std::max(-1.0f, std::min(1.0f, v));
+    return static_cast<short>(floor(v * 32767.0f + 0.5f));
+  }
+
+  static inline Ogre::uint32 quantizeSNorm10(float v)
+  {
+    v = std::max(-1.0f, std::min(1.0f, v));
+    int q = static_cast<int>(floor(v * 511.0f + 0.5f));
+    return static_cast<Ogre::uint32>(q) & 0x3ff;
+  }
+
+  ExVertexCompressor::ExVertexCompressor(float maxError)
+  {
+    m_maxError = maxError;
+    m_positions = false;
+    m_normals = false;
+    m_texCoords = false;
+    m_posOffset = Ogre::Vector3::ZERO;
+    m_posScale = Ogre::Vector3::UNIT_SCALE;
+  }
+
+  ExVertexCompressor::~ExVertexCompressor()
+  {
+  }
+
+  void ExVertexCompressor::setup(const Ogre::AxisAlignedBox& bounds, bool positions, bool normals, bool texCoords)
+  {
+    m_positions = false;
+    m_normals = false;
+    m_texCoords = false;
+
+    // 16 bits positions, the error is half a quantization step on the largest axis
+    if (positions && bounds.isFinite())
+    {
+      Ogre::Vector3 halfSize = bounds.getHalfSize();
+      float maxHalfSize = std::max(halfSize.x, std::max(halfSize.y, halfSize.z));
+      float posError = maxHalfSize / 32767.0f;
+      if (posError <= m_maxError)
+      {
+        m_positions = true;
+        m_posOffset = bounds.getCenter();
+
+        //same scale on all the axes, the decode node stays well conditioned and keeps the normals valid on flat meshes
+        m_posScale = Ogre::Vector3(std::max(maxHalfSize, 0.000001f));
+#if !EX_OGRE_HAS_NORM_TYPES
+        //plain shorts, the decode scale include the quantization range
+        m_posScale /= 32767.0f;
+#endif
+      }
+    }
+
+    // 10 bits normals components
+#if EX_OGRE_HAS_NORM_TYPES
+    if (normals && ((1.0f / 1022.0f) <= m_maxError))
+      m_normals = true;
+#endif
+
+    // half float uvs, the error depend on the uv range and is checked on each buffer
+#if EX_OGRE_HAS_HALF_TYPES
+    m_texCoords = texCoords;
+#endif
+  }
+
+  bool ExVertexCompressor::hasPositionTransform() const
+  {
+    return m_positions;
+  }
+
+  Ogre::Vector3 ExVertexCompressor::getPositionOffset() const
+  {
+    return m_posOffset;
+  }
+
+  Ogre::Vector3 ExVertexCompressor::getPositionScale() const
+  {
+    return m_posScale;
+  }
+
+  size_t ExVertexCompressor::getVertexSize(const Ogre::VertexDeclaration* decl)
+  {
+    size_t size = 0;
+    if (decl->getElementCount() == 0)
+      return size;
+
+    for (unsigned short source = 0; source <= decl->getMaxSource(); source++)
+      size += decl->getVertexSize(source);
+
+    return size;
+  }
+
+  float ExVertexCompressor::getMaxTexCoord(const Ogre::VertexElement& elem, Ogre::VertexData* vdata) const
+  {
+    Ogre::HardwareVertexBufferSharedPtr vbuf = vdata->vertexBufferBinding->getBuffer(elem.getSource());
+    unsigned char* pVert = static_cast<unsigned char*>(vbuf->lock(Ogre::HardwareBuffer::HBL_READ_ONLY));
+
+    float maxValue = 0.0f;
+    float* pFloat;
+    for (size_t v = 0; v < vdata->vertexCount; v++, pVert += vbuf->getVertexSize())
+    {
+      elem.baseVertexPointerToElement(pVert, &pFloat);
+      maxValue = std::max(maxValue, std::max(fabs(pFloat[0]), fabs(pFloat[1])));
+    }
+    vbuf->unlock();
+    return maxValue;
+  }
+
+  Ogre::VertexElementType ExVertexCompressor::getCompressedType(const Ogre::VertexElement& elem, Ogre::VertexData* vdata) const
+  {
+    switch (elem.getSemantic())
+    {
+    case Ogre::VES_POSITION:
+      if (m_positions && (elem.getType() == Ogre::VET_FLOAT3))
+#if EX_OGRE_HAS_NORM_TYPES
+        return Ogre::VET_SHORT4_NORM;
+#else
+        return Ogre::VET_SHORT4;
+#endif
+      break;
+
+#if EX_OGRE_HAS_NORM_TYPES
+    case Ogre::VES_NORMAL:
+      if (m_normals && (elem.getType() == Ogre::VET_FLOAT3))
+        return Ogre::VET_INT_10_10_10_2_NORM;
+      break;
+#endif
+
+#if EX_OGRE_HAS_HALF_TYPES
+    case Ogre::VES_TEXTURE_COORDINATES:
+      if (m_texCoords && (elem.getType() == Ogre::VET_FLOAT2))
+      {
+        // half float keep 11 significant bits
+        float maxValue = getMaxTexCoord(elem, vdata);
+        float ulp = (maxValue > 0.0f) ? pow(2.0f, floor(log(maxValue) / log(2.0f)) - 10.0f) : 0.0f;
+        if ((ulp * 0.5f) <= m_maxError)
+          return Ogre::VET_HALF2;
+      }
+      break;
+#endif
+
+    default:
+      break;
+    }
+    return elem.getType();
+  }
+
+  bool ExVertexCompressor::compress(Ogre::VertexData* vdata)
+  {
+    Ogre::VertexDeclaration* decl = vdata->vertexDeclaration;
+    if (!decl || (decl->getElementCount() == 0) || (vdata->vertexCount == 0))
+      return false;
+
+    // new declaration with the same sources and elements order
+    Ogre::VertexDeclaration* newDecl = Ogre::HardwareBufferManager::getSingleton().createVertexDeclaration();
+    std::vector<size_t> offsets(decl->getMaxSource() + 1, 0);
+    bool changed = false;
+
+    const Ogre::VertexDeclaration::VertexElementList& elems = decl->getElements();
+    Ogre::VertexDeclaration::VertexElementList::const_iterator elemItr;
+    for (elemItr = elems.begin(); elemItr != elems.end(); ++elemItr)
+    {
+      Ogre::VertexElementType type = getCompressedType(*elemItr, vdata);
+      if (type != elemItr->getType())
+        changed = true;
+
+      unsigned short source = elemItr->getSource();
+      newDecl->addElement(source, offsets[source], type, elemItr->getSemantic(), elemItr->getIndex());
+      offsets[source] += Ogre::VertexElement::getTypeSize(type);
+    }
+
+    if (!changed)
+    {
+      Ogre::HardwareBufferManager::getSingleton().destroyVertexDeclaration(newDecl);
+      return false;
+    }
+
+    // convert each source buffer
+    Ogre::VertexBufferBinding* bind = vdata->vertexBufferBinding;
+    for (unsigned short source = 0; source <= decl->getMaxSource(); source++)
+    {
+      if (!bind->isBufferBound(source))
+        continue;
+
+      Ogre::HardwareVertexBufferSharedPtr srcBuf = bind->getBuffer(source);
+      Ogre::HardwareVertexBufferSharedPtr dstBuf = Ogre::HardwareBufferManager::getSingleton().createVertexBuffer(
+        newDecl->getVertexSize(source), vdata->vertexCount, Ogre::HardwareBuffer::HBU_STATIC_WRITE_ONLY, false);
+
+      unsigned char* pSrcBase = static_cast<unsigned char*>(srcBuf->lock(Ogre::HardwareBuffer::HBL_READ_ONLY));
+      unsigned char* pDstBase = static_cast<unsigned char*>(dstBuf->lock(Ogre::HardwareBuffer::HBL_DISCARD));
+      size_t srcStride = srcBuf->getVertexSize();
+      size_t dstStride = dstBuf->getVertexSize();
+
+      Ogre::VertexDeclaration::VertexElementList srcElems = decl->findElementsBySource(source);
+      Ogre::VertexDeclaration::VertexElementList dstElems = newDecl->findElementsBySource(source);
+      Ogre::VertexDeclaration::VertexElementList::const_iterator srcItr = srcElems.begin();
+      Ogre::VertexDeclaration::VertexElementList::const_iterator dstItr = dstElems.begin();
+      for (; (srcItr != srcElems.end()) && (dstItr != dstElems.end()); ++srcItr, ++dstItr)
+      {
+        unsigned char* pSrc = pSrcBase + srcItr->getOffset();
+        unsigned char* pDst = pDstBase + dstItr->getOffset();
+        size_t srcSize = srcItr->getSize();
+
+        // one conversion loop per format
+        if (srcItr->getType() == dstItr->getType())
+        {
+          for (size_t v = 0; v < vdata->vertexCount; v++, pSrc += srcStride, pDst += dstStride)
+            memcpy(pDst, pSrc, srcSize);
+        }
+        else if (srcItr->getSemantic() == Ogre::VES_POSITION)
+        {
+          for (size_t v = 0; v < vdata->vertexCount; v++, pSrc += srcStride, pDst += dstStride)
+          {
+            const float* pFloat = reinterpret_cast<const float*>(pSrc);
+            short* pShort = reinterpret_cast<short*>(pDst);
+#if EX_OGRE_HAS_NORM_TYPES
+            pShort[0] = quantizeSNorm16((pFloat[0] - m_posOffset.x) / m_posScale.x);
+            pShort[1] = quantizeSNorm16((pFloat[1] - m_posOffset.y) / m_posScale.y);
+            pShort[2] = quantizeSNorm16((pFloat[2] - m_posOffset.z) / m_posScale.z);
+            pShort[3] = 32767;
+#else
+            pShort[0] = quantizeSNorm16((pFloat[0] - m_posOffset.x) / (m_posScale.x * 32767.0f));
+            pShort[1] = quantizeSNorm16((pFloat[1] - m_posOffset.y) / (m_posScale.y * 32767.0f));
+            pShort[2] = quantizeSNorm16((pFloat[2] - m_posOffset.z) / (m_posScale.z * 32767.0f));
+            pShort[3] = 1;
+#endif
+          }
+        }
+        else if (srcItr->getSemantic() == Ogre::VES_NORMAL)
+        {
+          for (size_t v = 0; v < vdata->vertexCount; v++, pSrc += srcStride, pDst += dstStride)
+          {
+            const float* pFloat = reinterpret_cast<const float*>(pSrc);
+            *reinterpret_cast<Ogre::uint32*>(pDst) = quantizeSNorm10(pFloat[0]) | (quantizeSNorm10(pFloat[1]) << 10) | (quantizeSNorm10(pFloat[2]) << 20);
+          }
+        }
+        else if (srcItr->getSemantic() == Ogre::VES_TEXTURE_COORDINATES)
+        {
+          for (size_t v = 0; v < vdata->vertexCount; v++, pSrc += srcStride, pDst += dstStride)
+          {
+            const float* pFloat = reinterpret_cast<const float*>(pSrc);
+            Ogre::uint16* pHalf = reinterpret_cast<Ogre::uint16*>(pDst);
+            pHalf[0] = Ogre::Bitwise::floatToHalf(pFloat[0]);
+            pHalf[1] = Ogre::Bitwise::floatToHalf(pFloat[1]);
+          }
+        }
+      }
+
+      srcBuf->unlock();
+      dstBuf->unlock();
+      bind->setBinding(source, dstBuf);
+    }
+
+    Ogre::HardwareBufferManager::getSingleton().destroyVertexDeclaration(decl);
+    vdata->vertexDeclaration = newDecl;
+    return true;
+  }
+
+}; //end of namespace
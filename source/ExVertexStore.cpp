@@ -0,0 +1,140 @@
+////////////////////////////////////////////////////////////////////////////////
+// ExVertexStore.cpp
+// Start Date : October 17, 2026
+////////////////////////////////////////////////////////////////////////////////
+/*********************************************************************************
+*                                                                                *
+*   This program is free software; you can redistribute it and/or modify         *
+*   it under the terms of the GNU Lesser General Public License as published by  *
+*   the Free Software Foundation; either version 2 of the License, or            *
+*   (at your option) any later version.                                          *
+*                                                                                *
+**********************************************************************************/
+
+#include "ExVertexStore.h"
+#include <algorithm>
+
+namespace EasyOgreExporter
+{
+  // gather the elements of a per vertex array in a new order
+  template <typename T> static void reorderArray(std::vector<T>& data, unsigned int stride, const std::vector<int>& order)
+  {
+    if (stride == 0)
+      return;
+
+    std::vector<T> ndata(order.size() * stride);
+    for (size_t v = 0; v < order.size(); v++)
+    {
+      const T* src = &data[order[v] * stride];
+      for (unsigned int k = 0; k < stride; k++)
+        ndata[(v * stride) + k] = src[k];
+    }
+    data.swap(ndata);
+  }
+
+  ExVertexStore::ExVertexStore()
+  {
+    m_numTexCoords = 0;
+    m_numInfluences = 0;
+    m_hasTangents = false;
+  }
+
+  ExVertexStore::~ExVertexStore()
+  {
+    clear();
+  }
+
+  void ExVertexStore::setLayout(unsigned int numTexCoords, unsigned int numInfluences, bool tangents)
+  {
+    clear();
+    m_numTexCoords = numTexCoords;
+    m_numInfluences = numInfluences;
+    m_hasTangents = tangents;
+  }
+
+  void ExVertexStore::reserve(unsigned int numVertices)
+  {
+    m_maxIds.reserve(numVertices);
+    m_positions.reserve(numVertices * 3);
+    m_normals.reserve(numVertices * 3);
+    m_colors.reserve(numVertices * 4);
+    m_texCoords.reserve(numVertices * m_numTexCoords * 2);
+    m_weights.reserve(numVertices * m_numInfluences);
+    m_boneIndices.reserve(numVertices * m_numInfluences);
+    m_tangents.reserve(m_hasTangents ? numVertices * 4 : 0);
+  }
+
+  void ExVertexStore::clear()
+  {
+    m_maxIds.clear();
+    m_positions.clear();
+    m_normals.clear();
+    m_colors.clear();
+    m_texCoords.clear();
+    m_weights.clear();
+    m_boneIndices.clear();
+    m_tangents.clear();
+  }
+
+  unsigned int ExVertexStore::addVertex(int maxId, const float* pos, const float* normal, const float* color, const float* texCoords, const float* weights, const int* bones, const float* tangent)
+  {
+    unsigned int handle = m_maxIds.size();
+    m_maxIds.push_back(maxId);
+    m_positions.insert(m_positions.end(), pos, pos + 3);
+    m_normals.insert(m_normals.end(), normal, normal + 3);
+    m_colors.insert(m_colors.end(), color, color + 4);
+
+    if (m_numTexCoords)
+      m_texCoords.insert(m_texCoords.end(), texCoords, texCoords + (m_numTexCoords * 2));
+
+    if (m_numInfluences)
+    {
+      if (weights && bones)
+      {
+        m_weights.insert(m_weights.end(), weights, weights + m_numInfluences);
+        m_boneIndices.insert(m_boneIndices.end(), bones, bones + m_numInfluences);
+      }
+      else
+      {
+        m_weights.resize(m_weights.size() + m_numInfluences, 0.0f);
+        m_boneIndices.resize(m_boneIndices.size() + m_numInfluences, 0);
+      }
+    }
+
+    if (m_hasTangents)
+    {
+      const float defaultTangent[4] = {1.0f, 0.0f, 0.0f, 1.0f};
+      const float* tan = tangent ? tangent : defaultTangent;
+      m_tangents.insert(m_tangents.end(), tan, tan + 4);
+    }
+    return handle;
+  }
+
+  void ExVertexStore::reorder(const std::vector<int>& order)
+  {
+    reorderArray(m_maxIds, 1, order);
+    reorderArray(m_positions, 3, order);
+    reorderArray(m_normals, 3, order);
+    reorderArray(m_colors, 4, order);
+    reorderArray(m_texCoords, m_numTexCoords * 2, order);
+    reorderArray(m_weights, m_numInfluences, order);
+    reorderArray(m_boneIndices, m_numInfluences, order);
+    reorderArray(m_tangents, m_hasTangents ? 4 : 0, order);
+  }
+
+  void ExVertexStore::swap(ExVertexStore& other)
+  {
+    std::swap(m_numTexCoords, other.m_numTexCoords);
+    std::swap(m_numInfluences, other.m_numInfluences);
+    std::swap(m_hasTangents, other.m_hasTangents);
+    m_maxIds.swap(other.m_maxIds);
+    m_positions.swap(other.m_positions);
+    m_normals.swap(other.m_normals);
+    m_colors.swap(other.m_colors);
+    m_texCoords.swap(other.m_texCoords);
+    m_weights.swap(other.m_weights);
+    m_boneIndices.swap(other.m_boneIndices);
+    m_tangents.swap(other.m_tangents);
+  }
+
+}; //end of namespace
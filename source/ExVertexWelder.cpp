@@ -0,0 +1,201 @@
+////////////////////////////////////////////////////////////////////////////////
+// ExVertexWelder.cpp
+// Start Date : October 17, 2026
+////////////////////////////////////////////////////////////////////////////////
+/*********************************************************************************
+*                                                                                *
+*   This program is free software; you can redistribute it and/or modify         *
+*   it under the terms of the GNU Lesser General Public License as published by  *
+*   the Free Software Foundation; either version 2 of the License, or            *
+*   (at your option) any later version.                                          *
+*                                                                                *
+**********************************************************************************/
+
+#include "ExVertexWelder.h"
+#include <math.h>
+
+namespace EasyOgreExporter
+{
+  // 64 bits finalizer from MurmurHash3, spread the quantized coordinates on all the bits
+  static inline unsigned long long mixHash64(unsigned long long h)
+  {
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
+  }
+
+  static inline long long quantize(float value, float invTolerance)
+  {
+    return (long long)floor((double)value * (double)invTolerance + 0.5);
+  }
+
+  ExVertexWelder::ExVertexWelder(float tolerance, unsigned int attribStride, unsigned int expectedVertices)
+  {
+    m_tolerance = (tolerance > 0.0f) ? tolerance : 0.000001f;
+    m_invTolerance = 1.0f / m_tolerance;
+    m_attribStride = attribStride;
+    m_tableMask = 0;
+
+    m_positions.reserve(expectedVertices * 3);
+    m_attribs.reserve(expectedVertices * m_attribStride);
+    m_cellHashes.reserve(expectedVertices);
+    m_fingerprints.reserve(expectedVertices);
+
+    //keep the table at most half full
+    unsigned int numSlots = 64;
+    while (numSlots < expectedVertices * 2)
+      numSlots <<= 1;
+
+    resizeTable(numSlots);
+  }
+
+  ExVertexWelder::~ExVertexWelder()
+  {
+    clear();
+  }
+
+  void ExVertexWelder::clear()
+  {
+    m_positions.clear();
+    m_attribs.clear();
+    m_cellHashes.clear();
+    m_fingerprints.clear();
+    m_table.assign(m_table.size(), -1);
+  }
+
+  unsigned int ExVertexWelder::getNumVertices() const
+  {
+    return m_cellHashes.size();
+  }
+
+  unsigned int ExVertexWelder::getAttribStride() const
+  {
+    return m_attribStride;
+  }
+
+  float ExVertexWelder::getTolerance() const
+  {
+    return m_tolerance;
+  }
+
+  const float* ExVertexWelder::getPosition(int index) const
+  {
+    return &m_positions[index * 3];
+  }
+
+  const float* ExVertexWelder::getAttributes(int index) const
+  {
+    return m_attribStride ? &m_attribs[index * m_attribStride] : 0;
+  }
+
+  unsigned long long ExVertexWelder::getCellHash(const float* pos) const
+  {
+    unsigned long long qx = (unsigned long long)quantize(pos[0], m_invTolerance);
+    unsigned long long qy = (unsigned long long)quantize(pos[1], m_invTolerance);
+    unsigned long long qz = (unsigned long long)quantize(pos[2], m_invTolerance);
+
+    unsigned long long h = mixHash64(qx * 0x9e3779b97f4a7c15ULL);
+    h = mixHash64(h ^ (qy * 0xc2b2ae3d27d4eb4fULL));
+    h = mixHash64(h ^ (qz * 0x165667b19e3779f9ULL));
+    return h;
+  }
+
+  unsigned int ExVertexWelder::getFingerprint(const float* attribs) const
+  {
+    //FNV-1a on the quantized attributes
+    //vertices with attributes on each side of a quantization step are not welded, this is the same behavior as the position cells
+    unsigned int fp = 2166136261u;
+    for (unsigned int i = 0; i < m_attribStride; i++)
+    {
+      unsigned long long q = (unsigned long long)quantize(attribs[i], m_invTolerance);
+      fp = (fp ^ (unsigned int)(q & 0xffffffff)) * 16777619u;
+      fp = (fp ^ (unsigned int)(q >> 32)) * 16777619u;
+    }
+    return fp;
+  }
+
+  bool ExVertexWelder::isEqual(int index, const float* pos, const float* attribs) const
+  {
+    const float* vpos = &m_positions[index * 3];
+    if ((fabs(vpos[0] - pos[0]) > m_tolerance) || (fabs(vpos[1] - pos[1]) > m_tolerance) || (fabs(vpos[2] - pos[2]) > m_tolerance))
+      return false;
+
+    const float* vattribs = getAttributes(index);
+    for (unsigned int i = 0; i < m_attribStride; i++)
+    {
+      if (fabs(vattribs[i] - attribs[i]) > m_tolerance)
+        return false;
+    }
+    return true;
+  }
+
+  int ExVertexWelder::findSlot(unsigned long long hash, unsigned int fingerprint, const float* pos, const float* attribs, int& vertex) const
+  {
+    unsigned int slot = (unsigned int)hash & m_tableMask;
+    vertex = -1;
+
+    //linear probing until an empty slot
+    while (m_table[slot] != -1)
+    {
+      int idx = m_table[slot];
+      if ((m_cellHashes[idx] == hash) && (m_fingerprints[idx] == fingerprint) && isEqual(idx, pos, attribs))
+      {
+        vertex = idx;
+        break;
+      }
+      slot = (slot + 1) & m_tableMask;
+    }
+    return slot;
+  }
+
+  void ExVertexWelder::resizeTable(unsigned int numSlots)
+  {
+    m_table.assign(numSlots, -1);
+    m_tableMask = numSlots - 1;
+
+    for (unsigned int i = 0; i < m_cellHashes.size(); i++)
+    {
+      unsigned int slot = (unsigned int)m_cellHashes[i] & m_tableMask;
+      while (m_table[slot] != -1)
+        slot = (slot + 1) & m_tableMask;
+
+      m_table[slot] = i;
+    }
+  }
+
+  int ExVertexWelder::findVertex(const float* pos, const float* attribs) const
+  {
+    int vertex = -1;
+    findSlot(getCellHash(pos), getFingerprint(attribs), pos, attribs, vertex);
+    return vertex;
+  }
+
+  int ExVertexWelder::addVertex(const float* pos, const float* attribs)
+  {
+    unsigned long long hash = getCellHash(pos);
+    unsigned int fingerprint = getFingerprint(attribs);
+
+    int vertex = -1;
+    unsigned int slot = findSlot(hash, fingerprint, pos, attribs, vertex);
+    if (vertex != -1)
+      return vertex;
+
+    vertex = m_cellHashes.size();
+    m_positions.insert(m_positions.end(), pos, pos + 3);
+    if (m_attribStride)
+      m_attribs.insert(m_attribs.end(), attribs, attribs + m_attribStride);
+    m_cellHashes.push_back(hash);
+    m_fingerprints.push_back(fingerprint);
+    m_table[slot] = vertex;
+
+    //grow the table when it is half full
+    if ((m_cellHashes.size() * 2) > m_table.size())
+      resizeTable(m_table.size() * 2);
+
+    return vertex;
+  }
+
+}; //end of namespace
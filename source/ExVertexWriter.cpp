@@ -0,0 +1,244 @@
+////////////////////////////////////////////////////////////////////////////////
+// ExVertexWriter.cpp
+// Start Date : October 17, 2026
+////////////////////////////////////////////////////////////////////////////////
+/*********************************************************************************
+*                                                                                *
+*   This program is free software; you can redistribute it and/or modify         *
+*   it under the terms of the GNU Lesser General Public License as published by  *
+*   the Free Software Foundation; either version 2 of the License, or            *
+*   (at your option) any later version.                                          *
+*                                                                                *
+**********************************************************************************/
+
+#include "ExVertexWriter.h"
+#include "ExBoneWeights.h"
+
+namespace EasyOgreExporter
+{
+  // strided copy of N floats per vertex
+  template <int N> static inline void copyFloats(unsigned char* pDest, const float* pSrc)
+  {
+    float* pFloat = reinterpret_cast<float*>(pDest);
+    for (int k = 0; k < N; k++)
+      pFloat[k] = pSrc[k];
+  }
+
+  ExVertexWriter::ExVertexWriter(const ExVertexStore& store) :
+    m_store(store)
+  {
+    m_normals = false;
+    m_colors = false;
+    m_numTexCoords = 0;
+    m_tangents = false;
+    m_tangentsAsTexCoord = false;
+    m_tangentParity = false;
+    m_blendWeights = false;
+    m_blendWeightsBytes = false;
+    m_vertexSize = 0;
+  }
+
+  ExVertexWriter::~ExVertexWriter()
+  {
+  }
+
+  void ExVertexWriter::setNormals(bool normals)
+  {
+    m_normals = normals;
+  }
+
+  void ExVertexWriter::setColors(bool colors)
+  {
+    m_colors = colors;
+  }
+
+  void ExVertexWriter::setNumTexCoords(unsigned int numTexCoords)
+  {
+    m_numTexCoords = std::min(numTexCoords, m_store.getNumTexCoords());
+  }
+
+  void ExVertexWriter::setTangents(bool asTexCoord, bool parity)
+  {
+    m_tangents = m_store.hasTangents();
+    m_tangentsAsTexCoord = asTexCoord;
+    m_tangentParity = parity;
+  }
+
+  void ExVertexWriter::setBlendWeights(bool blendWeights, bool bytes)
+  {
+    m_blendWeights = blendWeights && (m_store.getNumInfluences() > 0);
+    m_blendWeightsBytes = bytes;
+  }
+
+  size_t ExVertexWriter::getVertexSize() const
+  {
+    return m_vertexSize;
+  }
+
+  void ExVertexWriter::write(Ogre::VertexData* vdata, const std::vector<unsigned int>& vertices, bool skeletalAnimation, bool vertexAnimation)
+  {
+    // Describe the vertex format in a single source, the offsets are recomputed by the organisation
+    Ogre::VertexDeclaration* decl = vdata->vertexDeclaration;
+    size_t offset = 0;
+    decl->addElement(0, offset, Ogre::VET_FLOAT3, Ogre::VES_POSITION);
+    offset += Ogre::VertexElement::getTypeSize(Ogre::VET_FLOAT3);
+
+    if (m_normals)
+    {
+      decl->addElement(0, offset, Ogre::VET_FLOAT3, Ogre::VES_NORMAL);
+      offset += Ogre::VertexElement::getTypeSize(Ogre::VET_FLOAT3);
+    }
+
+    if (m_colors)
+    {
+      decl->addElement(0, offset, Ogre::VET_COLOUR, Ogre::VES_DIFFUSE);
+      offset += Ogre::VertexElement::getTypeSize(Ogre::VET_COLOUR);
+    }
+
+    //uv sets use VET_FLOAT2, the tangents are the only texture coordinates with 3 or 4 floats
+    for (unsigned int i = 0; i < m_numTexCoords; i++)
+    {
+      decl->addElement(0, offset, Ogre::VET_FLOAT2, Ogre::VES_TEXTURE_COORDINATES, i);
+      offset += Ogre::VertexElement::getTypeSize(Ogre::VET_FLOAT2);
+    }
+
+    if (m_tangents)
+    {
+      Ogre::VertexElementType tangentType = m_tangentParity ? Ogre::VET_FLOAT4 : Ogre::VET_FLOAT3;
+      if (m_tangentsAsTexCoord)
+        decl->addElement(0, offset, tangentType, Ogre::VES_TEXTURE_COORDINATES, m_numTexCoords);
+      else
+        decl->addElement(0, offset, tangentType, Ogre::VES_TANGENT);
+      offset += Ogre::VertexElement::getTypeSize(tangentType);
+    }
+
+    if (m_blendWeights)
+    {
+      Ogre::VertexElementType weightsType = m_blendWeightsBytes ? Ogre::VET_UBYTE4_NORM : Ogre::VertexElement::multiplyTypeCount(Ogre::VET_FLOAT1, std::min(m_store.getNumInfluences(), 4u));
+      decl->addElement(0, offset, Ogre::VET_UBYTE4, Ogre::VES_BLEND_INDICES);
+      offset += Ogre::VertexElement::getTypeSize(Ogre::VET_UBYTE4);
+      decl->addElement(0, offset, weightsType, Ogre::VES_BLEND_WEIGHTS);
+      offset += Ogre::VertexElement::getTypeSize(weightsType);
+    }
+
+    // Final layout, no reorganisation needed after the buffers are filled
+    Ogre::VertexDeclaration* newDecl = decl->getAutoOrganisedDeclaration(skeletalAnimation, vertexAnimation, false);
+    Ogre::HardwareBufferManager::getSingleton().destroyVertexDeclaration(decl);
+    vdata->vertexDeclaration = newDecl;
+    decl = newDecl;
+
+    Ogre::VertexBufferBinding* bind = vdata->vertexBufferBinding;
+    m_vertexSize = 0;
+    for (unsigned short source = 0; source <= decl->getMaxSource(); source++)
+    {
+      size_t stride = decl->getVertexSize(source);
+      if (stride == 0)
+        continue;
+
+      Ogre::HardwareVertexBufferSharedPtr vbuf = Ogre::HardwareBufferManager::getSingleton().createVertexBuffer(
+        stride, vdata->vertexCount, Ogre::HardwareBuffer::HBU_STATIC_WRITE_ONLY, false);
+      bind->setBinding(source, vbuf);
+
+      unsigned char* pBase = static_cast<unsigned char*>(vbuf->lock(Ogre::HardwareBuffer::HBL_DISCARD));
+
+      // one pass per element, the format is resolved once per element and not per vertex
+      Ogre::VertexDeclaration::VertexElementList elems = decl->findElementsBySource(source);
+      Ogre::VertexDeclaration::VertexElementList::const_iterator elemItr;
+      for (elemItr = elems.begin(); elemItr != elems.end(); ++elemItr)
+        writeElement(*elemItr, pBase + elemItr->getOffset(), stride, vertices);
+
+      vbuf->unlock();
+      m_vertexSize += stride;
+    }
+  }
+
+  void ExVertexWriter::writeElement(const Ogre::VertexElement& elem, unsigned char* pBase, size_t stride, const std::vector<unsigned int>& vertices)
+  {
+    size_t numVertices = vertices.size();
+    switch (elem.getSemantic())
+    {
+    case Ogre::VES_POSITION:
+      for (size_t i = 0; i < numVertices; i++, pBase += stride)
+        copyFloats<3>(pBase, m_store.getPosition(vertices[i]));
+      break;
+
+    case Ogre::VES_NORMAL:
+      for (size_t i = 0; i < numVertices; i++, pBase += stride)
+        copyFloats<3>(pBase, m_store.getNormal(vertices[i]));
+      break;
+
+    case Ogre::VES_DIFFUSE:
+    {
+      Ogre::VertexElementType colourType = Ogre::VertexElement::getBestColourVertexElementType();
+      for (size_t i = 0; i < numVertices; i++, pBase += stride)
+      {
+        const float* col = m_store.getColor(vertices[i]);
+        *reinterpret_cast<Ogre::ARGB*>(pBase) = Ogre::VertexElement::convertColourValue(Ogre::ColourValue(col[0], col[1], col[2], col[3]), colourType);
+      }
+    }
+    break;
+
+    case Ogre::VES_TEXTURE_COORDINATES:
+      if (elem.getType() == Ogre::VET_FLOAT2)
+      {
+        unsigned int set = elem.getIndex();
+        for (size_t i = 0; i < numVertices; i++, pBase += stride)
+          copyFloats<2>(pBase, m_store.getTexCoord(vertices[i], set));
+        break;
+      }
+      //tangents written as texture coordinates
+      //no break
+
+    case Ogre::VES_TANGENT:
+      if (elem.getType() == Ogre::VET_FLOAT4)
+      {
+        for (size_t i = 0; i < numVertices; i++, pBase += stride)
+          copyFloats<4>(pBase, m_store.getTangent(vertices[i]));
+      }
+      else
+      {
+        for (size_t i = 0; i < numVertices; i++, pBase += stride)
+          copyFloats<3>(pBase, m_store.getTangent(vertices[i]));
+      }
+      break;
+
+    case Ogre::VES_BLEND_INDICES:
+    {
+      //same blend index map as Ogre builds from the bone assignments of these vertices
+      std::vector<int> blendIndices;
+      buildBlendIndexMap(m_store, vertices, blendIndices);
+      unsigned int numInfluences = std::min(m_store.getNumInfluences(), 4u);
+      for (size_t i = 0; i < numVertices; i++, pBase += stride)
+        packBlendIndices(m_store.getWeights(vertices[i]), m_store.getBoneIndices(vertices[i]), numInfluences, blendIndices, pBase);
+    }
+    break;
+
+    case Ogre::VES_BLEND_WEIGHTS:
+    {
+      unsigned int numInfluences = std::min(m_store.getNumInfluences(), 4u);
+      unsigned int numWeights = Ogre::VertexElement::getTypeCount(elem.getType());
+      bool bytes = (elem.getType() == Ogre::VET_UBYTE4_NORM);
+      for (size_t i = 0; i < numVertices; i++, pBase += stride)
+      {
+        const float* weights = m_store.getWeights(vertices[i]);
+        if (bytes)
+        {
+          pBase[0] = pBase[1] = pBase[2] = pBase[3] = 0;
+          quantizeWeights(weights, numInfluences, pBase);
+        }
+        else
+        {
+          float* pFloat = reinterpret_cast<float*>(pBase);
+          for (unsigned int k = 0; k < numWeights; k++)
+            pFloat[k] = (k < numInfluences) ? weights[k] : 0.0f;
+        }
+      }
+    }
+    break;
+
+    default:
+      break;
+    }
+  }
+
+}; //end of namespace
@@ -22,6 +22,8 @@
 #include "ExData.h"
 #include "EasyOgreExporterLog.h"
 #include "ExTools.h"
+#include "ExMesh.h"
+#include "ExThreadPool.h"
 #include "tinyxml.h"
 
 #include "../resources/resource.h"
@@ -135,13 +137,13 @@ namespace EasyOgreExporter
         CheckDlgButton(hWnd, IDC_GENLOD, exp->generateLOD);
         CheckDlgButton(hWnd, IDC_EDGELIST, exp->buildEdges);
         CheckDlgButton(hWnd, IDC_TANGENT, exp->buildTangents);
-        CheckDlgButton(hWnd, IDC_SPLITMIRROR, exp->tangentsSplitMirrored);
-        CheckDlgButton(hWnd, IDC_SPLITROT, exp->tangentsSplitRotated);
         CheckDlgButton(hWnd, IDC_STOREPARITY, exp->tangentsUseParity);
+        CheckDlgButton(hWnd, IDC_COMPRESSVERT, exp->compressVertices);
 
         CheckDlgButton(hWnd, IDC_CONVDDS, exp->convertToDDS);
         CheckDlgButton(hWnd, IDC_RESAMPLE_ANIMS, exp->resampleAnims);
         CheckDlgButton(hWnd, IDC_LOGS, exp->enableLogs);
+        CheckDlgButton(hWnd, IDC_FORCEREBUILD, exp->forceRebuild);
     		
 #ifdef UNICODE
         //fill Shader mode combo box
@@ -361,12 +363,12 @@ namespace EasyOgreExporter
               exp->generateLOD = IsDlgButtonChecked(hWnd, IDC_GENLOD) ? true : false;
               exp->buildEdges = IsDlgButtonChecked(hWnd, IDC_EDGELIST) ? true : false;
               exp->buildTangents = IsDlgButtonChecked(hWnd, IDC_TANGENT) ? true : false;
-              exp->tangentsSplitMirrored = IsDlgButtonChecked(hWnd, IDC_SPLITMIRROR) ? true : false;
-              exp->tangentsSplitRotated = IsDlgButtonChecked(hWnd, IDC_SPLITROT) ? true : false;
               exp->tangentsUseParity = IsDlgButtonChecked(hWnd, IDC_STOREPARITY) ? true : false;
+              exp->compressVertices = IsDlgButtonChecked(hWnd, IDC_COMPRESSVERT) ? true : false;
               exp->convertToDDS = IsDlgButtonChecked(hWnd, IDC_CONVDDS) ? true : false;
               exp->resampleAnims = IsDlgButtonChecked(hWnd, IDC_RESAMPLE_ANIMS) ? true : false;
               exp->enableLogs = IsDlgButtonChecked(hWnd, IDC_LOGS) ? true : false;
+              exp->forceRebuild = IsDlgButtonChecked(hWnd, IDC_FORCEREBUILD) ? true : false;
 
               int shaderIdx = SendDlgItemMessage(hWnd, IDC_SHADERMODE, CB_GETCURSEL, 0, 0);
               if (shaderIdx != CB_ERR)
@@ -702,14 +704,6 @@ void OgreSceneExporter::loadExportConf(std::string path, ParamList &param)
     if(child)
       param.buildTangents = (child->GetText() && (atoi(child->GetText()) == 1)) ? true : false;
 
-    child = rootElem->FirstChildElement("IDC_SPLITMIRROR");
-    if(child)
-      param.tangentsSplitMirrored = (child->GetText() && (atoi(child->GetText()) == 1)) ? true : false;
-
-    child = rootElem->FirstChildElement("IDC_SPLITROT");
-    if(child)
-      param.tangentsSplitRotated = (child->GetText() && (atoi(child->GetText()) == 1)) ? true : false;
-
     child = rootElem->FirstChildElement("IDC_STOREPARITY");
     if(child)
       param.tangentsUseParity = (child->GetText() && (atoi(child->GetText()) == 1)) ? true : false;
@@ -766,6 +760,116 @@ void OgreSceneExporter::loadExportConf(std::string path, ParamList &param)
     child = rootElem->FirstChildElement("IDC_NUMMIPS");
     if(child && child->GetText())
       param.maxMipmaps = atoi(child->GetText());
+
+    child = rootElem->FirstChildElement("WELD_TOLERANCE");
+    if(child && child->GetText())
+      param.weldTolerance = (float)atof(child->GetText());
+
+    child = rootElem->FirstChildElement("OPTIMIZE_INDEX");
+    if(child)
+      param.optimizeIndexBuffers = (child->GetText() && (atoi(child->GetText()) == 1)) ? true : false;
+
+    child = rootElem->FirstChildElement("VERTEX_CACHE_SIZE");
+    if(child && child->GetText())
+      param.vertexCacheSize = atoi(child->GetText());
+
+    child = rootElem->FirstChildElement("SPLIT_SUBMESHES");
+    if(child)
+      param.splitSubMeshes = (child->GetText() && (atoi(child->GetText()) == 1)) ? true : false;
+
+    child = rootElem->FirstChildElement("MAX_SUBMESH_VERTICES");
+    if(child && child->GetText())
+      param.maxSubMeshVertices = atoi(child->GetText());
+
+    child = rootElem->FirstChildElement("OPTIMIZE_OVERDRAW");
+    if(child)
+      param.optimizeOverdraw = (child->GetText() && (atoi(child->GetText()) == 1)) ? true : false;
+
+    child = rootElem->FirstChildElement("OVERDRAW_THRESHOLD");
+    if(child && child->GetText())
+      param.overdrawThreshold = (float)atof(child->GetText());
+
+    child = rootElem->FirstChildElement("IDC_COMPRESSVERT");
+    if(child)
+      param.compressVertices = (child->GetText() && (atoi(child->GetText()) == 1)) ? true : false;
+
+    child = rootElem->FirstChildElement("COMPRESSION_ERROR");
+    if(child && child->GetText())
+      param.compressionError = (float)atof(child->GetText());
+
+    child = rootElem->FirstChildElement("NUM_THREADS");
+    if(child && child->GetText())
+      param.numThreads = atoi(child->GetText());
+
+    child = rootElem->FirstChildElement("DEDUPLICATE_MESHES");
+    if(child)
+      param.deduplicateMeshes = (child->GetText() && (atoi(child->GetText()) == 1)) ? true : false;
+
+    child = rootElem->FirstChildElement("LOD_LEVELS");
+    if(child && child->GetText())
+      param.lodLevels = atoi(child->GetText());
+
+    child = rootElem->FirstChildElement("LOD_REDUCTION");
+    if(child && child->GetText())
+      param.lodReduction = (float)atof(child->GetText());
+
+    child = rootElem->FirstChildElement("LOD_STRATEGY");
+    if(child && child->GetText())
+      param.lodStrategy = (atoi(child->GetText()) == 0) ? LOD_DISTANCE : LOD_PIXEL_COUNT;
+
+    child = rootElem->FirstChildElement("LOD_DISTANCE");
+    if(child && child->GetText())
+      param.lodDistance = (float)atof(child->GetText());
+
+    child = rootElem->FirstChildElement("LOD_SCREEN_RATIO");
+    if(child && child->GetText())
+      param.lodScreenRatio = (float)atof(child->GetText());
+
+    child = rootElem->FirstChildElement("NATIVE_MESH_SERIALIZER");
+    if(child)
+      param.nativeMeshSerializer = (child->GetText() && (atoi(child->GetText()) == 1)) ? true : false;
+
+    child = rootElem->FirstChildElement("MAX_BONE_INFLUENCES");
+    if(child && child->GetText())
+    {
+      int influences = atoi(child->GetText());
+      param.maxBoneInfluences = (influences < 1) ? 1 : ((influences > 4) ? 4 : influences);
+    }
+
+    child = rootElem->FirstChildElement("BLEND_ELEMENTS");
+    if(child)
+      param.blendElements = (child->GetText() && (atoi(child->GetText()) == 1)) ? true : false;
+
+    child = rootElem->FirstChildElement("BLEND_WEIGHTS_BYTE");
+    if(child)
+      param.blendWeightsByte = (child->GetText() && (atoi(child->GetText()) == 1)) ? true : false;
+
+    child = rootElem->FirstChildElement("MORPH_KEY_TOLERANCE");
+    if(child && child->GetText())
+      param.morphKeyTolerance = (float)atof(child->GetText());
+
+    child = rootElem->FirstChildElement("COMPRESS_MORPH_ANIMATION");
+    if(child)
+      param.compressMorphAnimation = (child->GetText() && (atoi(child->GetText()) == 1)) ? true : false;
+
+    child = rootElem->FirstChildElement("MORPH_COMPRESSION_TOLERANCE");
+    if(child && child->GetText())
+      param.morphCompressionTolerance = (float)atof(child->GetText());
+
+    child = rootElem->FirstChildElement("MORPH_COMPRESSION_MAX_POSES");
+    if(child && child->GetText())
+    {
+      int maxPoses = atoi(child->GetText());
+      param.morphCompressionMaxPoses = (maxPoses < 1) ? 1 : maxPoses;
+    }
+
+    child = rootElem->FirstChildElement("POSE_EPSILON");
+    if(child && child->GetText())
+      param.poseEpsilon = (float)atof(child->GetText());
+
+    child = rootElem->FirstChildElement("EXPORT_CACHE");
+    if(child)
+      param.exportCache = (child->GetText() && (atoi(child->GetText()) == 1)) ? true : false;
   }
 }
 
@@ -850,16 +954,6 @@ void OgreExporter::saveExportConf(std::string path)
   child->LinkEndChild(childText);
   contProperties->LinkEndChild(child);
 
-  child = new TiXmlElement("IDC_SPLITMIRROR");
-  childText = new TiXmlText(m_params.tangentsSplitMirrored ? "1" : "0");
-  child->LinkEndChild(childText);
-  contProperties->LinkEndChild(child);
-
-  child = new TiXmlElement("IDC_SPLITROT");
-  childText = new TiXmlText(m_params.tangentsSplitRotated ? "1" : "0");
-  child->LinkEndChild(childText);
-  contProperties->LinkEndChild(child);
-
   child = new TiXmlElement("IDC_STOREPARITY");
   childText = new TiXmlText(m_params.tangentsUseParity ? "1" : "0");
   child->LinkEndChild(childText);
@@ -908,6 +1002,166 @@ void OgreExporter::saveExportConf(std::string path)
   child->LinkEndChild(childText);
   contProperties->LinkEndChild(child);
 
+  std::stringstream oWeldVal;
+  oWeldVal << m_params.weldTolerance;
+  child = new TiXmlElement("WELD_TOLERANCE");
+  childText = new TiXmlText(oWeldVal.str().c_str());
+  child->LinkEndChild(childText);
+  contProperties->LinkEndChild(child);
+
+  child = new TiXmlElement("OPTIMIZE_INDEX");
+  childText = new TiXmlText(m_params.optimizeIndexBuffers ? "1" : "0");
+  child->LinkEndChild(childText);
+  contProperties->LinkEndChild(child);
+
+  std::stringstream oCacheVal;
+  oCacheVal << m_params.vertexCacheSize;
+  child = new TiXmlElement("VERTEX_CACHE_SIZE");
+  childText = new TiXmlText(oCacheVal.str().c_str());
+  child->LinkEndChild(childText);
+  contProperties->LinkEndChild(child);
+
+  child = new TiXmlElement("SPLIT_SUBMESHES");
+  childText = new TiXmlText(m_params.splitSubMeshes ? "1" : "0");
+  child->LinkEndChild(childText);
+  contProperties->LinkEndChild(child);
+
+  std::stringstream oSubMeshVal;
+  oSubMeshVal << m_params.maxSubMeshVertices;
+  child = new TiXmlElement("MAX_SUBMESH_VERTICES");
+  childText = new TiXmlText(oSubMeshVal.str().c_str());
+  child->LinkEndChild(childText);
+  contProperties->LinkEndChild(child);
+
+  child = new TiXmlElement("OPTIMIZE_OVERDRAW");
+  childText = new TiXmlText(m_params.optimizeOverdraw ? "1" : "0");
+  child->LinkEndChild(childText);
+  contProperties->LinkEndChild(child);
+
+  std::stringstream oOverdrawVal;
+  oOverdrawVal << m_params.overdrawThreshold;
+  child = new TiXmlElement("OVERDRAW_THRESHOLD");
+  childText = new TiXmlText(oOverdrawVal.str().c_str());
+  child->LinkEndChild(childText);
+  contProperties->LinkEndChild(child);
+
+  child = new TiXmlElement("IDC_COMPRESSVERT");
+  childText = new TiXmlText(m_params.compressVertices ? "1" : "0");
+  child->LinkEndChild(childText);
+  contProperties->LinkEndChild(child);
+
+  std::stringstream oCompressionVal;
+  oCompressionVal << m_params.compressionError;
+  child = new TiXmlElement("COMPRESSION_ERROR");
+  childText = new TiXmlText(oCompressionVal.str().c_str());
+  child->LinkEndChild(childText);
+  contProperties->LinkEndChild(child);
+
+  std::stringstream oNumThreadsVal;
+  oNumThreadsVal << m_params.numThreads;
+  child = new TiXmlElement("NUM_THREADS");
+  childText = new TiXmlText(oNumThreadsVal.str().c_str());
+  child->LinkEndChild(childText);
+  contProperties->LinkEndChild(child);
+
+  child = new TiXmlElement("DEDUPLICATE_MESHES");
+  childText = new TiXmlText(m_params.deduplicateMeshes ? "1" : "0");
+  child->LinkEndChild(childText);
+  contProperties->LinkEndChild(child);
+
+  std::stringstream oLodLevelsVal;
+  oLodLevelsVal << m_params.lodLevels;
+  child = new TiXmlElement("LOD_LEVELS");
+  childText = new TiXmlText(oLodLevelsVal.str().c_str());
+  child->LinkEndChild(childText);
+  contProperties->LinkEndChild(child);
+
+  std::stringstream oLodReductionVal;
+  oLodReductionVal << m_params.lodReduction;
+  child = new TiXmlElement("LOD_REDUCTION");
+  childText = new TiXmlText(oLodReductionVal.str().c_str());
+  child->LinkEndChild(childText);
+  contProperties->LinkEndChild(child);
+
+  child = new TiXmlElement("LOD_STRATEGY");
+  childText = new TiXmlText((m_params.lodStrategy == LOD_DISTANCE) ? "0" : "1");
+  child->LinkEndChild(childText);
+  contProperties->LinkEndChild(child);
+
+  std::stringstream oLodDistanceVal;
+  oLodDistanceVal << m_params.lodDistance;
+  child = new TiXmlElement("LOD_DISTANCE");
+  childText = new TiXmlText(oLodDistanceVal.str().c_str());
+  child->LinkEndChild(childText);
+  contProperties->LinkEndChild(child);
+
+  std::stringstream oLodScreenRatioVal;
+  oLodScreenRatioVal << m_params.lodScreenRatio;
+  child = new TiXmlElement("LOD_SCREEN_RATIO");
+  childText = new TiXmlText(oLodScreenRatioVal.str().c_str());
+  child->LinkEndChild(childText);
+  contProperties->LinkEndChild(child);
+
+  child = new TiXmlElement("NATIVE_MESH_SERIALIZER");
+  childText = new TiXmlText(m_params.nativeMeshSerializer ? "1" : "0");
+  child->LinkEndChild(childText);
+  contProperties->LinkEndChild(child);
+
+  std::stringstream oMaxBoneInfluencesVal;
+  oMaxBoneInfluencesVal << m_params.maxBoneInfluences;
+  child = new TiXmlElement("MAX_BONE_INFLUENCES");
+  childText = new TiXmlText(oMaxBoneInfluencesVal.str().c_str());
+  child->LinkEndChild(childText);
+  contProperties->LinkEndChild(child);
+
+  child = new TiXmlElement("BLEND_ELEMENTS");
+  childText = new TiXmlText(m_params.blendElements ? "1" : "0");
+  child->LinkEndChild(childText);
+  contProperties->LinkEndChild(child);
+
+  child = new TiXmlElement("BLEND_WEIGHTS_BYTE");
+  childText = new TiXmlText(m_params.blendWeightsByte ? "1" : "0");
+  child->LinkEndChild(childText);
+  contProperties->LinkEndChild(child);
+
+  std::stringstream oMorphKeyToleranceVal;
+  oMorphKeyToleranceVal << m_params.morphKeyTolerance;
+  child = new TiXmlElement("MORPH_KEY_TOLERANCE");
+  childText = new TiXmlText(oMorphKeyToleranceVal.str().c_str());
+  child->LinkEndChild(childText);
+  contProperties->LinkEndChild(child);
+
+  child = new TiXmlElement("COMPRESS_MORPH_ANIMATION");
+  childText = new TiXmlText(m_params.compressMorphAnimation ? "1" : "0");
+  child->LinkEndChild(childText);
+  contProperties->LinkEndChild(child);
+
+  std::stringstream oMorphCompressionToleranceVal;
+  oMorphCompressionToleranceVal << m_params.morphCompressionTolerance;
+  child = new TiXmlElement("MORPH_COMPRESSION_TOLERANCE");
+  childText = new TiXmlText(oMorphCompressionToleranceVal.str().c_str());
+  child->LinkEndChild(childText);
+  contProperties->LinkEndChild(child);
+
+  std::stringstream oMorphCompressionMaxPosesVal;
+  oMorphCompressionMaxPosesVal << m_params.morphCompressionMaxPoses;
+  child = new TiXmlElement("MORPH_COMPRESSION_MAX_POSES");
+  childText = new TiXmlText(oMorphCompressionMaxPosesVal.str().c_str());
+  child->LinkEndChild(childText);
+  contProperties->LinkEndChild(child);
+
+  std::stringstream oPoseEpsilonVal;
+  oPoseEpsilonVal << m_params.poseEpsilon;
+  child = new TiXmlElement("POSE_EPSILON");
+  childText = new TiXmlText(oPoseEpsilonVal.str().c_str());
+  child->LinkEndChild(childText);
+  contProperties->LinkEndChild(child);
+
+  child = new TiXmlElement("EXPORT_CACHE");
+  childText = new TiXmlText(m_params.exportCache ? "1" : "0");
+  child->LinkEndChild(childText);
+  contProperties->LinkEndChild(child);
+
   xmlDoc.SaveFile(path.c_str());
 }
 
@@ -991,9 +1245,146 @@ void OgreExporter::initIGameConf(std::string path)
 
   igameUserData->LinkEndChild(userData);
 
+  // lodLevels
+  TiXmlElement* lodLevels = new TiXmlElement("UserProperty");
+  TiXmlElement* lodLevelsId = new TiXmlElement("id");
+  TiXmlText* lodLevelsIdText = new TiXmlText("105");
+  lodLevelsId->LinkEndChild(lodLevelsIdText);
+  lodLevels->LinkEndChild(lodLevelsId);
+
+  TiXmlElement* lodLevelsSName = new TiXmlElement("simplename");
+  TiXmlText* lodLevelsSNameText = new TiXmlText("lodLevels");
+  lodLevelsSName->LinkEndChild(lodLevelsSNameText);
+  lodLevels->LinkEndChild(lodLevelsSName);
+
+  TiXmlElement* lodLevelsName = new TiXmlElement("keyName");
+  TiXmlText* lodLevelsNameText = new TiXmlText("lodLevels");
+  lodLevelsName->LinkEndChild(lodLevelsNameText);
+  lodLevels->LinkEndChild(lodLevelsName);
+
+  TiXmlElement* lodLevelsType = new TiXmlElement("type");
+  TiXmlText* lodLevelsTypeText = new TiXmlText("int");
+  lodLevelsType->LinkEndChild(lodLevelsTypeText);
+  lodLevels->LinkEndChild(lodLevelsType);
+
+  igameUserData->LinkEndChild(lodLevels);
+
+  // lodReduction
+  TiXmlElement* lodReduction = new TiXmlElement("UserProperty");
+  TiXmlElement* lodReductionId = new TiXmlElement("id");
+  TiXmlText* lodReductionIdText = new TiXmlText("106");
+  lodReductionId->LinkEndChild(lodReductionIdText);
+  lodReduction->LinkEndChild(lodReductionId);
+
+  TiXmlElement* lodReductionSName = new TiXmlElement("simplename");
+  TiXmlText* lodReductionSNameText = new TiXmlText("lodReduction");
+  lodReductionSName->LinkEndChild(lodReductionSNameText);
+  lodReduction->LinkEndChild(lodReductionSName);
+
+  TiXmlElement* lodReductionName = new TiXmlElement("keyName");
+  TiXmlText* lodReductionNameText = new TiXmlText("lodReduction");
+  lodReductionName->LinkEndChild(lodReductionNameText);
+  lodReduction->LinkEndChild(lodReductionName);
+
+  TiXmlElement* lodReductionType = new TiXmlElement("type");
+  TiXmlText* lodReductionTypeText = new TiXmlText("float");
+  lodReductionType->LinkEndChild(lodReductionTypeText);
+  lodReduction->LinkEndChild(lodReductionType);
+
+  igameUserData->LinkEndChild(lodReduction);
+
+  // noEdges
+  TiXmlElement* noEdges = new TiXmlElement("UserProperty");
+  TiXmlElement* noEdgesId = new TiXmlElement("id");
+  TiXmlText* noEdgesIdText = new TiXmlText("107");
+  noEdgesId->LinkEndChild(noEdgesIdText);
+  noEdges->LinkEndChild(noEdgesId);
+
+  TiXmlElement* noEdgesSName = new TiXmlElement("simplename");
+  TiXmlText* noEdgesSNameText = new TiXmlText("noEdges");
+  noEdgesSName->LinkEndChild(noEdgesSNameText);
+  noEdges->LinkEndChild(noEdgesSName);
+
+  TiXmlElement* noEdgesName = new TiXmlElement("keyName");
+  TiXmlText* noEdgesNameText = new TiXmlText("noEdges");
+  noEdgesName->LinkEndChild(noEdgesNameText);
+  noEdges->LinkEndChild(noEdgesName);
+
+  TiXmlElement* noEdgesType = new TiXmlElement("type");
+  TiXmlText* noEdgesTypeText = new TiXmlText("bool");
+  noEdgesType->LinkEndChild(noEdgesTypeText);
+  noEdges->LinkEndChild(noEdgesType);
+
+  igameUserData->LinkEndChild(noEdges);
+
   xmlDoc.SaveFile(path.c_str());
 }
 
+// build the vertices and submeshes of one captured mesh
+// meshes captured and waiting to be written are bounded by count per thread and by size
+#define MESH_BATCH_PER_THREAD 4
+#define MESH_BATCH_MAX_BYTES (256 * 1024 * 1024)
+
+class ExPrepareMeshJob : public ExPoolJob
+{
+public:
+  ExPrepareMeshJob(std::vector<ExMesh*>& meshes, std::vector<char>& failed) : m_meshes(meshes), m_failed(failed)
+  {
+  }
+
+  // a failing mesh is only marked, the other meshes are still processed
+  void run(size_t i)
+  {
+    try
+    {
+      m_meshes[i]->prepareMesh();
+    }
+    catch(std::exception& e)
+    {
+      EasyOgreExporterLog("Error: mesh processing failed : %s\n", e.what());
+      m_failed[i] = 1;
+    }
+    catch(...)
+    {
+      EasyOgreExporterLog("Error: mesh processing failed\n");
+      m_failed[i] = 1;
+    }
+  }
+
+private:
+  std::vector<ExMesh*>& m_meshes;
+  std::vector<char>& m_failed;
+};
+
+class ExWriteNativeMeshJob : public ExPoolJob
+{
+public:
+  ExWriteNativeMeshJob(std::vector<ExMesh*>& meshes) : m_meshes(meshes)
+  {
+  }
+
+  // the meshes are written in parallel, so each edge list is built on the job thread
+  // a failing mesh is reported by its writeOgreBinary like a serial write
+  void run(size_t i)
+  {
+    try
+    {
+      m_meshes[i]->writeNativeBinary(1);
+    }
+    catch(std::exception& e)
+    {
+      EasyOgreExporterLog("Error: mesh writing failed : %s\n", e.what());
+    }
+    catch(...)
+    {
+      EasyOgreExporterLog("Error: mesh writing failed\n");
+    }
+  }
+
+private:
+  std::vector<ExMesh*>& m_meshes;
+};
+
 bool OgreExporter::exportScene()
 {
   nodeCount = 0;
@@ -1107,16 +1498,113 @@ bool OgreExporter::exportScene()
     }
   }
 
-  // parse Max scene
+  // parse Max scene and find the nodes to export, Max is only used from this thread
+  exportedNodes.clear();
   for(int node = 0; node < pIGame->GetTopLevelNodeCount(); ++node)
   {
     IGameNode* pGameNode = pIGame->GetTopLevelNode(node);
     if(pGameNode)
     {
-      exportNode(pGameNode, 0);
+      exportNode(pGameNode, -1);
     }
   }
 
+#ifdef UNICODE
+  GetCOREInterface()->ProgressUpdate(40, FALSE, L"Processing meshes.");
+#else
+  GetCOREInterface()->ProgressUpdate(40, FALSE, "Processing meshes.");
+#endif
+  ExThreadPool pool(m_params.numThreads);
+  EasyOgreExporterLog("Info: processing meshes on %d threads\n", (int)pool.getNumThreads());
+
+  // capture, process and write the nodes by batches in the scene order
+  // only the snapshots of the current batch are kept in memory
+  size_t maxBatchMeshes = pool.getNumThreads() * MESH_BATCH_PER_THREAD;
+  std::vector<TiXmlElement*> nodeElements(exportedNodes.size(), 0);
+  size_t batchStart = 0;
+  while(batchStart < exportedNodes.size())
+  {
+    // the meshes shared with a previous one or kept from the previous export are not processed
+    std::vector<ExMesh*> meshes;
+    std::vector<size_t> meshNodes;
+    size_t numCaptured = 0;
+    size_t capturedSize = 0;
+    size_t batchEnd = batchStart;
+    while((batchEnd < exportedNodes.size()) && (numCaptured < maxBatchMeshes) && (capturedSize < MESH_BATCH_MAX_BYTES))
+    {
+      ExportedNode& exportedNode = exportedNodes[batchEnd];
+      if(exportedNode.geometry)
+      {
+        captureMesh(exportedNode);
+        if(exportedNode.mesh)
+        {
+          numCaptured++;
+          capturedSize += exportedNode.mesh->getSnapshotSize();
+          if(ogreConverter->checkMeshCache(exportedNode.mesh, exportedNode.pGameNode))
+          {
+            meshes.push_back(exportedNode.mesh);
+            meshNodes.push_back(batchEnd);
+          }
+        }
+      }
+      batchEnd++;
+    }
+
+    // process the meshes in parallel, each job only works on its own mesh
+    std::vector<char> failed(meshes.size(), 0);
+    try
+    {
+      ExPrepareMeshJob job(meshes, failed);
+      pool.run(meshes.size(), job);
+    }
+    catch(std::exception& e)
+    {
+      EasyOgreExporterLog("Error: mesh processing failed : %s\n", e.what());
+    }
+
+    // a mesh left unprepared by a pool failure is not written either
+    for(size_t i = 0; i < meshes.size(); i++)
+    {
+      if(failed[i] || !meshes[i]->isPrepared())
+        exportedNodes[meshNodes[i]].failed = true;
+    }
+
+    // the native mesh files make no Max or Ogre call, they are written in parallel
+    // their settings and file paths are read from this thread in the scene order before
+    std::vector<ExMesh*> nativeMeshes;
+    if(m_params.exportMesh)
+    {
+      for(size_t i = 0; i < meshes.size(); i++)
+      {
+        if(!exportedNodes[meshNodes[i]].failed && meshes[i]->setupWrite())
+          nativeMeshes.push_back(meshes[i]);
+      }
+    }
+
+    try
+    {
+      ExWriteNativeMeshJob job(nativeMeshes);
+      pool.run(nativeMeshes.size(), job);
+    }
+    catch(std::exception& e)
+    {
+      EasyOgreExporterLog("Error: mesh writing failed : %s\n", e.what());
+    }
+
+    // write the nodes in the scene order so the output does not depend on the threads
+    // Ogre managers are not thread safe, the other files are written from this thread
+    for(size_t i = batchStart; i < batchEnd; i++)
+    {
+      GetCOREInterface()->ProgressUpdate(40 + (int)(((float)i / (float)exportedNodes.size()) * 50.0f), FALSE, exportedNodes[i].pGameNode->GetName());
+
+      TiXmlElement* parent = (exportedNodes[i].parent >= 0) ? nodeElements[exportedNodes[i].parent] : 0;
+      nodeElements[i] = writeNode(exportedNodes[i], parent);
+    }
+    batchStart = batchEnd;
+  }
+  exportedNodes.clear();
+  ogreConverter->logSharedMeshes();
+
   if (sceneData)
   {
 #ifdef UNICODE
@@ -1135,6 +1623,7 @@ bool OgreExporter::exportScene()
     GetCOREInterface()->ProgressUpdate(98, FALSE, "Writing material file.");
 #endif
     ogreConverter->writeMaterialFile();
+    ogreConverter->saveExportCache();
   }
 
   if (sceneData)
@@ -1264,13 +1753,13 @@ bool OgreExporter::IsNodeToExport(IGameNode* pGameNode)
   return bShouldExport;
 }
 
-bool OgreExporter::exportNode(IGameNode* pGameNode, TiXmlElement* parent)
+bool OgreExporter::exportNode(IGameNode* pGameNode, int parent)
 {
-  GetCOREInterface()->ProgressUpdate((int)(((float)nodeCount / (float)pIGame->GetTotalNodeCount()) * 90.0f), TRUE); 
+  GetCOREInterface()->ProgressUpdate((int)(((float)nodeCount / (float)pIGame->GetTotalNodeCount()) * 40.0f), TRUE); 
 
   if(IsNodeToExport(pGameNode))
   {
-    GetCOREInterface()->ProgressUpdate((int)(((float)nodeCount / (float)pIGame->GetTotalNodeCount()) * 90.0f), FALSE, pGameNode->GetName());
+    GetCOREInterface()->ProgressUpdate((int)(((float)nodeCount / (float)pIGame->GetTotalNodeCount()) * 40.0f), FALSE, pGameNode->GetName());
 
     #ifdef UNICODE
       MSTR nodeName = pGameNode->GetName();
@@ -1282,9 +1771,16 @@ bool OgreExporter::exportNode(IGameNode* pGameNode, TiXmlElement* parent)
     IGameObject* pGameObject = pGameNode->GetIGameObject();
     if(pGameObject)
     {
-      IGameObject::ObjectTypes gameType = pGameObject->GetIGameType();
-        
-      switch(gameType)
+      ExportedNode exportedNode;
+      exportedNode.pGameNode = pGameNode;
+      exportedNode.gameType = pGameObject->GetIGameType();
+      exportedNode.parent = parent;
+      exportedNode.mesh = 0;
+      exportedNode.instance = false;
+      exportedNode.geometry = false;
+      exportedNode.failed = false;
+
+      switch(exportedNode.gameType)
       {
         case IGameObject::IGAME_UNKNOWN:
           {
@@ -1297,9 +1793,17 @@ bool OgreExporter::exportNode(IGameNode* pGameNode, TiXmlElement* parent)
           }
         case IGameObject::IGAME_MESH:
           {
+            INode* node = pGameNode->GetMaxNode();
+
+            //instances of an already found mesh skip all the geometry work
+            if(ogreConverter && (ogreConverter->registerInstance(node) != node))
+            {
+              exportedNode.instance = true;
+              break;
+            }
+
             bool delTri = false;
             Mesh* mMesh = 0;
-            INode* node = pGameNode->GetMaxNode();
             TriObject* triObj = getTriObjectFromNode(node, GetFirstFrame(), delTri);
 
             if (triObj)
@@ -1319,32 +1823,11 @@ bool OgreExporter::exportNode(IGameNode* pGameNode, TiXmlElement* parent)
               }
             }
 
+            //the Max data is captured with the batch of the node, the processing is done on the worker threads
             IGameMesh* pGameMesh = static_cast<IGameMesh*>(pGameObject);
             if(pGameMesh && (numFaces > 0))
             {
-              if(pGameMesh->InitializeData())
-              {
-                #ifdef UNICODE
-                  MSTR nodeName = pGameNode->GetName();
-                  EasyOgreExporterLog("Found mesh node: %ls\n", nodeName.data());
-                #else
-                  EasyOgreExporterLog("Found mesh node: %s\n", pGameNode->GetName());
-                #endif
-
-                std::vector<ExMaterial*> lmat;
-                if(ogreConverter)
-                {
-                  if (!ogreConverter->writeEntityData(pGameNode, pGameObject, pGameMesh, lmat))
-                  {
-                    EasyOgreExporterLog("Warning, mesh skipped\n");
-                  }
-                  else if (sceneData)
-                  {
-                    parent = sceneData->writeNodeData(parent, pGameNode, IGameObject::IGAME_MESH);
-                    sceneData->writeEntityData(parent, pGameNode, pGameMesh, lmat);
-                  }
-                }
-              }
+              exportedNode.geometry = true;
             }
             else
             {
@@ -1357,59 +1840,16 @@ bool OgreExporter::exportNode(IGameNode* pGameNode, TiXmlElement* parent)
             }
           }
           break;
-      case IGameObject::IGAME_LIGHT:
-        {
-          if(m_params.exportLights)
-          {
-            IGameLight* pGameLight = static_cast<IGameLight*>(pGameObject);
-            if(pGameLight)
-            {
-              #ifdef UNICODE
-                MSTR nodeName = pGameNode->GetName();
-                EasyOgreExporterLog("Found light: %ls\n", nodeName.data());
-              #else
-                EasyOgreExporterLog("Found light: %s\n", pGameNode->GetName());
-              #endif
-              if (sceneData)
-              {
-                parent = sceneData->writeNodeData(parent, pGameNode, IGameObject::IGAME_LIGHT);
-                sceneData->writeLightData(parent, pGameLight);
-              }
-            }
-          }
-        }
-        break;
-      case IGameObject::IGAME_CAMERA:
-        {
-          if(m_params.exportCameras)
-          {
-            IGameCamera* pGameCamera = static_cast<IGameCamera*>(pGameObject);
-            if(pGameCamera)
-            {
-              #ifdef UNICODE
-                MSTR nodeName = pGameNode->GetName();
-                EasyOgreExporterLog("Found camera: %ls\n", nodeName.data());
-              #else
-                EasyOgreExporterLog("Found camera: %s\n", pGameNode->GetName());
-              #endif
-
-              if (sceneData)
-              {
-                parent = sceneData->writeNodeData(parent, pGameNode, IGameObject::IGAME_CAMERA);
-                sceneData->writeCameraData(parent, pGameCamera);
-              }
-            }
-          }
-        }
-        break;
-      case IGameObject::IGAME_HELPER:
-        {
-          parent = sceneData->writeNodeData(parent, pGameNode, IGameObject::IGAME_HELPER);
-        }
-        break;
       default:
         break;
       }
+
+      //do not keep the Max data alive until the node is captured and written
+      pGameNode->ReleaseIGameObject();
+
+      //children are written under this node scene element
+      parent = exportedNodes.size();
+      exportedNodes.push_back(exportedNode);
     }
   }
 
@@ -1425,13 +1865,138 @@ bool OgreExporter::exportNode(IGameNode* pGameNode, TiXmlElement* parent)
     }
   }
 
-  pGameNode->ReleaseIGameObject();
-
   nodeCount++;
 
   return true;
 }
 
+void OgreExporter::captureMesh(ExportedNode& exportedNode)
+{
+  IGameNode* pGameNode = exportedNode.pGameNode;
+  IGameMesh* pGameMesh = static_cast<IGameMesh*>(pGameNode->GetIGameObject());
+  if(pGameMesh && pGameMesh->InitializeData())
+  {
+    #ifdef UNICODE
+      MSTR nodeName = pGameNode->GetName();
+      EasyOgreExporterLog("Found mesh node: %ls\n", nodeName.data());
+    #else
+      EasyOgreExporterLog("Found mesh node: %s\n", pGameNode->GetName());
+    #endif
+
+    if(ogreConverter)
+      exportedNode.mesh = ogreConverter->createMesh(pGameNode, pGameMesh);
+  }
+
+  //the mesh snapshot is captured, do not keep the Max data alive until the node is written
+  pGameNode->ReleaseIGameObject();
+}
+
+TiXmlElement* OgreExporter::writeNode(ExportedNode& exportedNode, TiXmlElement* parent)
+{
+  IGameNode* pGameNode = exportedNode.pGameNode;
+  IGameObject* pGameObject = 0;
+
+  switch(exportedNode.gameType)
+  {
+    case IGameObject::IGAME_UNKNOWN:
+    case IGameObject::IGAME_MESH:
+      {
+        if(exportedNode.failed)
+        {
+          #ifdef UNICODE
+            MSTR nodeName = pGameNode->GetName();
+            EasyOgreExporterLog("Warning, Mesh : %ls skipped, the processing failed\n", nodeName.data());
+          #else
+            EasyOgreExporterLog("Warning, Mesh node: %s skipped, the processing failed\n", pGameNode->GetName());
+          #endif
+
+          delete exportedNode.mesh;
+          exportedNode.mesh = 0;
+        }
+        else if(exportedNode.mesh || exportedNode.instance)
+        {
+          std::vector<ExMaterial*> lmat;
+          bool written = exportedNode.instance ? ogreConverter->writeInstanceData(pGameNode, lmat) : ogreConverter->writeEntityData(exportedNode.mesh, pGameNode, lmat);
+          if (!written)
+          {
+            EasyOgreExporterLog("Warning, mesh skipped\n");
+          }
+          else if (sceneData)
+          {
+            //acquired again only for the entity and its user properties
+            pGameObject = pGameNode->GetIGameObject();
+            IGameMesh* pGameMesh = static_cast<IGameMesh*>(pGameObject);
+            parent = sceneData->writeNodeData(parent, pGameNode, IGameObject::IGAME_MESH);
+            if (pGameMesh)
+              sceneData->writeEntityData(parent, pGameNode, pGameMesh, lmat);
+          }
+
+          delete exportedNode.mesh;
+          exportedNode.mesh = 0;
+        }
+      }
+      break;
+  case IGameObject::IGAME_LIGHT:
+    {
+      if(m_params.exportLights)
+      {
+        pGameObject = pGameNode->GetIGameObject();
+        IGameLight* pGameLight = static_cast<IGameLight*>(pGameObject);
+        if(pGameLight)
+        {
+          #ifdef UNICODE
+            MSTR nodeName = pGameNode->GetName();
+            EasyOgreExporterLog("Found light: %ls\n", nodeName.data());
+          #else
+            EasyOgreExporterLog("Found light: %s\n", pGameNode->GetName());
+          #endif
+          if (sceneData)
+          {
+            parent = sceneData->writeNodeData(parent, pGameNode, IGameObject::IGAME_LIGHT);
+            sceneData->writeLightData(parent, pGameLight);
+          }
+        }
+      }
+    }
+    break;
+  case IGameObject::IGAME_CAMERA:
+    {
+      if(m_params.exportCameras)
+      {
+        pGameObject = pGameNode->GetIGameObject();
+        IGameCamera* pGameCamera = static_cast<IGameCamera*>(pGameObject);
+        if(pGameCamera)
+        {
+          #ifdef UNICODE
+            MSTR nodeName = pGameNode->GetName();
+            EasyOgreExporterLog("Found camera: %ls\n", nodeName.data());
+          #else
+            EasyOgreExporterLog("Found camera: %s\n", pGameNode->GetName());
+          #endif
+
+          if (sceneData)
+          {
+            parent = sceneData->writeNodeData(parent, pGameNode, IGameObject::IGAME_CAMERA);
+            sceneData->writeCameraData(parent, pGameCamera);
+          }
+        }
+      }
+    }
+    break;
+  case IGameObject::IGAME_HELPER:
+    {
+      parent = sceneData->writeNodeData(parent, pGameNode, IGameObject::IGAME_HELPER);
+    }
+    break;
+  default:
+    break;
+  }
+
+  if (pGameObject)
+    pGameNode->ReleaseIGameObject();
+  return parent;
+}
+
 } // end namespace
 
 
@@ -0,0 +1,1440 @@
+////////////////////////////////////////////////////////////////////////////////
+// ExMeshBuilderTest.cpp
+// Start Date : October 17, 2026
+////////////////////////////////////////////////////////////////////////////////
+/*********************************************************************************
+*                                                                                *
+*   This program is free software; you can redistribute it and/or modify         *
+*   it under the terms of the GNU Lesser General Public License as published by  *
+*   the Free Software Foundation; either version 2 of the License, or            *
+*   (at your option) any later version.                                          *
+*                                                                                *
+**********************************************************************************/
+
+// Headless driver for the mesh processing, runs the builder on synthetic snapshots
+// and checks the result, also print the processing time so it can be used as a benchmark.
+
+#include "ExBoneWeights.h"
+#include "ExExportCache.h"
+#include "ExEdgeListBuilder.h"
+#include "ExHash.h"
+#include "ExMeshBuilder.h"
+#include "ExMeshOptimizer.h"
+#include "ExMeshSerializer.h"
+#include "ExMeshSimplifier.h"
+#include "ExMorphCompressor.h"
+#include "ExMorphFrames.h"
+#include "ExSkinBounds.h"
+#include "ExTangentGenerator.h"
+#include "ExThreadPool.h"
+#ifdef EX_HAVE_OGRE
+#include "ExVertexWriter.h"
+#include "OgreDefaultHardwareBufferManager.h"
+#endif
+
+#include <stdio.h>
+#include <math.h>
+#include <string.h>
+#include <chrono>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+
+using namespace EasyOgreExporter;
+
+static int g_failures = 0;
+
+#define EX_CHECK(cond) \
+  do { if (!(cond)) { printf("FAILED %s:%d : %s\n", __FILE__, __LINE__, #cond); g_failures++; } } while (0)
+
+static double elapsedMs(std::chrono::steady_clock::time_point start)
+{
+  return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+static void addCorner(ExMeshSnapshot& snapshot, int vertex, const float* normal, float u, float v)
+{
+  snapshot.faceVertices.push_back(vertex);
+  snapshot.cornerNormals.insert(snapshot.cornerNormals.end(), normal, normal + 3);
+  for (unsigned int set = 0; set < snapshot.numTexCoordSets; set++)
+  {
+    snapshot.cornerTexCoords.push_back(u);
+    snapshot.cornerTexCoords.push_back(v);
+    snapshot.cornerTexCoords.push_back(0.0f);
+  }
+}
+
+// unit cube with hard edges, two materials and a 2 bones skin
+static void buildCube(ExMeshSnapshot& snapshot)
+{
+  snapshot.clear();
+  snapshot.numTexCoordSets = 1;
+
+  for (int v = 0; v < 8; v++)
+  {
+    snapshot.positions.push_back((v & 1) ? 1.0f : -1.0f);
+    snapshot.positions.push_back((v & 2) ? 1.0f : -1.0f);
+    snapshot.positions.push_back((v & 4) ? 1.0f : -1.0f);
+  }
+
+  // quads as 4 corners, and their normal
+  const int quads[6][4] = {{0, 2, 3, 1}, {4, 5, 7, 6}, {0, 1, 5, 4}, {2, 6, 7, 3}, {0, 4, 6, 2}, {1, 3, 7, 5}};
+  const float normals[6][3] = {{0, 0, -1}, {0, 0, 1}, {0, -1, 0}, {0, 1, 0}, {-1, 0, 0}, {1, 0, 0}};
+  for (int q = 0; q < 6; q++)
+  {
+    addCorner(snapshot, quads[q][0], normals[q], 0.0f, 0.0f);
+    addCorner(snapshot, quads[q][1], normals[q], 1.0f, 0.0f);
+    addCorner(snapshot, quads[q][2], normals[q], 1.0f, 1.0f);
+    addCorner(snapshot, quads[q][0], normals[q], 0.0f, 0.0f);
+    addCorner(snapshot, quads[q][2], normals[q], 1.0f, 1.0f);
+    addCorner(snapshot, quads[q][3], normals[q], 0.0f, 1.0f);
+    snapshot.faceMaterialIds.push_back(q & 1);
+    snapshot.faceMaterialIds.push_back(q & 1);
+  }
+
+  // bottom vertices use one bone, top vertices two
+  for (int v = 0; v < 8; v++)
+  {
+    snapshot.influenceStart.push_back(snapshot.influenceWeights.size());
+    if (v & 4)
+    {
+      snapshot.influenceWeights.push_back(0.75f);
+      snapshot.influenceJoints.push_back(1);
+      snapshot.influenceWeights.push_back(0.25f);
+      snapshot.influenceJoints.push_back(0);
+    }
+    else
+    {
+      snapshot.influenceWeights.push_back(1.0f);
+      snapshot.influenceJoints.push_back(0);
+    }
+  }
+  snapshot.influenceStart.push_back(snapshot.influenceWeights.size());
+}
+
+// smooth grid of size * size quads on the xz plane
+static void buildGrid(ExMeshSnapshot& snapshot, int size)
+{
+  snapshot.clear();
+  snapshot.numTexCoordSets = 1;
+
+  const float up[3] = {0.0f, 1.0f, 0.0f};
+  for (int y = 0; y <= size; y++)
+  {
+    for (int x = 0; x <= size; x++)
+    {
+      snapshot.positions.push_back((float)x);
+      snapshot.positions.push_back(0.0f);
+      snapshot.positions.push_back((float)y);
+    }
+  }
+
+  float step = 1.0f / size;
+  for (int y = 0; y < size; y++)
+  {
+    for (int x = 0; x < size; x++)
+    {
+      int a = (y * (size + 1)) + x;
+      int c = a + size + 1;
+      addCorner(snapshot, a, up, x * step, y * step);
+      addCorner(snapshot, c, up, x * step, (y + 1) * step);
+      addCorner(snapshot, a + 1, up, (x + 1) * step, y * step);
+      addCorner(snapshot, a + 1, up, (x + 1) * step, y * step);
+      addCorner(snapshot, c, up, x * step, (y + 1) * step);
+      addCorner(snapshot, c + 1, up, (x + 1) * step, (y + 1) * step);
+      snapshot.faceMaterialIds.push_back(0);
+      snapshot.faceMaterialIds.push_back(0);
+    }
+  }
+}
+
+// every face is in one submesh and the local indices give back the face positions
+static void checkSubMeshes(const ExMeshSnapshot& snapshot, ExMeshBuilder& builder, bool shared)
+{
+  std::vector<int> faceUse(snapshot.getNumFaces(), 0);
+  const ExVertexStore& store = builder.getVertices();
+  for (unsigned int sub = 0; sub < builder.getNumSubMeshes(); sub++)
+  {
+    const ExBuiltSubMesh& submesh = builder.getSubMesh(sub);
+    EX_CHECK(submesh.indices.size() == submesh.faces.size() * 3);
+    EX_CHECK(submesh.vertices.size() <= 65535 || shared);
+
+    for (size_t fi = 0; fi < submesh.faces.size(); fi++)
+    {
+      int face = submesh.faces[fi];
+      faceUse[face]++;
+      EX_CHECK(snapshot.faceMaterialIds[face] == submesh.materialId);
+      for (int j = 0; j < 3; j++)
+      {
+        int local = submesh.indices[(fi * 3) + j];
+        EX_CHECK(local >= 0 && local < (int)submesh.vertices.size());
+        unsigned int handle = submesh.vertices[local];
+        EX_CHECK(handle == (unsigned int)builder.getFaceVertices()[(face * 3) + j]);
+        EX_CHECK(store.getMaxId(handle) == snapshot.faceVertices[(face * 3) + j]);
+        const float* pos = store.getPosition(handle);
+        const float* spos = &snapshot.positions[snapshot.faceVertices[(face * 3) + j] * 3];
+        EX_CHECK(pos[0] == spos[0] && pos[1] == spos[1] && pos[2] == spos[2]);
+      }
+    }
+  }
+
+  for (size_t f = 0; f < faceUse.size(); f++)
+    EX_CHECK(faceUse[f] == 1);
+}
+
+static void testCube()
+{
+  ExMeshSnapshot snapshot;
+  buildCube(snapshot);
+
+  ExMeshBuilder builder(snapshot);
+  builder.build(0.000001f);
+
+  const ExVertexStore& store = builder.getVertices();
+  EX_CHECK(store.size() == 24);
+  EX_CHECK(store.getNumInfluences() == 2);
+  EX_CHECK(builder.getNumSubMeshes() == 2);
+  EX_CHECK(builder.hasBounds());
+  EX_CHECK(builder.getBoundsMin()[0] == -1.0f && builder.getBoundsMax()[2] == 1.0f);
+  EX_CHECK(fabs(builder.getRadius() - sqrtf(3.0f)) < 0.0001f);
+
+  // unused influences are padded with a 0 weight
+  for (unsigned int v = 0; v < store.size(); v++)
+  {
+    const float* weights = store.getWeights(v);
+    EX_CHECK(fabs(weights[0] + weights[1] - 1.0f) < 0.0001f);
+    if ((store.getMaxId(v) & 4) == 0)
+      EX_CHECK(weights[1] == 0.0f);
+  }
+
+  for (unsigned int sub = 0; sub < builder.getNumSubMeshes(); sub++)
+    builder.optimizeSubMesh(sub, 32, true, 1.05f);
+  checkSubMeshes(snapshot, builder, false);
+
+  builder.optimizeSharedVertices();
+  checkSubMeshes(snapshot, builder, true);
+
+#ifdef EX_HAVE_OGRE
+  Ogre::VertexData vdata;
+  ExVertexWriter writer(store);
+  writer.setNormals(true);
+  writer.setColors(false);
+  writer.setNumTexCoords(1);
+  writer.write(&vdata, builder.getSubMesh(0).vertices, true, false);
+  EX_CHECK(vdata.vertexCount == builder.getSubMesh(0).vertices.size());
+  EX_CHECK(writer.getVertexSize() == (3 + 3 + 2) * sizeof(float));
+#endif
+}
+
+static void testGrid()
+{
+  ExMeshSnapshot snapshot;
+  buildGrid(snapshot, 400);
+
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  ExMeshBuilder builder(snapshot);
+  builder.build(0.000001f, 65535);
+  double buildTime = elapsedMs(start);
+
+  EX_CHECK(builder.getVertices().size() == 401 * 401);
+  EX_CHECK(builder.getNumSubMeshes() > 1);
+  checkSubMeshes(snapshot, builder, false);
+
+  start = std::chrono::steady_clock::now();
+  float acmrBefore = 0.0f;
+  float acmrAfter = 0.0f;
+  for (unsigned int sub = 0; sub < builder.getNumSubMeshes(); sub++)
+  {
+    const ExBuiltSubMesh& submesh = builder.getSubMesh(sub);
+    acmrBefore += computeACMR(submesh.indices, submesh.vertices.size(), 32);
+    builder.optimizeSubMesh(sub, 32, false, 1.05f);
+    acmrAfter += computeACMR(submesh.indices, submesh.vertices.size(), 32);
+  }
+  double optimizeTime = elapsedMs(start);
+
+  EX_CHECK(acmrAfter <= acmrBefore);
+  checkSubMeshes(snapshot, builder, false);
+
+  printf("grid %u faces : build %.1f ms, optimize %.1f ms, %u submeshes\n", snapshot.getNumFaces(), buildTime, optimizeTime, builder.getNumSubMeshes());
+}
+
+// build and optimize one mesh
+class BuildMeshJob : public ExPoolJob
+{
+public:
+  BuildMeshJob(std::vector<ExMeshBuilder*>& builders) : m_builders(builders)
+  {
+  }
+
+  void run(size_t i)
+  {
+    m_builders[i]->build(0.000001f);
+    for (unsigned int sub = 0; sub < m_builders[i]->getNumSubMeshes(); sub++)
+      m_builders[i]->optimizeSubMesh(sub, 32, true, 1.05f);
+  }
+
+private:
+  std::vector<ExMeshBuilder*>& m_builders;
+};
+
+// mark the job done, job 42 fails
+class FailingJob : public ExPoolJob
+{
+public:
+  FailingJob(std::vector<int>& done) : m_done(done)
+  {
+  }
+
+  void run(size_t i)
+  {
+    if (i == 42)
+      throw std::runtime_error("job failed");
+    m_done[i] = 1;
+  }
+
+private:
+  std::vector<int>& m_done;
+};
+
+// meshes processed on the pool give the same result as the serial processing
+static void testThreadPool()
+{
+  const int numMeshes = 12;
+  std::vector<ExMeshSnapshot> snapshots(numMeshes);
+  for (int i = 0; i < numMeshes; i++)
+  {
+    if (i & 1)
+      buildCube(snapshots[i]);
+    else
+      buildGrid(snapshots[i], 20 + (i * 10));
+  }
+
+  std::vector<ExMeshBuilder*> serial;
+  for (int i = 0; i < numMeshes; i++)
+  {
+    serial.push_back(new ExMeshBuilder(snapshots[i]));
+    serial[i]->build(0.000001f);
+    for (unsigned int sub = 0; sub < serial[i]->getNumSubMeshes(); sub++)
+      serial[i]->optimizeSubMesh(sub, 32, true, 1.05f);
+  }
+
+  std::vector<ExMeshBuilder*> parallel;
+  for (int i = 0; i < numMeshes; i++)
+    parallel.push_back(new ExMeshBuilder(snapshots[i]));
+
+  ExThreadPool pool(4);
+  EX_CHECK(pool.getNumThreads() == 4);
+  BuildMeshJob buildJob(parallel);
+  pool.run(parallel.size(), buildJob);
+
+  for (int i = 0; i < numMeshes; i++)
+  {
+    EX_CHECK(serial[i]->getNumSubMeshes() == parallel[i]->getNumSubMeshes());
+    for (unsigned int sub = 0; sub < serial[i]->getNumSubMeshes(); sub++)
+    {
+      EX_CHECK(serial[i]->getSubMesh(sub).indices == parallel[i]->getSubMesh(sub).indices);
+      EX_CHECK(serial[i]->getSubMesh(sub).vertices == parallel[i]->getSubMesh(sub).vertices);
+    }
+    delete serial[i];
+    delete parallel[i];
+  }
+
+  // a job exception is thrown back to the caller once the other jobs are done
+  std::vector<int> done(100, 0);
+  bool thrown = false;
+  try
+  {
+    FailingJob failingJob(done);
+    pool.run(done.size(), failingJob);
+  }
+  catch (std::runtime_error&)
+  {
+    thrown = true;
+  }
+  EX_CHECK(thrown);
+  for (size_t i = 0; i < done.size(); i++)
+    EX_CHECK(done[i] == ((i == 42) ? 0 : 1));
+}
+
+// same content gives the same fingerprint whatever the way it is added
+static void testHash()
+{
+  ExMeshSnapshot a;
+  ExMeshSnapshot b;
+  buildCube(a);
+  buildCube(b);
+
+  ExHasher hashA;
+  hashA.addVector(a.positions);
+  hashA.addVector(a.faceVertices);
+  ExHasher hashB;
+  hashB.addVector(b.positions);
+  hashB.addVector(b.faceVertices);
+  EX_CHECK(hashA.toString() == hashB.toString());
+  EX_CHECK(hashA.toString().size() == 32);
+
+  b.positions[5] += 0.001f;
+  ExHasher hashC;
+  hashC.addVector(b.positions);
+  hashC.addVector(b.faceVertices);
+  EX_CHECK(hashA.toString() != hashC.toString());
+
+  const char* text = "EasyOgreExporter mesh fingerprint";
+  ExHasher whole;
+  whole.add(text, strlen(text));
+  ExHasher split;
+  split.add(text, 3);
+  split.add(text + 3, 10);
+  split.add(text + 13, strlen(text) - 13);
+  EX_CHECK(whole.toString() == split.toString());
+
+  // the array sizes are hashed, the values can not move between arrays
+  std::vector<int> first(3, 1);
+  std::vector<int> second(2, 1);
+  ExHasher hashD;
+  hashD.addVector(first);
+  hashD.addVector(second);
+  ExHasher hashE;
+  hashE.addVector(second);
+  hashE.addVector(first);
+  EX_CHECK(hashD.toString() != hashE.toString());
+}
+
+// files are skipped only when their hash is unchanged and they still exist
+static void testExportCache()
+{
+  const std::string manifest = "ExMeshBuilderTest.exportcache";
+  const std::string meshFile = "ExMeshBuilderTest_cache.mesh";
+  const std::string texFile = "ExMeshBuilderTest_cache.dds";
+  std::ofstream(meshFile.c_str()) << "mesh";
+  std::ofstream(texFile.c_str()) << "texture";
+
+  ExExportCache cache;
+  cache.load(manifest, true);
+  EX_CHECK(!cache.isUpToDate(meshFile, "hash0"));
+  cache.update(meshFile, "hash0", "1 2 3 0.5 0.5 0.5");
+  cache.update(texFile, "hash1");
+  EX_CHECK(cache.save());
+
+  std::string data;
+  ExExportCache next;
+  next.load(manifest, false);
+  EX_CHECK(next.isUpToDate(meshFile, "hash0", &data));
+  EX_CHECK(data == "1 2 3 0.5 0.5 0.5");
+  EX_CHECK(!next.isUpToDate(meshFile, "hash2"));
+  EX_CHECK(!next.isUpToDate(meshFile, ""));
+  EX_CHECK(next.isUpToDate(texFile, "hash1"));
+  EX_CHECK(next.getNumSkipped() == 2);
+
+  // a file written without hash or failed can not be skipped anymore
+  next.update(texFile, "");
+  next.invalidate(meshFile);
+  EX_CHECK(!next.isUpToDate(texFile, "hash1"));
+  EX_CHECK(!next.isUpToDate(meshFile, "hash0"));
+
+  // deleted output and forced rebuild
+  ExExportCache removed;
+  removed.load(manifest, false);
+  remove(meshFile.c_str());
+  EX_CHECK(!removed.isUpToDate(meshFile, "hash0"));
+  EX_CHECK(removed.isUpToDate(texFile, "hash1"));
+
+  ExExportCache forced;
+  forced.load(manifest, true);
+  EX_CHECK(!forced.isUpToDate(texFile, "hash1"));
+
+  EX_CHECK(!ExExportCache::getFileStamp(texFile).empty());
+  EX_CHECK(ExExportCache::getFileStamp(meshFile).empty());
+
+  remove(texFile.c_str());
+  remove(manifest.c_str());
+}
+
+// triangle lists of the built submeshes as store handles
+static std::vector<std::vector<unsigned int> > getSubMeshHandles(ExMeshBuilder& builder)
+{
+  std::vector<std::vector<unsigned int> > handles(builder.getNumSubMeshes());
+  for (unsigned int sub = 0; sub < builder.getNumSubMeshes(); sub++)
+  {
+    const ExBuiltSubMesh& submesh = builder.getSubMesh(sub);
+    for (size_t i = 0; i < submesh.indices.size(); i++)
+      handles[sub].push_back(submesh.vertices[submesh.indices[i]]);
+  }
+  return handles;
+}
+
+// the levels reach their target without flipping faces or moving the outline
+static void testSimplifier()
+{
+  ExMeshSnapshot snapshot;
+  buildGrid(snapshot, 32);
+  ExMeshBuilder builder(snapshot);
+  builder.build(0.000001f);
+  const ExVertexStore& store = builder.getVertices();
+  std::vector<std::vector<unsigned int> > base = getSubMeshHandles(builder);
+  EX_CHECK(base.size() == 1);
+
+  std::vector<std::vector<unsigned int> > level;
+  EX_CHECK(simplifyMesh(store, base, 1.0f, ExSimplifyOptions(), level) == 2048);
+  EX_CHECK(level == base);
+
+  size_t kept = simplifyMesh(store, base, 0.25f, ExSimplifyOptions(), level);
+  EX_CHECK(kept <= 512 && kept > 64);
+  EX_CHECK(level[0].size() == kept * 3);
+
+  int corners = 0;
+  for (size_t i = 0; i < level[0].size(); i += 3)
+  {
+    const float* a = store.getPosition(level[0][i]);
+    const float* b = store.getPosition(level[0][i + 1]);
+    const float* c = store.getPosition(level[0][i + 2]);
+    // facing up, y of (b - a) x (c - a)
+    float ny = ((b[2] - a[2]) * (c[0] - a[0])) - ((b[0] - a[0]) * (c[2] - a[2]));
+    EX_CHECK(ny > 0.0f);
+    for (int k = 0; k < 3; k++)
+    {
+      const float* p = store.getPosition(level[0][i + k]);
+      if ((p[0] == 0.0f || p[0] == 32.0f) && (p[2] == 0.0f || p[2] == 32.0f))
+        corners++;
+    }
+  }
+  EX_CHECK(corners >= 4);
+
+  // the cube faces are split by hard edges and materials, nothing can collapse
+  buildCube(snapshot);
+  ExMeshBuilder cubeBuilder(snapshot);
+  cubeBuilder.build(0.000001f);
+  EX_CHECK(simplifyMesh(cubeBuilder.getVertices(), getSubMeshHandles(cubeBuilder), 0.5f, ExSimplifyOptions(), level) == 12);
+
+  buildGrid(snapshot, 200);
+  ExMeshBuilder bigBuilder(snapshot);
+  bigBuilder.build(0.000001f);
+  base = getSubMeshHandles(bigBuilder);
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  kept = simplifyMesh(bigBuilder.getVertices(), base, 0.25f, ExSimplifyOptions(), level);
+  printf("simplify %u faces to %u : %.1f ms\n", snapshot.getNumFaces(), (unsigned int)kept, elapsedMs(start));
+  EX_CHECK(kept <= 20000);
+}
+
+// tangents follow u, the handedness gives v and the mirrored half is split on the mirror line
+static void testTangents()
+{
+  ExMeshSnapshot snapshot;
+  buildGrid(snapshot, 32);
+  ExMeshBuilder builder(snapshot);
+  builder.setTangentTexCoordSet(0);
+  builder.build(0.000001f);
+  const ExVertexStore& store = builder.getVertices();
+  EX_CHECK(store.hasTangents());
+  EX_CHECK(store.size() == 33 * 33);
+  for (unsigned int v = 0; v < store.size(); v++)
+  {
+    const float* t = store.getTangent(v);
+    EX_CHECK(fabs(t[0] - 1.0f) < 0.0001f && fabs(t[1]) < 0.0001f && fabs(t[2]) < 0.0001f);
+    // binormal w * cross(up, +x) is -w along z, v goes along +z
+    EX_CHECK(t[3] == -1.0f);
+  }
+
+  // mirror u on the middle column
+  for (unsigned int corner = 0; corner < snapshot.getNumFaces() * 3; corner++)
+    snapshot.cornerTexCoords[corner * 3] = fabs(snapshot.positions[snapshot.faceVertices[corner] * 3] - 16.0f) / 32.0f;
+
+  ExMeshBuilder mirrorBuilder(snapshot);
+  mirrorBuilder.setTangentTexCoordSet(0);
+  mirrorBuilder.build(0.000001f);
+  const ExVertexStore& mirrored = mirrorBuilder.getVertices();
+  EX_CHECK(mirrored.size() == (33 * 33) + 33);
+  for (unsigned int v = 0; v < mirrored.size(); v++)
+  {
+    const float* t = mirrored.getTangent(v);
+    EX_CHECK(fabs(fabs(t[0]) - 1.0f) < 0.0001f);
+    EX_CHECK(fabs(t[0] + t[3]) < 0.0001f);
+    if (mirrored.getPosition(v)[0] < 16.0f)
+      EX_CHECK(t[3] == 1.0f);
+    if (mirrored.getPosition(v)[0] > 16.0f)
+      EX_CHECK(t[3] == -1.0f);
+  }
+
+  // no uv set, the store has no tangents
+  buildGrid(snapshot, 4);
+  snapshot.numTexCoordSets = 0;
+  snapshot.cornerTexCoords.clear();
+  ExMeshBuilder noUvBuilder(snapshot);
+  noUvBuilder.setTangentTexCoordSet(0);
+  noUvBuilder.build(0.000001f);
+  EX_CHECK(!noUvBuilder.getVertices().hasTangents());
+
+  buildGrid(snapshot, 400);
+  std::vector<float> cornerTangents;
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  computeTangents(snapshot, 0, 0.000001f, cornerTangents);
+  printf("tangents of %u faces : %.1f ms\n", snapshot.getNumFaces(), elapsedMs(start));
+  EX_CHECK(cornerTangents.size() == snapshot.getNumFaces() * 12);
+}
+
+// chunk reader for the serializer test
+static unsigned short readShort(const std::vector<unsigned char>& data, size_t pos)
+{
+  unsigned short value;
+  memcpy(&value, &data[pos], sizeof(value));
+  return value;
+}
+
+static unsigned int readInt(const std::vector<unsigned char>& data, size_t pos)
+{
+  unsigned int value;
+  memcpy(&value, &data[pos], sizeof(value));
+  return value;
+}
+
+static std::vector<unsigned char> readTestFile(const std::string& path)
+{
+  std::ifstream input(path.c_str(), std::ios::in | std::ios::binary);
+  std::vector<unsigned char> data((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+  input.close();
+  remove(path.c_str());
+  return data;
+}
+
+// one skinned submesh on the vertices with its bounds, name table and edge list, read back from the file
+static std::vector<unsigned char> writeNativeTestMesh(const ExVertexStore& store, const std::vector<unsigned int>& vertices, const std::vector<ExVertexElement>& elements, const std::string& version, bool oldEdgeList)
+{
+  const std::string path = "ExMeshBuilderTest_native.mesh";
+  ExMeshSerializer serializer;
+  EX_CHECK(serializer.open(path, version));
+  serializer.beginMesh(true);
+  serializer.beginSubMesh("material", false, vertices);
+  serializer.writeGeometry(store, vertices, elements, true);
+  serializer.writeSubMeshOperation(EX_OT_TRIANGLE_LIST);
+  serializer.writeBoneAssignments(EX_M_SUBMESH_BONE_ASSIGNMENT, ExMeshSerializer::rationaliseBoneAssignments(store, vertices));
+  serializer.endChunk();
+  serializer.writeSkeletonLink("skeleton.skeleton");
+  const float bmin[3] = {0.0f, 0.0f, 0.0f};
+  const float bmax[3] = {2.0f, 4.0f, 0.0f};
+  serializer.writeBounds(bmin, bmax, 2.5f);
+  serializer.writeSubMeshNameTable(std::vector<std::pair<std::string, unsigned short> >(1, std::make_pair(std::string("0"), (unsigned short)0)));
+  ExEdgeData edgeData;
+  ExEdgeListBuilder edgeBuilder(store);
+  edgeBuilder.addIndexSet(vertices, edgeBuilder.addVertexSet(vertices));
+  edgeBuilder.build(edgeData, 1);
+  serializer.writeEdgeList(edgeData, oldEdgeList);
+  serializer.endChunk();
+  EX_CHECK(serializer.close());
+  return readTestFile(path);
+}
+
+#ifdef EX_HAVE_OGRE
+// remove the submesh name table from the mesh chunk, Ogre writes it from a hash map
+static void removeSubMeshNameTable(std::vector<unsigned char>& data, size_t headerSize)
+{
+  size_t pos = headerSize + 7;
+  while (pos + 6 <= data.size())
+  {
+    unsigned int size = readInt(data, pos + 2);
+    if (size < 6)
+      return;
+
+    if (readShort(data, pos) == EX_M_SUBMESH_NAME_TABLE)
+    {
+      data.erase(data.begin() + pos, data.begin() + pos + size);
+      unsigned int meshSize = readInt(data, headerSize + 2) - size;
+      memcpy(&data[headerSize + 2], &meshSize, sizeof(meshSize));
+      return;
+    }
+    pos += size;
+  }
+}
+
+// the same mesh built through Ogre and written by Ogre::MeshSerializer must give the same file
+static void compareOgreMeshSerializer(const ExVertexStore& store, const std::vector<unsigned int>& vertices)
+{
+  Ogre::MeshPtr pMesh = Ogre::MeshManager::getSingleton().createManual("ExMeshBuilderTest", Ogre::ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME);
+  Ogre::SubMesh* pSubmesh = pMesh->createSubMesh();
+  pSubmesh->operationType = Ogre::RenderOperation::OT_TRIANGLE_LIST;
+  pSubmesh->setMaterialName("material");
+  pSubmesh->useSharedVertices = false;
+  pSubmesh->vertexData = new Ogre::VertexData();
+  pSubmesh->vertexData->vertexCount = vertices.size();
+
+  ExVertexWriter writer(store);
+  writer.setNormals(true);
+  writer.setColors(false);
+  writer.setNumTexCoords(1);
+  writer.write(pSubmesh->vertexData, vertices, true, false);
+
+  pSubmesh->indexData->indexCount = vertices.size();
+  pSubmesh->indexData->indexBuffer = Ogre::HardwareBufferManager::getSingleton().createIndexBuffer(
+    Ogre::HardwareIndexBuffer::IT_16BIT, vertices.size(), Ogre::HardwareBuffer::HBU_STATIC_WRITE_ONLY);
+  Ogre::uint16* pIdx = static_cast<Ogre::uint16*>(pSubmesh->indexData->indexBuffer->lock(Ogre::HardwareBuffer::HBL_DISCARD));
+  for (size_t i = 0; i < vertices.size(); i++)
+    pIdx[i] = static_cast<Ogre::uint16>(vertices[i]);
+  pSubmesh->indexData->indexBuffer->unlock();
+
+  std::vector<ExBoneAssignment> vbas = ExMeshSerializer::rationaliseBoneAssignments(store, vertices);
+  for (size_t i = 0; i < vbas.size(); i++)
+  {
+    Ogre::VertexBoneAssignment vba;
+    vba.vertexIndex = vbas[i].vertexIndex;
+    vba.boneIndex = vbas[i].boneIndex;
+    vba.weight = vbas[i].weight;
+    pSubmesh->addBoneAssignment(vba);
+  }
+  pMesh->nameSubMesh("0", 0);
+  pMesh->_setBounds(Ogre::AxisAlignedBox(0.0f, 0.0f, 0.0f, 2.0f, 4.0f, 0.0f), false);
+  pMesh->_setBoundingSphereRadius(2.5f);
+
+  // same steps as the exporter Ogre path
+  pMesh->load();
+  pMesh->buildEdgeList();
+  try
+  {
+    pMesh->setSkeletonName("skeleton.skeleton");
+  }
+  catch (Ogre::Exception &)
+  {
+    //ignore loading exception
+  }
+
+  std::vector<ExVertexElement> elements;
+  ExVertexElement elem = {0, EX_VET_FLOAT3, EX_VES_POSITION, 0, 0};
+  elements.push_back(elem);
+  elem.semantic = EX_VES_NORMAL;
+  elements.push_back(elem);
+  elem.type = EX_VET_FLOAT2;
+  elem.semantic = EX_VES_TEXTURE_COORDINATES;
+  elements.push_back(elem);
+  elements = ExMeshSerializer::organiseElements(elements, true, false, false);
+
+  // the mesh versions and headers of ParamList::getOgreVersion and getOgreVersionTag
+  const Ogre::MeshVersion versions[6] = {Ogre::MESH_VERSION_LATEST, Ogre::MESH_VERSION_1_10, Ogre::MESH_VERSION_1_8, Ogre::MESH_VERSION_1_7, Ogre::MESH_VERSION_1_4, Ogre::MESH_VERSION_1_0};
+  const char* tags[6] = {"[MeshSerializer_v1.100]", "[MeshSerializer_v1.100]", "[MeshSerializer_v1.8]", "[MeshSerializer_v1.41]", "[MeshSerializer_v1.40]", "[MeshSerializer_v1.30]"};
+  for (int v = 0; v < 6; v++)
+  {
+    const std::string path = "ExMeshBuilderTest_ogre.mesh";
+    Ogre::MeshSerializer serializer;
+    serializer.exportMesh(pMesh.get(), path, versions[v]);
+    std::vector<unsigned char> ogreData = readTestFile(path);
+    std::vector<unsigned char> nativeData = writeNativeTestMesh(store, vertices, elements, tags[v], versions[v] == Ogre::MESH_VERSION_1_0);
+
+    size_t headerSize = 2 + strlen(tags[v]) + 1;
+    EX_CHECK(ogreData.size() > headerSize + 6 && nativeData.size() > headerSize + 6);
+    if ((ogreData.size() <= headerSize + 6) || (nativeData.size() <= headerSize + 6))
+      continue;
+
+    removeSubMeshNameTable(ogreData, headerSize);
+    removeSubMeshNameTable(nativeData, headerSize);
+    if (ogreData != nativeData)
+      printf("mesh serializer %s differs from Ogre\n", tags[v]);
+    EX_CHECK(ogreData == nativeData);
+  }
+
+  Ogre::MeshManager::getSingleton().remove(pMesh->getHandle());
+}
+#endif
+
+// the written chunks are nested with consistent sizes and hold the expected data
+static void testMeshSerializer()
+{
+  ExVertexStore store;
+  store.setLayout(1, 4);
+  const float normal[3] = {0.0f, 0.0f, 1.0f};
+  const float color[4] = {1.0f, 0.5f, 0.0f, 1.0f};
+  for (int i = 0; i < 3; i++)
+  {
+    float pos[3] = {(float)i, (float)(i * 2), 0.0f};
+    float uv[2] = {(float)i, 1.0f};
+    // five influences on the first vertex, the smallest one is dropped
+    float weights[4] = {0.5f, 0.25f, (i == 0) ? 0.125f : 0.0f, (i == 0) ? 0.0625f : 0.0f};
+    int bones[4] = {3, 1, 2, 0};
+    store.addVertex(i, pos, normal, color, uv, weights, bones);
+  }
+
+  std::vector<ExBoneAssignment> vbas = ExMeshSerializer::rationaliseBoneAssignments(store, std::vector<unsigned int>(1, 0), 3);
+  EX_CHECK(vbas.size() == 3);
+  EX_CHECK(vbas[0].boneIndex == 3 && vbas[1].boneIndex == 1 && vbas[2].boneIndex == 2);
+  EX_CHECK(fabs(vbas[0].weight + vbas[1].weight + vbas[2].weight - 1.0f) < 0.0001f);
+
+  // Ogre auto organised layouts
+  std::vector<ExVertexElement> elements;
+  ExVertexElement elem = {0, EX_VET_FLOAT2, EX_VES_TEXTURE_COORDINATES, 0, 0};
+  elements.push_back(elem);
+  elem.type = EX_VET_FLOAT3;
+  elem.semantic = EX_VES_NORMAL;
+  elements.push_back(elem);
+  elem.semantic = EX_VES_POSITION;
+  elements.push_back(elem);
+
+  std::vector<ExVertexElement> staticElems = ExMeshSerializer::organiseElements(elements, false, false, false);
+  EX_CHECK(staticElems[0].semantic == EX_VES_POSITION && staticElems[0].source == 0 && staticElems[0].offset == 0);
+  EX_CHECK(staticElems[1].semantic == EX_VES_NORMAL && staticElems[1].source == 0 && staticElems[1].offset == 12);
+  EX_CHECK(staticElems[2].semantic == EX_VES_TEXTURE_COORDINATES && staticElems[2].source == 0 && staticElems[2].offset == 24);
+
+  std::vector<ExVertexElement> skinnedElems = ExMeshSerializer::organiseElements(elements, true, false, false);
+  EX_CHECK(skinnedElems[1].source == 0 && skinnedElems[1].offset == 12);
+  EX_CHECK(skinnedElems[2].source == 1 && skinnedElems[2].offset == 0);
+
+  std::vector<ExVertexElement> morphElems = ExMeshSerializer::organiseElements(elements, false, true, false);
+  EX_CHECK(morphElems[1].source == 1 && morphElems[1].offset == 0);
+  EX_CHECK(morphElems[2].source == 1 && morphElems[2].offset == 12);
+
+  const std::string version = "[MeshSerializer_v1.100]";
+  std::vector<unsigned int> vertices;
+  vertices.push_back(0);
+  vertices.push_back(1);
+  vertices.push_back(2);
+  std::vector<unsigned char> data = writeNativeTestMesh(store, vertices, skinnedElems, version, false);
+
+  size_t headerSize = 2 + version.size() + 1;
+  EX_CHECK(data.size() > headerSize + 6);
+  if (data.size() <= headerSize + 6)
+    return;
+
+  EX_CHECK(readShort(data, 0) == EX_M_HEADER);
+  EX_CHECK(std::string(data.begin() + 2, data.begin() + headerSize) == version + "\n");
+  EX_CHECK(readShort(data, headerSize) == EX_M_MESH);
+  EX_CHECK(readInt(data, headerSize + 2) == data.size() - headerSize);
+  EX_CHECK(data[headerSize + 6] == 1);
+
+  // walk the mesh children and the submesh children
+  size_t numBoneAssignments = 0;
+  size_t vertexDataSize = 0;
+  bool foundBounds = false;
+  bool foundNames = false;
+  bool foundEdges = false;
+  size_t pos = headerSize + 7;
+  while (pos + 6 <= data.size())
+  {
+    unsigned short id = readShort(data, pos);
+    unsigned int size = readInt(data, pos + 2);
+    EX_CHECK(size >= 6 && pos + size <= data.size());
+    if (size < 6 || pos + size > data.size())
+      return;
+
+    if (id == EX_M_SUBMESH)
+    {
+      // material, shared flag, 3 indices on 16 bits
+      size_t sub = pos + 6;
+      EX_CHECK(std::string(data.begin() + sub, data.begin() + sub + 9) == "material\n");
+      sub += 9;
+      EX_CHECK(data[sub] == 0);
+      EX_CHECK(readInt(data, sub + 1) == 3);
+      EX_CHECK(data[sub + 5] == 0);
+      EX_CHECK(readShort(data, sub + 6) == 0 && readShort(data, sub + 8) == 1 && readShort(data, sub + 10) == 2);
+      sub += 12;
+      while (sub < pos + size)
+      {
+        unsigned short subId = readShort(data, sub);
+        unsigned int subSize = readInt(data, sub + 2);
+        EX_CHECK(subSize >= 6 && sub + subSize <= pos + size);
+        if (subSize < 6)
+          return;
+
+        if (subId == EX_M_GEOMETRY)
+        {
+          EX_CHECK(readInt(data, sub + 6) == 3);
+          size_t geom = sub + 10;
+          while (geom < sub + subSize)
+          {
+            if (readShort(data, geom) == EX_M_GEOMETRY_VERTEX_BUFFER)
+              vertexDataSize += readInt(data, geom + 12) - 6;
+            geom += readInt(data, geom + 2);
+          }
+          EX_CHECK(geom == sub + subSize);
+        }
+        else if (subId == EX_M_SUBMESH_OPERATION)
+          EX_CHECK(readShort(data, sub + 6) == EX_OT_TRIANGLE_LIST);
+        else if (subId == EX_M_SUBMESH_BONE_ASSIGNMENT)
+          numBoneAssignments++;
+
+        sub += subSize;
+      }
+      EX_CHECK(sub == pos + size);
+    }
+    else if (id == EX_M_MESH_BOUNDS)
+    {
+      float radius;
+      memcpy(&radius, &data[pos + 6 + 24], sizeof(float));
+      EX_CHECK(size == 6 + 28 && radius == 2.5f);
+      foundBounds = true;
+    }
+    else if (id == EX_M_SUBMESH_NAME_TABLE)
+    {
+      EX_CHECK(readShort(data, pos + 6) == EX_M_SUBMESH_NAME_TABLE_ELEMENT);
+      foundNames = true;
+    }
+    else if (id == EX_M_EDGE_LISTS)
+    {
+      // one level with one triangle and one group of 3 open edges
+      EX_CHECK(size == 6 + (18 + 48 + (6 + 16 + (3 * 25))));
+      EX_CHECK(readShort(data, pos + 6) == EX_M_EDGE_LIST_LOD);
+      EX_CHECK(data[pos + 14] == 0 && data[pos + 15] == 0);
+      EX_CHECK(readInt(data, pos + 16) == 1 && readInt(data, pos + 20) == 1);
+      EX_CHECK(readShort(data, pos + 24 + 48) == EX_M_EDGE_GROUP);
+      foundEdges = true;
+    }
+    pos += size;
+  }
+  EX_CHECK(pos == data.size());
+
+  // positions and normals in the first buffer, texture coordinates in the second
+  EX_CHECK(vertexDataSize == 3 * (24 + 8));
+  EX_CHECK(numBoneAssignments == 4 + 2 + 2);
+  EX_CHECK(foundBounds && foundNames && foundEdges);
+
+#ifdef EX_HAVE_OGRE
+  compareOgreMeshSerializer(store, vertices);
+#endif
+}
+
+// count the edges of each kind and check the face planes
+static void checkEdgeList(const ExVertexStore& store, const std::vector<std::vector<unsigned int> >& vertexSets, const ExEdgeData& data, size_t& numEdges, size_t& numOpen)
+{
+  numEdges = 0;
+  numOpen = 0;
+  for (size_t g = 0; g < data.edgeGroups.size(); g++)
+  {
+    const ExEdgeGroup& group = data.edgeGroups[g];
+    for (size_t e = 0; e < group.edges.size(); e++)
+    {
+      const ExEdge& edge = group.edges[e];
+      numEdges++;
+      if (edge.degenerate)
+      {
+        numOpen++;
+        EX_CHECK(edge.triIndex[1] == 0xffffffff);
+        continue;
+      }
+
+      // the second triangle use the edge the other way
+      const ExEdgeTriangle& tri = data.triangles[edge.triIndex[1]];
+      bool found = false;
+      for (int k = 0; k < 3; k++)
+        found |= (tri.sharedVertIndex[k] == edge.sharedVertIndex[1]) && (tri.sharedVertIndex[(k + 1) % 3] == edge.sharedVertIndex[0]);
+      EX_CHECK(found);
+    }
+  }
+
+  for (size_t t = 0; t < data.triangles.size(); t++)
+  {
+    const ExEdgeTriangle& tri = data.triangles[t];
+    const float* n = &data.faceNormals[t * 4];
+    for (int k = 0; k < 3; k++)
+    {
+      const float* p = store.getPosition(vertexSets[tri.vertexSet][tri.vertIndex[k]]);
+      EX_CHECK(fabs((n[0] * p[0]) + (n[1] * p[1]) + (n[2] * p[2]) + n[3]) < 0.001f);
+    }
+  }
+}
+
+// closed cube split in submeshes with their own vertices or shared ones, open grid
+static void testEdgeList()
+{
+  ExMeshSnapshot snapshot;
+  buildCube(snapshot);
+  ExMeshBuilder builder(snapshot);
+  builder.build(0.000001f);
+  const ExVertexStore& store = builder.getVertices();
+
+  std::vector<std::vector<unsigned int> > vertexSets;
+  std::vector<std::vector<unsigned int> > indexSets;
+  for (unsigned int sub = 0; sub < builder.getNumSubMeshes(); sub++)
+  {
+    const ExBuiltSubMesh& submesh = builder.getSubMesh(sub);
+    vertexSets.push_back(submesh.vertices);
+    indexSets.push_back(std::vector<unsigned int>(submesh.indices.begin(), submesh.indices.end()));
+  }
+  EX_CHECK(vertexSets.size() == 2);
+
+  ExEdgeData data;
+  ExEdgeListBuilder dedicated(store);
+  for (size_t sub = 0; sub < vertexSets.size(); sub++)
+    dedicated.addIndexSet(indexSets[sub], dedicated.addVertexSet(vertexSets[sub]));
+  dedicated.build(data);
+
+  size_t numEdges = 0;
+  size_t numOpen = 0;
+  checkEdgeList(store, vertexSets, data, numEdges, numOpen);
+  EX_CHECK(data.isClosed);
+  EX_CHECK(data.triangles.size() == 12 && numEdges == 18 && numOpen == 0);
+  EX_CHECK(data.edgeGroups.size() == 2);
+  EX_CHECK(data.edgeGroups[0].triStart == 0 && data.edgeGroups[0].triCount == 6);
+  EX_CHECK(data.edgeGroups[1].triStart == 6 && data.edgeGroups[1].triCount == 6);
+
+  std::vector<std::vector<unsigned int> > sharedSets(1);
+  for (unsigned int v = 0; v < store.size(); v++)
+    sharedSets[0].push_back(v);
+  std::vector<std::vector<unsigned int> > sharedIndices = getSubMeshHandles(builder);
+  ExEdgeListBuilder shared(store);
+  shared.addVertexSet(sharedSets[0]);
+  for (size_t sub = 0; sub < sharedIndices.size(); sub++)
+    shared.addIndexSet(sharedIndices[sub], 0);
+  shared.build(data);
+  checkEdgeList(store, sharedSets, data, numEdges, numOpen);
+  EX_CHECK(data.isClosed && data.edgeGroups.size() == 1);
+  EX_CHECK(numEdges == 18 && numOpen == 0);
+
+  buildGrid(snapshot, 8);
+  ExMeshBuilder gridBuilder(snapshot);
+  gridBuilder.build(0.000001f);
+  std::vector<std::vector<unsigned int> > gridSets(1);
+  for (unsigned int v = 0; v < gridBuilder.getVertices().size(); v++)
+    gridSets[0].push_back(v);
+  std::vector<std::vector<unsigned int> > gridIndices = getSubMeshHandles(gridBuilder);
+  ExEdgeListBuilder grid(gridBuilder.getVertices());
+  grid.addVertexSet(gridSets[0]);
+  grid.addIndexSet(gridIndices[0], 0);
+  grid.build(data);
+  checkEdgeList(gridBuilder.getVertices(), gridSets, data, numEdges, numOpen);
+  EX_CHECK(!data.isClosed);
+  EX_CHECK(numEdges == (3 * 64) + (2 * 8) && numOpen == 4 * 8);
+
+  buildGrid(snapshot, 400);
+  ExMeshBuilder bigBuilder(snapshot);
+  bigBuilder.build(0.000001f, 65535);
+  const ExVertexStore& bigStore = bigBuilder.getVertices();
+  std::vector<std::vector<unsigned int> > bigSets;
+  std::vector<std::vector<unsigned int> > bigIndices;
+  for (unsigned int sub = 0; sub < bigBuilder.getNumSubMeshes(); sub++)
+  {
+    const ExBuiltSubMesh& submesh = bigBuilder.getSubMesh(sub);
+    bigSets.push_back(submesh.vertices);
+    bigIndices.push_back(std::vector<unsigned int>(submesh.indices.begin(), submesh.indices.end()));
+  }
+  ExEdgeListBuilder big(bigStore);
+  for (size_t sub = 0; sub < bigSets.size(); sub++)
+    big.addIndexSet(bigIndices[sub], big.addVertexSet(bigSets[sub]));
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  big.build(data);
+  printf("edge list of %u faces in %u submeshes : %.1f ms\n", snapshot.getNumFaces(), (unsigned int)bigSets.size(), elapsedMs(start));
+  checkEdgeList(bigStore, bigSets, data, numEdges, numOpen);
+  EX_CHECK(numEdges == (3 * 400 * 400) + (2 * 400) && numOpen == 4 * 400);
+}
+
+static void testBoneWeights()
+{
+  // bone 3 is given twice, the two smallest distinct influences are removed
+  const float weights[6] = {0.1f, 0.3f, 0.05f, 0.2f, 0.15f, 0.2f};
+  const int bones[6] = {3, 1, 4, 2, 5, 3};
+  float outWeights[4];
+  int outBones[4];
+  float removed = 0.0f;
+  unsigned int numBones = reduceInfluences(weights, bones, 6, 4, outWeights, outBones, removed);
+  EX_CHECK(numBones == 5);
+  EX_CHECK(outBones[0] == 3 && outBones[1] == 1 && outBones[2] == 2 && outBones[3] == 5);
+  EX_CHECK(fabs(removed - 0.05f) < 0.0001f);
+  EX_CHECK(fabs(outWeights[0] + outWeights[1] + outWeights[2] + outWeights[3] - 1.0f) < 0.0001f);
+  EX_CHECK(fabs(outWeights[0] - (0.3f / 0.95f)) < 0.0001f);
+  EX_CHECK(outWeights[0] >= outWeights[1] && outWeights[1] >= outWeights[2] && outWeights[2] >= outWeights[3]);
+
+  // fewer influences than kept, the unused slots are null
+  numBones = reduceInfluences(weights, bones, 1, 4, outWeights, outBones, removed);
+  EX_CHECK(numBones == 1 && outBones[0] == 3 && outWeights[0] == 1.0f);
+  EX_CHECK(outWeights[1] == 0.0f && outBones[1] == 0 && removed == 0.0f);
+
+  const float thirds[3] = {1.0f / 3.0f, 1.0f / 3.0f, 1.0f / 3.0f};
+  unsigned char bytes[4] = {0, 0, 0, 0};
+  quantizeWeights(thirds, 3, bytes);
+  EX_CHECK(bytes[0] + bytes[1] + bytes[2] == 255 && bytes[3] == 0);
+  quantizeWeights(outWeights, 4, bytes);
+  EX_CHECK(bytes[0] == 255 && bytes[1] == 0);
+
+  // the cube with 6 influences on its top vertices keeps 2 of them
+  ExMeshSnapshot snapshot;
+  buildCube(snapshot);
+  snapshot.influenceStart.clear();
+  snapshot.influenceWeights.clear();
+  snapshot.influenceJoints.clear();
+  for (int v = 0; v < 8; v++)
+  {
+    snapshot.influenceStart.push_back(snapshot.influenceWeights.size());
+    int count = (v & 4) ? 6 : 1;
+    for (int j = 0; j < count; j++)
+    {
+      snapshot.influenceWeights.push_back(weights[j]);
+      snapshot.influenceJoints.push_back(bones[j]);
+    }
+  }
+  snapshot.influenceStart.push_back(snapshot.influenceWeights.size());
+
+  ExMeshBuilder builder(snapshot);
+  builder.setMaxInfluences(2);
+  builder.build(0.000001f);
+  const ExVertexStore& store = builder.getVertices();
+  EX_CHECK(store.getNumInfluences() == 2);
+  EX_CHECK(builder.getReducedInfluences().size() == 4);
+  for (size_t i = 0; i < builder.getReducedInfluences().size(); i++)
+  {
+    const ExInfluenceReport& report = builder.getReducedInfluences()[i];
+    EX_CHECK((report.vertex & 4) && report.numInfluences == 5);
+    EX_CHECK(fabs(report.removedWeight - 0.4f) < 0.0001f);
+  }
+  for (unsigned int v = 0; v < store.size(); v++)
+  {
+    const float* w = store.getWeights(v);
+    EX_CHECK(fabs(w[0] + w[1] - 1.0f) < 0.0001f);
+    if (store.getMaxId(v) & 4)
+      EX_CHECK(store.getBoneIndices(v)[0] == 3 && store.getBoneIndices(v)[1] == 1);
+  }
+
+  // blend indices in the Ogre index map, bones 1 and 3 are used so they get 0 and 1
+  std::vector<unsigned int> all;
+  for (unsigned int v = 0; v < store.size(); v++)
+    all.push_back(v);
+  std::vector<int> blendIndices;
+  EX_CHECK(buildBlendIndexMap(store, all, blendIndices) == 2);
+  EX_CHECK(blendIndices.size() == 4 && blendIndices[0] == -1 && blendIndices[1] == 0 && blendIndices[2] == -1 && blendIndices[3] == 1);
+  for (unsigned int v = 0; v < store.size(); v++)
+  {
+    unsigned char packed[4];
+    packBlendIndices(store.getWeights(v), store.getBoneIndices(v), store.getNumInfluences(), blendIndices, packed);
+    if (store.getMaxId(v) & 4)
+      EX_CHECK(packed[0] == 1 && packed[1] == 0 && packed[2] == 0 && packed[3] == 0);
+    else
+      EX_CHECK(packed[0] == 1 && packed[1] == 0);
+  }
+
+  // a vertex set on bone 3 only has a single blend index
+  std::vector<unsigned int> bottom;
+  for (unsigned int v = 0; v < store.size(); v++)
+  {
+    if (!(store.getMaxId(v) & 4))
+      bottom.push_back(v);
+  }
+  EX_CHECK(buildBlendIndexMap(store, bottom, blendIndices) == 1 && blendIndices[3] == 0);
+
+  // packed blend elements, one buffer after the other elements
+  std::vector<ExVertexElement> elements;
+  ExVertexElement elem;
+  elem.source = 0;
+  elem.offset = 0;
+  elem.index = 0;
+  elem.type = EX_VET_FLOAT3;
+  elem.semantic = EX_VES_POSITION;
+  elements.push_back(elem);
+  elem.type = EX_VET_UBYTE4;
+  elem.semantic = EX_VES_BLEND_INDICES;
+  elements.push_back(elem);
+  elem.type = EX_VET_UBYTE4_NORM;
+  elem.semantic = EX_VES_BLEND_WEIGHTS;
+  elements.push_back(elem);
+  std::vector<ExVertexElement> organised = ExMeshSerializer::organiseElements(elements, true, false, false);
+  EX_CHECK(organised.size() == 3);
+  EX_CHECK(organised[1].semantic == EX_VES_BLEND_WEIGHTS && organised[1].source == 1 && organised[1].offset == 0);
+  EX_CHECK(organised[2].semantic == EX_VES_BLEND_INDICES && organised[2].source == 1 && organised[2].offset == 4);
+  EX_CHECK(ExMeshSerializer::getTypeSize(EX_VET_UBYTE4_NORM) == 4 && ExMeshSerializer::getTypeSize(EX_VET_FLOAT1 + 1) == 8);
+}
+
+static void testSkinBounds()
+{
+  ExMeshSnapshot snapshot;
+  buildGrid(snapshot, 16);
+  ExMeshBuilder gridBuilder(snapshot);
+  gridBuilder.build(0.000001f);
+  const ExVertexStore& grid = gridBuilder.getVertices();
+  std::vector<unsigned int> all;
+  for (unsigned int v = 0; v < grid.size(); v++)
+    all.push_back(v);
+
+  // a square of side 16 has a minimal sphere of radius 8 * sqrt(2)
+  float center[3];
+  float radius = 0.0f;
+  EX_CHECK(computeBoundingSphere(grid, all, center, radius));
+  EX_CHECK(radius >= 8.0f * sqrtf(2.0f) - 0.0001f && radius < 8.0f * sqrtf(2.0f) * 1.05f);
+  for (unsigned int v = 0; v < grid.size(); v++)
+  {
+    const float* p = grid.getPosition(v);
+    float d[3] = {p[0] - center[0], p[1] - center[1], p[2] - center[2]};
+    EX_CHECK(sqrtf((d[0] * d[0]) + (d[1] * d[1]) + (d[2] * d[2])) <= radius + 0.0001f);
+  }
+  EX_CHECK(!computeBoundingSphere(grid, std::vector<unsigned int>(), center, radius));
+
+  // cube top vertices follow bone 1 at 0.75, bottom vertices only bone 0
+  buildCube(snapshot);
+  ExMeshBuilder builder(snapshot);
+  builder.build(0.000001f);
+  const ExVertexStore& store = builder.getVertices();
+  ExSkinBounds skinBounds(store, 3);
+  EX_CHECK(skinBounds.getNumUsedBones() == 2);
+
+  float identity[12] = {1, 0, 0, 0, 1, 0, 0, 0, 1, 0, 0, 0};
+  float poses[3 * 12];
+  for (int b = 0; b < 3; b++)
+    memcpy(&poses[b * 12], identity, sizeof(identity));
+
+  float minB[3] = {-1.0f, -1.0f, -1.0f};
+  float maxB[3] = {1.0f, 1.0f, 1.0f};
+  float boundsRadius = sqrtf(3.0f);
+  skinBounds.addPose(poses, minB, maxB, boundsRadius);
+  EX_CHECK(minB[0] == -1.0f && maxB[2] == 1.0f && fabs(boundsRadius - sqrtf(3.0f)) < 0.0001f);
+
+  // bone 1 moved up by 5 and bone 0 turned a quarter around z
+  poses[12 + 11] = 5.0f;
+  float quarter[12] = {0, 1, 0, -1, 0, 0, 0, 0, 1, 0, 0, 0};
+  memcpy(poses, quarter, sizeof(quarter));
+  skinBounds.addPose(poses, minB, maxB, boundsRadius);
+  EX_CHECK(fabs(maxB[2] - 6.0f) < 0.0001f && minB[2] == -1.0f);
+  EX_CHECK(fabs(maxB[0] - 1.0f) < 0.0001f && fabs(minB[1] + 1.0f) < 0.0001f);
+  EX_CHECK(fabs(boundsRadius - sqrtf(38.0f)) < 0.0001f);
+
+  // the skinned positions of that pose stay inside
+  for (unsigned int v = 0; v < store.size(); v++)
+  {
+    const float* p = store.getPosition(v);
+    const float* w = store.getWeights(v);
+    const int* bones = store.getBoneIndices(v);
+    float skinned[3] = {0.0f, 0.0f, 0.0f};
+    for (unsigned int j = 0; j < store.getNumInfluences(); j++)
+    {
+      const float* m = &poses[bones[j] * 12];
+      for (int k = 0; k < 3; k++)
+        skinned[k] += w[j] * ((p[0] * m[k]) + (p[1] * m[3 + k]) + (p[2] * m[6 + k]) + m[9 + k]);
+    }
+    for (int k = 0; k < 3; k++)
+      EX_CHECK(skinned[k] >= minB[k] - 0.0001f && skinned[k] <= maxB[k] + 0.0001f);
+    EX_CHECK(sqrtf((skinned[0] * skinned[0]) + (skinned[1] * skinned[1]) + (skinned[2] * skinned[2])) <= boundsRadius + 0.0001f);
+  }
+}
+
+// frames of a wave on the grid vertices, still between the moves
+static void buildWaveFrames(const ExVertexStore& store, ExMorphFrames& frames, int numFrames)
+{
+  std::vector<int> sources;
+  for (unsigned int v = 0; v < store.size(); v++)
+    sources.push_back(store.getMaxId(v));
+  frames.setVertices(sources);
+
+  for (int f = 0; f < numFrames; f++)
+  {
+    float* pos = frames.addFrame(f * 160);
+    float phase = (float)((f / 4) * 4);
+    for (unsigned int v = 0; v < frames.getNumSourceVertices(); v++, pos += 3)
+    {
+      int source = frames.getSourceVertices()[v];
+      pos[0] = (float)source;
+      pos[1] = sinf((source * 0.1f) + (phase * 0.2f));
+      pos[2] = 0.0f;
+    }
+  }
+}
+
+static void testMorphFrames()
+{
+  // the difference is found at any offset, also in the tail after the full lanes
+  std::vector<float> a(1003, 1.0f);
+  std::vector<float> b(a);
+  EX_CHECK(maxAbsDifference(&a[0], &b[0], a.size(), 0.0f) == 0.0f);
+  for (size_t i = 0; i < a.size(); i += 97)
+  {
+    b[i] = -1.5f;
+    EX_CHECK(maxAbsDifference(&a[0], &b[0], a.size(), 0.0f) == 2.5f);
+    EX_CHECK(maxAbsDifference(&a[0], &b[0], a.size(), 10.0f) == 2.5f);
+    b[i] = 1.0f;
+  }
+  b[1002] = 1.25f;
+  EX_CHECK(maxAbsDifference(&a[0], &b[0], a.size(), 0.0f) == 0.25f);
+  b[1] = 3.0f;
+  EX_CHECK(maxAbsDifference(&a[0], &b[0], a.size(), 0.5f) == 2.0f);
+  EX_CHECK(maxAbsDifference(&a[0], &b[0], 0, 0.0f) == 0.0f);
+
+  ExMeshSnapshot snapshot;
+  buildCube(snapshot);
+  ExMeshBuilder builder(snapshot);
+  builder.build(0.000001f);
+  const ExVertexStore& store = builder.getVertices();
+
+  // the 24 cube vertices share 8 positions
+  ExMorphFrames frames;
+  buildWaveFrames(store, frames, 10);
+  EX_CHECK(frames.getNumSourceVertices() == 8);
+  EX_CHECK(frames.getNumFrames() == 10);
+  for (unsigned int v = 0; v < store.size(); v++)
+    EX_CHECK(frames.getPosition(3, v)[0] == (float)store.getMaxId(v));
+
+  // frames 0-3, 4-7 and 8-9 are equal, only the first and last of each run stay
+  EX_CHECK(frames.removeStaticFrames(0.000001f) == 4);
+  EX_CHECK(frames.getNumFrames() == 6);
+  const int keptTimes[6] = {0, 3 * 160, 4 * 160, 7 * 160, 8 * 160, 9 * 160};
+  for (unsigned int f = 0; f < frames.getNumFrames(); f++)
+    EX_CHECK(frames.getTime(f) == keptTimes[f]);
+  EX_CHECK(frames.getPosition(2, 0)[1] == sinf((store.getMaxId(0) * 0.1f) + 0.8f));
+
+  buildGrid(snapshot, 200);
+  ExMeshBuilder gridBuilder(snapshot);
+  gridBuilder.build(0.000001f);
+  ExMorphFrames gridFrames;
+  buildWaveFrames(gridBuilder.getVertices(), gridFrames, 400);
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  unsigned int removed = gridFrames.removeStaticFrames(0.000001f);
+  printf("static frames of %u vertices * %u frames : %.1f ms\n", gridFrames.getNumSourceVertices(), 400, elapsedMs(start));
+  EX_CHECK(removed == 200 && gridFrames.getNumFrames() == 200);
+
+  // a linear move then a stop, the interpolation keeps the frames where the speed changes
+  std::vector<int> sources;
+  sources.push_back(0);
+  ExMorphFrames line;
+  line.setVertices(sources);
+  const float heights[9] = {0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 4.0f, 4.0f, 4.0005f, 4.0f};
+  for (int f = 0; f < 9; f++)
+  {
+    float* pos = line.addFrame(f * 160);
+    pos[0] = 0.0f;
+    pos[1] = heights[f];
+    pos[2] = 0.0f;
+  }
+  EX_CHECK(maxInterpolationError(line.getFrame(0), line.getFrame(4), 0.5f, line.getFrame(2), 3, 0.0f) == 0.0f);
+  EX_CHECK(line.reduceFrames(0.001f) == 6);
+  EX_CHECK(line.getNumFrames() == 3);
+  EX_CHECK(line.getTime(0) == 0 && line.getTime(1) == 4 * 160 && line.getTime(2) == 8 * 160);
+
+  // each still step of the wave needs its first and last frames
+  ExMorphFrames wave;
+  buildWaveFrames(store, wave, 12);
+  unsigned int numSampled = wave.getNumFrames();
+  wave.reduceFrames(0.0001f);
+  EX_CHECK(wave.getNumFrames() < numSampled && wave.getNumFrames() >= 6);
+
+  buildWaveFrames(gridBuilder.getVertices(), gridFrames, 400);
+  start = std::chrono::steady_clock::now();
+  removed = gridFrames.reduceFrames(0.01f);
+  printf("interpolated frames of %u vertices * %u frames : %.1f ms, %u kept\n", gridFrames.getNumSourceVertices(), 400, elapsedMs(start), gridFrames.getNumFrames());
+  EX_CHECK(gridFrames.getNumFrames() == 400 - removed && gridFrames.getNumFrames() >= 200);
+}
+
+static void testMorphOffsets()
+{
+  ExMeshSnapshot snapshot;
+  buildCube(snapshot);
+  ExMeshBuilder builder(snapshot);
+  builder.build(0.000001f);
+  const ExVertexStore& store = builder.getVertices();
+
+  // the target moves the vertex 7 and shakes the vertex 0 under epsilon
+  std::vector<float> target(snapshot.positions);
+  target[(7 * 3) + 1] += 0.5f;
+  target[0] += 0.0000001f;
+
+  // only the submeshes with a face on the vertex 7 get offsets, 3 corners each
+  size_t numMoved = 0;
+  std::vector<unsigned int> moved;
+  std::vector<float> offsets;
+  for (unsigned int sub = 0; sub < builder.getNumSubMeshes(); sub++)
+  {
+    const std::vector<unsigned int>& vertices = builder.getSubMesh(sub).vertices;
+    getMorphOffsets(store, vertices, &target[0], 0.000001f, moved, offsets);
+    EX_CHECK(offsets.size() == moved.size() * 3);
+    for (size_t k = 0; k < moved.size(); k++)
+    {
+      EX_CHECK(store.getMaxId(vertices[moved[k]]) == 7);
+      EX_CHECK(offsets[k * 3] == 0.0f && offsets[(k * 3) + 1] == 0.5f && offsets[(k * 3) + 2] == 0.0f);
+    }
+    numMoved += moved.size();
+  }
+  EX_CHECK(numMoved == 3);
+
+  // without epsilon the vertex 0 corners are kept too
+  std::vector<unsigned int> all;
+  for (unsigned int v = 0; v < store.size(); v++)
+    all.push_back(v);
+  getMorphOffsets(store, all, &target[0], 0.0f, moved, offsets);
+  EX_CHECK(moved.size() == 6);
+  getMorphOffsets(store, all, &snapshot.positions[0], 0.0f, moved, offsets);
+  EX_CHECK(moved.empty() && offsets.empty());
+}
+
+static void testMorphCompressor()
+{
+  ExMeshSnapshot snapshot;
+  buildGrid(snapshot, 100);
+  ExMeshBuilder builder(snapshot);
+  builder.build(0.000001f);
+  const ExVertexStore& store = builder.getVertices();
+
+  // two bending modes mixed by independent weights, the frames are rank 2
+  std::vector<int> sources;
+  for (unsigned int v = 0; v < store.size(); v++)
+    sources.push_back(store.getMaxId(v));
+  ExMorphFrames frames;
+  frames.setVertices(sources);
+  std::vector<float> base(frames.getNumSourceVertices() * 3);
+  for (unsigned int v = 0; v < store.size(); v++)
+    memcpy(&base[frames.getSourceIndex(v) * 3], store.getPosition(v), 3 * sizeof(float));
+
+  const int numFrames = 120;
+  for (int f = 0; f < numFrames; f++)
+  {
+    float* pos = frames.addFrame(f * 160);
+    float a = sinf(f * 0.1f);
+    float b = cosf(f * 0.37f) * 0.5f;
+    for (unsigned int v = 0; v < frames.getNumSourceVertices(); v++)
+    {
+      const float* p = &base[v * 3];
+      pos[(v * 3)] = p[0];
+      pos[(v * 3) + 1] = p[1] + (a * sinf(p[0] * 0.1f)) + (b * cosf(p[2] * 0.05f));
+      pos[(v * 3) + 2] = p[2];
+    }
+  }
+
+  ExMorphCompression compression;
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  bool compressed = compressMorphFrames(frames, &base[0], 0.001f, 16, 0, compression);
+  printf("morph compression of %u vertices * %d frames : %.1f ms, %u poses\n", frames.getNumSourceVertices(), numFrames, elapsedMs(start), compression.numPoses);
+  EX_CHECK(compressed && compression.numPoses == 2 && compression.maxError <= 0.001f);
+  EX_CHECK(compression.poses.size() == 2 * base.size() && compression.weights.size() == 2 * numFrames);
+
+  // the weights are at most 1 and the poses give back the frames
+  float maxError = 0.0f;
+  for (int f = 0; f < numFrames; f++)
+  {
+    const float* weights = &compression.weights[f * 2];
+    EX_CHECK(fabs(weights[0]) <= 1.0f && fabs(weights[1]) <= 1.0f);
+    const float* frame = frames.getFrame(f);
+    for (size_t i = 0; i < base.size(); i++)
+    {
+      float value = base[i] + (weights[0] * compression.poses[i]) + (weights[1] * compression.poses[base.size() + i]);
+      maxError = std::max(maxError, fabsf(value - frame[i]));
+    }
+  }
+  EX_CHECK(maxError <= 0.001f);
+
+  // one pose can not reach the tolerance
+  EX_CHECK(!compressMorphFrames(frames, &base[0], 0.001f, 1, 0, compression));
+  EX_CHECK(compression.numPoses == 1 && compression.maxError > 0.001f);
+
+  // frames on the base need no pose
+  EX_CHECK(compressMorphFrames(frames, frames.getFrame(3), 100.0f, 16, 0, compression) && compression.numPoses == 0);
+}
+
+int main()
+{
+#ifdef EX_HAVE_OGRE
+  Ogre::LogManager logManager;
+  logManager.createLog("ExMeshBuilderTest.log", true, false, true);
+  Ogre::DefaultHardwareBufferManager bufferManager;
+  // mesh, skeleton and resource managers for the Ogre::MeshSerializer comparison, no render system
+  Ogre::Root root("", "", "");
+#endif
+
+  testCube();
+  testGrid();
+  testThreadPool();
+  testHash();
+  testExportCache();
+  testMeshSerializer();
+  testSimplifier();
+  testTangents();
+  testEdgeList();
+  testBoneWeights();
+  testSkinBounds();
+  testMorphFrames();
+  testMorphCompressor();
+  testMorphOffsets();
+
+  if (g_failures)
+  {
+    printf("%d checks failed\n", g_failures);
+    return 1;
+  }
+
+  printf("all checks passed\n");
+  return 0;
+}